@@ -32,7 +32,7 @@ multizone::multizone(MODULE *module)
 {
 	if (oclass==NULL)
 	{
-		oclass = gl_register_class(module,"multizone",sizeof(multizone),passconfig);
+		oclass = gl_register_class(module,"multizone",sizeof(multizone),passconfig|PC_UNSAFE_INIT);
 		if (oclass==NULL)
 			throw "unable to register class multizone";
 		else
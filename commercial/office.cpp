@@ -371,8 +371,13 @@ int office::init(OBJECT *parent)
 
 	OBJECT *hdr = OBJECTHDR(this);
 
-	// link to climate data
-	static FINDLIST *climates = gl_find_objects(FL_NEW,FT_CLASS,SAME,"climate",FT_END);
+	// link to climate data (offices are initialized in parallel, so the first one finds the climates under the lock)
+	static FINDLIST *climates = NULL;
+	static unsigned int climates_lock = 0;
+	::wlock(&climates_lock);
+	if (climates==NULL)
+		climates = gl_find_objects(FL_NEW,FT_CLASS,SAME,"climate",FT_END);
+	::wunlock(&climates_lock);
 	if (climates==NULL)
 		gl_warning("office: no climate data found, using static data");
 	else if (climates->hit_count>1)
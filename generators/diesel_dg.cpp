@@ -25,7 +25,7 @@ diesel_dg::diesel_dg(MODULE *module)
 {
 	if (oclass==NULL)
 	{
-		oclass = gl_register_class(module,"diesel_dg",sizeof(diesel_dg),passconfig|PC_AUTOLOCK);
+		oclass = gl_register_class(module,"diesel_dg",sizeof(diesel_dg),passconfig|PC_AUTOLOCK|PC_UNSAFE_INIT|PC_NONREENTRANT);
 		if (oclass==NULL)
 			throw "unable to register class diesel_dg";
 		else
@@ -180,7 +180,7 @@ int windturb_dg::init_climate()
 	OBJECT *hdr = OBJECTHDR(this);
 
 	// link to climate data
-	static FINDLIST *climates = NULL;
+	FINDLIST *climates = NULL;
 	int not_found = 0;
 
 	climates = gl_find_objects(FL_NEW,FT_CLASS,SAME,"climate",FT_END);
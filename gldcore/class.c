@@ -17,6 +17,7 @@
 #include "enduse.h"
 #include "stream.h"
 #include "random.h"
+#include "lock.h"
 
 #if defined(WIN32) && !defined(__MINGW32__)
 #define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
@@ -49,6 +50,32 @@ extern struct s_property_specs property_type[_PT_LAST];
 static CLASS *first_class = NULL; /**< first class in class list */
 static CLASS *last_class = NULL; /**< last class in class list */
 
+/* property name index
+
+	Each class has an open-addressing hash table of the names of all the properties 
+	it can access, including those it inherits from its parent classes.  The first 
+	property found in list order wins, so the lookup gives the same result as a 
+	linear walk up the parent chain.  Adding a property to a class drops the index 
+	of that class and of every class that inherits from it, and an index is also 
+	rebuilt when the class's parent changes.  Lookups read the index without a 
+	lock, so a dropped or replaced index is not freed while another thread may be 
+	searching it; it goes on the retired list instead, which is freed at exit.  
+	Properties are only added while modules and models are being loaded, so the 
+	list stays short.
+ */
+typedef struct s_property_slot {
+	unsigned int hash; /**< hash of the property name */
+	PROPERTY *prop; /**< property (NULL if slot is empty) */
+} PROPERTYSLOT;
+struct s_property_index {
+	CLASS *parent; /**< parent class when the index was built */
+	unsigned int mask; /**< table size - 1 (size is a power of 2) */
+	PROPERTYSLOT *slot; /**< hash table */
+	struct s_property_index *next_retired; /**< next index on the retired list */
+};
+static unsigned int property_index_lock = 0;
+static struct s_property_index *retired_index = NULL; /**< indexes that may still be in use by lookups */
+
 /** Get the first property in a class's property list.
 	All subsequent properties that have the same class
 	can be scanned.  Be careful not to scan off the end
@@ -144,33 +171,152 @@ int property_create(PROPERTY *prop, void *addr)
 }
 #endif
 
-/* though improbable, this is to prevent more complicated, specifically crafted
-	inheritence loops.  these should be impossible if a class_register call is
-	immediately followed by a class_define_map call. -d3p988 */
-PROPERTY *class_find_property_rec(CLASS *oclass, 
-                                  PROPERTYNAME name, 
-                                  CLASS *pclass)
+/* FNV-1a hash of a property name */
+static unsigned int property_hash(const char *name)
+{
+	unsigned int hash = 2166136261u;
+	while ( *name!='\0' )
+	{
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/* find a property in an index */
+static PROPERTY *property_index_find(struct s_property_index *index, const char *name)
+{
+	unsigned int hash = property_hash(name);
+	unsigned int n;
+	for ( n=hash&index->mask ; index->slot[n].prop!=NULL ; n=(n+1)&index->mask )
+	{
+		if ( index->slot[n].hash==hash && strcmp(index->slot[n].prop->name,name)==0 )
+			return index->slot[n].prop;
+	}
+	return NULL;
+}
+
+/* free the retired property indexes (at exit) */
+static void property_index_free_retired(void)
+{
+	while ( retired_index!=NULL )
+	{
+		struct s_property_index *next = retired_index->next_retired;
+		free(retired_index->slot);
+		free(retired_index);
+		retired_index = next;
+	}
+}
+
+/* retire a property index (caller holds property_index_lock) */
+static void property_index_retire(struct s_property_index *index)
+{
+	if ( index!=NULL )
+	{
+		if ( retired_index==NULL )
+			atexit(property_index_free_retired);
+		index->next_retired = retired_index;
+		retired_index = index;
+	}
+}
+
+/* build the property index of a class, including inherited properties */
+static struct s_property_index *class_build_index(CLASS *oclass)
 {
+	struct s_property_index *index;
+	unsigned int size = 16, count = 0, depth;
+	CLASS *pclass;
 	PROPERTY *prop;
-	for (prop=oclass->pmap; prop!=NULL && prop->oclass==oclass; prop=prop->next)
+
+	wlock(&property_index_lock);
+
+	/* another thread may have rebuilt it already */
+	index = oclass->pindex;
+	if ( index!=NULL && index->parent==oclass->parent )
 	{
-		if (strcmp(name,prop->name)==0)
-			return prop;
+		wunlock(&property_index_lock);
+		return index;
 	}
-	if (oclass->parent==pclass)
+
+	/* count the properties visible in the class */
+	for ( pclass=oclass, depth=0 ; pclass!=NULL && depth<=class_count ; pclass=pclass->parent, depth++ )
 	{
-		output_error("class_find_property_rec(CLASS *oclass='%s', PROPERTYNAME name='%s', CLASS *pclass='%s') causes an infinite class inheritance loop", oclass->name, name, pclass->name);
-		/*	TROUBLESHOOT
-			A class has somehow specified itself as a parent class, either directly or indirectly.
-			This means there is a problem with the module that publishes the class.
+		for ( prop=pclass->pmap ; prop!=NULL && prop->oclass==pclass ; prop=prop->next )
+			count++;
+		if ( pclass->parent==oclass )
+		{
+			/* though improbable, this is to prevent more complicated, specifically crafted
+				inheritence loops.  these should be impossible if a class_register call is
+				immediately followed by a class_define_map call. -d3p988 */
+			output_error("class_build_index(CLASS *oclass='%s'): class '%s' causes an infinite class inheritance loop", oclass->name, pclass->name);
+			/*	TROUBLESHOOT
+				A class has somehow specified itself as a parent class, either directly or indirectly.
+				This means there is a problem with the module that publishes the class.
+			 */
+			break;
+		}
+	}
+	while ( size<count*2 )
+		size *= 2;
+
+	index = (struct s_property_index*)malloc(sizeof(struct s_property_index));
+	if ( index==NULL || (index->slot=(PROPERTYSLOT*)malloc(sizeof(PROPERTYSLOT)*size))==NULL )
+	{
+		wunlock(&property_index_lock);
+		throw_exception("class_build_index(CLASS *oclass='%s'): memory allocation failed", oclass->name);
+		/* TROUBLESHOOT
+			The system has run out of memory.  Try making the model smaller and trying again.
 		 */
-		return NULL;
 	}
-	else if (oclass->parent!=NULL)
-		return class_find_property_rec(oclass->parent,name, pclass);
-	else
-		return NULL;
+	memset(index->slot,0,sizeof(PROPERTYSLOT)*size);
+	index->mask = size-1;
+	index->parent = oclass->parent;
+	index->next_retired = NULL;
+
+	/* add the properties in search order, keeping only the first of each name */
+	for ( pclass=oclass, depth=0 ; pclass!=NULL && depth<=class_count ; pclass=pclass->parent, depth++ )
+	{
+		for ( prop=pclass->pmap ; prop!=NULL && prop->oclass==pclass ; prop=prop->next )
+		{
+			unsigned int hash = property_hash(prop->name);
+			unsigned int n;
+			for ( n=hash&index->mask ; index->slot[n].prop!=NULL ; n=(n+1)&index->mask )
+			{
+				if ( index->slot[n].hash==hash && strcmp(index->slot[n].prop->name,prop->name)==0 )
+					break;
+			}
+			if ( index->slot[n].prop==NULL )
+			{
+				index->slot[n].hash = hash;
+				index->slot[n].prop = prop;
+			}
+		}
+		if ( pclass->parent==oclass )
+			break;
+	}
+
+	property_index_retire(oclass->pindex);
+	oclass->pindex = index;
+	wunlock(&property_index_lock);
+	return index;
+}
 
+/* get the current property index of a class */
+static struct s_property_index *class_get_index(CLASS *oclass)
+{
+	struct s_property_index *index = *(struct s_property_index *volatile*)&oclass->pindex;
+	if ( index==NULL || index->parent!=oclass->parent )
+		index = class_build_index(oclass);
+	return index;
+}
+
+/** Find the named property in the class or its parents (without deprecation notices)
+	@return a pointer to the PROPERTY, or \p NULL if the property is not found.
+ **/
+PROPERTY *class_find_property_rec(CLASS *oclass, 
+                                  PROPERTYNAME name)
+{
+	return property_index_find(class_get_index(oclass),name);
 }
 
 static PROPERTY *find_header_property(CLASS *oclass, 
@@ -193,36 +339,38 @@ PROPERTY *class_find_property(CLASS *oclass,     /**< the object class */
 	if(oclass == NULL)
 		return NULL;
 
-	for (prop=oclass->pmap; prop!=NULL && prop->oclass==oclass; prop=prop->next)
+	prop = property_index_find(class_get_index(oclass),name);
+
+	/* deprecation notices are only given for the class's own properties */
+	if (prop!=NULL && prop->oclass==oclass && prop->flags&PF_DEPRECATED && !(prop->flags&PF_DEPRECATED_NONOTICE) && !global_suppress_deprecated_messages)
 	{
-		if (strcmp(name,prop->name)==0)
-		{
-			if (prop->flags&PF_DEPRECATED && !(prop->flags&PF_DEPRECATED_NONOTICE) && !global_suppress_deprecated_messages)
-			{
-				output_warning("class_find_property(CLASS *oclass='%s', PROPERTYNAME name='%s': property is deprecated", oclass->name, name);
-				/* TROUBLESHOOT
-					You have done a search on a property that has been flagged as deprecated and will most likely not be supported soon.
-					Correct the usage of this property to get rid of this message.
-				 */
-				if (global_suppress_repeat_messages)
-					prop->flags |= ~PF_DEPRECATED_NONOTICE;
-			}
-			return prop;
-		}
+		output_warning("class_find_property(CLASS *oclass='%s', PROPERTYNAME name='%s': property is deprecated", oclass->name, name);
+		/* TROUBLESHOOT
+			You have done a search on a property that has been flagged as deprecated and will most likely not be supported soon.
+			Correct the usage of this property to get rid of this message.
+		 */
+		if (global_suppress_repeat_messages)
+			prop->flags |= ~PF_DEPRECATED_NONOTICE;
 	}
-	if (oclass->parent==oclass)
+	return prop;
+}
+
+/* drop the property index of a class and of all the classes that inherit from it */
+static void class_drop_index(CLASS *oclass)
+{
+	CLASS *pclass, *ancestor;
+	unsigned int depth;
+	wlock(&property_index_lock);
+	for ( pclass=first_class ; pclass!=NULL ; pclass=pclass->next )
 	{
-		output_error("class_find_property(oclass='%s', name='%s') causes an infinite class inheritance loop", oclass->name, name);
-		/*	TROUBLESHOOT
-			A class has somehow specified itself as a parent class, either directly or indirectly.
-			This means there is a problem with the module that publishes the class.
-		 */
-		return NULL;
+		for ( ancestor=pclass, depth=0 ; ancestor!=NULL && ancestor!=oclass && depth<=class_count ; ancestor=ancestor->parent, depth++ ) {}
+		if ( ancestor==oclass )
+		{
+			property_index_retire(pclass->pindex);
+			pclass->pindex = NULL;
+		}
 	}
-	else if (oclass->parent!=NULL)
-		return class_find_property_rec(oclass->parent,name, oclass);
-	else
-		return NULL;
+	wunlock(&property_index_lock);
 }
 
 /** Add a property to a class
@@ -237,6 +385,9 @@ void class_add_property(CLASS *oclass,  /**< the class to which the property is
 		oclass->pmap = prop;
 	else
 		last->next = prop;
+
+	/* drop the property indexes of this class and any class that inherits from it */
+	class_drop_index(oclass);
 }
 
 /** Add an extended property to a class 
@@ -473,6 +624,7 @@ CLASS *class_register(MODULE *module,        /**< the module that implements the
 	oclass->profiler.numobjs=0;
 	oclass->profiler.count=0;
 	oclass->profiler.clocks=0;
+	class_build_index(oclass);
 	if (first_class==NULL)
 		first_class = oclass;
 	else
@@ -1139,14 +1291,25 @@ int class_saveall_xml(FILE *fp) /**< a pointer to the stream FILE structure */
 	return count;
 }
 
+/* orders classes by decreasing profiler time */
+static int class_profile_compare(const void *a, const void *b)
+{
+	CLASS *c1 = *(CLASS**)a;
+	CLASS *c2 = *(CLASS**)b;
+	if ( c1->profiler.clocks>c2->profiler.clocks ) return -1;
+	if ( c1->profiler.clocks<c2->profiler.clocks ) return 1;
+	return 0;
+}
+
 /** Generate profile information for the classes used
  **/
 void class_profiles(void)
 {
 	CLASS *cl;
 	int64 total=0;
-	int count=0, i=0, hits;
+	int count=0, i=0;
 	CLASS **index;
+	object_profile_merge();
 	output_profile("Model profiler results");
 	output_profile("======================\n");
 	output_profile("Class            Time (s) Time (%%) msec/obj");
@@ -1166,21 +1329,7 @@ void class_profiles(void)
 	}
 	for (cl=first_class; cl!=NULL; cl=cl->next)
 		index[i++]=cl;
-	hits=-1;
-	while (hits!=0)
-	{
-		hits=0;
-		for (i=0; i<count-1; i++)
-		{
-			if (index[i]->profiler.clocks<index[i+1]->profiler.clocks)
-			{
-				CLASS *tmp = index[i];
-				index[i]=index[i+1];
-				index[i+1]=tmp;
-				hits++;
-			}
-		}
-	}
+	qsort(index,count,sizeof(CLASS*),class_profile_compare);
 	for (i=0; i<count; i++)
 	{
 		cl = index[i];
@@ -42,6 +42,8 @@ typedef unsigned long PASSCONFIG; /**< the pass configuration */
 #define PC_ABSTRACTONLY 0x100 /**< used to flag that the class should never be instantiated itself, only inherited classes should */
 #define PC_AUTOLOCK 0x200 /**< used to flag that sync operations should not be automatically write locked */
 #define PC_OBSERVER 0x400 /**< used to flag whether commit process needs to be delayed with respect to ordinary "in-the-loop" objects */
+#define PC_NONREENTRANT 0x800 /**< used to flag that deltamode updates of the class's objects (including those of inheriting classes) must not run concurrently with other non-reentrant updates in the same module */
+#define PC_UNSAFE_INIT 0x1000 /**< used to flag that the init calls of the class's objects (including those of inheriting classes) must not run concurrently with other unsafe init calls in the same module */
 
 typedef enum {
 	NM_PREUPDATE = 0, /**< notify module before property change */
@@ -120,6 +122,8 @@ struct s_class_list {
 	bool has_runtime;	///< flag indicating that a runtime dll, so, or dylib is in use
 	char runtime[1024]; ///< name of file containing runtime dll, so, or dylib
 	struct s_class_list *next;
+	struct s_property_index *pindex; ///< property name index (see class_find_property)
+	struct s_object_arena *arena; ///< memory from which objects of this class are allocated (see object_create_single)
 }; /* CLASS */
 
 #ifdef __cplusplus
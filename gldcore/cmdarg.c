@@ -847,6 +847,24 @@ static int output(int argc, char *argv[])
 		return CMDERR;
 	}
 }
+static int compile_to(int argc, char *argv[])
+{
+	if (argc>1)
+	{
+		strcpy(global_compilefile,(argc--,*++argv));
+		return 1;
+	}
+	else
+	{
+		output_fatal("missing compiled model file");
+		/* TROUBLESHOOT
+			The <b>--compile-to</b> command line directive
+			was not followed by a valid filename.  The correct syntax is
+			<b>--compile-to <i>file</i>.glb</b>.
+		 */
+		return CMDERR;
+	}
+}
 static int environment(int argc, char *argv[])
 {
 	if (argc>1)
@@ -1286,6 +1304,7 @@ static CMDARG main[] = {
 	{"compile",		"C",	compile,		NULL, "Toggles compile-only flags" },
 	{"environment",	"e",	environment,	"<appname>", "Set the application to use for run environment" },
 	{"output",		"o",	output,			"<file>", "Enables save of output to a file (default is gridlabd.glm)" },
+	{"compile-to",	NULL,	compile_to,		"<file>", "Compiles the loaded model to a binary model file (.glb) that loads faster, then exits" },
 	{"pause",		NULL,	pauseatexit,			NULL, "Toggles pause-at-exit feature" },
 	{"relax",		NULL,	relax,			NULL, "Allows implicit variable definition when assignments are made" },
 
@@ -17,12 +17,33 @@
 #include "deltamode.h"
 #include "output.h"
 #include "realtime.h"
+#include "threadpool.h"
+#include "exec.h"
 
 static OBJECT **delta_objectlist = NULL; /* qualified object list */
 static int delta_objectcount = 0; /* qualified object count */
 static MODULE **delta_modulelist = NULL; /* qualified module list */
 static int delta_modulecount = 0; /* qualified module count */
 
+/* parallel update tasks - each task updates one or more objects in list order */
+typedef struct s_deltatask {
+	unsigned int first; /* first entry of the task in delta_taskobject */
+	unsigned int count; /* number of objects updated by the task */
+} DELTATASK;
+static DELTATASK *delta_tasklist = NULL; /* tasks, grouped by rank */
+static unsigned int *delta_taskobject = NULL; /* delta_objectlist index of each task's objects */
+static unsigned int *delta_rankfirst = NULL; /* first task of each rank group (delta_rankcount+1 entries) */
+static unsigned int delta_rankcount = 0; /* number of rank groups */
+
+/* per-thread results of a parallel update */
+typedef struct s_deltaresult {
+	SIMULATIONMODE mode; /* combined mode of the updates done by the thread */
+	int error; /* lowest delta_objectlist index of a failed update, or -1 */
+} DELTARESULT;
+static DELTARESULT *delta_threadresult = NULL;
+static DT delta_task_timestep = 0; /* timestep passed to the parallel updates */
+static unsigned int delta_task_iteration = 0; /* iteration passed to the parallel updates */
+
 /* profile data structure */
 static DELTAPROFILE profile;
 DELTAPROFILE *delta_getprofile(void)
@@ -199,11 +220,202 @@ STATUS delta_init(void)
 	rankcount = NULL;
 	free(ranklist);
 	ranklist = NULL;
+
+	/* per-object update times */
+	profile.n_objects = delta_objectcount;
+	profile.object = delta_objectlist;
+	profile.t_object = (double*)malloc(sizeof(double)*delta_objectcount);
+	if ( profile.t_object==NULL )
+	{
+		output_error("unable to allocate memory for deltamode object profile");
+		/* TROUBLESHOOT
+		  Deltamode operation requires more memory than is available.
+		  Try freeing up memory by making more heap available or making the model smaller. 
+		 */
+		return FAILED;
+	}
+	memset(profile.t_object,0,sizeof(double)*delta_objectcount);
+
+	/* parallel update tasks */
+	if ( global_deltamode_parallel && wsp_get_threadcount()>1 && delta_buildtasks()==FAILED )
+		return FAILED;
 Success:
 	profile.t_init += clock() - t;
 	return SUCCESS;
 }
 
+/* combine two object update modes (DELTA_ITER trumps DELTA trumps EVENT) */
+static SIMULATIONMODE delta_combine(SIMULATIONMODE mode, SIMULATIONMODE result)
+{
+	if ( result==SM_DELTA_ITER )
+		return SM_DELTA_ITER;
+	else if ( result==SM_DELTA && mode!=SM_DELTA_ITER )
+		return SM_DELTA;
+	else
+		return mode;
+}
+
+/* update a single object in the deltamode object list (skipped objects return SM_EVENT) */
+static SIMULATIONMODE delta_updateobject(int n, DT timestep, unsigned int iteration)
+{
+	OBJECT *obj = delta_objectlist[n];
+	SIMULATIONMODE result;
+	double t;
+
+	/* See if the object is in service or not and make sure the update exists - init should handle this */
+	if ( obj->in_svc_double>global_delta_curr_clock || obj->out_svc_double<global_delta_curr_clock || !obj->oclass->update )
+		return SM_EVENT;
+
+	if ( !global_profiler )
+		return obj->oclass->update(obj,global_clock,global_deltaclock,timestep,iteration);
+
+	t = exec_wallclock();
+	result = obj->oclass->update(obj,global_clock,global_deltaclock,timestep,iteration);
+	profile.t_object[n] += exec_wallclock() - t;
+	return result;
+}
+
+/* returns non-zero if the updates of the class must not run concurrently */
+static int delta_isnonreentrant(CLASS *oclass)
+{
+	for ( ; oclass!=NULL ; oclass=oclass->parent )
+	{
+		if ( oclass->passconfig&PC_NONREENTRANT )
+			return 1;
+	}
+	return 0;
+}
+
+/* build the parallel update tasks
+
+	Objects are updated one rank at a time, and all the tasks in a rank can run 
+	concurrently.  Each object gets its own task unless its class or one of its parent
+	classes is flagged PC_NONREENTRANT, in which case all the non-reentrant objects of 
+	the same module in that rank are put in a single task and updated serially in list 
+	order.  Only the object update functions run in parallel; the module interupdate 
+	calls (e.g., powerflow and generators) remain serial.
+ */
+static STATUS delta_buildtasks(void)
+{
+	unsigned int n, m, first, last, n_tasks=0, n_taskobjects=0;
+	MODULE **nonreentrant = (MODULE**)malloc(sizeof(MODULE*)*delta_objectcount);
+	unsigned int n_nonreentrant;
+
+	delta_tasklist = (DELTATASK*)malloc(sizeof(DELTATASK)*delta_objectcount);
+	delta_taskobject = (unsigned int*)malloc(sizeof(unsigned int)*delta_objectcount);
+	delta_rankfirst = (unsigned int*)malloc(sizeof(unsigned int)*(delta_objectcount+1));
+	delta_threadresult = (DELTARESULT*)malloc(sizeof(DELTARESULT)*wsp_get_threadcount());
+	if ( nonreentrant==NULL || delta_tasklist==NULL || delta_taskobject==NULL || delta_rankfirst==NULL || delta_threadresult==NULL )
+	{
+		output_error("unable to allocate memory for deltamode update tasks");
+		/* TROUBLESHOOT
+		  Deltamode operation requires more memory than is available.
+		  Try freeing up memory by making more heap available or making the model smaller. 
+		 */
+		free(nonreentrant);
+		return FAILED;
+	}
+
+	/* the object list is sorted by rank, so each rank is a contiguous group */
+	delta_rankcount = 0;
+	for ( first=0 ; first<(unsigned int)delta_objectcount ; first=last )
+	{
+		for ( last=first+1 ; last<(unsigned int)delta_objectcount && delta_objectlist[last]->rank==delta_objectlist[first]->rank ; last++ ) {}
+		delta_rankfirst[delta_rankcount++] = n_tasks;
+
+		/* reentrant objects are tasks by themselves */
+		n_nonreentrant = 0;
+		for ( n=first ; n<last ; n++ )
+		{
+			CLASS *oclass = delta_objectlist[n]->oclass;
+			if ( !oclass->update )
+				continue;
+			if ( delta_isnonreentrant(oclass) )
+			{
+				for ( m=0 ; m<n_nonreentrant && nonreentrant[m]!=oclass->module ; m++ ) {}
+				if ( m==n_nonreentrant )
+					nonreentrant[n_nonreentrant++] = oclass->module;
+				continue;
+			}
+			delta_tasklist[n_tasks].first = n_taskobjects;
+			delta_tasklist[n_tasks].count = 1;
+			delta_taskobject[n_taskobjects++] = n;
+			n_tasks++;
+		}
+
+		/* non-reentrant objects are grouped by module */
+		for ( m=0 ; m<n_nonreentrant ; m++ )
+		{
+			delta_tasklist[n_tasks].first = n_taskobjects;
+			for ( n=first ; n<last ; n++ )
+			{
+				CLASS *oclass = delta_objectlist[n]->oclass;
+				if ( oclass->update && oclass->module==nonreentrant[m] && delta_isnonreentrant(oclass) )
+					delta_taskobject[n_taskobjects++] = n;
+			}
+			delta_tasklist[n_tasks].count = n_taskobjects - delta_tasklist[n_tasks].first;
+			n_tasks++;
+		}
+	}
+	delta_rankfirst[delta_rankcount] = n_tasks;
+	free(nonreentrant);
+
+	profile.n_tasks = n_tasks;
+	output_verbose("deltamode object updates use %d tasks in %d ranks on %d threads", n_tasks, delta_rankcount, wsp_get_threadcount());
+	return SUCCESS;
+}
+
+/* run one parallel update task */
+static void delta_updateproc(unsigned int thread, size_t item, void *data)
+{
+	DELTATASK *task = (DELTATASK*)data + item;
+	DELTARESULT *result = delta_threadresult + thread;
+	unsigned int *n;
+	for ( n=delta_taskobject+task->first ; n<delta_taskobject+task->first+task->count ; n++ )
+	{
+		SIMULATIONMODE mode = delta_updateobject(*n,delta_task_timestep,delta_task_iteration);
+		if ( mode==SM_ERROR )
+		{
+			if ( result->error<0 || (int)*n<result->error )
+				result->error = *n;
+			break;
+		}
+		result->mode = delta_combine(result->mode,mode);
+	}
+}
+
+/* update all the objects on the thread pool one rank at a time
+	@return the combined mode, or SM_ERROR with *error set to the lowest failed object index
+ */
+static SIMULATIONMODE delta_updateparallel(DT timestep, unsigned int iteration, int *error)
+{
+	SIMULATIONMODE mode = SM_EVENT;
+	unsigned int r, n, n_threads = wsp_get_threadcount();
+	delta_task_timestep = timestep;
+	delta_task_iteration = iteration;
+	for ( r=0 ; r<delta_rankcount ; r++ )
+	{
+		for ( n=0 ; n<n_threads ; n++ )
+		{
+			delta_threadresult[n].mode = SM_EVENT;
+			delta_threadresult[n].error = -1;
+		}
+		wsp_run(delta_updateproc, delta_tasklist+delta_rankfirst[r], delta_rankfirst[r+1]-delta_rankfirst[r], 1);
+
+		/* reduce the thread results */
+		*error = -1;
+		for ( n=0 ; n<n_threads ; n++ )
+		{
+			if ( delta_threadresult[n].error>=0 && (*error<0 || delta_threadresult[n].error<*error) )
+				*error = delta_threadresult[n].error;
+			mode = delta_combine(mode,delta_threadresult[n].mode);
+		}
+		if ( *error>=0 )
+			return SM_ERROR;
+	}
+	return mode;
+}
+
 /** Determine whether any modules desire operation in delta mode and if so at what DT
 	@return DT=0 if no modules want to run in delta mode; DT>0 if at least one 
 	desires running in delta mode; DT=DT_INVALID on error.
@@ -251,8 +463,6 @@ DT delta_update(void)
 	int n;
 	double dbl_stop_time;
 	double dbl_curr_clk_time;
-	OBJECT *d_obj = NULL;
-	CLASS *d_oclass = NULL;
 
 	/* send preupdate messages */
 	timestep=delta_preupdate();
@@ -302,43 +512,38 @@ DT delta_update(void)
 			interupdate_mode = SM_EVENT;
 
 			/* Loop through objects with their individual updates */
-			for ( n=0 ; n<delta_objectcount ; n++ )
+			if ( delta_rankcount>0 )
 			{
-				d_obj = delta_objectlist[n];	/* Shouldn't need NULL checks, since they were done above */
-				d_oclass = d_obj->oclass;
-
-				/* See if the object is in service or not */
-				if ((d_obj->in_svc_double <= global_delta_curr_clock) && (d_obj->out_svc_double >= global_delta_curr_clock))
+				interupdate_mode = delta_updateparallel(timestep,delta_iteration_count,&n);
+				if ( interupdate_mode==SM_ERROR )
+				{
+					output_error("delta_update(): update failed for object \'%s\'", object_name(delta_objectlist[n], temp_name_buff, 63));
+					/* TROUBLESHOOT
+					   An object failed to update correctly while operating in deltamode.
+					   Generally, this is an internal error and should be reported to the GridLAB-D developers.
+					 */
+					return DT_INVALID;
+				}
+			}
+			else
+			{
+				for ( n=0 ; n<delta_objectcount ; n++ )
 				{
-					if ( d_oclass->update )	/* Make sure it exists - init should handle this */
+					/* Call the object-level interupdate */
+					interupdate_mode_result = delta_updateobject(n,timestep,delta_iteration_count);
+
+					/* Check the status and handle appropriately */
+					if ( interupdate_mode_result==SM_ERROR )
 					{
-						/* Call the object-level interupdate */
-						interupdate_mode_result = d_oclass->update(d_obj,global_clock,global_deltaclock,timestep,delta_iteration_count);
-
-						/* Check the status and handle appropriately */
-						switch ( interupdate_mode_result ) {
-							case SM_DELTA_ITER:
-								interupdate_mode = SM_DELTA_ITER;
-								break;
-							case SM_DELTA:
-								if (interupdate_mode != SM_DELTA_ITER)
-									interupdate_mode = SM_DELTA;
-								/* default else - leave it as is (SM_DELTA_ITER) */
-								break;
-							case SM_ERROR:
-								output_error("delta_update(): update failed for object \'%s\'", object_name(d_obj, temp_name_buff, 63));
-								/* TROUBLESHOOT
-								   An object failed to update correctly while operating in deltamode.
-								   Generally, this is an internal error and should be reported to the GridLAB-D developers.
-								 */
-								return DT_INVALID;
-							case SM_EVENT:
-							default: /* mode remains untouched */
-								break;
-						}
-					} /*End update exists */
-				}/* End in service */
-				/* Defaulted else, skip over it (not in service) */
+						output_error("delta_update(): update failed for object \'%s\'", object_name(delta_objectlist[n], temp_name_buff, 63));
+						/* TROUBLESHOOT
+						   An object failed to update correctly while operating in deltamode.
+						   Generally, this is an internal error and should be reported to the GridLAB-D developers.
+						 */
+						return DT_INVALID;
+					}
+					interupdate_mode = delta_combine(interupdate_mode,interupdate_mode_result);
+				}
 			}
 
 			/* send interupdate messages */
@@ -12,6 +12,7 @@ static DT delta_preupdate(void); /* send preupdate messages ; dt==0|DT_INVALID f
 static SIMULATIONMODE delta_interupdate(DT timestep, unsigned int iteration_count_val); /* send interupdate messages  - 0=INIT (used?), 1=EVENT, 2=DELTA, 3=DELTA_ITER, 255=ERROR */
 static SIMULATIONMODE delta_clockupdate(DT timestep, SIMULATIONMODE interupdate_result); /* notification that we are finished with the current deltamode timestep and are moving to the next timestep. */
 static STATUS delta_postupdate(void); /* send postupdate messages - 0 = FAILED, 1=SUCCESS */
+static STATUS delta_buildtasks(void); /* build the parallel object update tasks - 0 = FAILED, 1=SUCCESS */
 
 typedef struct {
 	clock_t t_init; /**< time in initiation */
@@ -25,6 +26,10 @@ typedef struct {
 	unsigned int64 t_max;	/**< maximum delta (ns) */
 	unsigned int64 t_min;	/**< minimum delta (ns) */
 	char module_list[1024]; /**< list of active modules */
+	unsigned int n_objects; /**< number of objects in the deltamode object list */
+	unsigned int n_tasks; /**< number of parallel update tasks (0 if updates are serial) */
+	struct s_object_list **object; /**< deltamode object list (in update order) */
+	double *t_object; /**< wall time (s) spent in each object's update (collected only when profiling) */
 } DELTAPROFILE;
 DELTAPROFILE *delta_getprofile(void);
 
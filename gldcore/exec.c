@@ -94,11 +94,17 @@
 #include <direct.h>
 #else
 #include <unistd.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/errno.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
 #define SOCKET int
 #define INVALID_SOCKET (-1)
 #define closesocket close
@@ -343,6 +349,107 @@ static STATUS show_progress(void)
 /***********************************************************************/
 /* CHECKPOINTS (DPC Apr 2011) */
 
+static char checkpoint_base[1024] = ""; /* last full checkpoint file (base of incremental checkpoints) */
+static int checkpoint_increments = 0; /* number of incremental checkpoints since the last full checkpoint */
+#ifndef WIN32
+static pid_t checkpoint_pid = 0; /* background checkpoint writer process (0 when none is running) */
+static char checkpoint_pending[1024] = ""; /* checkpoint file being written in the background */
+#endif
+
+/* stream a checkpoint (full if base is NULL, otherwise only objects changed since base) */
+static int checkpoint_stream(FILE *fp, const char *fn, const char *base)
+{
+	char hashfile[1024];
+	size_t len;
+	if ( base==NULL )
+		len = stream(fp,SF_OUT);
+	else
+	{
+		sprintf(hashfile,"%s.hash",base);
+		len = stream_incremental(fp,base,hashfile);
+	}
+	if ( len==0 || len==(size_t)-1 )
+	{
+		output_error("checkpoint failure (stream context is %s)",stream_context());
+		return 0;
+	}
+
+	/* save the object hashes needed by later incremental checkpoints */
+	if ( base==NULL && global_checkpoint_incremental>0 )
+	{
+		sprintf(hashfile,"%s.hash",fn);
+		if ( stream_savehash(hashfile)==FAILED )
+			return 0;
+	}
+	return 1;
+}
+
+/* write a checkpoint file in the foreground */
+static int checkpoint_write(const char *fn, const char *base)
+{
+	int ok;
+	FILE *fp = fopen(fn,"wb");
+	if ( fp==NULL )
+	{
+		output_error("unable to open checkpoint file '%s' for writing", fn);
+		/* TROUBLESHOOT
+			The checkpoint file could not be created.  Check that the checkpoint file
+			folder is writable and that there is enough disk space.
+		 */
+		return 0;
+	}
+	ok = checkpoint_stream(fp,fn,base);
+	if ( fclose(fp)!=0 )
+		ok = 0;
+	return ok;
+}
+
+#ifndef WIN32
+/* write the checkpoint from a snapshot of the model while the simulation continues
+	The writer is a forked copy of the process taken between sync steps, so it streams a
+	copy-on-write image of the model that later passes cannot change.
+	@return 1 if the writer was started, 0 if the checkpoint must be written in the foreground
+ */
+static int checkpoint_background(const char *fn, const char *base)
+{
+	pid_t pid = fork();
+	if ( pid<0 )
+		return 0;
+	if ( pid==0 )
+	{
+		/* writer process: _exit skips the exit handlers and the stdio buffers inherited from the simulation */
+		_exit(checkpoint_write(fn,base)?0:1);
+	}
+	strcpy(checkpoint_pending,fn);
+	checkpoint_pid = pid;
+	return 1;
+}
+#endif
+
+/* wait for the background checkpoint writer to finish */
+static void checkpoint_wait(void)
+{
+#ifndef WIN32
+	int status = -1;
+	pid_t pid;
+	if ( checkpoint_pid==0 )
+		return;
+	do {
+		pid = waitpid(checkpoint_pid,&status,0);
+	} while ( pid<0 && errno==EINTR );
+	checkpoint_pid = 0;
+	if ( pid<0 || !WIFEXITED(status) || WEXITSTATUS(status)!=0 )
+		output_error("background checkpoint '%s' failed", checkpoint_pending);
+		/* TROUBLESHOOT
+			The process writing a checkpoint in the background could not write the checkpoint file.
+			Check that the checkpoint file folder is writable and that there is enough disk space 
+			for the checkpoint file.
+		 */
+	else
+		output_verbose("background checkpoint '%s' done", checkpoint_pending);
+#endif
+}
+
 void do_checkpoint(void)
 {
 	/* last checkpoint value */
@@ -393,7 +500,10 @@ void do_checkpoint(void)
 		if ( last_checkpoint + global_checkpoint_interval <= now )
 		{
 			static char fn[1024] = "";
-			FILE *fp = NULL;
+			int incremental = global_checkpoint_incremental>0 && checkpoint_base[0]!='\0' && checkpoint_increments<global_checkpoint_incremental;
+
+			/* the previous background checkpoint must be finished before its file is removed or used as a base */
+			checkpoint_wait();
 
 			/* default checkpoint filename */
 			if ( strcmp(global_checkpoint_file,"")==0 )
@@ -409,35 +519,182 @@ void do_checkpoint(void)
 					*ext = '\0';
 			}
 
-			/* delete old checkpoint file if not desired */
-			if ( global_checkpoint_keepall==0 && strcmp(fn,"")!=0 )
-				unlink(fn);
+			/* delete old checkpoint files if not desired (the base of incremental checkpoints is kept until the next full checkpoint) */
+			if ( global_checkpoint_keepall==0 )
+			{
+				if ( strcmp(fn,"")!=0 && strcmp(fn,checkpoint_base)!=0 )
+					unlink(fn);
+				if ( !incremental && strcmp(checkpoint_base,"")!=0 )
+				{
+					char hashfile[1024];
+					sprintf(hashfile,"%s.hash",checkpoint_base);
+					unlink(checkpoint_base);
+					unlink(hashfile);
+				}
+			}
 
 			/* create current checkpoint save filename */
 			sprintf(fn,"%s.%d",global_checkpoint_file,global_checkpoint_seqnum++);
-			fp = fopen(fn,"w");
-			if ( fp==NULL )
-				output_error("unable to open checkpoint file '%s' for writing");
+#ifndef WIN32
+			if ( !global_checkpoint_background || !checkpoint_background(fn,incremental?checkpoint_base:NULL) )
+#endif
+				checkpoint_write(fn,incremental?checkpoint_base:NULL);
+
+			if ( incremental )
+				checkpoint_increments++;
 			else
 			{
-				if ( stream(fp,SF_OUT)<=0 )
-					output_error("checkpoint failure (stream context is %s)",stream_context());
-				fclose(fp);
-				last_checkpoint = now;
+				strcpy(checkpoint_base,fn);
+				checkpoint_increments = 0;
 			}
+			last_checkpoint = now;
+		}
+	}
+
+}
+
+/***********************************************************************/
+/* profiler event trace, written in the Chrome trace event format so it can
+   be viewed with chrome://tracing or Perfetto (see global_profiler_trace) */
+#define TRACE_BUFSIZE 4096 /* events buffered by each thread before they are written */
+typedef struct s_traceevent {
+	double start; /* wall clock when the event started (s) */
+	double stop; /* wall clock when the event stopped (s) */
+	OBJECT *obj; /* object synchronized (NULL for a rank list) */
+	TIMESTAMP clock; /* simulation clock */
+	unsigned int pass; /* pass index */
+	unsigned int rank; /* object rank */
+	unsigned int n_obj; /* number of objects in a rank list */
+} TRACEEVENT;
+typedef struct s_tracebuffer {
+	unsigned int n; /* number of events in the buffer */
+	TRACEEVENT event[TRACE_BUFSIZE];
+} TRACEBUFFER;
+static FILE *trace_fp = NULL;
+static TRACEBUFFER *trace_buffer = NULL; /* one buffer per pool thread */
+static unsigned int trace_threads = 0; /* number of buffers */
+static double trace_t0 = 0; /* wall clock when the trace started */
+static int64 trace_count = 0; /* number of events written */
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* writes a JSON string value */
+static void trace_string(const char *str)
+{
+	fputc('"',trace_fp);
+	for ( ; *str!='\0' ; str++ )
+	{
+		if ( *str=='"' || *str=='\\' )
+			fputc('\\',trace_fp);
+		if ( (unsigned char)*str>=' ' )
+			fputc(*str,trace_fp);
+	}
+	fputc('"',trace_fp);
+}
+
+/* writes the buffered events of a thread */
+static void trace_flush(unsigned int thread)
+{
+	static const char *passname[] = {"presync","sync","postsync"};
+	TRACEBUFFER *buf = &trace_buffer[thread];
+	unsigned int n;
+	pthread_mutex_lock(&trace_lock);
+	for ( n=0 ; n<buf->n ; n++ )
+	{
+		TRACEEVENT *event = &buf->event[n];
+		fprintf(trace_fp,",\n{\"ph\":\"X\",\"pid\":1,\"ts\":%.1f,\"dur\":%.1f,",
+			(event->start-trace_t0)*1e6, (event->stop-event->start)*1e6);
+		if ( event->obj!=NULL )
+		{
+			char name[64];
+			fprintf(trace_fp,"\"tid\":%u,\"cat\":\"%s\",\"name\":", thread, passname[event->pass]);
+			trace_string(event->obj->oclass->name);
+			fprintf(trace_fp,",\"args\":{\"object\":");
+			trace_string(object_name(event->obj,name,sizeof(name)));
+			fprintf(trace_fp,",\"id\":%u", event->obj->id);
 		}
+		else
+			fprintf(trace_fp,"\"tid\":%u,\"cat\":\"%s\",\"name\":\"rank %u\",\"args\":{\"objects\":%u",
+				trace_threads, passname[event->pass], event->rank, event->n_obj);
+		fprintf(trace_fp,",\"rank\":%u,\"pass\":\"%s\",\"clock\":%" FMT_INT64 "d}}",
+			event->rank, passname[event->pass], event->clock);
+	}
+	trace_count += buf->n;
+	buf->n = 0;
+	pthread_mutex_unlock(&trace_lock);
+}
+
+/* records an event in the buffer of a thread */
+static void trace_event(unsigned int thread, OBJECT *obj, unsigned int rank, unsigned int n_obj, double start)
+{
+	TRACEBUFFER *buf = &trace_buffer[thread];
+	TRACEEVENT *event = &buf->event[buf->n];
+	event->start = start;
+	event->stop = exec_wallclock();
+	event->obj = obj;
+	event->clock = global_clock;
+	event->pass = pass;
+	event->rank = rank;
+	event->n_obj = n_obj;
+	if ( ++buf->n==TRACE_BUFSIZE )
+		trace_flush(thread);
+}
+
+/* starts the trace when global_profiler_trace names a file */
+static void trace_open(unsigned int n_threads)
+{
+	unsigned int n;
+	if ( global_profiler_trace[0]=='\0' )
+		return;
+	trace_buffer = (TRACEBUFFER*)calloc(n_threads,sizeof(TRACEBUFFER));
+	trace_fp = trace_buffer ? fopen(global_profiler_trace,"w") : NULL;
+	if ( trace_fp==NULL )
+	{
+		output_warning("unable to write profiler trace to '%s', trace disabled", (char*)global_profiler_trace);
+		/* TROUBLESHOOT
+			The profiler trace file could not be opened, or there was not enough
+			memory for the trace buffers.  Check that the file named by the
+			profiler_trace global is writeable and try again.
+		 */
+		free(trace_buffer);
+		trace_buffer = NULL;
+		return;
 	}
+	trace_threads = n_threads;
+	trace_count = 0;
+	trace_t0 = exec_wallclock();
+	fprintf(trace_fp,"{\"traceEvents\":[\n{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"gridlabd\"}}");
+	for ( n=0 ; n<n_threads ; n++ )
+		fprintf(trace_fp,",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"thread %u\"}}", n, n);
+	fprintf(trace_fp,",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"rank lists\"}}", n_threads);
+}
 
+/* writes the remaining events and closes the trace */
+static void trace_close(void)
+{
+	unsigned int n;
+	if ( trace_fp==NULL )
+		return;
+	for ( n=0 ; n<trace_threads ; n++ )
+		trace_flush(n);
+	fprintf(trace_fp,"\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(trace_fp);
+	trace_fp = NULL;
+	free(trace_buffer);
+	trace_buffer = NULL;
+	output_verbose("profiler trace of %" FMT_INT64 "d events written to '%s'", trace_count, (char*)global_profiler_trace);
 }
 
 /***********************************************************************/
 //sjin: implement new ss_do_object_sync for pthreads
-static void ss_do_object_sync(int thread, void *item)
+/* returns the event posted (negative if soft), TS_NEVER if none, or TS_INVALID if the object stopped its clock */
+static TIMESTAMP ss_do_object_sync(int thread, void *item)
 {
 	struct sync_data *data = &thread_data->data[thread];
 	OBJECT *obj = (OBJECT *) item;
 	TIMESTAMP this_t;
+	int soft = 0;
 	char b[64];
+	double trace_start = trace_fp!=NULL ? exec_wallclock() : 0;
 
 	//printf("thread %d\t%d\t%s\n", thread, obj->rank, obj->name);
 	//this_t = object_sync(obj, global_clock, passtype[pass]);
@@ -510,7 +767,10 @@ static void ss_do_object_sync(int thread, void *item)
 
 	/* check for "soft" event (events that are ignored when stopping) */
 	if (this_t < -1)
+	{
 		this_t = -this_t;
+		soft = 1;
+	}
 	else if (this_t != TS_NEVER)
 		data->hard_event++;  /* this counts the number of hard events */
 
@@ -524,6 +784,7 @@ static void ss_do_object_sync(int thread, void *item)
 			is caused by a bug in the module that implements that object's class.
 		 */
 		data->status = FAILED;
+		this_t = TS_INVALID;
 	} else {
 		/* check for iteration limit approach */
 		if (iteration_counter == 2 && this_t == global_clock) {
@@ -553,6 +814,10 @@ static void ss_do_object_sync(int thread, void *item)
 		}
 		//printf("data->step_to=%d, this_t=%d\n", data->step_to, this_t);
 	}
+
+	if ( trace_fp!=NULL )
+		trace_event(thread,obj,obj->rank,0,trace_start);
+	return ( soft && this_t!=TS_INVALID ) ? -this_t : this_t;
 }
 
 //sjin: implement new ss_do_object_sync_list for pthreads
@@ -770,6 +1035,294 @@ static int init_by_deferral()
 	return SUCCESS;
 }
 
+/* parallel initialization
+
+	Objects are initialized one rank layer at a time from the highest rank down, so an
+	object's parent and the objects it depends on (which always rank higher) get their 
+	init call before it does.  All the tasks in a batch run concurrently on the thread 
+	pool.  Each object is a task by itself unless its class or one of its parent classes
+	is flagged PC_UNSAFE_INIT, in which case all the unsafe objects of the same module in
+	the batch are put in a single task and initialized serially in rank order.  Modules
+	flag the classes whose init calls write state shared with the other objects of the 
+	module, such as the powerflow NR bus and branch counters, the house panels residential 
+	enduses attach to, the ranks of the auctions market controllers bid into and of the 
+	parents batteries and multizones promote.  Lazy statics shared by safe inits (e.g., 
+	the climate lists of houses and offices) are guarded by the module itself.
+	
+	A deferred object is retried when its parent completes its initialization, or, if 
+	its parent was already initialized when it deferred, whenever some other object 
+	completes, since the dependency it is waiting for is not known.
+ */
+typedef struct s_inittask {
+	unsigned int first; /**< first entry of the task in init_taskobject */
+	unsigned int count; /**< number of objects in the task */
+} INITTASK;
+static OBJECT **init_objectlist = NULL; /**< objects being initialized, by descending rank */
+static int *init_result = NULL; /**< last object_init() result of each object */
+static OBJECT **init_waiton = NULL; /**< uninitialized parent each deferred object waits on */
+static unsigned int *init_defercount = NULL; /**< number of times each object was deferred */
+static INITTASK *init_tasklist = NULL;
+static unsigned int *init_taskobject = NULL; /**< init_objectlist index of each task object */
+static MODULE **init_unsafe = NULL; /**< modules with unsafe objects in the batch */
+
+static int init_compare(const void *a, const void *b)
+{
+	OBJECT *obj1 = *(OBJECT**)a, *obj2 = *(OBJECT**)b;
+	if ( obj1->rank!=obj2->rank )
+		return obj1->rank>obj2->rank ? -1 : 1;
+	return obj1->id<obj2->id ? -1 : (obj1->id>obj2->id ? 1 : 0);
+}
+
+/* returns non-zero if the init calls of the class must not run concurrently */
+static int init_isunsafe(CLASS *oclass)
+{
+	for ( ; oclass!=NULL ; oclass=oclass->parent )
+		if ( oclass->passconfig&PC_UNSAFE_INIT )
+			return 1;
+	return 0;
+}
+
+/* initialize the objects of one task */
+static void init_proc(unsigned int thread, size_t item, void *data)
+{
+	INITTASK *task = (INITTASK*)data + item;
+	unsigned int *n;
+	for ( n=init_taskobject+task->first ; n<init_taskobject+task->first+task->count ; n++ )
+	{
+		OBJECT *obj = init_objectlist[*n];
+		int rv = init_result[*n] = object_init(obj);
+		wlock(&obj->lock);
+		if ( rv==1 )
+			obj->flags = (obj->flags|OF_INIT)&~OF_DEFERRED;
+		else if ( rv==2 )
+			obj->flags |= OF_DEFERRED;
+		wunlock(&obj->lock);
+		if ( rv==0 )
+			break;
+	}
+}
+
+/* initialize a batch of objects, returns the number of objects that completed or -1 on failure */
+static int init_batch(unsigned int *batch, unsigned int n_batch)
+{
+	unsigned int n, m, n_tasks=0, n_taskobjects=0, n_unsafe=0, n_done=0;
+	char b[64];
+
+	/* safe objects are tasks by themselves */
+	for ( n=0 ; n<n_batch ; n++ )
+	{
+		OBJECT *obj = init_objectlist[batch[n]];
+		init_result[batch[n]] = -1;
+		if ( init_isunsafe(obj->oclass) )
+		{
+			for ( m=0 ; m<n_unsafe && init_unsafe[m]!=obj->oclass->module ; m++ ) {}
+			if ( m==n_unsafe )
+				init_unsafe[n_unsafe++] = obj->oclass->module;
+			continue;
+		}
+		init_tasklist[n_tasks].first = n_taskobjects;
+		init_tasklist[n_tasks].count = 1;
+		init_taskobject[n_taskobjects++] = batch[n];
+		n_tasks++;
+	}
+
+	/* unsafe objects are grouped by module */
+	for ( m=0 ; m<n_unsafe ; m++ )
+	{
+		init_tasklist[n_tasks].first = n_taskobjects;
+		for ( n=0 ; n<n_batch ; n++ )
+		{
+			CLASS *oclass = init_objectlist[batch[n]]->oclass;
+			if ( oclass->module==init_unsafe[m] && init_isunsafe(oclass) )
+				init_taskobject[n_taskobjects++] = batch[n];
+		}
+		init_tasklist[n_tasks].count = n_taskobjects - init_tasklist[n_tasks].first;
+		n_tasks++;
+	}
+
+	if ( global_threadcount>1 && !global_debug_mode )
+		wsp_run(init_proc,init_tasklist,n_tasks,1);
+	else
+	{
+		for ( n=0 ; n<n_tasks ; n++ )
+			init_proc(0,n,init_tasklist);
+	}
+
+	/* report failures in batch order */
+	for ( n=0 ; n<n_batch ; n++ )
+	{
+		OBJECT *obj = init_objectlist[batch[n]];
+		switch ( init_result[batch[n]] ) {
+		case 0:
+			output_error("init_by_parallel(): object %s initialization failed", object_name(obj, b, 63));
+			/* TROUBLESHOOT
+				The initialization of the named object has failed.  Make sure that the object's
+				requirements for initialization are satisfied and try again.
+			 */
+			return -1;
+		case 1:
+			n_done++;
+			break;
+		case 2:
+			if ( ++init_defercount[batch[n]]>(unsigned int)global_init_max_defer )
+			{
+				output_error("init_by_parallel(): object %s exhausted initialization attempts", object_name(obj, b, 63));
+				/* TROUBLESHOOT
+					The named object deferred its initialization more times than init_max_defer allows.
+					Check the object's dependencies on other objects, or increase init_max_defer, and try again.
+				 */
+				return -1;
+			}
+			break;
+		default: /* not run because an earlier object in its task failed */
+			break;
+		}
+	}
+	return n_done;
+}
+
+/* initialize the objects in the list starting with first and return the last one */
+static OBJECT *init_by_parallel_list(OBJECT *first, STATUS *rv)
+{
+	OBJECT *obj, *last = NULL;
+	unsigned int n, m, n_obj=0, layer, next, n_batch, n_deferred=0;
+	unsigned int *batch, *deferred;
+	int n_done;
+
+	for ( obj=first ; obj!=NULL ; obj=obj->next )
+	{
+		last = obj;
+		n_obj++;
+	}
+	init_objectlist = (OBJECT**)malloc(sizeof(OBJECT*)*n_obj);
+	init_result = (int*)malloc(sizeof(int)*n_obj);
+	init_waiton = (OBJECT**)malloc(sizeof(OBJECT*)*n_obj);
+	init_defercount = (unsigned int*)malloc(sizeof(unsigned int)*n_obj);
+	init_tasklist = (INITTASK*)malloc(sizeof(INITTASK)*n_obj);
+	init_taskobject = (unsigned int*)malloc(sizeof(unsigned int)*n_obj);
+	init_unsafe = (MODULE**)malloc(sizeof(MODULE*)*n_obj);
+	batch = (unsigned int*)malloc(sizeof(unsigned int)*n_obj);
+	deferred = (unsigned int*)malloc(sizeof(unsigned int)*n_obj);
+	if ( init_objectlist==NULL || init_result==NULL || init_waiton==NULL || init_defercount==NULL || init_tasklist==NULL 
+		|| init_taskobject==NULL || init_unsafe==NULL || batch==NULL || deferred==NULL )
+	{
+		output_error("init_by_parallel(): unable to allocate memory for %d objects", n_obj);
+		/* TROUBLESHOOT
+			Parallel initialization requires more memory than is available.
+			Try freeing up memory, or use init_sequence=DEFERRED, and try again.
+		 */
+		*rv = FAILED;
+		goto Done;
+	}
+	for ( n=0, obj=first ; n<n_obj ; n++, obj=obj->next )
+		init_objectlist[n] = obj;
+	qsort(init_objectlist,n_obj,sizeof(OBJECT*),init_compare);
+	memset(init_defercount,0,sizeof(unsigned int)*n_obj);
+
+	for ( layer=0 ; layer<n_obj ; layer=next )
+	{
+		/* the layer is all the objects with the same rank */
+		for ( next=layer+1 ; next<n_obj && init_objectlist[next]->rank==init_objectlist[layer]->rank ; next++ ) {}
+		for ( n=layer ; n<next ; n++ )
+			batch[n-layer] = n;
+		n_batch = next-layer;
+
+		/* retry the deferred objects whose dependencies have completed */
+		do {
+			n_done = init_batch(batch,n_batch);
+			if ( n_done<0 )
+			{
+				*rv = FAILED;
+				goto Done;
+			}
+			for ( n=0 ; n<n_batch ; n++ )
+			{
+				if ( init_result[batch[n]]==2 )
+				{
+					OBJECT *parent = init_objectlist[batch[n]]->parent;
+					init_waiton[batch[n]] = ( parent!=NULL && !(parent->flags&OF_INIT) ) ? parent : NULL;
+					deferred[n_deferred++] = batch[n];
+				}
+			}
+			for ( m=n_batch=n=0 ; n<n_deferred ; n++ )
+			{
+				OBJECT *waiton = init_waiton[deferred[n]];
+				if ( waiton!=NULL ? (waiton->flags&OF_INIT)==OF_INIT : n_done>0 )
+					batch[n_batch++] = deferred[n];
+				else
+					deferred[m++] = deferred[n];
+			}
+			n_deferred = m;
+		} while ( n_batch>0 );
+	}
+	if ( n_deferred>0 )
+	{
+		output_error("init_by_parallel(): all %d uninitialized objects deferred, model is unable to initialize", n_deferred);
+		/* TROUBLESHOOT
+			The remaining objects are all waiting for each other to initialize.  Check the
+			dependencies between these objects and try again.
+		 */
+		*rv = FAILED;
+	}
+
+Done:
+	free(deferred);
+	free(batch);
+	free(init_unsafe);
+	free(init_taskobject);
+	free(init_tasklist);
+	free(init_defercount);
+	free(init_waiton);
+	free(init_result);
+	free(init_objectlist);
+	init_objectlist = NULL;
+	return last;
+}
+
+static STATUS init_by_parallel(void)
+{
+	OBJECT *obj, *last = NULL;
+	STATUS rv = SUCCESS;
+
+	if ( global_threadcount>1 && !global_debug_mode )
+	{
+		int n = wsp_init(global_threadcount);
+		if ( n==0 )
+		{
+			output_error("unable to start thread pool");
+			/* TROUBLESHOOT
+				The work-stealing thread pool could not be started.  This is usually
+				preceded by a more detailed message that explains why it failed.  Follow
+				the guidance for that message, or run with threadcount=1, and try again.
+			 */
+			return FAILED;
+		}
+		output_verbose("initializing objects using %d thread(s)", n);
+	}
+
+	/* objects created by init calls are initialized after the objects that created them */
+	for ( obj=object_get_first() ; obj!=NULL && rv==SUCCESS ; obj=last->next )
+		last = init_by_parallel_list(obj,&rv);
+	if ( rv==FAILED )
+		return FAILED;
+
+	for ( obj=object_get_first() ; obj!=NULL ; obj=obj->next )
+	{
+		if ((obj->oclass->passconfig & PC_FORCE_NAME) == PC_FORCE_NAME)
+		{
+			if (0 == strcmp(obj->name, ""))
+			{
+				output_warning("init: object %s:%d should have a name, but doesn't", obj->oclass->name, obj->id);
+				/* TROUBLESHOOT
+				   The object indicated has been flagged by the module which implements its class as one which must be named
+				   to work properly.  Please provide the object with a name and try again.
+				 */
+			}
+		}
+	}
+	return SUCCESS;
+}
+
 OBJECT **object_heartbeats = NULL;
 unsigned int n_object_heartbeats = 0;
 unsigned int max_object_heartbeats = 0;
@@ -796,6 +1349,9 @@ static STATUS init_all(void)
 		case IS_DEFERRED:
 			rv = init_by_deferral();
 			break;
+		case IS_PARALLEL:
+			rv = init_by_parallel();
+			break;
 		case IS_BOTTOMUP:
 			output_fatal("Bottom-up rank-based initialization mode not yet supported");
 			rv = FAILED;
@@ -1297,70 +1853,740 @@ void exec_sleep(unsigned int usec)
 #endif
 }
 
-typedef struct s_objsyncdata {
-	unsigned int n; // thread id 0~n_threads for this object rank list
-	pthread_t pt;
-	bool ok;
-	//void *item;
-	LISTITEM *ls;
-	unsigned int nObj; // number of obj in this object rank list
-	unsigned int t0;
-	int i; // index of mutex or cond this object rank list uses 
-} OBJSYNCDATA;
+/* object rank lists flattened into arrays for the work-stealing pool */
+typedef struct s_ranklist {
+	unsigned int pass; /* pass in which the rank list is used */
+	unsigned int n_obj; /* number of objects in the rank list */
+	OBJECT **obj; /* objects in the rank list */
+	struct s_rankqueue *queue; /* sync queue of the rank list (NULL if every object runs on every pass) */
+} RANKLIST;
+
+static void obj_syncproc(unsigned int thread, size_t item, void *data)
+{
+	RANKLIST *list = (RANKLIST*)data;
+	ss_do_object_sync(thread, list->obj[item]);
+}
+
+/* objects of the same class run back to back in the order they were created,
+   which is also the order of their memory in the class arena */
+static int ranklist_compare(const void *a, const void *b)
+{
+	OBJECT *obj1 = *(OBJECT**)a;
+	OBJECT *obj2 = *(OBJECT**)b;
+	if ( obj1->oclass->id!=obj2->oclass->id )
+		return obj1->oclass->id<obj2->oclass->id ? -1 : 1;
+	return obj1->id<obj2->id ? -1 : ( obj1->id>obj2->id ? 1 : 0 );
+}
+
+/* classes run in the order their first object in the rank was created */
+typedef struct s_rankgroup {
+	OBJECT **obj; /* first object of the class in the rank list */
+	unsigned int n_obj; /* number of objects of the class */
+} RANKGROUP;
+static int rankgroup_compare(const void *a, const void *b)
+{
+	OBJECTNUM id1 = (*((RANKGROUP*)a)->obj)->id;
+	OBJECTNUM id2 = (*((RANKGROUP*)b)->obj)->id;
+	return id1<id2 ? -1 : ( id1>id2 ? 1 : 0 );
+}
+
+/** Sort a rank list by class, keeping the order in which the model created the objects
+	(only when global_sync_class_batch is set, otherwise the rank order is kept)
+	@return SUCCESS, or FAILED if out of memory
+ **/
+static STATUS ranklist_sort(RANKLIST *list)
+{
+	RANKGROUP *group;
+	OBJECT **obj;
+	unsigned int n, m, n_group = 0;
+
+	if ( !global_sync_class_batch )
+		return SUCCESS;
+	qsort(list->obj,list->n_obj,sizeof(OBJECT*),ranklist_compare);
+	group = (RANKGROUP*)malloc(sizeof(RANKGROUP)*list->n_obj);
+	obj = (OBJECT**)malloc(sizeof(OBJECT*)*list->n_obj);
+	if ( group==NULL || obj==NULL )
+	{
+		free(group);
+		free(obj);
+		return list->n_obj>0 ? FAILED : SUCCESS;
+	}
+	for ( n=0 ; n<list->n_obj ; n++ )
+	{
+		if ( n==0 || list->obj[n]->oclass!=list->obj[n-1]->oclass )
+		{
+			group[n_group].obj = list->obj+n;
+			group[n_group++].n_obj = 0;
+		}
+		group[n_group-1].n_obj++;
+	}
+	qsort(group,n_group,sizeof(RANKGROUP),rankgroup_compare);
+	for ( n=0, m=0 ; n<n_group ; m+=group[n++].n_obj )
+		memcpy(obj+m,group[n].obj,sizeof(OBJECT*)*group[n].n_obj);
+	free(list->obj);
+	free(group);
+	list->obj = obj;
+	return SUCCESS;
+}
+
+/***********************************************************************/
+/* event sync queue (see global_sync_queue)
+
+   The queue decides at the start of each iteration which objects run.  The
+   decision covers all the passes of an object because its passes share state
+   (e.g., a presync that clears accumulators the sync fills).  Objects waiting
+   for an event are kept in heaps ordered by the time of the event, hard and soft
+   events apart so the events of the objects skipped can be posted as though
+   they had run.  An object runs when its event is due, when it is woken (see
+   exec_wake), or when all its passes returned TS_NEVER, because such objects
+   only react to their inputs and cannot tell when they must run again.  Objects
+   that run also run their parent and their children, since those are coupled to
+   them through pointers (e.g., enduses and their house, recorders and the object
+   they observe), so a parent/child tree always runs as a whole.  Objects coupled
+   any other way (e.g., through a climate or a market) are only run together when
+   the module wakes them (see exec_wake), so QUEUE is approximate for such models
+   and is only used when sync_queue is set.
+ */
+#define N_PASSES (sizeof(passtype)/sizeof(passtype[0]))
+typedef enum {
+	SD_NONE=0, /* object is skipped */
+	SD_RUN=1, /* object runs because it is reactive or was woken */
+	SD_DUE=2, /* object runs because its event is due */
+} SYNCDISPATCH;
+typedef enum {
+	SH_HARD=0, /* hard event heap */
+	SH_SOFT=1, /* soft event heap */
+	SH_COUNT,
+} SYNCHEAPTYPE;
+typedef struct s_syncobj {
+	OBJECT *obj; /* object synchronized (NULL if it is in no rank list) */
+	int list[N_PASSES]; /* rank list of the object in each pass (-1 if none) */
+	unsigned int index[N_PASSES]; /* position of the object in each rank list */
+	TIMESTAMP posted[N_PASSES]; /* event posted by the last sync of each pass (negative if soft) */
+	TIMESTAMP due[SH_COUNT]; /* hard and soft events the object waits for (TS_NEVER if none) */
+	unsigned int pos[SH_COUNT]; /* position in each event heap */
+	int reactive; /* position in the reactive list (-1 if not reactive) */
+	unsigned char dispatch; /* why the object runs in this iteration (see SYNCDISPATCH) */
+	unsigned char pending; /* object was woken since it last ran */
+	unsigned char observed; /* object is observed by a child that only commits (e.g., an assert) */
+	unsigned char earlier; /* a skipped sync moved the event earlier (validation only) */
+	PROPERTY *changed; /* property changed by a skipped sync (validation only) */
+} SYNCOBJ;
+typedef struct s_syncheap {
+	unsigned int n; /* number of objects in the heap */
+	OBJECTNUM *id; /* objects ordered by due time */
+} SYNCHEAP;
+typedef struct s_rankqueue {
+	unsigned int *batch; /* objects of the rank list that run in this iteration */
+	unsigned int n_batch;
+} RANKQUEUE;
+typedef struct s_syncreport {
+	void *key; /* property or class already reported */
+	struct s_syncreport *next;
+} SYNCREPORT;
+static RANKLIST *queue_ranklist = NULL; /* rank lists using the queue (NULL if not running) */
+static unsigned int queue_nlists = 0;
+static SYNCOBJ *queue_obj = NULL; /* queue state of each object id */
+static OBJECTNUM queue_nids = 0;
+static unsigned int queue_nobjs = 0; /* number of objects in rank lists */
+static SYNCHEAP queue_heap[SH_COUNT]; /* objects waiting for an event */
+static OBJECTNUM *queue_reactive = NULL; /* objects that run in every iteration */
+static unsigned int queue_nreactive = 0;
+static OBJECTNUM *queue_woken = NULL; /* objects woken since the last iteration */
+static unsigned int queue_nwoken = 0;
+static unsigned int queue_lock = 0; /* lock on the woken objects */
+static OBJECTNUM *queue_selected = NULL; /* objects that run in this iteration */
+static unsigned int queue_nselected = 0;
+static OBJECT **queue_child = NULL, **queue_sibling = NULL; /* first child and next sibling of each object id */
+static char **queue_snapshot = NULL; /* per-thread copy of an object before a skipped sync (validation only) */
+static unsigned int queue_nsnapshots = 0;
+static SYNCREPORT *queue_reported = NULL; /* validation differences already reported */
+static int64 queue_dispatched = 0, queue_skipped = 0; /* number of object iterations run and skipped by the queue */
+static int64 queue_changes = 0, queue_earlier = 0; /* number of skipped syncs that made a difference (validation only) */
+
+static void heap_move(SYNCHEAPTYPE h, unsigned int pos, OBJECTNUM id)
+{
+	queue_heap[h].id[pos] = id;
+	queue_obj[id].pos[h] = pos;
+}
+static void heap_up(SYNCHEAPTYPE h, unsigned int pos)
+{
+	SYNCHEAP *heap = &queue_heap[h];
+	OBJECTNUM id = heap->id[pos];
+	while ( pos>0 && queue_obj[heap->id[(pos-1)/2]].due[h]>queue_obj[id].due[h] )
+	{
+		heap_move(h,pos,heap->id[(pos-1)/2]);
+		pos = (pos-1)/2;
+	}
+	heap_move(h,pos,id);
+}
+static void heap_down(SYNCHEAPTYPE h, unsigned int pos)
+{
+	SYNCHEAP *heap = &queue_heap[h];
+	OBJECTNUM id = heap->id[pos];
+	for ( ;; )
+	{
+		unsigned int child = 2*pos+1;
+		if ( child>=heap->n )
+			break;
+		if ( child+1<heap->n && queue_obj[heap->id[child+1]].due[h]<queue_obj[heap->id[child]].due[h] )
+			child++;
+		if ( queue_obj[heap->id[child]].due[h]>=queue_obj[id].due[h] )
+			break;
+		heap_move(h,pos,heap->id[child]);
+		pos = child;
+	}
+	heap_move(h,pos,id);
+}
+static void heap_push(SYNCHEAPTYPE h, OBJECTNUM id)
+{
+	heap_move(h,queue_heap[h].n,id);
+	heap_up(h,queue_heap[h].n++);
+}
+static void heap_remove(SYNCHEAPTYPE h, unsigned int pos)
+{
+	SYNCHEAP *heap = &queue_heap[h];
+	OBJECTNUM id;
+	if ( --heap->n==pos )
+		return;
+	id = heap->id[heap->n];
+	heap_move(h,pos,id);
+	heap_up(h,pos);
+	heap_down(h,queue_obj[id].pos[h]);
+}
+
+/* take an object out of the reactive list and the event heaps */
+static void queue_leave(OBJECTNUM id)
+{
+	SYNCOBJ *item = &queue_obj[id];
+	unsigned int h;
+	if ( item->reactive>=0 )
+	{
+		queue_reactive[item->reactive] = queue_reactive[--queue_nreactive];
+		queue_obj[queue_reactive[item->reactive]].reactive = item->reactive;
+		item->reactive = -1;
+	}
+	for ( h=0 ; h<SH_COUNT ; h++ )
+	{
+		if ( item->due[h]<TS_NEVER )
+			heap_remove(h,item->pos[h]);
+		item->due[h] = TS_NEVER;
+	}
+}
+
+/* put an object where it waits according to the events its last syncs posted */
+static void queue_wait(OBJECTNUM id)
+{
+	SYNCOBJ *item = &queue_obj[id];
+	unsigned int pass, h;
+	int reactive = 1;
+	queue_leave(id);
+	for ( pass=0 ; pass<N_PASSES && !item->observed ; pass++ )
+	{
+		TIMESTAMP t = item->posted[pass];
+		if ( item->list[pass]<0 || t==TS_NEVER )
+			continue;
+		if ( t==TS_INVALID )
+		{
+			reactive = 1;
+			break;
+		}
+		reactive = 0;
+		h = ( t<0 ? SH_SOFT : SH_HARD );
+		if ( t<0 ) t = -t;
+		if ( t<item->due[h] )
+			item->due[h] = t;
+	}
+	if ( reactive )
+	{
+		item->due[SH_HARD] = item->due[SH_SOFT] = TS_NEVER;
+		item->reactive = queue_nreactive;
+		queue_reactive[queue_nreactive++] = id;
+	}
+	else
+	{
+		for ( h=0 ; h<SH_COUNT ; h++ )
+			if ( item->due[h]<TS_NEVER )
+				heap_push(h,id);
+	}
+}
+
+/* add an object to those that run in this iteration */
+static void queue_select(OBJECT *obj, SYNCDISPATCH why)
+{
+	SYNCOBJ *item = obj!=NULL && obj->id<queue_nids ? &queue_obj[obj->id] : NULL;
+	if ( item==NULL || item->obj==NULL )
+		return;
+	if ( item->dispatch==SD_NONE )
+		queue_selected[queue_nselected++] = obj->id;
+	if ( item->dispatch<why )
+		item->dispatch = why;
+}
+
+static int queue_compare(const void *a, const void *b)
+{
+	unsigned int k1 = *(unsigned int*)a;
+	unsigned int k2 = *(unsigned int*)b;
+	return k1<k2 ? -1 : ( k1>k2 ? 1 : 0 );
+}
 
-static pthread_mutex_t *startlock;
-static pthread_mutex_t *donelock;
-static pthread_cond_t *start;
-static pthread_cond_t *done;
+/* select the objects that run in this iteration and fill the batch of each rank list */
+static void queue_start(void)
+{
+	unsigned int n, h, pass;
+	OBJECT *child;
+
+	queue_nselected = 0;
+	for ( n=0 ; n<queue_nreactive ; n++ )
+		queue_select(queue_obj[queue_reactive[n]].obj,SD_RUN);
+	for ( h=0 ; h<SH_COUNT ; h++ )
+	{
+		SYNCHEAP *heap = &queue_heap[h];
+		while ( heap->n>0 && queue_obj[heap->id[0]].due[h]<=global_clock )
+		{
+			SYNCOBJ *item = &queue_obj[heap->id[0]];
+			heap_remove(h,0);
+			item->due[h] = TS_NEVER;
+			queue_select(item->obj,SD_DUE);
+		}
+	}
+	wlock(&queue_lock);
+	for ( n=0 ; n<queue_nwoken ; n++ )
+	{
+		queue_obj[queue_woken[n]].pending = 0;
+		queue_select(queue_obj[queue_woken[n]].obj,SD_RUN);
+	}
+	queue_nwoken = 0;
+	wunlock(&queue_lock);
 
-static unsigned int *next_t1;
-static unsigned int *donecount;
-static unsigned int *n_threads; //number of thread used in the threadpool of an object rank list
+	/* objects run with their parent and their children, which may read or write their data through
+	   pointers, and so do the objects selected that way, so the whole parent/child tree runs together */
+	for ( n=0 ; n<queue_nselected ; n++ )
+	{
+		SYNCOBJ *item = &queue_obj[queue_selected[n]];
+		queue_select(item->obj->parent,SD_RUN);
+		for ( child=queue_child[item->obj->id] ; child!=NULL ; child=queue_sibling[child->id] )
+			queue_select(child,SD_RUN);
+	}
+	queue_dispatched += queue_nselected;
+	queue_skipped += queue_nobjs-queue_nselected;
+
+	/* validation runs every object, otherwise the batches keep the rank list order */
+	for ( n=0 ; n<queue_nlists ; n++ )
+	{
+		RANKLIST *list = &queue_ranklist[n];
+		unsigned int k;
+		if ( global_sync_queue==SQ_VALIDATE )
+		{
+			for ( k=0 ; k<list->n_obj ; k++ )
+				list->queue->batch[k] = k;
+			list->queue->n_batch = list->n_obj;
+		}
+		else
+			list->queue->n_batch = 0;
+	}
+	if ( global_sync_queue!=SQ_VALIDATE )
+	{
+		for ( n=0 ; n<queue_nselected ; n++ )
+		{
+			SYNCOBJ *item = &queue_obj[queue_selected[n]];
+			for ( pass=0 ; pass<N_PASSES ; pass++ )
+			{
+				RANKQUEUE *queue;
+				if ( item->list[pass]<0 )
+					continue;
+				queue = queue_ranklist[item->list[pass]].queue;
+				queue->batch[queue->n_batch++] = item->index[pass];
+			}
+		}
+		for ( n=0 ; n<queue_nlists ; n++ )
+			qsort(queue_ranklist[n].queue->batch,queue_ranklist[n].queue->n_batch,sizeof(unsigned int),queue_compare);
+	}
+}
+
+/* compare the published properties of an object with a copy of its data
+   @return the first property that differs, or NULL if none */
+static PROPERTY *queue_changed(OBJECT *obj, char *snapshot)
+{
+	CLASS *oclass;
+	PROPERTY *prop;
+	for ( oclass=obj->oclass ; oclass!=NULL ; oclass=oclass->parent )
+	{
+		for ( prop=class_get_first_property(oclass) ; prop!=NULL ; prop=class_get_next_property(prop) )
+		{
+			size_t offset = (size_t)prop->addr;
+			size_t size = property_size(prop);
+			if ( prop->ptype==PT_delegated || size==0 || offset+size>obj->oclass->size )
+				continue;
+			if ( memcmp((char*)(obj+1)+offset,snapshot+offset,size)!=0 )
+				return prop;
+		}
+	}
+	return NULL;
+}
+
+static void queue_syncproc(unsigned int thread, size_t item, void *data)
+{
+	RANKLIST *list = (RANKLIST*)data;
+	OBJECT *obj = list->obj[list->queue->batch[item]];
+	SYNCOBJ *entry = &queue_obj[obj->id];
+	if ( entry->dispatch==SD_NONE ) /* only when validating */
+	{
+		char *snapshot = queue_snapshot[thread];
+		TIMESTAMP t;
+		memcpy(snapshot,obj+1,obj->oclass->size);
+		t = entry->posted[list->pass] = ss_do_object_sync(thread,obj);
+		if ( entry->changed==NULL )
+			entry->changed = queue_changed(obj,snapshot);
+		if ( t!=TS_NEVER && t!=TS_INVALID && absolute_timestamp(t)<entry->due[SH_HARD] && absolute_timestamp(t)<entry->due[SH_SOFT] )
+			entry->earlier = 1;
+	}
+	else
+		entry->posted[list->pass] = ss_do_object_sync(thread,obj);
+}
 
-static void *obj_syncproc(void *ptr)
+/* run the objects of a rank list selected in this iteration */
+static void queue_run(RANKLIST *list)
 {
-	OBJSYNCDATA *data = (OBJSYNCDATA*)ptr;
-	LISTITEM *s;
+	RANKQUEUE *queue = list->queue;
 	unsigned int n;
-	int i = data->i;
+	if ( global_threadcount==1 )
+	{
+		for ( n=0 ; n<queue->n_batch ; n++ )
+		{
+			queue_syncproc(0,n,list);
+			if ( list->obj[queue->batch[n]]->valid_to==TS_INVALID )
+				break;
+		}
+	}
+	else
+		wsp_run(queue_syncproc,list,queue->n_batch,global_sync_chunksize);
+}
 
-	// begin processing loop
-	while (data->ok)
+/* check whether a validation difference was already reported */
+static int queue_isreported(void *key)
+{
+	SYNCREPORT *report;
+	for ( report=queue_reported ; report!=NULL ; report=report->next )
+		if ( report->key==key )
+			return 1;
+	report = (SYNCREPORT*)malloc(sizeof(SYNCREPORT));
+	if ( report!=NULL )
+	{
+		report->key = key;
+		report->next = queue_reported;
+		queue_reported = report;
+	}
+	return 0;
+}
+
+/* report the validation differences of a skipped object */
+static void queue_report(SYNCOBJ *item)
+{
+	char name[64];
+	if ( item->changed!=NULL )
 	{
-		// lock access to start condition
-		pthread_mutex_lock(&startlock[i]);
+		queue_changes++;
+		if ( !queue_isreported(item->changed) )
+			output_warning("sync queue would have skipped %s but its sync changed %s.%s", object_name(item->obj,name,sizeof(name)-1), item->obj->oclass->name, item->changed->name);
+			/* TROUBLESHOOT
+				The sync queue validation found an object whose sync changes a property at a time
+				the queue would not have run it.  The value seen by other objects lags until the
+				object runs again, so results with sync_queue=QUEUE may differ from a full sweep.
+				Each property is reported once; the totals are given at the end of the run.
+			 */
+	}
+	if ( item->earlier )
+	{
+		queue_earlier++;
+		if ( !queue_isreported(item->obj->oclass) )
+			output_warning("sync queue would have skipped %s but its sync moved its next event earlier", object_name(item->obj,name,sizeof(name)-1));
+			/* TROUBLESHOOT
+				The sync queue validation found an object that changes the time of its next event
+				at a time the queue would not have run it, because the object does not report its
+				next event accurately or depends on inputs that change without waking it.  Objects
+				of this class may miss events with sync_queue=QUEUE.  Each class is reported once;
+				the totals are given at the end of the run.
+			 */
+	}
+	item->changed = NULL;
+	item->earlier = 0;
+}
 
-		// wait for thread start condition)
-		while (data->t0 == next_t1[i]) 
-			pthread_cond_wait(&start[i], &startlock[i]);
-		// unlock access to start count
-		pthread_mutex_unlock(&startlock[i]);
+/* put the objects that ran back in the queue and post the events of those skipped */
+static void queue_stop(void)
+{
+	unsigned int n;
+	OBJECT *obj;
 
-		// process the list for this thread
-		for (s=data->ls, n=0; s!=NULL, n<data->nObj; s=s->next,n++) {
-			OBJECT *obj = s->data;
-			ss_do_object_sync(data->n, s->data);
+	if ( global_sync_queue==SQ_VALIDATE )
+	{
+		for ( obj=object_get_first() ; obj!=NULL ; obj=object_get_next(obj) )
+		{
+			SYNCOBJ *item = obj->id<queue_nids ? &queue_obj[obj->id] : NULL;
+			if ( item!=NULL && item->dispatch==SD_NONE && (item->changed!=NULL || item->earlier) )
+				queue_report(item);
 		}
+	}
+	for ( n=0 ; n<queue_nselected ; n++ )
+	{
+		queue_obj[queue_selected[n]].dispatch = SD_NONE;
+		queue_wait(queue_selected[n]);
+	}
+	queue_nselected = 0;
 
-		// signal completed condition
-		data->t0 = next_t1[i];
+	/* validation ran every object so their own events are already posted */
+	if ( global_sync_queue!=SQ_VALIDATE )
+	{
+		if ( queue_heap[SH_HARD].n>0 )
+			exec_sync_set(NULL,queue_obj[queue_heap[SH_HARD].id[0]].due[SH_HARD]);
+		if ( queue_heap[SH_SOFT].n>0 )
+			exec_sync_set(NULL,-queue_obj[queue_heap[SH_SOFT].id[0]].due[SH_SOFT]);
+	}
+}
 
-		// lock access to done condition
-		pthread_mutex_lock(&donelock[i]);
+/** Run an object in the next iteration when the sync queue is used (see global_sync_queue).
+	Property changes through the core call this automatically; modules call gl_wake()
+	when they change the data of another object directly.
+ **/
+void exec_wake(OBJECT *obj)
+{
+	SYNCOBJ *item;
+	if ( queue_obj==NULL || obj==NULL || obj->id>=queue_nids )
+		return;
+	item = &queue_obj[obj->id];
+	if ( item->obj==NULL || item->pending )
+		return;
+	wlock(&queue_lock);
+	if ( !item->pending )
+	{
+		item->pending = 1;
+		queue_woken[queue_nwoken++] = obj->id;
+	}
+	wunlock(&queue_lock);
+}
 
-		// signal thread is done for now
-		donecount[i] --; 
+/** Set up the sync queue of the rank lists
+	@return SUCCESS, or FAILED if out of memory
+ **/
+static STATUS queue_init(RANKLIST *ranklist, unsigned int n_lists)
+{
+	OBJECT *obj;
+	CLASS *oclass;
+	unsigned int n, k, pass, size = 0;
 
-		// signal change in done condition
-		pthread_cond_broadcast(&done[i]);
+	for ( obj=object_get_first() ; obj!=NULL ; obj=object_get_next(obj) )
+		if ( obj->id>=queue_nids )
+			queue_nids = obj->id+1;
+	queue_obj = (SYNCOBJ*)malloc(sizeof(SYNCOBJ)*(queue_nids+1));
+	queue_heap[SH_HARD].id = (OBJECTNUM*)malloc(sizeof(OBJECTNUM)*(queue_nids+1));
+	queue_heap[SH_SOFT].id = (OBJECTNUM*)malloc(sizeof(OBJECTNUM)*(queue_nids+1));
+	queue_reactive = (OBJECTNUM*)malloc(sizeof(OBJECTNUM)*(queue_nids+1));
+	queue_woken = (OBJECTNUM*)malloc(sizeof(OBJECTNUM)*(queue_nids+1));
+	queue_selected = (OBJECTNUM*)malloc(sizeof(OBJECTNUM)*(queue_nids+1));
+	queue_child = (OBJECT**)malloc(sizeof(OBJECT*)*(queue_nids+1));
+	queue_sibling = (OBJECT**)malloc(sizeof(OBJECT*)*(queue_nids+1));
+	if ( queue_obj==NULL || queue_heap[SH_HARD].id==NULL || queue_heap[SH_SOFT].id==NULL || queue_reactive==NULL 
+		|| queue_woken==NULL || queue_selected==NULL || queue_child==NULL || queue_sibling==NULL )
+		return FAILED;
+	memset(queue_obj,0,sizeof(SYNCOBJ)*queue_nids);
+	for ( n=0 ; n<queue_nids ; n++ )
+	{
+		for ( pass=0 ; pass<N_PASSES ; pass++ )
+		{
+			queue_obj[n].list[pass] = -1;
+			queue_obj[n].posted[pass] = TS_NEVER;
+		}
+		queue_obj[n].due[SH_HARD] = queue_obj[n].due[SH_SOFT] = TS_NEVER;
+		queue_obj[n].reactive = -1;
+		queue_child[n] = queue_sibling[n] = NULL;
+	}
+	for ( obj=object_get_first() ; obj!=NULL ; obj=object_get_next(obj) )
+	{
+		if ( obj->parent==NULL )
+			continue;
+		queue_sibling[obj->id] = queue_child[obj->parent->id];
+		queue_child[obj->parent->id] = obj;
+	}
 
-		//unlock access to done count
-		pthread_mutex_unlock(&donelock[i]);
+	/* index the objects of every rank list */
+	for ( n=0 ; n<n_lists ; n++ )
+	{
+		RANKLIST *list = &ranklist[n];
+		list->queue = (RANKQUEUE*)malloc(sizeof(RANKQUEUE));
+		if ( list->queue==NULL )
+			return FAILED;
+		list->queue->n_batch = 0;
+		list->queue->batch = (unsigned int*)malloc(sizeof(unsigned int)*(list->n_obj+1));
+		if ( list->queue->batch==NULL )
+			return FAILED;
+		for ( k=0 ; k<list->n_obj ; k++ )
+		{
+			SYNCOBJ *item = &queue_obj[list->obj[k]->id];
+			item->obj = list->obj[k];
+			item->list[list->pass] = n;
+			item->index[list->pass] = k;
+		}
+	}
+
+	/* objects observed by children that only commit must run on every iteration */
+	for ( obj=object_get_first() ; obj!=NULL ; obj=object_get_next(obj) )
+	{
+		if ( queue_obj[obj->id].obj==NULL && obj->oclass->commit!=NULL && obj->parent!=NULL )
+			queue_obj[obj->parent->id].observed = 1;
+	}
+
+	/* every object starts out reactive */
+	for ( n=0 ; n<queue_nids ; n++ )
+	{
+		if ( queue_obj[n].obj==NULL )
+			continue;
+		queue_wait(n);
+		queue_nobjs++;
+	}
+
+	/* validation keeps a copy of each object before the syncs the queue would skip */
+	if ( global_sync_queue==SQ_VALIDATE )
+	{
+		for ( oclass=class_get_first_class() ; oclass!=NULL ; oclass=oclass->next )
+			if ( oclass->size>size )
+				size = oclass->size;
+		queue_nsnapshots = global_threadcount>1 ? wsp_get_threadcount() : 1;
+		queue_snapshot = (char**)malloc(sizeof(char*)*queue_nsnapshots);
+		if ( queue_snapshot==NULL )
+			return FAILED;
+		for ( n=0 ; n<queue_nsnapshots ; n++ )
+			if ( (queue_snapshot[n]=(char*)malloc(size+1))==NULL )
+				return FAILED;
+	}
+	queue_ranklist = ranklist;
+	queue_nlists = n_lists;
+	output_verbose("sync queue %s for %d objects", global_sync_queue==SQ_VALIDATE?"validating":"enabled", queue_nobjs);
+	return SUCCESS;
+}
+
+/* make every object reactive again (used after the objects ran outside of the queue) */
+static void queue_reset(void)
+{
+	OBJECTNUM n;
+	unsigned int pass;
+	for ( n=0 ; n<queue_nids ; n++ )
+	{
+		if ( queue_obj[n].obj==NULL )
+			continue;
+		for ( pass=0 ; pass<N_PASSES ; pass++ )
+			queue_obj[n].posted[pass] = TS_NEVER;
+		queue_wait(n);
 	}
-	pthread_exit((void*)0);
-	return (void*)0;
 }
 
+/* release the sync queue and report the validation results */
+static void queue_term(void)
+{
+	unsigned int n;
+	if ( queue_ranklist==NULL )
+		return;
+	for ( n=0 ; n<queue_nlists ; n++ )
+	{
+		free(queue_ranklist[n].queue->batch);
+		free(queue_ranklist[n].queue);
+		queue_ranklist[n].queue = NULL;
+	}
+	for ( n=0 ; n<queue_nsnapshots ; n++ )
+		free(queue_snapshot[n]);
+	while ( queue_reported!=NULL )
+	{
+		SYNCREPORT *next = queue_reported->next;
+		free(queue_reported);
+		queue_reported = next;
+	}
+	free(queue_snapshot);
+	free(queue_obj);
+	free(queue_heap[SH_HARD].id);
+	free(queue_heap[SH_SOFT].id);
+	free(queue_reactive);
+	free(queue_woken);
+	free(queue_selected);
+	free(queue_child);
+	free(queue_sibling);
+	memset(queue_heap,0,sizeof(queue_heap));
+	queue_snapshot = NULL;
+	queue_nsnapshots = 0;
+	queue_obj = NULL;
+	queue_reactive = queue_woken = queue_selected = NULL;
+	queue_nreactive = queue_nwoken = queue_nselected = 0;
+	queue_child = queue_sibling = NULL;
+	queue_ranklist = NULL;
+	queue_nlists = 0;
+	queue_nids = 0;
+	output_verbose("sync queue ran %lld object iterations and skipped %lld", queue_dispatched, queue_skipped);
+	if ( global_sync_queue==SQ_VALIDATE )
+	{
+		if ( queue_changes>0 || queue_earlier>0 )
+		{
+			output_warning("sync queue validation found %lld of %lld skipped object iterations changed properties and %lld moved events earlier", queue_changes, queue_skipped, queue_earlier);
+			/* TROUBLESHOOT
+				The sync queue validation found objects whose syncs make a difference when the
+				queue would not have run them.  The first difference of each property or class
+				is reported earlier in the output.  Results with sync_queue=QUEUE may differ
+				from a full sweep.
+			 */
+		}
+		else
+			output_message("sync queue validation found no differences in %lld skipped object iterations", queue_skipped);
+	}
+}
+
+/* hardware cache misses of the main thread, counted for the profiler where the OS allows it */
+static int cachemiss_fd = -1;
+static void cachemiss_start(void)
+{
+#if defined(__linux__) && defined(__NR_perf_event_open)
+	struct perf_event_attr attr;
+	memset(&attr,0,sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	cachemiss_fd = (int)syscall(__NR_perf_event_open,&attr,0,-1,-1,0);
+	if ( cachemiss_fd<0 )
+		output_verbose("cache miss counter is not available: %s", strerror(errno));
+#endif
+}
+static int64 cachemiss_stop(void)
+{
+	int64 count = -1;
+#ifdef __linux__
+	if ( cachemiss_fd>=0 )
+	{
+		if ( read(cachemiss_fd,&count,sizeof(count))!=sizeof(count) )
+			count = -1;
+		close(cachemiss_fd);
+		cachemiss_fd = -1;
+	}
+#endif
+	return count;
+}
+
+/* wall clock in seconds (higher resolution than exec_clock) */
+double exec_wallclock(void)
+{
+#ifdef WIN32
+	static LARGE_INTEGER freq = {0};
+	LARGE_INTEGER now;
+	if ( freq.QuadPart==0 )
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (double)now.QuadPart/(double)freq.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec*1e-6;
+#endif
+}
+static double pass_walltime[] = {0,0,0}; /* wall time spent in each pass */
+
 /** MAIN LOOP CONTROL ******************************************************************/
 
 /*static*/ pthread_mutex_t mls_svr_lock;
@@ -1672,17 +2898,10 @@ STATUS exec_start(void)
 	int pc_rv = 0; // precommit return value
 	STATUS fnl_rv = 0; // finalize all return value
 	time_t started_at = realtime_now(); // for profiler
-	int j, k;
+	int64 cache_misses = -1; // for profiler
+	int j;
 	LISTITEM *ptr;
-	int incr;
-	struct arg_data *arg_data_array;
-
-	// Only setup threadpool for each object rank list at the first iteration;
-	// After the first iteration, setTP = false;
-	bool setTP = true; 
-	//int n_threads; //number of thread used in the threadpool of an object rank list
-	OBJSYNCDATA *thread = NULL;
-
+	RANKLIST *ranklist = NULL;
 	int nObjRankList, iObjRankList;
 
 	/* run create scripts, if any */
@@ -1746,10 +2965,6 @@ STATUS exec_start(void)
 			output_verbose("using %d helper thread(s)", global_threadcount);
 		}
 
-		//sjin: allocate arg_data_array to store pthreads creation argument
-		arg_data_array = (struct arg_data *) malloc(sizeof(struct arg_data) 
-						 * global_threadcount);
-
 		/* allocate thread synchronization data */
 		thread_data = (struct thread_data *) malloc(sizeof(struct thread_data) +
 					  sizeof(struct sync_data) * global_threadcount);
@@ -1757,7 +2972,7 @@ STATUS exec_start(void)
 			output_error("thread memory allocation failed");
 			/* TROUBLESHOOT
 				A thread memory allocation failed.  
-				Follow the standard process for freeing up memory ang try again.
+				Follow the standard process for freeing up memory and try again.
 			 */
 			return FAILED;
 		}
@@ -1765,6 +2980,26 @@ STATUS exec_start(void)
 		thread_data->data = (struct sync_data *) (thread_data + 1);
 		for (j = 0; j < thread_data->count; j++) 
 			thread_data->data[j].status = SUCCESS;
+
+		/* start the work-stealing pool used by all rank lists */
+		if (global_threadcount > 1)
+		{
+			int n = wsp_init(global_threadcount);
+			if ( n==0 )
+			{
+				output_error("unable to start thread pool");
+				/* TROUBLESHOOT
+					The work-stealing thread pool could not be started.  This is usually
+					preceded by a more detailed message that explains why it failed.  Follow
+					the guidance for that message, or run with threadcount=1, and try again.
+				 */
+				return FAILED;
+			}
+			output_verbose("thread pool started with %d thread(s)", n);
+		}
+
+		/* start the profiler trace, if any */
+		trace_open(global_threadcount>1 ? wsp_get_threadcount() : 1);
 	}
 	else
 	{
@@ -1842,30 +3077,64 @@ STATUS exec_start(void)
 			nObjRankList++; // count how many object rank list in one iteration
 		}
 	}
-
-	/* allocate and initialize thread data */
 	output_debug("nObjRankList=%d ",nObjRankList);
 
-	next_t1 = malloc(sizeof(next_t1[0])*nObjRankList);
-	memset(next_t1,0,sizeof(next_t1[0])*nObjRankList);
-
-	donecount = malloc(sizeof(donecount[0])*nObjRankList);
-	memset(donecount,0,sizeof(donecount[0])*nObjRankList);
-
-	n_threads = malloc(sizeof(n_threads[0])*nObjRankList);
-	memset(n_threads,0,sizeof(n_threads[0])*nObjRankList);
+	/* flatten the object rank lists into arrays for the thread pool */
+	ranklist = (RANKLIST*)malloc(sizeof(RANKLIST)*(nObjRankList+1));
+	if ( ranklist==NULL )
+	{
+		output_error("rank list memory allocation failed");
+		/* TROUBLESHOOT
+			A rank list memory allocation failed.  
+			Follow the standard process for freeing up memory and try again.
+		 */
+		return FAILED;
+	}
+	iObjRankList = 0;
+	for (pass = 0; ranks[pass] != NULL; pass++)
+	{
+		int i;
+		for (i = PASSINIT(pass); PASSCMP(i, pass); i += PASSINC(pass))
+		{
+			RANKLIST *list = &ranklist[iObjRankList];
+			if (ranks[pass]->ordinal[i] == NULL) 
+				continue;
+			list->pass = pass;
+			list->n_obj = 0;
+			list->queue = NULL;
+			list->obj = (OBJECT**)malloc(sizeof(OBJECT*)*ranks[pass]->ordinal[i]->size);
+			if ( list->obj==NULL )
+			{
+				output_error("rank list memory allocation failed");
+				while ( iObjRankList-->0 )
+					free(ranklist[iObjRankList].obj);
+				free(ranklist);
+				return FAILED;
+			}
+			for (ptr = ranks[pass]->ordinal[i]->first; ptr != NULL; ptr=ptr->next)
+				list->obj[list->n_obj++] = ptr->data;
+			if ( ranklist_sort(list)==FAILED )
+			{
+				output_error("rank list memory allocation failed");
+				free(list->obj);
+				while ( iObjRankList-->0 )
+					free(ranklist[iObjRankList].obj);
+				free(ranklist);
+				return FAILED;
+			}
+			iObjRankList++;
+		}
+	}
 
-	// allocation and nitialize mutex and cond for object rank lists
-	startlock = malloc(sizeof(startlock[0])*nObjRankList);
-	donelock = malloc(sizeof(donelock[0])*nObjRankList);
-	start = malloc(sizeof(start[0])*nObjRankList);
-	done = malloc(sizeof(done[0])*nObjRankList);
-	for(k=0;k<nObjRankList;k++) 
+	/* set up the sync queues, if any */
+	if ( global_sync_queue!=SQ_NONE && !global_debug_mode && queue_init(ranklist,nObjRankList)==FAILED )
 	{
-		pthread_mutex_init(&startlock[k], NULL);
-		pthread_mutex_init(&donelock[k], NULL);
-		pthread_cond_init(&start[k], NULL);
-		pthread_cond_init(&done[k], NULL);
+		output_error("sync queue memory allocation failed");
+		/* TROUBLESHOOT
+			A sync queue memory allocation failed.  
+			Follow the standard process for freeing up memory, or run with sync_queue=NONE, and try again.
+		 */
+		return FAILED;
 	}
 
 	// global test mode
@@ -1880,6 +3149,8 @@ STATUS exec_start(void)
 
 	//sjin: GetMachineCycleCount
 	cstart = (clock_t)exec_clock();
+	if ( global_profiler )
+		cachemiss_start();
 
 	/* main loop exception handler */
 	TRY {
@@ -2050,10 +3321,15 @@ STATUS exec_start(void)
 			}
 			iObjRankList = -1;
 
+			/* select the objects that run in this iteration */
+			if ( queue_ranklist!=NULL )
+				queue_start();
+
 			/* scan the ranks of objects for each pass */
 			for (pass = 0; ranks[pass] != NULL; pass++)
 			{
 				int i;
+				double pass_start = exec_wallclock();
 
 				/* process object in order of rank using index */
 				for (i = PASSINIT(pass); PASSCMP(i, pass); i += PASSINC(pass))
@@ -2079,95 +3355,34 @@ STATUS exec_start(void)
 					}
 					else
 					{
+						double rank_start = trace_fp!=NULL ? exec_wallclock() : 0;
+
+						/* run only the objects that are due or woken */
+						if ( ranklist[iObjRankList].queue!=NULL )
+							queue_run(&ranklist[iObjRankList]);
 						//sjin: if global_threadcount == 1, no pthread multhreading
-						if (global_threadcount == 1) 
+						else if (global_threadcount == 1) 
 						{
-							for (ptr = ranks[pass]->ordinal[i]->first; ptr != NULL; ptr=ptr->next) {
-								OBJECT *obj = ptr->data;
-								ss_do_object_sync(0, ptr->data);					
+							RANKLIST *list = &ranklist[iObjRankList];
+							unsigned int n;
+							for (n = 0; n < list->n_obj; n++) {
+								OBJECT *obj = list->obj[n];
+								ss_do_object_sync(0, obj);
 								
 								if (obj->valid_to == TS_INVALID)
 								{
 									//Get us out of the loop so others don't exec on bad status
 									break;
 								}
-								///printf("%d %s %d\n", obj->id, obj->name, obj->rank);
 							}
-							//printf("\n");
 						} 
 						else 
-						{ //sjin: implement pthreads
-							unsigned int n_items,objn=0,n;
-							unsigned int n_obj = ranks[pass]->ordinal[i]->size;
-
-							// Only create threadpool for each object rank list at the first iteration. 
-							// Reuse the threadppol of each object rank list at all other iterations.
-							if (setTP == true) { 
-								incr = (int)ceil((float) n_obj / global_threadcount);
-								// if the number of objects is less than or equal to the number of threads, each thread process one object 
-								if (incr <= 1) {
-									n_threads[iObjRankList] = n_obj;
-									n_items = 1;
-								// if the number of objects is greater than the number of threads, each thread process the same number of 
-								// objects (incr), except that the last thread may process less objects 
-								} else {
-									n_threads[iObjRankList] = (int)ceil((float) n_obj / incr);
-									n_items = incr;
-								}
-								if ((int)n_threads[iObjRankList] > global_threadcount) {
-									output_error("Running threads > global_threadcount");
-									exit(0);
-								}
-
-								// allocate thread list
-								thread = (OBJSYNCDATA*)malloc(sizeof(OBJSYNCDATA)*n_threads[iObjRankList]);
-								memset(thread,0,sizeof(OBJSYNCDATA)*n_threads[iObjRankList]);
-								// assign starting obj for each thread
-								for (ptr=ranks[pass]->ordinal[i]->first;ptr!=NULL;ptr=ptr->next)
-								{
-									if (thread[objn].nObj==n_items)
-										objn++;
-									if (thread[objn].nObj==0) {
-										thread[objn].ls=ptr;
-									}
-									thread[objn].nObj++;
-								}
-								// create threads
-								for (n=0; n<n_threads[iObjRankList]; n++) {
-									thread[n].ok = true;
-									thread[n].i = iObjRankList;
-									if (pthread_create(&(thread[n].pt),NULL,obj_syncproc,&(thread[n]))!=0) {
-										output_fatal("obj_sync thread creation failed");
-										thread[n].ok = false;
-									} else
-										thread[n].n = n;
-								}
-
-							}
-														
-							// lock access to done count
-							pthread_mutex_lock(&donelock[iObjRankList]);
-							
-							// initialize wait count
-							donecount[iObjRankList] = n_threads[iObjRankList];
-
-							// lock access to start condition
-							pthread_mutex_lock(&startlock[iObjRankList]);
-
-							// update start condition
-							next_t1[iObjRankList] ++;
-
-							// signal all the threads
-							pthread_cond_broadcast(&start[iObjRankList]);
-							// unlock access to start count
-							pthread_mutex_unlock(&startlock[iObjRankList]);
-
-							// begin wait
-							while (donecount[iObjRankList]>0)
-								pthread_cond_wait(&done[iObjRankList],&donelock[iObjRankList]);
-							// unlock done count
-							pthread_mutex_unlock(&donelock[iObjRankList]);
+						{
+							/* run the rank list on the thread pool (returns when all objects are done) */
+							wsp_run(obj_syncproc,&ranklist[iObjRankList],ranklist[iObjRankList].n_obj,global_sync_chunksize);
 						}
+						if ( trace_fp!=NULL )
+							trace_event(0,NULL,i,ranklist[iObjRankList].queue!=NULL?ranklist[iObjRankList].queue->n_batch:ranklist[iObjRankList].n_obj,rank_start);
 
 						for (j = 0; j < thread_data->count; j++) {
 							if (thread_data->data[j].status == FAILED) {
@@ -2179,13 +3394,14 @@ STATUS exec_start(void)
 				}
 
 
+				pass_walltime[pass] += exec_wallclock() - pass_start;
+
 				/* run all non-schedule transforms */
 				{
 					TIMESTAMP st = transform_syncall(global_clock,XS_DOUBLE|XS_COMPLEX|XS_ENDUSE);// if (abs(t)<t2) t2=t;
 					exec_sync_set(NULL,st);
 				}
 			}
-			setTP = false;
 
 			if (!global_debug_mode)
 			{
@@ -2194,6 +3410,10 @@ STATUS exec_start(void)
 					exec_sync_merge(NULL,&thread_data->data[j]);
 				}
 
+				/* post the events of the objects the sync queue skipped */
+				if ( queue_ranklist!=NULL )
+					queue_stop();
+
 				/* report progress */
 				realtime_run_schedule();
 			}
@@ -2282,6 +3502,10 @@ STATUS exec_start(void)
 				}
 				exec_sync_set(NULL,global_clock + deltatime);
 				global_simulation_mode = SM_EVENT;
+
+				/* objects updated in delta mode must run again before the queue skips them */
+				if ( queue_ranklist!=NULL )
+					queue_reset();
 			}
 
 			/* clock update is the very last chance to change the next time */
@@ -2315,6 +3539,10 @@ STATUS exec_start(void)
 	}
 	ENDCATCH
 	output_debug("*** main loop ended at %lli; stoptime=%lli, n_events=%i, exitcode=%i ***", exec_sync_get(NULL), global_stoptime, exec_sync_getevents(NULL), exec_getexitcode());
+	trace_close();
+
+	/* the last background checkpoint must be on disk before the term scripts run */
+	checkpoint_wait();
 	if(global_multirun_mode == MRM_MASTER)
 	{
 		instance_master_done(TS_NEVER); // tell everyone to pack up and go home
@@ -2349,15 +3577,18 @@ STATUS exec_start(void)
 #endif
 	}
 
-	// Destroy mutex and cond
-	for(k=0;k<nObjRankList;k++) {
-		pthread_mutex_destroy(&startlock[k]);
-		pthread_mutex_destroy(&donelock[k]);
-		pthread_cond_destroy(&start[k]);
-		pthread_cond_destroy(&done[k]);
-	}
+	/* stop thread pool and release rank lists */
+	wsp_term();
+
+	/* finish writing the last background checkpoint */
+	checkpoint_wait();
+	queue_term();
+	for (iObjRankList = 0; iObjRankList < nObjRankList; iObjRankList++)
+		free(ranklist[iObjRankList].obj);
+	free(ranklist);
 
 	/* report performance */
+	cache_misses = cachemiss_stop();
 	if (global_profiler && !exec_sync_isinvalid(NULL) )
 	{
 		double elapsed_sim = timestamp_to_hours(global_clock)-timestamp_to_hours(global_starttime);
@@ -2377,6 +3608,7 @@ STATUS exec_start(void)
 		DELTAPROFILE *dp = delta_getprofile();
 		double delta_runtime = 0, delta_simtime = 0;
 		if (global_threadcount==0) global_threadcount=1;
+		object_profile_merge();
 		for (cl=class_get_first_class(); cl!=NULL; cl=cl->next)
 			sync_time += ((double)cl->profiler.clocks)/CLOCKS_PER_SEC;
 		sync_time /= global_threadcount;
@@ -2407,6 +3639,19 @@ STATUS exec_start(void)
 		else
 			output_profile("Simulation speed         %7.0lf object.hours/second", sim_speed*1000);
 		output_profile("Passes completed        %8d passes", passes);
+		output_profile("  Presync pass time     %8.3f seconds (%.1f%%)", pass_walltime[0],pass_walltime[0]/elapsed_wall*100);
+		output_profile("  Sync pass time        %8.3f seconds (%.1f%%)", pass_walltime[1],pass_walltime[1]/elapsed_wall*100);
+		output_profile("  Postsync pass time    %8.3f seconds (%.1f%%)", pass_walltime[2],pass_walltime[2]/elapsed_wall*100);
+		if ( wsp_get_stats()->jobs>0 )
+		{
+			WSPSTATS *ws = wsp_get_stats();
+			output_profile("  Thread pool jobs      %8lld jobs (%d threads)", ws->jobs, ws->n_threads);
+			output_profile("  Thread pool chunks    %8lld chunks (%.1f%% stolen)", ws->chunks, ws->chunks>0 ? (double)ws->steals/ws->chunks*100 : 0);
+		}
+		if ( global_sync_queue!=SQ_NONE && queue_dispatched+queue_skipped>0 )
+			output_profile("  Sync queue skips      %8lld objects (%.1f%% of object iterations)", queue_skipped, (double)queue_skipped/(queue_dispatched+queue_skipped)*100);
+		if ( cache_misses>=0 )
+			output_profile("  Cache misses          %8.1f per object per pass (main thread)", object_get_count()>0&&passes>0 ? (double)cache_misses/object_get_count()/passes : 0);
 		output_profile("Time steps completed    %8d timesteps", tsteps);
 		output_profile("Convergence efficiency  %8.02lf passes/timestep", (double)passes/tsteps);
 #ifndef NOLOCKS
@@ -2433,6 +3678,33 @@ STATUS exec_start(void)
 			output_profile("Postupdate time         %8.1lf s (%.1f%%)", (double)(dp->t_postupdate)/(double)CLOCKS_PER_SEC, (double)(dp->t_postupdate)/total*100);
 			output_profile("Total deltamode runtime %8.1lf s (100%%)", delta_runtime);
 			output_profile("Simulation rate         %8.1lf x realtime", delta_simtime/delta_runtime/1000);
+			if ( dp->n_tasks>0 )
+				output_profile("Parallel update tasks   %8u tasks", dp->n_tasks);
+			if ( dp->n_objects>0 && dp->t_object!=NULL )
+			{
+				/* list the objects with the longest update times */
+				unsigned int top[10], n_top=0, n, m;
+				for ( n=0 ; n<dp->n_objects ; n++ )
+				{
+					if ( dp->t_object[n]<=0 ) 
+						continue;
+					for ( m=n_top ; m>0 && dp->t_object[top[m-1]]<dp->t_object[n] ; m-- )
+						if ( m<sizeof(top)/sizeof(top[0]) ) top[m] = top[m-1];
+					if ( m<sizeof(top)/sizeof(top[0]) )
+					{
+						top[m] = n;
+						if ( n_top<sizeof(top)/sizeof(top[0]) ) n_top++;
+					}
+				}
+				if ( n_top>0 )
+					output_profile("Slowest object updates");
+				for ( m=0 ; m<n_top ; m++ )
+				{
+					char name[64];
+					OBJECT *obj = dp->object[top[m]];
+					output_profile("  %-21.21s %8.3lf ms (%s)", object_name(obj,name,sizeof(name)-1), dp->t_object[top[m]]*1000, obj->oclass->name);
+				}
+			}
 		}
 		output_profile("\n");
 	}
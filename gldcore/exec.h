@@ -35,6 +35,7 @@ STATUS t_setup_ranks(void);
 INDEX **exec_getranks(void);
 void exec_sleep(unsigned int usec);
 int64 exec_clock(void);
+double exec_wallclock(void);
 
 void exec_mls_create(void);
 void exec_mls_init(void);
@@ -54,6 +55,7 @@ int exec_sync_ishard(struct sync_data *d);
 int exec_sync_isnever(struct sync_data *d);
 int exec_sync_isinvalid(struct sync_data *d);
 STATUS exec_sync_getstatus(struct sync_data *d);
+void exec_wake(struct s_object_list *obj);
 
 EXITCODE exec_setexitcode(EXITCODE);
 EXITCODE exec_getexitcode(void);
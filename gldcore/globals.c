@@ -72,7 +72,14 @@ static KEYWORD isc_keys[] = {
 	{"CREATION", IS_CREATION, isc_keys+1},
 	{"DEFERRED", IS_DEFERRED, isc_keys+2},
 	{"BOTTOMUP", IS_BOTTOMUP, isc_keys+3},
-	{"TOPDOWN", IS_TOPDOWN, NULL}
+	{"TOPDOWN", IS_TOPDOWN, isc_keys+4},
+	{"PARALLEL", IS_PARALLEL, NULL}
+};
+
+static KEYWORD sq_keys[] = {
+	{"NONE", SQ_NONE, sq_keys+1},			/**< every object runs on every pass */
+	{"QUEUE", SQ_QUEUE, sq_keys+2},			/**< only objects that are due or woken run */
+	{"VALIDATE", SQ_VALIDATE, NULL},		/**< every object runs and the queue's skips are checked */
 };
 
 static KEYWORD mcf_keys[] = {
@@ -134,10 +141,13 @@ static struct s_varmap {
 	{"workdir", PT_char1024, &global_workdir, PA_REFERENCE, "working directory"},
 	{"dumpfile", PT_char1024, &global_dumpfile, PA_PUBLIC, "dump filename"},
 	{"savefile", PT_char1024, &global_savefile, PA_PUBLIC, "save filename"},
+	{"compilefile", PT_char1024, &global_compilefile, PA_PUBLIC, "compiled model filename"},
 	{"dumpall", PT_bool, &global_dumpall, PA_PUBLIC, "dumpall enable flag"},
 	{"runchecks", PT_bool, &global_runchecks, PA_PUBLIC, "runchecks enable flag"},
 	{"threadcount", PT_int32, &global_threadcount, PA_PUBLIC, "number of threads to use while using multicore"},
+	{"sync_chunksize", PT_int32, &global_sync_chunksize, PA_PUBLIC, "number of objects per thread pool chunk (0 is automatic)"},
 	{"profiler", PT_bool, &global_profiler, PA_PUBLIC, "profiler enable flag"},
+	{"profiler_trace", PT_char1024, &global_profiler_trace, PA_PUBLIC, "profiler event trace filename (Chrome trace JSON)"},
 	{"pauseatexit", PT_bool, &global_pauseatexit, PA_PUBLIC, "pause at exit flag"},
 	{"testoutputfile", PT_char1024, &global_testoutputfile, PA_PUBLIC, "filename for test output"},
 	{"xml_encoding", PT_int32, &global_xml_encoding, PA_PUBLIC, "XML data encoding"},
@@ -163,6 +173,8 @@ static struct s_varmap {
 	{"force_compile", PT_int32, &global_force_compile, PA_PUBLIC, "force recompile enable flag"},
 	{"nolocks", PT_bool, &global_nolocks, PA_PUBLIC, "locking disable flag"},
 	{"skipsafe", PT_bool, &global_skipsafe, PA_PUBLIC, "skip sync safe enable flag"},
+	{"sync_class_batch", PT_bool, &global_sync_class_batch, PA_PUBLIC, "sync class batching enable flag (objects of a rank are grouped by class)"},
+	{"sync_queue", PT_enumeration, &global_sync_queue, PA_PUBLIC, "sync queue mode (QUEUE skips objects whose next event is not due, which is approximate for objects coupled other than by parent and child; VALIDATE reports what QUEUE would miss)", sq_keys},
 	{"dateformat", PT_enumeration, &global_dateformat, PA_PUBLIC, "date format string", df_keys},
 	{"init_sequence", PT_enumeration, &global_init_sequence, PA_PUBLIC, "initialization sequence control flag", isc_keys},
 	{"minimum_timestep", PT_int32, &global_minimum_timestep, PA_PUBLIC, "minimum timestep"},
@@ -191,6 +203,8 @@ static struct s_varmap {
 	{"checkpoint_seqnum", PT_int32, &global_checkpoint_seqnum, PA_PUBLIC, "checkpoint sequence number"},
 	{"checkpoint_interval", PT_int32, &global_checkpoint_interval, PA_PUBLIC, "checkpoint interval"},
 	{"checkpoint_keepall", PT_bool, &global_checkpoint_keepall, PA_PUBLIC, "checkpoint file keep enable flag"},
+	{"checkpoint_background", PT_bool, &global_checkpoint_background, PA_PUBLIC, "checkpoint background write enable flag"},
+	{"checkpoint_incremental", PT_int32, &global_checkpoint_incremental, PA_PUBLIC, "number of incremental checkpoints between full checkpoints"},
 	{"check_version", PT_bool, &global_check_version, PA_PUBLIC, "check version enable flag"},
 	{"random_number_generator", PT_enumeration, &global_randomnumbergenerator, PA_PUBLIC, "random number generator version control flag", rng_keys},
 	{"mainloop_state", PT_enumeration, &global_mainloopstate, PA_PUBLIC, "main sync loop state flag", mls_keys},
@@ -224,6 +238,7 @@ static struct s_varmap {
 	{"delta_current_clock", PT_double, &global_delta_curr_clock, PA_PUBLIC, "Absolute delta time (global clock offset)"},
 	{"deltamode_updateorder", PT_char1024, &global_deltamode_updateorder, PA_REFERENCE, "order in which modules are update in deltamode"},
 	{"deltamode_iteration_limit", PT_int32, &global_deltamode_iteration_limit, PA_PUBLIC, "iteration limit for each delta timestep (object and interupdate)"},
+	{"deltamode_parallel", PT_bool, &global_deltamode_parallel, PA_PUBLIC, "run deltamode object update functions in parallel by rank (requires threadcount>1; module interupdates remain serial)"},
 	{"run_powerworld", PT_bool, &global_run_powerworld, PA_PUBLIC, "boolean that that says your system is set up correctly to run with PowerWorld"},
 	{"bigranks", PT_bool, &global_bigranks, PA_PUBLIC, "enable fast/blind set_rank operations"},
 	{"exename", PT_char1024, &global_execname, PA_REFERENCE, "argv[0] value"},
@@ -87,11 +87,14 @@ GLOBAL unsigned global_iteration_limit INIT(100); /**< The global iteration limi
 GLOBAL char global_workdir[1024] INIT("."); /**< The current working directory */
 GLOBAL char global_dumpfile[1024] INIT("gridlabd.xml"); /**< The dump file name */
 GLOBAL char global_savefile[1024] INIT(""); /**< The save file name */
+GLOBAL char global_compilefile[1024] INIT(""); /**< The compiled model file name (the loaded model is compiled to it instead of being run) */
 GLOBAL int global_dumpall INIT(FALSE);	/**< Flags all modules to dump data after run complete */
 GLOBAL int global_runchecks INIT(FALSE); /**< Flags module check code to be called after initialization */
 /** @todo Set the threadcount to zero to automatically use the maximum system resources (tickets 180) */
 GLOBAL int global_threadcount INIT(1); /**< the maximum thread limit, zero means automagically determine best thread count */
+GLOBAL int global_sync_chunksize INIT(0); /**< the number of objects per thread pool chunk, zero means automatically determined */
 GLOBAL int global_profiler INIT(0); /**< Flags the profiler to process class performance data */
+GLOBAL char1024 global_profiler_trace INIT(""); /**< File to which the profiler writes sync events in Chrome trace format (none if empty) */
 GLOBAL int global_pauseatexit INIT(0); /**< Enable a pause for user input after exit */
 GLOBAL char global_testoutputfile[1024] INIT("test.txt"); /**< Specifies the test output file */
 GLOBAL int global_xml_encoding INIT(8);  /**< Specifies XML encoding (default is 8) */
@@ -131,9 +134,12 @@ GLOBAL int global_force_compile INIT(0); /** flag to force recompile of GLM file
 GLOBAL int global_nolocks INIT(0); /** flag to disable memory locking */
 GLOBAL int global_forbid_multiload INIT(0); /** flag to disable multiple GLM file loads */
 GLOBAL int global_skipsafe INIT(0); /** flag to allow skipping of safe syncs (see OF_SKIPSAFE) */
+typedef enum {SQ_NONE=0, SQ_QUEUE=1, SQ_VALIDATE=2} SYNCQUEUEMODE;
+GLOBAL bool global_sync_class_batch INIT(false); /** flag to sync the objects of each rank grouped by class rather than in rank order */
+GLOBAL int global_sync_queue INIT(SQ_NONE); /** sync queue mode (NONE runs every object on every pass, QUEUE runs only objects that are due or woken, VALIDATE runs every object and checks what QUEUE would skip) */
 typedef enum {DF_ISO=0, DF_US=1, DF_EURO=2} DATEFORMAT;
 GLOBAL int global_dateformat INIT(DF_ISO); /** date format (ISO=0, US=1, EURO=2) */
-typedef enum {IS_CREATION=0, IS_DEFERRED=1, IS_BOTTOMUP=2, IS_TOPDOWN=3} INITSEQ;
+typedef enum {IS_CREATION=0, IS_DEFERRED=1, IS_BOTTOMUP=2, IS_TOPDOWN=3, IS_PARALLEL=4} INITSEQ;
 GLOBAL int global_init_sequence INIT(IS_DEFERRED); /** initialization sequence, default is ordered-by-creation */
 #include "timestamp.h"
 #include "realtime.h"
@@ -207,6 +213,8 @@ GLOBAL char global_checkpoint_file[1024] INIT(""); /**< checkpoint file name is
 GLOBAL int global_checkpoint_seqnum INIT(0); /**< checkpoint sequence file number */
 GLOBAL int global_checkpoint_interval INIT(0); /** checkpoint interval (default is 3600 for CPT_WALL and 86400 for CPT_SIM */
 GLOBAL int global_checkpoint_keepall INIT(0); /** determines whether all checkpoint files are kept, non-zero keeps files, zero delete all but last */
+GLOBAL int global_checkpoint_background INIT(0); /** determines whether checkpoints are saved to disk by a background process while the simulation continues (not available on Windows) */
+GLOBAL int global_checkpoint_incremental INIT(0); /** number of incremental checkpoints written between full checkpoints (0 writes only full checkpoints) */
 
 /* version check */
 GLOBAL int global_check_version INIT(0); /**< check version flag */
@@ -254,6 +262,7 @@ GLOBAL DELTAT global_deltaclock INIT(0); /**< the cumulative delta runtime with
 GLOBAL double global_delta_curr_clock INIT(0.0);	/**< Deltamode clock offset by main clock (not just delta offset) */
 GLOBAL char global_deltamode_updateorder[1025] INIT(""); /**< the order in which modules are updated */
 GLOBAL unsigned int global_deltamode_iteration_limit INIT(10);	/**< Global iteration limit for each delta timestep (object and interupdate calls) */
+GLOBAL int global_deltamode_parallel INIT(FALSE); /**< flag to run deltamode object updates on the thread pool */
 
 /* master/slave */
 GLOBAL char global_master[1024] INIT(""); /**< master hostname */
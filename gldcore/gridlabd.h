@@ -125,6 +125,17 @@ CDECL EXTERN CALLBACKS *callback INIT(NULL);
 #define gl_version_build (*callback->version.build)
 #define gl_version_branch (*callback->version.branch)
 
+/******************************************************************************
+ * Parallel processing on the core thread pool
+ */
+#define gl_parallel_run (*callback->parallel.run) /* size_t (*parallel.run)(void (*call)(unsigned int thread, size_t item, void *data), void *data, size_t n_items, size_t chunksize) */
+#define gl_parallel_threadcount (*callback->parallel.threadcount) /* unsigned int (*parallel.threadcount)(void) */
+
+/******************************************************************************
+ * Sync queue notification
+ */
+#define gl_wake (*callback->wake) /* void (*wake)(OBJECT *obj) */
+
 /******************************************************************************
  * Variable publishing
  */
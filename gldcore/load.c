@@ -169,6 +169,8 @@ typedef struct _stat STAT;
 #define snprintf _snprintf
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 typedef struct stat STAT;
 #define FSTAT fstat
 #endif
@@ -188,6 +190,7 @@ typedef struct stat STAT;
 
 static unsigned int linenum=1;
 static int include_fail = 0;
+static char *uncompilable = NULL; /* last construct loaded that a compiled model cannot reproduce */
 static char filename[1024];
 static time_t modtime = 0;
 static int last_good_depth = -1;
@@ -307,7 +310,6 @@ void inline_code_term(void)
 #define FN_EXPORT		0x1000
 
 /* used for tracking #include directives in files */
-#define BUFFERSIZE (65536*1000)
 typedef struct s_include_list {
 	char file[256];
 	struct s_include_list *next;
@@ -3968,8 +3970,14 @@ MODULE *load_get_current_module(void)
 {
 	return current_module;
 }
+/* returns the last construct loaded that a compiled model cannot reproduce (NULL if none) */
+char *load_get_uncompilable(void)
+{
+	return uncompilable;
+}
 static int object_block(PARSER, OBJECT *parent, OBJECT **obj);
-static int object_properties(PARSER, CLASS *oclass, OBJECT *obj)
+/* parses one property (or nested object) of an object block, more is set when another one may follow */
+static int object_property(PARSER, CLASS *oclass, OBJECT *obj, int *more)
 {
 	PROPERTYNAME propname;
 	char1024 propval;
@@ -4002,6 +4010,7 @@ static int object_properties(PARSER, CLASS *oclass, OBJECT *obj)
 		LOADMETHOD *method = class_get_loadmethod(obj->oclass,propname);
 		if ( method!=NULL )
 		{
+			uncompilable = "loadmethod";
 			if ( TERM(value(HERE,propval,sizeof(propval))) )
 			{
 				if ( method->call(obj,propval)==1 )
@@ -4423,13 +4432,26 @@ static int object_properties(PARSER, CLASS *oclass, OBJECT *obj)
 	else if LITERAL("}") {/* don't accept yet */ DONE;}
 	else { syntax_error(HERE); REJECT; }
 	/* may be repeated */
-	if TERM(object_properties(HERE,oclass,obj))
-	{
-		ACCEPT;
-	}
-	else
+	*more = 1;
+	DONE;
+}
+
+/* parses the properties of an object block one at a time so large blocks do not deepen the stack */
+static int object_properties(PARSER, CLASS *oclass, OBJECT *obj)
+{
+	int more = 1;
+	START;
+	while ( more )
 	{
-		REJECT;
+		more = 0;
+		if TERM(object_property(HERE,oclass,obj,&more))
+		{
+			ACCEPT;
+		}
+		else
+		{
+			REJECT;
+		}
 	}
 	DONE;
 }
@@ -4510,6 +4532,7 @@ static int object_block(PARSER, OBJECT *parent, OBJECT **subobj)
 	if WHITE ACCEPT;
 	if (LITERAL("namespace") && (WHITE,TERM(name(HERE,space,sizeof(space)))) && (WHITE,LITERAL("{")))
 	{
+		uncompilable = "namespace";
 		if (!object_open_namespace(space))
 		{
 			output_error_raw("%s(%d): namespace %s could not be opened", filename, linenum, space);
@@ -5844,17 +5867,17 @@ static int gridlabd_file(PARSER)
 	OR if TERM(class_block(HERE)) {ACCEPT; DONE;}
 	OR if TERM(module_block(HERE)) {ACCEPT; DONE;}
 	OR if TERM(clock_block(HERE)) {ACCEPT; DONE;}
-	OR if TERM(import(HERE)) {ACCEPT; DONE; }
-	OR if TERM(export(HERE)) {ACCEPT; DONE; }
-	OR if TERM(library(HERE)) {ACCEPT; DONE; }
+	OR if TERM(import(HERE)) { uncompilable = "import"; ACCEPT; DONE; }
+	OR if TERM(export(HERE)) { uncompilable = "export"; ACCEPT; DONE; }
+	OR if TERM(library(HERE)) { uncompilable = "library"; ACCEPT; DONE; }
 	OR if TERM(schedule(HERE)) {ACCEPT; DONE; }
-	OR if TERM(instance_block(HERE)) {ACCEPT; DONE; }
-	OR if TERM(gui(HERE)) {ACCEPT; DONE;}
-	OR if TERM(extern_block(HERE)) {ACCEPT; DONE; }
-	OR if TERM(filter_block(HERE)) {ACCEPT; DONE; }
+	OR if TERM(instance_block(HERE)) { uncompilable = "instance"; ACCEPT; DONE; }
+	OR if TERM(gui(HERE)) { uncompilable = "gui"; ACCEPT; DONE; }
+	OR if TERM(extern_block(HERE)) { uncompilable = "extern"; ACCEPT; DONE; }
+	OR if TERM(filter_block(HERE)) { uncompilable = "filter"; ACCEPT; DONE; }
 	OR if TERM(global_declaration(HERE)) {ACCEPT; DONE; }
-	OR if TERM(link_declaration(HERE)) { ACCEPT; DONE; }
-	OR if TERM(script_directive(HERE)) { ACCEPT; DONE; }
+	OR if TERM(link_declaration(HERE)) { uncompilable = "link"; ACCEPT; DONE; }
+	OR if TERM(script_directive(HERE)) { uncompilable = "script"; ACCEPT; DONE; }
 	OR if TERM(modify_directive(HERE)) { ACCEPT; DONE; }
 	OR if (*(HERE)=='\0') {ACCEPT; DONE;}
 	else REJECT;
@@ -5921,103 +5944,141 @@ static int suppress = 0;
 static int nesting = 0;
 static int macro_line[64];
 static int process_macro(char *line, int size, char *filename, int linenum);
-static int buffer_read(FILE *fp, char *buffer, char *filename, int size)
+/* GLM input source - the file is memory mapped when possible and handed out line by line like fgets */
+typedef struct s_glminput {
+	FILE *fp;		/**< file stream (used when the file could not be mapped) */
+	char *data;		/**< mapped file contents */
+	size_t size;	/**< size of the mapped contents */
+	size_t pos;		/**< read position in the mapped contents */
+} GLMINPUT;
+static double load_bytes = 0; /**< bytes read by the GLM loader (for the throughput report) */
+
+static void glminput_close(GLMINPUT *in)
 {
-	char line[65536];
-	int n=0;
-	int linenum=0;
-	int startnest = nesting;
-	while (fgets(line,sizeof(line),fp)!=NULL)
-	{
-		int len;
-		char subst[65536];
-
-		/* comments must have preceding whitespace in macros */
-		char *c = line[0]!='#'?strstr(line,COMMENT):strstr(line, " " COMMENT);
-		linenum++;
-		if (c!=NULL) /* truncate at comment */
-			strcpy(c,"\n");
-		len = (int)strlen(line);
-		if (len>=size-1)
-			return 0;
-
-	
-#ifndef OLDSTYLE
-		/* check for oldstyle file under newstyle parse */
-		if (linenum==1 && strncmp(line,"# ",2)==0)
-		{
-			output_error("%s looks like a version 1.x GLM files, please convert this file to new style before loading", filename);
-			return 0;
-		}
+	if (in==NULL)
+		return;
+#ifndef WIN32
+	if (in->data!=NULL)
+		munmap(in->data,in->size);
 #endif
-		/* expand variables */
-		if ((len=replace_variables(subst,line,sizeof(subst),suppress==0))>=0)
-			strcpy(line,subst);
-		else
-		{
-			output_error_raw("%s(%d): unable to continue", filename,linenum);
-			return -1;
-		}
+	if (in->fp!=NULL)
+		fclose(in->fp);
+	free(in);
+}
 
-		/* expand macros */
-		if (strncmp(line,MACRO,strlen(MACRO))==0)
+static GLMINPUT *glminput_open(char *name, STAT *stat)
+{
+	GLMINPUT *in = (GLMINPUT*)malloc(sizeof(GLMINPUT));
+	if (in==NULL)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+	memset(in,0,sizeof(GLMINPUT));
+#ifndef WIN32
+	{	int fd = open(name,O_RDONLY);
+		if (fd<0)
 		{
-			/* macro disables reading */
-			if (process_macro(line,sizeof(line),filename,linenum)==FALSE)
-				return 0;
-			len = (int)strlen(line);
-			strcat(buffer,line);
-			buffer += len;
-			size -= len;
-			n += len;
+			free(in);
+			return NULL;
 		}
-
-		/* if reading is enabled */
-		else if (suppress==0)
+		if (FSTAT(fd,stat)==0 && stat->st_size>0)
 		{
-			strcpy(buffer,subst);
-			buffer+=len;
-			size -= len;
-			n+=len;
+			void *data = mmap(NULL,(size_t)stat->st_size,PROT_READ,MAP_PRIVATE,fd,0);
+			if (data!=MAP_FAILED)
+			{
+				in->data = (char*)data;
+				in->size = (size_t)stat->st_size;
+#ifdef MADV_SEQUENTIAL
+				madvise(data,in->size,MADV_SEQUENTIAL);
+#endif
+				close(fd);
+				return in;
+			}
 		}
+		close(fd);
 	}
-	if (nesting != startnest)
+#endif
+	/* not mappable (empty, special file, or no mmap) - read it as a stream */
+	in->fp = fopen(name,"rt");
+	if (in->fp==NULL || FSTAT(fileno(in->fp),stat)!=0)
 	{
-		//output_message("%s(%d): missing %sendif for #if at %s(%d)", filename,linenum,MACRO,filename,macro_line[nesting-1]);
-		output_error_raw("%s(%d): Unbalanced %sif/%sendif at %s(%d) ~ started with nestlevel %i, ending %i", filename,linenum,MACRO,MACRO,filename,macro_line[nesting-1], startnest, nesting);
-		return -1;
+		glminput_close(in);
+		return NULL;
 	}
-	return n;
+	return in;
+}
+
+/* reads the next line (at most size-1 characters) from the input, same semantics as fgets */
+static char *glminput_gets(char *line, int size, GLMINPUT *in)
+{
+	size_t len;
+	if (in->data==NULL)
+	{
+		if (fgets(line,size,in->fp)==NULL)
+			return NULL;
+		load_bytes += strlen(line);
+		return line;
+	}
+	if (in->pos>=in->size || size<2)
+		return NULL;
+	else
+	{
+		size_t avail = in->size - in->pos;
+		char *eol = (char*)memchr(in->data+in->pos,'\n',avail<(size_t)size-1?avail:(size_t)size-1);
+		len = eol!=NULL ? (size_t)(eol-(in->data+in->pos))+1 : (avail<(size_t)size-1?avail:(size_t)size-1);
+	}
+	memcpy(line,in->data+in->pos,len);
+	line[len] = '\0';
+	in->pos += len;
+	load_bytes += len;
+	return line;
+}
+
+/* makes room for len more characters (and the terminator) after the first used characters of a block buffer */
+static int block_reserve(char **block, int *size, int used, int len)
+{
+	if (used+len+1>*size)
+	{
+		int newsize = *size>0 ? *size : 20480;
+		char *data;
+		while (used+len+1>newsize)
+			newsize *= 2;
+		data = (char*)realloc(*block,newsize);
+		if (data==NULL)
+			return 0;
+		*block = data;
+		*size = newsize;
+	}
+	return 1;
 }
 
-static int buffer_read_alt(FILE *fp, char *buffer, char *filename, int size)
+/* reads the next complete top-level block (a statement, {...} block, or macro) from the input
+   into the block buffer, which is grown as needed
+   @return the length of the block, 0 at end of input or when reading stops, -1 on error */
+static int buffer_read_alt(GLMINPUT *in, char **block, int *blocksize, char *filename)
 {
-	char line[10240];
-	char *buf = buffer;
+	char line[65536];
 	int n = 0, i = 0;
 	int _linenum=0;
 	int startnest = nesting;
 	int bnest = 0, quote = 0;
 	int hassc = 0; // has semicolon
 	int quoteline = 0;
-	while (fgets(line,sizeof(line),fp)!=NULL)
+	if (!block_reserve(block,blocksize,0,0))
+		return -1;
+	**block = '\0';
+	while (glminput_gets(line,sizeof(line),in)!=NULL)
 	{
 		int len;
 		char subst[65536];
+		char *text = subst;
 
 		/* comments must have preceding whitespace in macros */
 		char *c = line[0]!='#'?strstr(line,COMMENT):strstr(line, " " COMMENT);
 		_linenum++;
 		if (c!=NULL) /* truncate at comment */
 			strcpy(c,"\n");
-		len = (int)strlen(line);
-		if (len>=size-1){
-			output_error("load.c: buffer exhaustion reading %i lines past line %i", _linenum, linenum);
-			if(quote != 0){
-				output_error("look for an unterminated doublequote string on line %i", quoteline);
-			}
-			return 0;
-		}
 	
 #ifndef OLDSTYLE
 		/* check for oldstyle file under newstyle parse */
@@ -6045,21 +6106,13 @@ static int buffer_read_alt(FILE *fp, char *buffer, char *filename, int size)
 			} else {
 				++hassc;
 			}
-			//strcat(buffer,line);
-			strcpy(buffer,line);
-			len = (int)strlen(buffer); // include anything else in the buffer, then advance
-			buffer += len;
-			size -= len;
-			n += len;
+			text = line;
+			len = (int)strlen(line);
 		}
 
 		/* if reading is enabled */
 		else if (suppress==0)
 		{
-			strcpy(buffer,subst);
-			buffer+=len;
-			size -= len;
-			n+=len;
 			for(i = 0; i < len; ++i){
 				if(quote == 0){
 					if(subst[i] == '\"'){
@@ -6082,11 +6135,27 @@ static int buffer_read_alt(FILE *fp, char *buffer, char *filename, int size)
 				}
 			}
 		} else {
-			strcpy(buffer,"\n");
-			buffer+=strlen("\n");
-			size -= 1;
-			n += 1;
+			text = "\n";
+			len = 1;
+		}
+
+		/* append to the block */
+		if (!block_reserve(block,blocksize,n,len))
+		{
+			output_error("%s(%d): unable to grow the load buffer beyond %d bytes", filename, linenum + _linenum - 1, *blocksize);
+			/* TROUBLESHOOT
+				The loader could not allocate enough memory to hold a complete block of the model.
+				Blocks end at the closing brace of each top-level item, so a very large nested object
+				needs that much memory at once.  Check for a missing closing brace or free up memory and try again.
+			 */
+			if(quote != 0){
+				output_error("look for an unterminated doublequote string on line %i", quoteline);
+			}
+			return -1;
 		}
+		memcpy(*block+n,text,len+1);
+		n += len;
+
 		if(bnest == 0 && hassc > 0 && nesting == startnest){ // make sure we read ALL of an #if block, if possible
 			/* end of block */
 			return n;
@@ -6118,8 +6187,9 @@ static int include_file(char *incname, char *buffer, int size, int _linenum)
 	char *name = 0;
 	STAT stat;
 	char ff[1024];
-	FILE *fp = 0;
-	char buffer2[20480];
+	GLMINPUT *in = NULL;
+	char *block = NULL;
+	int blocksize = 0;
 	unsigned int old_linenum = _linenum;
 	/* check include list */
 	INCLUDELIST *list;
@@ -6128,8 +6198,6 @@ static int include_file(char *incname, char *buffer, int size, int _linenum)
 	strcpy(this->file, incname);
 	this->next = include_list;
 
-	buffer2[0]=0;
-	
 	for (list = include_list; list != NULL; list = list->next)
 	{
 		if (strcmp(incname, list->file) == 0 && !global_reinclude )
@@ -6166,9 +6234,9 @@ static int include_file(char *incname, char *buffer, int size, int _linenum)
 	}
 
 	/* open file */
-	fp = find_file(incname,NULL,R_OK,ff,sizeof(ff)) ? fopen(ff, "rt") : NULL;
+	in = find_file(incname,NULL,R_OK,ff,sizeof(ff)) ? glminput_open(ff, &stat) : NULL;
 	
-	if(fp == NULL){
+	if(in == NULL){
 		output_error_raw("%s(%d): include file open failed: %s", incname, _linenum, errno?strerror(errno):"(no details)");
 		return -1;
 	}
@@ -6179,20 +6247,8 @@ static int include_file(char *incname, char *buffer, int size, int _linenum)
 	old_linenum = linenum;
 	linenum = 1;
 
-	if(FSTAT(fileno(fp), &stat) == 0){
-		if(stat.st_mtime > modtime){
-			modtime = stat.st_mtime;
-		}
-
-		//if(size < stat.st_size){
-			/** @todo buffer must grow (ticket #31) */
-			/* buffer = realloc(buffer,size+stat.st_size); */
-		//	output_message("%s(%d): unable to grow size of read buffer to include file", incname, linenum);
-		//	return 0;
-		//}
-	} else {
-		output_error_raw("%s(%d): unable to get size of included file", incname, _linenum);
-		return -1;
+	if(stat.st_mtime > modtime){
+		modtime = stat.st_mtime;
 	}
 
 	output_verbose("%s(%d): included file is %d bytes long", incname, old_linenum, stat.st_size);
@@ -6201,10 +6257,10 @@ static int include_file(char *incname, char *buffer, int size, int _linenum)
 	include_list = this;
 	//count = buffer_read(fp,buffer,incname,size); // fread(buffer,1,stat.st_size,fp);
 
-	move = buffer_read_alt(fp, buffer2, incname, 20479);
+	move = buffer_read_alt(in, &block, &blocksize, incname);
 	while(move > 0){
 		count += move;
-		p = buffer2; // grab a block
+		p = block; // grab a block
 		while(*p != 0){
 			// and process it
 			move = gridlabd_file(p);
@@ -6217,8 +6273,13 @@ static int include_file(char *incname, char *buffer, int size, int _linenum)
 			count = -1;
 			break;
 		}
-		move = buffer_read_alt(fp, buffer2, incname, 20479);
+		move = buffer_read_alt(in, &block, &blocksize, incname);
+	}
+	if(move < 0){
+		count = -1;
 	}
+	free(block);
+	glminput_close(in);
 
 	//include_list = this.next;
 
@@ -6960,123 +7021,39 @@ static int process_macro(char *line, int size, char *_filename, int linenum)
 	return FALSE;
 }
 
-STATUS loadall_glm(char *file) /**< a pointer to the first character in the file name string */
-{
-	OBJECT *obj, *first = object_get_first();
-	char *buffer = NULL, *p = NULL;
-	int fsize = 0;
-	STATUS status=FAILED;
-	STAT stat;
-	char *ext = strrchr(file,'.');
-	FILE *fp;
-	int move=0;
-	errno = 0;
-
-	fp = fopen(file,"rt");
-	if (fp==NULL)
-		goto Failed;
-	if (FSTAT(fileno(fp),&stat)==0)
-	{
-		modtime = stat.st_mtime;
-		fsize = stat.st_size;
-		buffer = malloc(BUFFERSIZE); /* lots of space */
-	}
-	output_verbose("file '%s' is %d bytes long", file,fsize);
-	if (buffer==NULL)
-	{
-		output_error("unable to allocate buffer for file '%s': %s", file, errno?strerror(errno):"(no details)");
-		errno = ENOMEM;
-		goto Done;
-	}
-	else
-		p=buffer;
-
-	buffer[0] = '\0';
-	if (buffer_read(fp,buffer,file,BUFFERSIZE)==0)
-	{
-		fclose(fp);
-		goto Failed;
-	}
-	fclose(fp);
-
-	/* reset line counter for parser */
-	linenum = 1;
-	while (*p!='\0')
-	{
-		move = gridlabd_file(p);
-		if (move==0)
-			break;
-		p+=move;
-	}
-	status = (*p=='\0') ? SUCCESS : FAILED;
-	if (status==FAILED)
-	{
-		char *eol = strchr(p,'\n');
-		if (eol!=NULL)
-			*eol='\0';
-		output_error_raw("%s(%d): load failed at or near '%.12s...'", file, linenum,*p=='\0'?"end of line":p);
-		if (p==0)
-			output_error("%s doesn't appear to be a GLM file", file);
-		goto Failed;
-	}
-	else if ((status=load_resolve_all())==FAILED)
-		goto Failed;
-
-	/* establish ranks */
-	for (obj=first?first:object_get_first(); obj!=NULL; obj=obj->next)
-		object_set_parent(obj,obj->parent);
-	output_verbose("%d object%s loaded", object_get_count(), object_get_count()>1?"s":"");
-	goto Done;
-Failed:
-	if (errno!=0){
-		output_error("unable to load '%s': %s", file, errno?strerror(errno):"(no details)");
-		/*	TROUBLESHOOT
-			In most cases, strerror(errno) will claim "No such file or directory".  This claim should be ignored in
-			favor of prior error messages.
-		*/
-	}
-Done:
-	free(buffer);
-	buffer = NULL;
-	free_index();
-	linenum=1; // parser starts at 1
-	return status;
-}
-
 /**/
 STATUS loadall_glm_roll(char *file) /**< a pointer to the first character in the file name string */
 {
 	OBJECT *obj, *first = object_get_first();
-	//char *buffer = NULL, *p = NULL;
 	char *p = NULL;
-	char buffer[20480];
+	char *block = NULL;
+	int blocksize = 0;
 	int fsize = 0;
 	STATUS status=FAILED;
 	STAT stat;
 	char *ext = strrchr(file,'.');
-	FILE *fp;
+	GLMINPUT *in;
 	int move = 0;
+	double t0 = exec_wallclock();
+	double b0 = load_bytes;
 	errno = 0;
 
-	fp = fopen(file,"rt");
-	if (fp==NULL)
+	in = glminput_open(file,&stat);
+	if (in==NULL)
 		goto Failed;
-	if (FSTAT(fileno(fp),&stat)==0)
-	{
-		modtime = stat.st_mtime;
-		fsize = stat.st_size;
-	}
+	modtime = stat.st_mtime;
+	fsize = stat.st_size;
 	if(fsize <= 1){
 		// empty file short circuit
+		glminput_close(in);
 		return SUCCESS;
 	}
 	output_verbose("file '%s' is %d bytes long", file,fsize);
-	/* removed malloc check since it doesn't malloc any more */
-	buffer[0] = '\0';
 
-	move = buffer_read_alt(fp, buffer, file, 20479);
+	/* read and parse one top-level block at a time */
+	move = buffer_read_alt(in, &block, &blocksize, file);
 	while(move > 0){
-		p = buffer; // grab a block
+		p = block; // grab a block
 		while(*p != 0){
 			// and process it
 			move = gridlabd_file(p);
@@ -7089,11 +7066,11 @@ STATUS loadall_glm_roll(char *file) /**< a pointer to the first character in the
 			status = FAILED;
 			break;
 		}
-		move = buffer_read_alt(fp, buffer, file, 20479);
+		move = buffer_read_alt(in, &block, &blocksize, file);
 	}
 
 	if(p != 0){ /* did the file contain anything? */
-		status = (*p=='\0' && !include_fail) ? SUCCESS : FAILED;
+		status = (*p=='\0' && move>=0 && !include_fail) ? SUCCESS : FAILED;
 	} else {
 		status = FAILED;
 	}
@@ -7113,7 +7090,16 @@ STATUS loadall_glm_roll(char *file) /**< a pointer to the first character in the
 			output_error("%s doesn't appear to be a GLM file", file);
 		goto Failed;
 	}
-	else if ((status=load_resolve_all())==FAILED)
+	else
+	{
+		double dt = exec_wallclock() - t0;
+		double mb = (load_bytes - b0)/1e6;
+		if ( dt>0 )
+			output_verbose("parsed %.3f MB from '%s' and its includes in %.3f s (%.2f MB/s)", mb, file, dt, mb/dt);
+		else
+			output_verbose("parsed %.3f MB from '%s' and its includes", mb, file);
+	}
+	if ((status=load_resolve_all())==FAILED)
 		goto Failed;
 
 	/* establish ranks */
@@ -7130,10 +7116,10 @@ Failed:
 		*/
 	}
 Done:
-	//free(buffer);
+	free(block);
 	free_index();
 	linenum=1; // parser starts at one
-	if (fp!=NULL) fclose(fp);
+	glminput_close(in);
 	return status;
 }
 
@@ -7242,6 +7228,8 @@ STATUS loadall(char *file){
 		else
 			load_status = SUCCESS;
 	}
+	else if (ext!=NULL && strcmp(ext, ".glb")==0)
+		load_status = stream_load_compiled(filename);
 	else if (ext==NULL || strcmp(ext, ".glm")==0)
 		load_status = loadall_glm_roll(filename);
 #ifdef HAVE_XERCES
@@ -68,6 +68,7 @@ UNRESOLVED *add_unresolved(OBJECT *by, PROPERTYTYPE ptype, void *ref, CLASS *ocl
 int load_resolve_all();
 OBJECT *load_get_current_object(void);
 MODULE *load_get_current_module(void);
+char *load_get_uncompilable(void);
 
 #ifdef __cplusplus
 }
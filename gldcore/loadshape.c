@@ -1069,7 +1069,16 @@ int convert_from_loadshape(char *string,int size,void *data, PROPERTY *prop)
 	case MT_UNKNOWN:
 		return sprintf(string,"%s","type: unknown");
 	case MT_ANALOG:
-		if (ls->params.analog.energy>0)
+		if (ls->schedule==NULL) /* allowed with a warning by loadshape_init */
+		{
+			if (ls->params.analog.energy>0)
+				return sprintf(string,"type: analog; energy: %g kWh", ls->params.analog.energy);
+			else if (ls->params.analog.power>0)
+				return sprintf(string,"type: analog; power: %g kW", ls->params.analog.power);
+			else
+				return sprintf(string,"%s","type: analog");
+		}
+		else if (ls->params.analog.energy>0)
 			return sprintf(string,"type: analog; schedule: %s; energy: %g kWh",	ls->schedule->name, ls->params.analog.energy);
 		else if (ls->params.analog.power>0)
 			return sprintf(string,"type: analog; schedule: %s; power: %g kW",	ls->schedule->name, ls->params.analog.power);
@@ -28,11 +28,13 @@
 #include "random.h"
 #include "realtime.h"
 #include "save.h"
+#include "stream.h"
 #include "local.h"
 #include "exec.h"
 #include "kml.h"
 #include "kill.h"
 #include "threadpool.h"
+#include "schedule.h"
 
 #if defined WIN32 && _DEBUG 
 /** Implements a pause on exit capability for Windows consoles
@@ -122,6 +124,23 @@ int main(int argc, /**< the number entries on command-line argument list \p argv
 		exit(XC_ARGERR);
 	}
 
+	/* compile the model instead of running it */
+	if (strcmp(global_compilefile,"")!=0)
+	{
+		if (stream_compile(global_compilefile)==FAILED)
+		{
+			output_fatal("unable to compile the model to '%s'", global_compilefile);
+			/*	TROUBLESHOOT
+				The loaded model could not be written as a compiled model.  This usually
+				follows a more specific message regarding the problem.  Follow the
+				recommendation for the indicated problem, or run the GLM file directly.
+			 */
+			exit(XC_IOERR);
+		}
+		output_verbose("model compiled to '%s'", global_compilefile);
+		exit(exec_getexitcode());
+	}
+
 	/* stitch clock */
 	global_clock = global_starttime;
 
@@ -222,6 +241,9 @@ int main(int argc, /**< the number entries on command-line argument list \p argv
 	schedule_dumpall("schedules.txt");
 #endif
 
+	/* release schedules */
+	schedule_termall();
+
 	/* restore locale */
 	locale_pop();
 
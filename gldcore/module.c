@@ -82,6 +82,7 @@
 #include "exec.h"
 #include "stream.h"
 #include "transform.h"
+#include "threadpool.h"
 
 #include "console.h"
 
@@ -226,6 +227,8 @@ static CALLBACKS callbacks = {
 	{transform_getnext,transform_add_linear,transform_add_external,transform_apply},
 	{randomvar_getnext,randomvar_getspec},
 	{version_major,version_minor,version_patch,version_build,version_branch},
+	{wsp_run,wsp_get_threadcount},
+	exec_wake,
 	MAGIC /* used to check structure */
 };
 CALLBACKS *module_callbacks(void) { return &callbacks; }
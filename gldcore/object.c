@@ -42,6 +42,7 @@
 #include "lock.h"
 #include "threadpool.h"
 #include "exec.h"
+#include "realtime.h"
 
 /* object list */
 static OBJECTNUM next_object_id = 0;
@@ -279,6 +280,71 @@ char *object_get_unit(OBJECT *obj, char *name)
 	}
 }
 
+/* objects are allocated in blocks for each class so that objects of
+   the same class are contiguous in memory in the order they are created */
+#define ARENA_FIRST 16 /* objects in the first block of a class */
+#define ARENA_MAX 4096 /* largest number of objects in a block */
+typedef struct s_object_arena {
+	size_t size; /* bytes per object in the current block */
+	unsigned int n_used; /* objects used in the current block */
+	unsigned int n_alloc; /* objects in the current block */
+	char *block; /* current block (a pointer to the previous block comes first) */
+} OBJECTARENA;
+#define ARENA_HEADER 16 /* keeps objects aligned after the previous block pointer */
+
+/** Allocate zeroed memory for an object of a class
+	@return a pointer to the memory, NULL if none
+ **/
+static OBJECT *object_arena_alloc(CLASS *oclass)
+{
+	OBJECTARENA *arena = oclass->arena;
+	size_t size = (sizeof(OBJECT) + oclass->size + 15) & ~(size_t)15;
+	char *ptr;
+	if ( arena==NULL )
+	{
+		arena = oclass->arena = (OBJECTARENA*)calloc(1,sizeof(OBJECTARENA));
+		if ( arena==NULL )
+			return NULL;
+	}
+
+	/* start a new block when the current one is full or the class size changed */
+	if ( arena->block==NULL || arena->n_used==arena->n_alloc || arena->size!=size )
+	{
+		unsigned int n = arena->n_alloc==0 ? ARENA_FIRST : ( arena->n_alloc<ARENA_MAX ? arena->n_alloc*2 : ARENA_MAX );
+		char *block = (char*)malloc(ARENA_HEADER + n*size);
+		if ( block==NULL )
+			return NULL;
+		*(char**)block = arena->block;
+		arena->block = block;
+		arena->size = size;
+		arena->n_alloc = n;
+		arena->n_used = 0;
+	}
+	ptr = arena->block + ARENA_HEADER + arena->n_used++*size;
+	memset(ptr,0,size);
+	return (OBJECT*)ptr;
+}
+
+/** Release all the objects allocated for a class
+ **/
+static void object_arena_free(CLASS *oclass)
+{
+	OBJECTARENA *arena = oclass->arena;
+	if ( arena!=NULL )
+	{
+		while ( arena->block!=NULL )
+		{
+			char *prev = *(char**)arena->block;
+			free(arena->block);
+			arena->block = prev;
+		}
+		free(arena);
+		oclass->arena = NULL;
+	}
+}
+
+static pthread_mutex_t create_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /** Create a single object.
 	@return a pointer to object header, \p NULL of error, set \p errno as follows:
 	- \p EINVAL type is not valid
@@ -290,7 +356,6 @@ OBJECT *object_create_single(CLASS *oclass){ /**< the class of the object */
 	static int tp_next = 0;
 	static int tp_count = 0;
 	PROPERTY *prop;
-	int sz = sizeof(OBJECT);
 
 	if(tp_count == 0){
 		tp_count = processor_count();
@@ -312,17 +377,18 @@ OBJECT *object_create_single(CLASS *oclass){ /**< the class of the object */
 		*/
 	}
 
-	obj = (OBJECT*)malloc(sz + oclass->size);
+	/* objects may be created by other objects' init calls running concurrently (see init_by_parallel() in exec.c) */
+	pthread_mutex_lock(&create_lock);
+	obj = object_arena_alloc(oclass);
 
 	if(obj == NULL){
+		pthread_mutex_unlock(&create_lock);
 		throw_exception("object_create_single(CLASS *oclass='%s'): memory allocation failed", oclass->name);
 		/* TROUBLESHOOT
 			The system has run out of memory and is unable to create the object requested.  Try freeing up system memory and try again.
 		 */
 	}
 
-	memset(obj, 0, sz + oclass->size);
-
 	tp_next %= tp_count;
 
 	obj->id = next_object_id++;
@@ -357,6 +423,7 @@ OBJECT *object_create_single(CLASS *oclass){ /**< the class of the object */
 	
 	last_object = obj;
 	oclass->profiler.numobjs++;
+	pthread_mutex_unlock(&create_lock);
 	
 	return obj;
 }
@@ -438,6 +505,10 @@ void object_stream_fixup(OBJECT *obj, char *classname, char *objname)
 	else
 		last_object->next = obj;
 	last_object = obj;
+
+	/* keep the object count and id lookup consistent with the restored ids */
+	if ( obj->id>=next_object_id )
+		next_object_id = obj->id+1;
 }
 
 /** Create multiple objects.
@@ -484,8 +555,7 @@ OBJECT *object_remove_by_id(OBJECTNUM id){
 		next = target->next;
 		prev->next = next;
 		target->oclass->profiler.numobjs--;
-		free(target);
-		target = NULL;
+		target = NULL; /* the memory stays in the class arena */
 		deleted_object_count++;
 	}
 	
@@ -804,6 +874,9 @@ int object_set_value_by_addr(OBJECT *obj, /**< the object to alter */
 			output_error("postupdate notify failure on %s in %s", prop->name, obj->name ? obj->name : "an unnamed object");
 		}
 	}
+
+	/* the object must run in the next iteration when the sync queue is used */
+	exec_wake(obj);
 	return result;
 }
 
@@ -1041,6 +1114,7 @@ int object_set_int16_by_name(OBJECT *obj, PROPERTYNAME name, int16 value)
 		return 0;
 	}
 	*(int16 *)((char *)(obj+1)+(int64)(prop->addr)) = value; /* warning: cast from pointer to integer of different size */
+	exec_wake(obj);
 	return 1;
 }
 
@@ -1062,6 +1136,7 @@ int object_set_int32_by_name(OBJECT *obj, PROPERTYNAME name, int32 value)
 		return 0;
 	}
 	*(int32 *)((char *)(obj+1)+(int64)(prop->addr)) = value; /* warning: cast from pointer to integer of different size */
+	exec_wake(obj);
 	return 1;
 }
 
@@ -1083,6 +1158,7 @@ int object_set_int64_by_name(OBJECT *obj, PROPERTYNAME name, int64 value)
 		return 0;
 	}
 	*(int64 *)((char *)(obj+1)+(int64)(prop->addr)) = value; /* warning: cast from pointer to integer of different size */
+	exec_wake(obj);
 	return 1;
 }
 
@@ -1104,6 +1180,7 @@ int object_set_double_by_name(OBJECT *obj, PROPERTYNAME name, double value)
 		return 0;
 	}
 	*(double*)((char *)(obj+1)+(int64)(prop->addr)) = value; /* warning: cast from pointer to integer of different size */
+	exec_wake(obj);
 	return 1;
 }
 
@@ -1125,6 +1202,7 @@ int object_set_complex_by_name(OBJECT *obj, PROPERTYNAME name, complex value)
 		return 0;
 	}
 	*(complex*)((char *)(obj+1)+(int64)(prop->addr)) = value; /* warning: cast from pointer to integer of different size */
+	exec_wake(obj);
 	return 1;
 }
 
@@ -1256,6 +1334,7 @@ static int _set_rank(OBJECT *obj, OBJECTRANK rank, OBJECT *first)
 /* this version is fast, blind to errors, and not recursive -- it's only used when global_fastrank is TRUE */
 static int _set_rankx(OBJECT *obj, OBJECTRANK rank, OBJECT *first)
 {
+	OBJECT *target = obj;
 	int n = object_get_count();
 	if ( obj == NULL )
 	{
@@ -1299,10 +1378,17 @@ static int _set_rankx(OBJECT *obj, OBJECTRANK rank, OBJECT *first)
 	}
 	for ( obj=first ; obj!=NULL ; obj=obj->parent )
 		obj->flags &= ~OF_RERANK;
+	return target->rank;
 }
+/* ranks may be changed by objects initialized concurrently (see init_by_parallel() in exec.c) */
+static pthread_mutex_t rank_lock = PTHREAD_MUTEX_INITIALIZER;
 static int set_rank(OBJECT *obj, OBJECTRANK rank, OBJECT *first)
 {
-	global_bigranks==TRUE ? _set_rankx(obj,rank,NULL) : _set_rank(obj,rank,NULL);
+	int rv;
+	pthread_mutex_lock(&rank_lock);
+	rv = global_bigranks==TRUE ? _set_rankx(obj,rank,NULL) : _set_rank(obj,rank,NULL);
+	pthread_mutex_unlock(&rank_lock);
+	return rv;
 }
 
 /** Set the rank of an object but forcing it's parent
@@ -1396,19 +1482,112 @@ char *object_property_to_string(OBJECT *obj, char *name, char *buffer, int sz)
 		return "";
 }
 
+/* class profile counters of one thread, which are merged into the
+   class profilers by object_profile_merge() so threads never share them */
+typedef struct s_profilecounters {
+	unsigned int n_class; /* number of classes the arrays can hold */
+	int64 *clocks; /* clocks used by each class (indexed by class id) */
+	int32 *count; /* number of calls to each class */
+	struct s_profilecounters *next; /* counters of the other threads */
+} PROFILECOUNTERS;
+static PROFILECOUNTERS *profile_counters = NULL;
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t profile_key;
+static pthread_once_t profile_once = PTHREAD_ONCE_INIT;
+
+static void profile_init(void)
+{
+	/* counters outlive their thread so they can be merged after the pool stops */
+	pthread_key_create(&profile_key,NULL);
+}
+
+/** Get the class profile counters of the calling thread
+	@return the counters, or NULL if none could be allocated
+ **/
+static PROFILECOUNTERS *profile_get_counters(CLASS *oclass)
+{
+	PROFILECOUNTERS *pc;
+	pthread_once(&profile_once,profile_init);
+	pc = (PROFILECOUNTERS*)pthread_getspecific(profile_key);
+	if ( pc==NULL )
+	{
+		pc = (PROFILECOUNTERS*)calloc(1,sizeof(PROFILECOUNTERS));
+		if ( pc==NULL || pthread_setspecific(profile_key,pc)!=0 )
+		{
+			free(pc);
+			return NULL;
+		}
+		pthread_mutex_lock(&profile_lock);
+		pc->next = profile_counters;
+		profile_counters = pc;
+		pthread_mutex_unlock(&profile_lock);
+	}
+	if ( (unsigned int)oclass->id>=pc->n_class )
+	{
+		/* classes may be registered at any time, so grow to the current count */
+		unsigned int n = class_get_count();
+		int64 *clocks;
+		int32 *count;
+		if ( n<=(unsigned int)oclass->id ) n = oclass->id+1;
+		pthread_mutex_lock(&profile_lock); /* merge may be reading the arrays */
+		clocks = (int64*)realloc(pc->clocks,sizeof(int64)*n);
+		count = clocks==NULL ? NULL : (int32*)realloc(pc->count,sizeof(int32)*n);
+		if ( count!=NULL )
+		{
+			memset(clocks+pc->n_class,0,sizeof(int64)*(n-pc->n_class));
+			memset(count+pc->n_class,0,sizeof(int32)*(n-pc->n_class));
+			pc->count = count;
+			pc->n_class = n;
+		}
+		if ( clocks!=NULL )
+			pc->clocks = clocks;
+		pthread_mutex_unlock(&profile_lock);
+		if ( (unsigned int)oclass->id>=pc->n_class )
+			return NULL;
+	}
+	return pc;
+}
+
 void object_profile(OBJECT *obj, OBJECTPROFILEITEM pass, clock_t t)
 {
 	if ( global_profiler==1 )
 	{
 		clock_t dt = (clock_t)exec_clock()-t;
+		PROFILECOUNTERS *pc = profile_get_counters(obj->oclass);
 		obj->synctime[pass] += dt;
-		wlock(&obj->oclass->profiler.lock);
-		obj->oclass->profiler.count++;
-		obj->oclass->profiler.clocks += dt;
-		wunlock(&obj->oclass->profiler.lock);
+		if ( pc!=NULL )
+		{
+			pc->count[obj->oclass->id]++;
+			pc->clocks[obj->oclass->id] += dt;
+		}
 	}
 }
 
+/** Merge the class profile counters of all threads into the class profilers.
+	This must be called when no objects are being profiled, e.g., before
+	the profiler results are reported.
+ **/
+void object_profile_merge(void)
+{
+	PROFILECOUNTERS *pc;
+	pthread_mutex_lock(&profile_lock);
+	for ( pc=profile_counters; pc!=NULL; pc=pc->next )
+	{
+		CLASS *oclass;
+		for ( oclass=class_get_first_class(); oclass!=NULL; oclass=oclass->next )
+		{
+			if ( (unsigned int)oclass->id<pc->n_class )
+			{
+				oclass->profiler.clocks += pc->clocks[oclass->id];
+				oclass->profiler.count += pc->count[oclass->id];
+				pc->clocks[oclass->id] = 0;
+				pc->count[oclass->id] = 0;
+			}
+		}
+	}
+	pthread_mutex_unlock(&profile_lock);
+}
+
 TIMESTAMP _object_sync(OBJECT *obj, /**< the object to synchronize */
 					  TIMESTAMP ts, /**< the desire clock to sync to */
 					  PASSCONFIG pass) /**< the pass configuration */
@@ -1441,10 +1620,8 @@ TIMESTAMP _object_sync(OBJECT *obj, /**< the object to synchronize */
 		return TS_INVALID;
 	}
 
-#ifndef WIN32
-	/* setup lockup alarm */
-	alarm(global_maximum_synctime);
-#endif
+	/* setup lockup watchdog */
+	realtime_sync_begin(obj);
 
 	/* call recalc if recalc bit is set */
 	if( (obj->flags&OF_RECALC) && obj->oclass->recalc!=NULL)
@@ -1476,10 +1653,8 @@ TIMESTAMP _object_sync(OBJECT *obj, /**< the object to synchronize */
 	else
 		obj->valid_to = sync_time; // NOTE, this can be negative
 
-#ifndef WIN32
-	/* clear lockup alarm */
-	alarm(0);
-#endif
+	/* clear lockup watchdog */
+	realtime_sync_end();
 
 	return obj->valid_to;
 }
@@ -2103,6 +2278,7 @@ typedef struct s_objecttree {
 	OBJECT *obj;
 	struct s_objecttree *before, *after;
 	int balance; /* unused */
+	int height; /* height of the subtree rooted here */
 } OBJECTTREE;
 
 static OBJECTTREE *top=NULL;
@@ -2125,15 +2301,15 @@ void debug_traverse_tree(OBJECTTREE *tree){
 
 /* returns the height of the tree */
 int tree_get_height(OBJECTTREE *tree){
-	if(tree == NULL){
-		return 0;
-	} else {
-		int left = tree_get_height(tree->before);
-		int right = tree_get_height(tree->after);
-		if(left > right)
-			return left+1;
-		else return right+1;
-	}
+	return tree==NULL ? 0 : tree->height;
+}
+
+/* updates the cached height and balance of a node from its children */
+static void tree_update_height(OBJECTTREE *tree){
+	int left = tree_get_height(tree->before);
+	int right = tree_get_height(tree->after);
+	tree->height = (left > right ? left : right) + 1;
+	tree->balance = right - left;
 }
 
 /* returns the node to point to instead of tree */
@@ -2145,8 +2321,8 @@ void rotate_tree_right(OBJECTTREE **tree){ /* move one object from left to right
 	*tree = pivot;
 	pivot->after = root;
 	root->before = child;
-	root->balance += 2;
-	pivot->balance += 1;
+	tree_update_height(root);
+	tree_update_height(pivot);
 }
 
 /* returns the node to point to instead of tree */
@@ -2158,8 +2334,8 @@ void rotate_tree_left(OBJECTTREE **tree){ /* move one object from right to left
 	*tree = pivot;
 	pivot->before = root;
 	root->after = child;
-	root->balance -= 2;
-	pivot->balance -= 1;
+	tree_update_height(root);
+	tree_update_height(pivot);
 }
 
 /*  Rebalance the tree to make searching more efficient
@@ -2176,7 +2352,7 @@ int object_tree_rebalance(OBJECTTREE *tree) /* AVL logic */
  */
 static int addto_tree(OBJECTTREE **tree, OBJECTTREE *item){
 	int rel = strcmp((*tree)->name, item->name);
-	int right = 0, left = 0, ir = 0, il = 0, rv = 0, height = 0;
+	int ir = 0, il = 0, rv = 0, height = 0;
 
 	// find location to insert new object
 	if(rel > 0){
@@ -2185,6 +2361,7 @@ static int addto_tree(OBJECTTREE **tree, OBJECTTREE *item){
 		} else {
 			rv = addto_tree(&((*tree)->before), item);
 			if(global_no_balance){
+				tree_update_height(*tree);
 				return rv + 1;
 			}
 		}
@@ -2194,6 +2371,7 @@ static int addto_tree(OBJECTTREE **tree, OBJECTTREE *item){
 		} else {
 			rv = addto_tree(&((*tree)->after),item);
 			if(global_no_balance){
+				tree_update_height(*tree);
 				return rv + 1;
 			}
 		}
@@ -2202,9 +2380,7 @@ static int addto_tree(OBJECTTREE **tree, OBJECTTREE *item){
 	}
 
 	// check balance
-	right = tree_get_height((*tree)->after);
-	left = tree_get_height((*tree)->before);
-	(*tree)->balance = right - left;
+	tree_update_height(*tree);
 
 	// rotations needed?
 	if((*tree)->balance > 1){
@@ -2237,6 +2413,7 @@ static OBJECTTREE *object_tree_add(OBJECT *obj, OBJECTNAME name){
 	
 	item->obj = obj;
 	item->balance = 0;
+	item->height = 1;
 	strncpy(item->name, name, sizeof(item->name));
 	item->before = item->after = NULL;
 
@@ -2254,35 +2431,18 @@ static OBJECTTREE *object_tree_add(OBJECT *obj, OBJECTNAME name){
 
 /*	Finds a name in the tree
  */
-static OBJECTTREE **findin_tree(OBJECTTREE *tree, OBJECTNAME name)
+static OBJECTTREE **findin_tree(OBJECTTREE **tree, OBJECTNAME name)
 {
-	static OBJECTTREE **temptree = NULL;
-	if(tree == NULL){
+	if(*tree == NULL){
 		return NULL;
 	} else {
-		int rel = strcmp(tree->name, name);
+		int rel = strcmp((*tree)->name, name);
 		if(rel > 0){
-			if(tree->before != NULL){
-				if(strcmp(tree->before->name, name) == 0){
-					return &(tree->before);
-				} else {
-					return findin_tree(tree->before, name);
-				}
-			} else {
-				return NULL;
-			}
+			return findin_tree(&((*tree)->before), name);
 		} else if(rel<0) {
-			if(tree->after != NULL){
-				if(strcmp(tree->after->name, name) == 0){
-					return &(tree->after);
-				} else {
-					return findin_tree(tree->after, name);
-				}
-			} else {
-				return NULL;
-			}
+			return findin_tree(&((*tree)->after), name);
 		} else {
-			return (temptree = &tree);
+			return tree;
 		}
 	}
 }
@@ -2292,7 +2452,7 @@ static OBJECTTREE **findin_tree(OBJECTTREE *tree, OBJECTNAME name)
  */
 void object_tree_delete(OBJECT *obj, OBJECTNAME name)
 {
-	OBJECTTREE **item = findin_tree(top,name);
+	OBJECTTREE **item = findin_tree(&top,name);
 	OBJECTTREE *temp = NULL, **dtemp = NULL;
 
 	if(item != NULL && strcmp((*item)->name, name)!=0){
@@ -2338,7 +2498,7 @@ void object_tree_delete(OBJECT *obj, OBJECTNAME name)
 OBJECT *object_find_name(OBJECTNAME name){
 	OBJECTTREE **item = NULL;
 
-	item = findin_tree(top, name);
+	item = findin_tree(&top, name);
 	
 	if(item != NULL && *item != NULL){
 		return (*item)->obj;
@@ -2430,13 +2590,16 @@ OBJECTNAME object_set_name(OBJECT *obj, OBJECTNAME name){
 void remove_objects(){ 
 	OBJECT* obj1;
 
+	CLASS *oclass;
+
 	obj1 = first_object;
 	while(obj1 != NULL){
 		first_object = obj1->next;
 		obj1->oclass->profiler.numobjs--;
-		free(obj1);
 		obj1 = first_object;
 	}
+	for ( oclass=class_get_first_class() ; oclass!=NULL ; oclass=oclass->next )
+		object_arena_free(oclass);
 
 	next_object_id = 0;
 }
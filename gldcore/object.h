@@ -324,6 +324,11 @@ typedef struct s_callbacks {
 		unsigned int (*build)(void);
 		const char * (*branch)(void);
 	} version;
+	struct {
+		size_t (*run)(void (*call)(unsigned int thread, size_t item, void *data), void *data, size_t n_items, size_t chunksize); /**< run a job on the core thread pool (see wsp_run) */
+		unsigned int (*threadcount)(void); /**< number of threads in the core thread pool */
+	} parallel;
+	void (*wake)(OBJECT *obj); /**< run an object in the next iteration when the sync queue is used (see exec_wake) */
 	long unsigned int magic; /* used to check structure alignment */
 } CALLBACKS; /**< core callback function table */
 
@@ -432,6 +437,7 @@ void object_remote_write(void *local, OBJECT *obj, PROPERTY *prop); /** access r
 
 double object_get_part(void *x, char *name);
 TIMESTAMP object_heartbeat(OBJECT *obj);
+void object_profile_merge(void);
 
 int object_loadmethod(OBJECT *obj, char *name, char *value);
 
@@ -5,7 +5,18 @@
 
 #include <stdlib.h>
 #include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#ifdef WIN32
+#include <windows.h>
+#define THREADLOCAL __declspec(thread)
+#else
+#include <unistd.h>
+#define THREADLOCAL __thread
+#endif
 #include "realtime.h"
+#include "object.h"
+#include "output.h"
 
 time_t realtime_now(void)
 {
@@ -76,3 +87,116 @@ STATUS realtime_run_schedule(void)
 	}
 	return SUCCESS;
 }
+
+/****************************************************************
+ * Sync lockup watchdog
+ *
+ * Each thread that calls object syncs gets a heartbeat slot. The
+ * slot records the object being synced and the watchdog tick at
+ * which the sync started.  A single watchdog thread advances the 
+ * tick once a second and reports a lockup when any slot has been 
+ * busy for more than global_maximum_synctime seconds.  This costs
+ * no system calls per sync and watches every sync thread, which a
+ * process-wide alarm() cannot do.
+ ****************************************************************/
+
+#define MAXWATCHSLOTS 256 /* maximum number of threads watched */
+typedef struct s_watchslot {
+	OBJECT * volatile obj; /* object being synced (NULL when idle) */
+	volatile unsigned int start; /* tick at which the sync started */
+} WATCHSLOT;
+static WATCHSLOT watch_slot[MAXWATCHSLOTS];
+static volatile unsigned int watch_tick = 0; /* seconds since the watchdog started */
+static volatile int watch_running = 0;
+static unsigned int watch_count = 0; /* number of slots assigned */
+static pthread_mutex_t watch_lock = PTHREAD_MUTEX_INITIALIZER;
+static THREADLOCAL int watch_id = -1; /* slot of this thread (-2 if none available) */
+static THREADLOCAL unsigned int watch_depth = 0; /* nesting depth of syncs on this thread */
+
+static void *realtime_watchdog(void *arg)
+{
+	while ( 1 )
+	{
+		unsigned int n;
+#ifdef WIN32
+		Sleep(1000);
+#else
+		sleep(1);
+#endif
+		watch_tick++;
+		if ( global_maximum_synctime<=0 )
+			continue;
+		for ( n=0 ; n<watch_count ; n++ )
+		{
+			OBJECT *obj = watch_slot[n].obj;
+			if ( obj!=NULL && watch_tick-watch_slot[n].start>(unsigned int)global_maximum_synctime )
+			{
+				char name[64];
+				output_fatal("sync lockup: object '%s' did not complete its sync within %d seconds (thread %d)", 
+					object_name(obj,name,sizeof(name)-1), global_maximum_synctime, n);
+				/*	TROUBLESHOOT
+					An object sync call did not return within the time allowed by the
+					global maximum_synctime.  This usually means that the object is stuck
+					in an infinite loop or a deadlock.  If the object legitimately requires
+					more time, increase the value of maximum_synctime (0 disables the check).
+				 */
+#ifdef WIN32
+				exit(XC_PRCERR);
+#else
+				raise(SIGALRM);
+#endif
+			}
+		}
+	}
+	return NULL;
+}
+
+/* get the watchdog slot of the calling thread, starting the watchdog if needed */
+static int realtime_watch_slot(void)
+{
+	pthread_mutex_lock(&watch_lock);
+	if ( !watch_running )
+	{
+		pthread_t pid;
+		if ( pthread_create(&pid,NULL,realtime_watchdog,NULL)==0 )
+		{
+			pthread_detach(pid);
+			watch_running = 1;
+		}
+		else
+		{
+			output_warning("unable to start sync lockup watchdog; maximum_synctime will not be enforced");
+			/* TROUBLESHOOT
+				The thread that checks for sync lockups could not be created.  The
+				simulation will continue but object syncs that never return will not
+				be detected.  Free up system resources and try again.
+			 */
+		}
+	}
+	if ( watch_count<MAXWATCHSLOTS )
+		watch_id = watch_count++;
+	else
+		watch_id = -2;
+	pthread_mutex_unlock(&watch_lock);
+	return watch_id;
+}
+
+/** Notify the watchdog that the calling thread is starting an object sync **/
+void realtime_sync_begin(OBJECT *obj)
+{
+	int id = watch_id;
+	if ( id==-1 )
+		id = realtime_watch_slot();
+	if ( id>=0 && watch_depth++==0 ) /* nested syncs are timed by the outermost one */
+	{
+		watch_slot[id].start = watch_tick;
+		watch_slot[id].obj = obj;
+	}
+}
+
+/** Notify the watchdog that the calling thread completed its object sync **/
+void realtime_sync_end(void)
+{
+	if ( watch_id>=0 && --watch_depth==0 )
+		watch_slot[watch_id].obj = NULL;
+}
@@ -14,4 +14,7 @@ time_t realtime_runtime(void);
 STATUS realtime_schedule_event(time_t, STATUS (*callback)(void));
 STATUS realtime_run_schedule(void);
 
+void realtime_sync_begin(struct s_object_list *obj);
+void realtime_sync_end(void);
+
 #endif
@@ -504,6 +504,8 @@ typedef unsigned long PASSCONFIG; /**< the pass configuration */
 #define PC_PARENT_OVERRIDE_OMIT 0x40	/**< used to ignore parent's use of PC_UNSAFE_OVERRIDE_OMIT */
 #define PC_UNSAFE_OVERRIDE_OMIT 0x80	/**< used to flag that omitting overrides is unsafe */
 #define PC_ABSTRACTONLY 0x100 /**< used to flag that the class should never be instantiated itself, only inherited classes should */
+#define PC_NONREENTRANT 0x800 /**< used to flag that deltamode updates of the class's objects (including those of inheriting classes) must not run concurrently with other non-reentrant updates in the same module */
+#define PC_UNSAFE_INIT 0x1000 /**< used to flag that the init calls of the class's objects (including those of inheriting classes) must not run concurrently with other unsafe init calls in the same module */
 
 #ifndef FALSE
 #define FALSE (0)
@@ -669,6 +671,7 @@ struct s_class_list {
 	bool has_runtime;	///< flag indicating that a runtime dll, so, or dylib is in use
 	char runtime[1024]; ///< name of file containing runtime dll, so, or dylib
 	CLASS *next;
+	struct s_property_index *pindex; ///< property name index (core use only)
 };
 
 typedef char FULLNAME[1024]; /** Full object name (including space name) */
@@ -752,13 +755,29 @@ typedef struct s_datetime { ///< The s_datetime structure
 	int tzoffset; /**< time zone offset in seconds (-43200 - 43200) */
 } DATETIME; ///< A typedef for struct s_datetime
 
+typedef struct s_schedulerun {
+	unsigned short start;	/**< the first minute of the run (minute of day) */
+	unsigned short vend;	/**< the minute of day at which the value next changes (1440 if it does not change before midnight) */
+	unsigned char index;	/**< the value index used during the run */
+} SCHEDULERUN;
+
+typedef struct s_scheduleday {
+	unsigned int first;		/**< the first run of the profile in the run list */
+	unsigned int nruns;		/**< the number of runs in the profile */
+} SCHEDULEDAY;
+
 struct s_schedule {
 	char name[64];						/**< the name of the schedule */
-	char definition[65536];				/**< the definition string of the schedule */
+	char *definition;					/**< the definition string of the schedule */
 	char blockname[MAXBLOCKS][64];		/**< the name of each block */
 	unsigned char block;				/**< the last block used (4 max) */
-	unsigned char index[14][366*24*60];	/**< the schedule index (enough room for all 14 annual calendars to 1 minute resolution) */
-	uint32 dtnext[14][366*24*60];/**< the time until the next schedule change (in minutes) */
+	unsigned short day[14][366];		/**< the daily profile used on each day of all 14 annual calendars */
+	uint32 dayvend[14][366];			/**< the minute of year at which the value last used on each day next changes */
+	SCHEDULEDAY *profile;				/**< the list of distinct daily profiles */
+	unsigned int nprofiles;				/**< the number of distinct daily profiles */
+	SCHEDULERUN *run;					/**< the runs of all the daily profiles (to 1 minute resolution) */
+	unsigned int nruns;					/**< the number of runs in all the daily profiles */
+	int invariant;						/**< flag indicating the schedule never changes value (dtnext is always 0) */
 	double data[MAXBLOCKS*MAXVALUES];	/**< the list of values used in each block */
 	unsigned int weight[MAXBLOCKS*MAXVALUES];	/**< the weight (in minutes) associate with each value */
 	double sum[MAXBLOCKS];				/**< the sum of values for each block -- used to normalize */
@@ -175,11 +175,11 @@ int find_value_index (SCHEDULE *sch, /// schedule to search
 	return -1;
 }
 
-/* compiles a single schedule block and report errors
+/* compiles a single schedule block into the index table and report errors
    returns 1 on success, 0 on failure 
  */
 
-int schedule_compile_block(SCHEDULE *sch, char *blockname, char *blockdef)
+int schedule_compile_block(SCHEDULE *sch, unsigned char (*index)[SCHEDULE_MINUTES], char *blockname, char *blockdef)
 {
 	char *token = NULL;
 	unsigned int minute=0;
@@ -315,10 +315,10 @@ int schedule_compile_block(SCHEDULE *sch, char *blockname, char *blockdef)
 						{
 							if (matcher[0].table[minute%60])
 							{
-								if (sch->index[calendar][minute]>0)
+								if (index[calendar][minute]>0)
 								{
 									char *dayofweek[] = {"Sun","Mon","Tue","Wed","Thu","Fri","Sat","Sun","Hol"};
-									output_error("schedule_compile(SCHEDULE *sch={name='%s', ...}) '%s' in block '%s' has a conflict with value %g on %s %d/%d %02d:%02d", sch->name, token, blockname, sch->data[sch->index[calendar][minute]], dayofweek[weekday], month+1, day+1, hour, minute%60);
+									output_error("schedule_compile(SCHEDULE *sch={name='%s', ...}) '%s' in block '%s' has a conflict with value %g on %s %d/%d %02d:%02d", sch->name, token, blockname, sch->data[index[calendar][minute]], dayofweek[weekday], month+1, day+1, hour, minute%60);
 									/* TROUBLESHOOT
 									   The schedule definition is not valid and has been ignored.  Check the syntax of your schedule and try again.
 									 */
@@ -327,7 +327,7 @@ int schedule_compile_block(SCHEDULE *sch, char *blockname, char *blockdef)
 								else
 								{
 									/* associate this time with the current value */
-									sch->index[calendar][minute] = n;
+									index[calendar][minute] = n;
 									sch->weight[n]++;
 									sch->minutes[sch->block]++;
 
@@ -344,13 +344,13 @@ int schedule_compile_block(SCHEDULE *sch, char *blockname, char *blockdef)
 	return 1;
 }
 
-/* compiles a multi-block schedule and report errors
+/* compiles a multi-block schedule into the index table and report errors
    returns 1 on success, 0 on failure 
  */
-int schedule_compile(SCHEDULE *sch)
+int schedule_compile(SCHEDULE *sch, unsigned char (*index)[SCHEDULE_MINUTES])
 {
 	char *p = sch->definition, *q = NULL;
-	char blockdef[65536];
+	char blockdef[MAXDEFINITION];
 	char blockname[64];
 	enum {INIT, NAME, OPEN, BLOCK, CLOSE} state = INIT;
 	int comment=0;
@@ -362,7 +362,7 @@ int schedule_compile(SCHEDULE *sch)
 		/* remove leading whitespace */
 		while (isspace(*p)) p++;
 		strcpy(blockdef,p);
-		if (schedule_compile_block(sch,"*",blockdef))
+		if (schedule_compile_block(sch,index,"*",blockdef))
 		{
 			sch->block++;
 			return 1;
@@ -484,7 +484,7 @@ int schedule_compile(SCHEDULE *sch)
 				state = CLOSE;
 				q = NULL;
 				p++;
-				if (schedule_compile_block(sch,blockname,blockdef))
+				if (schedule_compile_block(sch,index,blockname,blockdef))
 					sch->block++;
 				else
 					return 0;
@@ -513,6 +513,175 @@ int schedule_compile(SCHEDULE *sch)
 	return 1;
 }
 
+/* converts the index table of a compiled schedule into distinct daily profiles of runs of minutes 
+   that use the same value index
+   returns 1 on success, 0 on failure
+ */
+/* releases the daily profiles and runs of a schedule */
+static void schedule_free_profiles(SCHEDULE *sch)
+{
+	free(sch->profile);
+	free(sch->run);
+	sch->profile = NULL;
+	sch->run = NULL;
+	sch->nprofiles = sch->nruns = 0;
+}
+
+int schedule_encode(SCHEDULE *sch, unsigned char (*index)[SCHEDULE_MINUTES])
+{
+	unsigned int calendar, day, t, n;
+	unsigned int max_profiles = 64, max_runs = 1024;
+	unsigned int *hash = NULL;
+	SCHEDULERUN run[24*60];
+
+	sch->nprofiles = sch->nruns = 0;
+	sch->profile = (SCHEDULEDAY*)malloc(sizeof(SCHEDULEDAY)*max_profiles);
+	sch->run = (SCHEDULERUN*)malloc(sizeof(SCHEDULERUN)*max_runs);
+	hash = (unsigned int*)malloc(sizeof(unsigned int)*max_profiles);
+	if (sch->profile==NULL || sch->run==NULL || hash==NULL)
+		goto Failed;
+
+	/* find the distinct daily profiles */
+	for (calendar=0; calendar<14; calendar++)
+	{
+		for (day=0; day<366; day++)
+		{
+			unsigned char *table = index[calendar] + day*24*60;
+			unsigned int h = 0, p;
+			int r;
+
+			/* collect the runs for this day */
+			for (t=0, n=0; t<24*60; t++)
+			{
+				if (t==0 || table[t]!=table[t-1])
+				{
+					run[n].start = t;
+					run[n].index = table[t];
+					h = h*31 + t*257 + table[t];
+					n++;
+				}
+			}
+
+			/* scan backwards to find where each value actually changes (different indexes can have the same value) */
+			run[n-1].vend = 24*60;
+			for (r=n-2; r>=0; r--)
+				run[r].vend = (sch->data[run[r].index]==sch->data[run[r+1].index]) ? run[r+1].vend : run[r+1].start;
+
+			/* use an existing profile if there is one */
+			for (p=0; p<sch->nprofiles; p++)
+			{
+				if (hash[p]==h && sch->profile[p].nruns==n)
+				{
+					SCHEDULERUN *other = sch->run + sch->profile[p].first;
+					for (t=0; t<n; t++)
+					{
+						if (other[t].start!=run[t].start || other[t].index!=run[t].index)
+							break;
+					}
+					if (t==n)
+						break;
+				}
+			}
+			if (p==sch->nprofiles)
+			{
+				/* add a new profile */
+				if (sch->nprofiles==max_profiles)
+				{
+					void *ptr;
+					max_profiles *= 2;
+					if ((ptr=realloc(sch->profile,sizeof(SCHEDULEDAY)*max_profiles))==NULL) goto Failed;
+					sch->profile = (SCHEDULEDAY*)ptr;
+					if ((ptr=realloc(hash,sizeof(unsigned int)*max_profiles))==NULL) goto Failed;
+					hash = (unsigned int*)ptr;
+				}
+				while (sch->nruns+n>max_runs)
+				{
+					void *ptr;
+					max_runs *= 2;
+					if ((ptr=realloc(sch->run,sizeof(SCHEDULERUN)*max_runs))==NULL) goto Failed;
+					sch->run = (SCHEDULERUN*)ptr;
+				}
+				memcpy(sch->run+sch->nruns,run,sizeof(SCHEDULERUN)*n);
+				sch->profile[p].first = sch->nruns;
+				sch->profile[p].nruns = n;
+				hash[p] = h;
+				sch->nruns += n;
+				sch->nprofiles++;
+			}
+			sch->day[calendar][day] = p;
+		}
+	}
+	free(hash);
+	hash = NULL;
+
+	/* trim the lists to size */
+	sch->profile = (SCHEDULEDAY*)realloc(sch->profile,sizeof(SCHEDULEDAY)*sch->nprofiles);
+	sch->run = (SCHEDULERUN*)realloc(sch->run,sizeof(SCHEDULERUN)*sch->nruns);
+
+	/* scan backwards through the days to find where the value at the end of each day next changes */
+	sch->invariant = 1;
+	for (calendar=0; calendar<14; calendar++)
+	{
+		int d;
+		sch->dayvend[calendar][365] = SCHEDULE_MINUTES;
+		for (d=364; d>=0; d--)
+		{
+			SCHEDULEDAY *today = sch->profile + sch->day[calendar][d];
+			SCHEDULERUN *last = sch->run + today->first + today->nruns - 1;
+			SCHEDULERUN *next = sch->run + sch->profile[sch->day[calendar][d+1]].first;
+			if (sch->data[last->index]!=sch->data[next->index])
+				sch->dayvend[calendar][d] = (d+1)*24*60;
+			else if (next->vend<24*60)
+				sch->dayvend[calendar][d] = (d+1)*24*60 + next->vend;
+			else
+				sch->dayvend[calendar][d] = sch->dayvend[calendar][d+1];
+		}
+		for (day=0; day<366; day++)
+		{
+			SCHEDULEDAY *today = sch->profile + sch->day[calendar][day];
+			if (today->nruns>1 && sch->run[today->first].vend<24*60)
+				sch->invariant = 0;
+		}
+		if (sch->dayvend[calendar][0]!=SCHEDULE_MINUTES)
+			sch->invariant = 0;
+	}
+	return 1;
+
+Failed:
+	output_error("schedule_encode(SCHEDULE *sch={name='%s', ...}) memory allocation failed", sch->name);
+	/* TROUBLESHOOT
+		The schedule could not allocate enough memory to store its daily profiles.  Try freeing system memory and try again.
+	 */
+	if (hash!=NULL) free(hash);
+	schedule_free_profiles(sch);
+	return 0;
+}
+
+/* finds the run that contains a minute of a calendar */
+static SCHEDULERUN *schedule_run(SCHEDULE *sch, unsigned int cal, unsigned int min)
+{
+	SCHEDULEDAY *profile = sch->profile + sch->day[cal][min/(24*60)];
+	SCHEDULERUN *run = sch->run + profile->first;
+	unsigned int lo = 0, hi = profile->nruns;
+	min %= 24*60;
+	while (hi-lo>1)
+	{
+		unsigned int mid = (lo+hi)/2;
+		if (run[mid].start<=min)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return run+lo;
+}
+
+/* gets the number of bytes used by a schedule */
+static size_t schedule_size(SCHEDULE *sch)
+{
+	return sizeof(SCHEDULE) + strlen(sch->definition) + 1 
+		+ sizeof(SCHEDULEDAY)*sch->nprofiles + sizeof(SCHEDULERUN)*sch->nruns;
+}
+
 static pthread_cond_t sc_active = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t sc_activelock = PTHREAD_MUTEX_INITIALIZER;
 static STATUS sc_status = SUCCESS;
@@ -523,6 +692,7 @@ void *schedule_createproc(void *args)
 	STATUS status = SUCCESS;
 	void *rv = 0;
 	SCHEDULE *sch = (SCHEDULE *)args;
+	unsigned char (*index)[SCHEDULE_MINUTES] = NULL;
 
 	pthread_mutex_lock(&sc_activelock);
 	while ( sc_running>=global_threadcount )
@@ -535,83 +705,22 @@ void *schedule_createproc(void *args)
 	pthread_cond_broadcast(&sc_active);
 	pthread_mutex_unlock(&sc_activelock);
 
-	/* compile the schedule */
-	if (schedule_compile(sch))
+	/* compile the schedule into a temporary index table */
+	index = (unsigned char(*)[SCHEDULE_MINUTES])calloc(14,SCHEDULE_MINUTES);
+	if (index==NULL)
 	{
-		/* construct the dtnext array */
-		unsigned char calendar;
-		int invariant = 1;
-		for (calendar=0; calendar<14; calendar++)
-		{
-			/* number of minutes that are indexed */
-			int t = sizeof(sch->dtnext[calendar])/sizeof(sch->dtnext[calendar][0])-1;
-
-			/* assume that loopback results in a value change in 1 minute */
-			sch->dtnext[calendar][t] = 1; 
-
-			/* scan backwards through time */
-			for (t--; t>=0; t--)
-			{
-				/* get this and the next index to values */
-				int index0 = sch->index[calendar][t];
-				int index1 = sch->index[calendar][t+1];
-
-				/* if the values are the same */
-				if (sch->data[index0]==sch->data[index1])
-				{	
-					/* if we haven't reached the maximum delta-t (for unsigned char dtnext) */
-					if (sch->dtnext[calendar][t+1]<255)
-
-						/* add 1 minute to next values time */
-						sch->dtnext[calendar][t] = sch->dtnext[calendar][t+1] + 1;
-					else
-
-						/* start the time over at 1 minute (to next value) */
-						sch->dtnext[calendar][t] = 1;
-				}
-				else
-				{
-					/* start the time over at 1 minute (to next value) */
-					sch->dtnext[calendar][t] = 1;
-					invariant = 0;
-				}
-			}
-		}
-
-		/* special case for invariant schedule */
-		if (invariant)
-			memset(sch->dtnext,0,sizeof(sch->dtnext)); /* zero means never */
-
-		/* check for gaps in the schedule */
-		else
-		{
-			int ngaps = 0;
-			int ingap = 0;
-			for (calendar=0; calendar<14; calendar++)
-			{
-				int t;
-				for ( t=0; t<sizeof(sch->dtnext[calendar])/sizeof(sch->dtnext[calendar][0])-1; t++ )
-				{
-					if ( sch->dtnext[calendar][t] == 0 && !ingap)
-					{
-						int day = t/60/24;
-						int hour = t/60 - day*24;
-						int minute = t - hour*60 - day*24*60;
-						output_debug("schedule '%s' gap in calendar %d at day %d, hour %d, minute %d lasting %d minutes", sch->name, day, hour, minute);
-						ingap = 1;
-						ngaps++;
-					}
-					else if ( sch->dtnext[calendar][t] != 0 && ingap )
-						ingap = 0;
-				}
-			}
-			if (ngaps>0)
-				output_error("schedule '%s' has %d gaps which may cause erroneous results", sch->name, ngaps);
-				/* TROUBLESHOOT
-					The definition given the schedule has missing data that will cause time synchronization problems.
-					Make sure that all the time covered by the schedule has values given.
-				 */
-		}
+		output_error("schedule_createproc(SCHEDULE *sch={name='%s', ...}) memory allocation failed", sch->name);
+		/* TROUBLESHOOT
+			The schedule could not allocate enough memory to compile its definition.  Try freeing system memory and try again.
+		 */
+		status = FAILED;
+	}
+	else if (schedule_compile(sch,index) && schedule_encode(sch,index))
+	{
+		/* the runs are all that is kept */
+		free(index);
+		index = NULL;
+		output_debug("schedule '%s' uses %.1f kB of memory", sch->name, schedule_size(sch)/1000.0);
 
 		/* normalize */
 		if (sch->flags!=0)
@@ -634,6 +743,8 @@ void *schedule_createproc(void *args)
 	else
 		status = FAILED;
 Done:
+	if (index!=NULL)
+		free(index);
 	pthread_mutex_lock(&sc_activelock);
 	sc_running--;
 	sc_done++;
@@ -713,7 +824,6 @@ SCHEDULE *schedule_create(char *name,		/**< the name of the schedule */
 		 */
 		return NULL;
 	}
-	output_debug("schedule '%s' uses %.1f MB of memory", name, sizeof(SCHEDULE)/1000000.0);
 	if (strlen(name)>=sizeof(sch->name))
 	{
 		output_error("schedule_create(char *name='%s', char *definition='%s') name too long)", name, definition);
@@ -724,7 +834,7 @@ SCHEDULE *schedule_create(char *name,		/**< the name of the schedule */
 		return NULL;
 	}
 	strcpy(sch->name,name);
-	if (strlen(definition)>=sizeof(sch->definition))
+	if (strlen(definition)>=MAXDEFINITION)
 	{
 		output_error("schedule_create(char *name='%s', char *definition='%s') definition too long)", name, definition);
 		/* TROUBLESHOOT
@@ -733,7 +843,16 @@ SCHEDULE *schedule_create(char *name,		/**< the name of the schedule */
 		free(sch);
 		return NULL;
 	}
-	strcpy(sch->definition,definition);
+	sch->definition = strdup(definition);
+	if (sch->definition==NULL)
+	{
+		output_error("schedule_create(char *name='%s', char *definition='%s') memory allocation failed)", name, definition);
+		/* TROUBLESHOOT
+			The schedule module could not allocate enough memory to create a schedule item.  Try freeing system memory and try again.
+		 */
+		free(sch);
+		return NULL;
+	}
 
 	/* attach to schedule list */
 	schedule_add(sch);
@@ -749,6 +868,10 @@ SCHEDULE *schedule_create(char *name,		/**< the name of the schedule */
 		else
 		{
 			/* error message should be given by schedule_compile */
+			schedule_list = sch->next;
+			n_schedules--;
+			schedule_free_profiles(sch);
+			free(sch->definition);
 			free(sch);
 			sch = NULL;
 			return NULL;
@@ -771,6 +894,18 @@ SCHEDULE *schedule_create(char *name,		/**< the name of the schedule */
 	}
 }
 
+/** release the memory used by all schedules (call only at exit) **/
+void schedule_termall(void)
+{
+	SCHEDULE *sch;
+	for (sch=schedule_list; sch!=NULL; sch=sch->next)
+	{
+		schedule_free_profiles(sch);
+		free(sch->definition);
+		sch->definition = NULL;
+	}
+}
+
 SCHEDULE *schedule_new(void)
 {
 	/* create the schedule */
@@ -945,9 +1080,12 @@ double schedule_value(SCHEDULE *sch,		/**< the schedule to read */
 {
 	int32 cal = GET_CALENDAR(index);
 	int32 min = GET_MINUTE(index);
-	if ( cal>=14 || min>=60*24*366 )
+	if ( cal>=14 || min>=SCHEDULE_MINUTES )
+	{
 		output_error("schedule_index(): index %d has calendar %d minute %d which is invalid", index, cal, min);
-	return sch->data[sch->index[cal][min]];
+		return 0.0;
+	}
+	return sch->data[schedule_run(sch,cal,min)->index];
 }
 
 /** reads the time until the next change in the schedule 
@@ -958,9 +1096,20 @@ int32 schedule_dtnext(SCHEDULE *sch,			/**< the schedule to read */
 {
 	int32 cal = GET_CALENDAR(index);
 	int32 min = GET_MINUTE(index);
-	if ( cal>=14 || min>=60*24*366 )
+	SCHEDULERUN *run;
+	uint32 vend;
+	if ( cal>=14 || min>=SCHEDULE_MINUTES )
+	{
 		output_error("schedule_dtnext(): index %d has calendar %d minute %d which is invalid", index, cal, min);
-	return sch->dtnext[cal][min];
+		return 0;
+	}
+	if ( sch->invariant )
+		return 0; /* zero means never */
+
+	/* minutes to the next value change, restarting every 255 minutes */
+	run = schedule_run(sch,cal,min);
+	vend = ( run->vend<24*60 ? (min/(24*60))*24*60 + run->vend : sch->dayvend[cal][min/(24*60)] );
+	return (vend-1-min)%255 + 1;
 }
 
 int32 schedule_duration(SCHEDULE *sch,			/**< the schedule to read */
@@ -969,9 +1118,12 @@ int32 schedule_duration(SCHEDULE *sch,			/**< the schedule to read */
 	int32 cal = GET_CALENDAR(index);
 	int32 min = GET_MINUTE(index);
 	int block;
-	if ( cal>=14 || min>=60*24*366 )
+	if ( cal>=14 || min>=SCHEDULE_MINUTES )
+	{
 		output_error("schedule_duration(): index %d has calendar %d minute %d which is invalid", index, cal, min);
-	block = (sch->index[cal][min]>>6)&MAXBLOCKS; // these change if MAXVALUES or MAXBLOCKS changes
+		return 0;
+	}
+	block = (schedule_run(sch,cal,min)->index>>6)&MAXBLOCKS; // these change if MAXVALUES or MAXBLOCKS changes
 	return sch->minutes[block];
 }
 
@@ -980,9 +1132,12 @@ double schedule_weight(SCHEDULE *sch,			/**< the schedule to read */
 {
 	int32 cal = GET_CALENDAR(index);
 	int32 min = GET_MINUTE(index);
-	if ( cal>=14 || min>=60*24*366 )
+	if ( cal>=14 || min>=SCHEDULE_MINUTES )
+	{
 		output_error("schedule_weight(): index %d has calendar %d minute %d which is invalid", index, cal, min);
-	return sch->weight[sch->index[cal][min]];
+		return 0.0;
+	}
+	return sch->weight[schedule_run(sch,cal,min)->index];
 }
 
 /** synchronize the schedule to the time given
@@ -1354,7 +1509,7 @@ void schedule_dump(SCHEDULE *sch, char *file, char *mode)
 	int calendar;
 
 	fprintf(fp,"schedule %s { %s }\n", sch->name, sch->definition);
-	fprintf(fp,"sizeof(SCHEDULE) = %.3f MB\n", (double)sizeof(SCHEDULE)/1024/1024);
+	fprintf(fp,"sizeof(SCHEDULE) = %.3f kB\n", (double)schedule_size(sch)/1024);
 	for (calendar=0; calendar<14; calendar++)
 	{
 		int year=0, month, y;
@@ -46,10 +46,26 @@ typedef uint32 SCHEDULEINDEX;
 #define SET_CALENDAR(N,X) (N)|=(((X)&0x0f)<<20)
 #define SET_MINUTE(N,X) (N)|=((X)&0x0fffff)
 
+#define MAXDEFINITION 65536	/**< the longest schedule definition allowed */
+#define SCHEDULE_MINUTES (366*24*60)	/**< the number of minutes in each schedule calendar */
+
 #ifdef _DEBUG
 #define SCHEDULE_MAGIC 0x47ab617e
 #endif
 
+/** The SCHEDULERUN structure defines a run of minutes in a daily profile that use the same value */
+typedef struct s_schedulerun {
+	unsigned short start;	/**< the first minute of the run (minute of day) */
+	unsigned short vend;	/**< the minute of day at which the value next changes (1440 if it does not change before midnight) */
+	unsigned char index;	/**< the value index used during the run */
+} SCHEDULERUN;
+
+/** The SCHEDULEDAY structure defines a distinct daily profile as a list of runs */
+typedef struct s_scheduleday {
+	unsigned int first;		/**< the first run of the profile in the run list */
+	unsigned int nruns;		/**< the number of runs in the profile */
+} SCHEDULEDAY;
+
 /** The SCHEDULE structure defines POSIX style schedules */
 typedef struct s_schedule SCHEDULE;
 struct s_schedule {
@@ -59,11 +75,16 @@ struct s_schedule {
 	unsigned int magic1;	/* values between magic1 and magic2 should never change once compiled */
 #endif
 	char name[64];						/**< the name of the schedule */
-	char definition[65536];				/**< the definition string of the schedule */
+	char *definition;					/**< the definition string of the schedule */
 	char blockname[MAXBLOCKS][64];		/**< the name of each block */
 	unsigned char block;				/**< the last block used (4 max) */
-	unsigned char index[14][366*24*60];	/**< the schedule index (enough room for all 14 annual calendars to 1 minute resolution) */
-	unsigned char dtnext[14][366*24*60];/**< the time until the next schedule change (in minutes) */
+	unsigned short day[14][366];		/**< the daily profile used on each day of all 14 annual calendars */
+	uint32 dayvend[14][366];			/**< the minute of year at which the value last used on each day next changes */
+	SCHEDULEDAY *profile;				/**< the list of distinct daily profiles */
+	unsigned int nprofiles;				/**< the number of distinct daily profiles */
+	SCHEDULERUN *run;					/**< the runs of all the daily profiles (to 1 minute resolution) */
+	unsigned int nruns;					/**< the number of runs in all the daily profiles */
+	int invariant;						/**< flag indicating the schedule never changes value (dtnext is always 0) */
 	double data[MAXBLOCKS*MAXVALUES];	/**< the list of values used in each block */
 	unsigned int weight[MAXBLOCKS*MAXVALUES];	/**< the weight (in minutes) associate with each value */
 	double sum[MAXBLOCKS];				/**< the sum of values for each block -- used to normalize */
@@ -110,6 +131,7 @@ TIMESTAMP schedule_syncall(TIMESTAMP t);
 int schedule_test(void);
 void schedule_dump(SCHEDULE *sch, char *file, char *mode);
 void schedule_dumpall(char *file);
+void schedule_termall(void);
 int schedule_createwait(void);
 SCHEDULE *schedule_getfirst(void);
 int schedule_saveall(FILE *fp);
@@ -3,6 +3,11 @@ pkglib_LTLIBRARIES += gldcore/solvers/glsolvers.la
 gldcore_solvers_glsolvers_la_CPPFLAGS =
 gldcore_solvers_glsolvers_la_CPPFLAGS += $(AM_CPPFLAGS)
 
+# the ETP batch solver needs the lane selects if-converted to vectorize
+gldcore_solvers_glsolvers_la_CXXFLAGS =
+gldcore_solvers_glsolvers_la_CXXFLAGS += $(AM_CXXFLAGS)
+gldcore_solvers_glsolvers_la_CXXFLAGS += -fno-trapping-math
+
 gldcore_solvers_glsolvers_la_LDFLAGS =
 gldcore_solvers_glsolvers_la_LDFLAGS += $(AM_LDFLAGS)
 
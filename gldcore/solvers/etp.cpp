@@ -78,21 +78,12 @@ EXPORT int etp_get(char *param, ...)
 	return n;
 }
 
-/** solve an equation of the form $f[ ae^{nt} + be^{mt} + c = 0 $f]
-	@returns 1 = t is set ok, 0 if not converged; t is NaN if no solution found
- **/
-EXPORT int etp_solve(ETPDATA *etp)
+/* checks the degenerate cases and finds where Newton's method must start
+   @returns 1 if Newton's method must start from t, 0 if t is already the solution (NaN if none)
+ */
+static int etp_start(const double a, const double n, const double b, const double m, const double c, const double p, double &t)
 {
-	const double &a = etp->a;
-	const double &n = etp->n;
-	const double &b = etp->b;
-	const double &m = etp->m;
-	const double &c = etp->c;
-	const double &p = etp->p;
-	const unsigned int &max_iterations = etp->i;
-	double &e = etp->e;
-	double &t= etp->t;
-	double f = EVAL(t,a,n,b,m,c);
+	double f = t==0 ? a+b+c : EVAL(t,a,n,b,m,c);
 
 	// check for degenerate cases (1 exponential term is dominant)
 	// solve for t in dominant exponential, but only when a solution exists
@@ -100,12 +91,12 @@ EXPORT int etp_solve(ETPDATA *etp)
 	if (fabs(a/b)<p) // a is dominant
 	{
 		t = c*b<0 && fabs(c)<fabs(b) ? log(-c/b)/m : NaN;
-		return 1;
+		return 0;
 	}
 	else if (fabs(b/a)<p) // b is dominant
 	{
 		t = c*a<0 && fabs(c)<fabs(a) ? log(-c/a)/n : NaN;
-		return 1;
+		return 0;
 	}
 
 	// is there an extremum/inflexion to consider
@@ -126,7 +117,7 @@ EXPORT int etp_solve(ETPDATA *etp)
 			else // no solution is in range
 			{
 				t = NaN;
-				return 1;
+				return 0;
 			}
 		}
 		else if (tm<0 && ti>0) // no extremum but inflexion in domain
@@ -136,7 +127,7 @@ EXPORT int etp_solve(ETPDATA *etp)
 			else // no solution in range
 			{
 				t = NaN;
-				return 1;
+				return 0;
 			}
 		}
 		else if (ti<0) // no extremum or inflexion in domain
@@ -146,25 +137,44 @@ EXPORT int etp_solve(ETPDATA *etp)
 			else // no solution in range
 			{
 				t = NaN;
-				return 1;
+				return 0;
 			}
 		}
 		else // no solution possible (includes tm==0 and ti==0)
 		{
 			t = NaN;
-			return 1;
+			return 0;
 		}
 	}
 	else if (f*c>0) // solution is not reachable from t=0 (same sign)
 	{
 		t = NaN;
-		return 1;
+		return 0;
 	}
+	return 1;
+}
+
+/** solve an equation of the form $f[ ae^{nt} + be^{mt} + c = 0 $f]
+	@returns 1 = t is set ok, 0 if not converged; t is NaN if no solution found
+ **/
+EXPORT int etp_solve(ETPDATA *etp)
+{
+	const double &a = etp->a;
+	const double &n = etp->n;
+	const double &b = etp->b;
+	const double &m = etp->m;
+	const double &c = etp->c;
+	const double &p = etp->p;
+	const unsigned int &max_iterations = etp->i;
+	double &e = etp->e;
+	double &t= etp->t;
+
+	if ( !etp_start(a,n,b,m,c,p,t) )
+		return 1;
 
 	// solve using Newton's method
 	unsigned int iter = max_iterations;
-	if (t!=0) // initial t changed to inflexion point
-		f = EVAL(t,a,n,b,m,c);
+	double f = EVAL(t,a,n,b,m,c);
 	double dfdt = EVAL(t,a*n,n,b*m,m,0); 
 	while ( fabs(f)>p && isfinite(t) && iter-->0)
 	{
@@ -183,4 +193,232 @@ EXPORT int etp_solve(ETPDATA *etp)
 	return 1;
 }
 
+/* The batch solver (etpbatch) solves many ETP equations in one call.  The arrays
+   hold one equation per entry, and the equations that need Newton's method are
+   solved ETP_LANES at a time in lockstep.  The inner loops have a fixed trip
+   count and make no calls, so the compiler can vectorize them, including
+   the exponentials (the library is built with -fno-trapping-math so the
+   selects in these loops can be if-converted).
+ */
+#define ETP_LANES 8
 
+typedef struct s_etpbatch {
+	unsigned int size; ///< number of equations
+	double *t; ///< times (initial guess, solution or NaN if none)
+	double *a,*n; ///< a e^n
+	double *b,*m; ///< b e^m
+	double *c; ///< constants
+	double *p; ///< precisions
+	double *e; ///< errors (p/dfdt)
+	unsigned char *s; ///< status (1=solved, 2=not converged)
+	unsigned int i; ///< maximum iterations (default is 100)
+} ETPBATCH;
+
+/* exp() of each lane without calls or branches: range reduction by ln2 with
+   rounding done by the 1.5*2^52 shift, a 13th order series on |r|<ln2/2, and
+   the power of 2 scale built in the exponent bits
+ */
+static inline void etp_exp_lanes(const double *x, double *y)
+{
+	for ( unsigned int k=0 ; k<ETP_LANES ; k++ )
+	{
+		double xk = x[k]<-708.0 ? -708.0 : ( x[k]>709.0 ? 709.0 : x[k] );
+		double kd = xk*1.4426950408889634 + 6755399441055744.0;
+		int64 ki;
+		memcpy(&ki,&kd,sizeof(ki));
+		ki -= 0x4338000000000000LL;
+		kd -= 6755399441055744.0;
+		double r = xk - kd*6.93147180369123816490e-01 - kd*1.90821492927058770002e-10;
+		double q = 1.0/6227020800.0;
+		q = q*r + 1.0/479001600.0;
+		q = q*r + 1.0/39916800.0;
+		q = q*r + 1.0/3628800.0;
+		q = q*r + 1.0/362880.0;
+		q = q*r + 1.0/40320.0;
+		q = q*r + 1.0/5040.0;
+		q = q*r + 1.0/720.0;
+		q = q*r + 1.0/120.0;
+		q = q*r + 1.0/24.0;
+		q = q*r + 1.0/6.0;
+		q = q*r + 0.5;
+		q = q*r + 1.0;
+		q = q*r + 1.0;
+		int64 si = (ki+1023)<<52;
+		double scale;
+		memcpy(&scale,&si,sizeof(scale));
+		q *= scale;
+		q = x[k]>709.0 ? INFINITY : q;
+		y[k] = x[k]<-708.0 ? 0.0 : q;
+	}
+}
+
+EXPORT int etpbatch_init(CALLBACKS *fntable)
+{
+	callback=fntable;
+	return 1;
+}
+
+EXPORT int etpbatch_set(char *param, ...)
+{
+	int n=0;
+	va_list arg;
+	va_start(arg,param);
+	char *tag = param;
+	while ( tag!=NULL )
+	{
+		if ( strcmp(tag,"max_iterations")==0 )
+			default_etp_iterations = va_arg(arg,unsigned int);
+		else
+		{
+			gl_error("etpbatch_set(char *param='%s',...): tag '%s' is not recognized",param,tag);
+			return n;
+		}
+		tag = va_arg(arg,char*);
+		n++;
+	}
+	return n;
+}
+
+EXPORT int etpbatch_get(char *param, ...)
+{
+	int n=0;
+	va_list arg;
+	va_start(arg,param);
+	char *tag = param;
+	while ( tag!=NULL )
+	{
+		if ( strcmp(tag,"max_iterations")==0 )
+			*va_arg(arg,unsigned int*) = default_etp_iterations;
+		else if ( strcmp(tag,"version")==0 )
+			*va_arg(arg,unsigned int*) = version;
+		else if ( strcmp(tag,"lanes")==0 )
+			*va_arg(arg,unsigned int*) = ETP_LANES;
+		else if ( strcmp(tag,"init")==0 )
+		{
+			ETPBATCH *data = va_arg(arg,ETPBATCH*);
+			memset(data,0,sizeof(ETPBATCH));
+			data->i = default_etp_iterations;
+		}
+		else
+		{
+			gl_error("etpbatch_get(char *param='%s',...): tag '%s' is not recognized",param,tag);
+			return n;
+		}
+		tag = va_arg(arg,char*);
+		n++;
+	}
+	return n;
+}
+
+/** solve a batch of equations of the form $f[ a_ie^{n_it} + b_ie^{m_it} + c_i = 0 $f]
+	The degenerate cases are solved one equation at a time as etp_solve does.  The
+	others are solved by Newton's method in ETP_LANES lanes run in lockstep, and a
+	lane takes the next equation as soon as its equation is done, so equations
+	that take many iterations do not hold up the others.
+	@returns the number of equations solved; equations not converged have s=2 and t=NaN
+ **/
+EXPORT int etpbatch_solve(ETPBATCH *etp)
+{
+	double t[ETP_LANES], a[ETP_LANES], n[ETP_LANES], b[ETP_LANES], m[ETP_LANES], c[ETP_LANES], p[ETP_LANES];
+	double f[ETP_LANES], dfdt[ETP_LANES], x[ETP_LANES], en[ETP_LANES], em[ETP_LANES], live[ETP_LANES];
+	unsigned int item[ETP_LANES], iter[ETP_LANES];
+	unsigned int next=0, solved=0, k, j;
+
+	for ( k=0 ; k<ETP_LANES ; k++ )
+	{
+		item[k] = etp->size;
+		live[k] = 0;
+	}
+	for ( ;; )
+	{
+		// finish the equations that are done and give their lanes the next equations
+		unsigned int busy = 0;
+		for ( k=0 ; k<ETP_LANES ; k++ )
+		{
+			if ( live[k]!=0 )
+			{
+				busy++;
+				continue;
+			}
+			if ( item[k]<etp->size )
+			{
+				j = item[k];
+				if ( iter[k]>etp->i )
+				{
+					gl_error("etpbatch::solve(a=%.4f,n=%.4f,b=%.4f,m=%.4f,c=%.4f,prec=%.g) failed to converge",a[k],n[k],b[k],m[k],c[k],p[k]);
+					etp->t[j] = NaN;
+					etp->s[j] = 2;
+				}
+				else
+				{
+					etp->e[j] = p[k]/dfdt[k];
+					etp->t[j] = t[k]<=0 ? NaN : t[k];
+					etp->s[j] = 1;
+					solved++;
+				}
+				item[k] = etp->size;
+			}
+			while ( next<etp->size )
+			{
+				j = next++;
+				if ( etp_start(etp->a[j],etp->n[j],etp->b[j],etp->m[j],etp->c[j],etp->p[j],etp->t[j]) )
+				{
+					item[k] = j;
+					break;
+				}
+				etp->e[j] = 0;
+				etp->s[j] = 1;
+				solved++;
+			}
+			if ( item[k]<etp->size )
+			{
+				t[k] = etp->t[j];
+				a[k] = etp->a[j];
+				n[k] = etp->n[j];
+				b[k] = etp->b[j];
+				m[k] = etp->m[j];
+				c[k] = etp->c[j];
+				p[k] = etp->p[j];
+				iter[k] = 0;
+				live[k] = 1;
+				busy++;
+			}
+			else // idle lanes solve 0=0
+			{
+				t[k] = a[k] = n[k] = b[k] = m[k] = c[k] = 0;
+				p[k] = 1;
+			}
+		}
+		if ( busy==0 )
+			break;
+
+		for ( k=0 ; k<ETP_LANES ; k++ )
+			x[k] = n[k]*t[k];
+		etp_exp_lanes(x,en);
+		for ( k=0 ; k<ETP_LANES ; k++ )
+			x[k] = m[k]*t[k];
+		etp_exp_lanes(x,em);
+		for ( k=0 ; k<ETP_LANES ; k++ )
+		{
+			f[k] = a[k]*en[k] + b[k]*em[k] + c[k];
+			dfdt[k] = a[k]*n[k]*en[k] + b[k]*m[k]*em[k];
+		}
+
+		// lanes stop when they converge, t is no longer finite, or the iterations are used up
+		for ( k=0 ; k<ETP_LANES ; k++ )
+			live[k] = live[k]!=0 && fabs(f[k])>p[k] && t[k]-t[k]==0 ? 1 : 0;
+		for ( k=0 ; k<ETP_LANES ; k++ )
+		{
+			if ( live[k]!=0 && iter[k]==etp->i )
+			{
+				live[k] = 0;
+				iter[k]++; // failed
+			}
+		}
+		for ( k=0 ; k<ETP_LANES ; k++ )
+			t[k] = live[k]!=0 ? t[k]-f[k]/dfdt[k] : t[k];
+		for ( k=0 ; k<ETP_LANES ; k++ )
+			iter[k] += ( live[k]!=0 );
+	}
+	return solved;
+}
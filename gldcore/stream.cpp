@@ -10,6 +10,16 @@
 #include "transform.h"
 #include "class.h"
 #include "object.h"
+#include "load.h"
+#include "unit.h"
+#include "exec.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
 
 extern "C" {
 	struct s_stream {
@@ -299,6 +309,8 @@ static unsigned int stream_version = STREAM_VERSION;
 static unsigned int stream_wordsize = sizeof(void*);
 static size_t stream_pos = 0;
 static int flags = 0x00;
+static const char *stream_map = NULL; // mapped input (read instead of fp when set)
+static size_t stream_maplen = 0; // size of the mapped input
 
 /** Stream data
     @returns Bytes read/written to/from stream
@@ -362,11 +374,25 @@ size_t stream(void *ptr, ///< pointer to buffer
 		stream_pos += b;
 		return b;
 #else
-		size_t a, b = fread(&a,1,sizeof(size_t),fp);
-		if ( b<sizeof(size_t) ) throw -1;
-		if ( a>len ) throw;
-		size_t c = fread((void*)ptr,1,a,fp);
-		if ( a!=c ) throw;
+		size_t a, b, c;
+		if ( stream_map!=NULL )
+		{
+			if ( stream_pos+sizeof(size_t)>stream_maplen ) throw -1;
+			memcpy(&a,stream_map+stream_pos,sizeof(size_t));
+			b = sizeof(size_t);
+			if ( a>len || stream_pos+b+a>stream_maplen ) throw;
+			memcpy(ptr,stream_map+stream_pos+b,a);
+			c = a;
+		}
+		else
+		{
+			b = fread(&a,1,sizeof(size_t),fp);
+			if ( b<sizeof(size_t) ) throw -1;
+			if ( a>len ) throw;
+			c = fread((void*)ptr,1,a,fp);
+			if ( a!=c ) throw;
+		}
+		if ( is_str && a<len ) ((char*)ptr)[a] = '\0';
 		if ( match!=NULL && memcmp(ptr,match,a)!=0 ) throw 0;
 		b+=c;
 		stream_pos += b;
@@ -491,6 +517,119 @@ void stream(OBJECT *obj)
 	stream("/OBJ");
 }
 
+// fold a block of memory into an object hash (64-bit FNV-1a)
+static unsigned int64 stream_hashdata(unsigned int64 hash, const void *ptr, size_t size)
+{
+	const unsigned char *p = (const unsigned char*)ptr;
+	size_t n;
+	for ( n=0 ; n+sizeof(unsigned int64)<=size ; n+=sizeof(unsigned int64) )
+	{
+		unsigned int64 word;
+		memcpy(&word,p+n,sizeof(word));
+		hash = (hash^word)*1099511628211ULL;
+	}
+	for ( ; n<size ; n++ )
+		hash = (hash^p[n])*1099511628211ULL;
+	return hash;
+}
+#define stream_hashfield(H,X) stream_hashdata(H,&(X),sizeof(X))
+
+// object hash used to detect changes between checkpoints
+// Only the class data and the header fields that persist between passes are hashed.  The clock and
+// valid_to change on every pass whether or not the object does, so stream_delta saves them for all
+// objects; the profiler times and the lock are not restored at all.
+static unsigned int64 stream_objecthash(OBJECT *obj)
+{
+	unsigned int64 hash = 14695981039346656037ULL;
+	uint32 oflags = obj->flags&~OF_LOCKED;
+	hash = stream_hashfield(hash,obj->groupid);
+	hash = stream_hashfield(hash,obj->parent);
+	hash = stream_hashfield(hash,obj->child_count);
+	hash = stream_hashfield(hash,obj->rank);
+	hash = stream_hashfield(hash,obj->schedule_skew);
+	hash = stream_hashfield(hash,obj->latitude);
+	hash = stream_hashfield(hash,obj->longitude);
+	hash = stream_hashfield(hash,obj->in_svc);
+	hash = stream_hashfield(hash,obj->out_svc);
+	hash = stream_hashfield(hash,obj->in_svc_micro);
+	hash = stream_hashfield(hash,obj->out_svc_micro);
+	hash = stream_hashfield(hash,obj->rng_state);
+	hash = stream_hashfield(hash,obj->heartbeat);
+	hash = stream_hashfield(hash,oflags);
+	return stream_hashdata(hash,obj+1,obj->oclass->size);
+}
+
+// base of an incremental stream
+static const char *delta_basefile = NULL; // file name of the base stream
+static unsigned int64 *delta_basehash = NULL; // object hashes at the time of the base stream, indexed by object id
+static size_t delta_basecount = 0; // number of entries in delta_basehash
+
+// object delta stream (objects that changed since the base stream)
+void stream_delta(OBJECT *obj)
+{
+	stream("OBJ+");
+
+	// find the changed objects
+	size_t count = 0, n;
+	char *changed = NULL;
+	if ( flags&SF_OUT )
+	{
+		changed = (char*)malloc(object_get_count());
+		if ( changed==NULL ) throw "OBJ+";
+		OBJECT *item;
+		for ( item=obj, n=0 ; item!=NULL ; item=item->next, n++ )
+		{
+			changed[n] = ( item->id>=delta_basecount || stream_objecthash(item)!=delta_basehash[item->id] );
+			if ( changed[n] ) count++;
+		}
+	}
+	stream(count);
+
+	size_t m = 0;
+	for ( n=0 ; n<count ; n++ )
+	{
+		OBJECTNUM id; 
+		unsigned int size;
+		if ( flags&SF_OUT )
+		{
+			while ( !changed[m] ) { m++; obj=obj->next; }
+			changed[m] = 0;
+			id = obj->id;
+			size = sizeof(OBJECT)+obj->oclass->size;
+		}
+		stream(id);
+		stream(&size,sizeof(size));
+		if ( flags&SF_OUT )
+			stream(obj,size);
+		else if ( flags&SF_IN )
+		{
+			// overwrite the object restored from the base stream, keeping its core links
+			obj = object_find_by_id(id);
+			if ( obj==NULL || size!=sizeof(OBJECT)+obj->oclass->size ) throw "OBJ+";
+			OBJECT *data = (OBJECT*)malloc(size);
+			if ( data==NULL ) throw "OBJ+";
+			stream(data,size);
+			data->oclass = obj->oclass;
+			data->name = obj->name;
+			data->next = obj->next;
+			memcpy(obj,data,size);
+			free(data);
+		}
+	}
+	if ( changed!=NULL ) free(changed);
+
+	// clocks of all objects (they are not part of the object hash)
+	count = object_get_count();
+	stream(count);
+	if ( count!=object_get_count() ) throw "OBJ+";
+	for ( obj=object_get_first() ; obj!=NULL ; obj=obj->next )
+	{
+		stream(obj->clock);
+		stream(obj->valid_to);
+	}
+	stream("/OBJ+");
+}
+
 // globals stream
 void stream(GLOBALVAR *var)
 {
@@ -519,20 +658,49 @@ size_t stream(FILE *fileptr,int opts)
 	stream_pos = 0;
 	fp = fileptr;
 	flags = opts;
+	stream_map = NULL;
 	output_debug("starting stream on file %d with options %x", fileno(fp), flags);
 	try {
 
 		// header
-		stream("GLD30");
+		char header[8]; 
+		memset(header,0,sizeof(header));
+		if ( flags&SF_OUT ) strcpy(header,(flags&SF_DELTA)?"GLDI30":"GLD30");
+		stream(header,sizeof(header)-1);
+		if ( strcmp(header,"GLDI30")==0 )
+		{
+			// incremental stream: restore the base stream first
+			char basefile[1024]; if ( delta_basefile ) strcpy(basefile,delta_basefile);
+			stream(basefile,sizeof(basefile));
+			if ( flags&SF_IN )
+			{
+				FILE *basefp = fopen(basefile,"rb");
+				if ( basefp==NULL ) throw "base";
+				size_t pos = stream_pos;
+				size_t len = stream(basefp,SF_IN);
+				fclose(basefp);
+				if ( len==(size_t)-1 ) throw "base";
+				fp = fileptr;
+				flags = opts;
+				stream_pos = pos;
+			}
 
-		// runtime classes
-		try { stream(class_get_first_runtime()); } catch (int) {};
+			// objects changed since the base
+			try { stream_delta(object_get_first()); } catch (int) {};
+		}
+		else if ( strcmp(header,"GLD30")!=0 )
+			throw "header";
+		else
+		{
+			// runtime classes
+			try { stream(class_get_first_runtime()); } catch (int) {};
 
-		// modules
-		try { stream(module_get_first()); } catch (int) {}
+			// modules
+			try { stream(module_get_first()); } catch (int) {}
 
-		// objects
-		try { stream(object_get_first()); } catch (int) {};
+			// objects
+			try { stream(object_get_first()); } catch (int) {};
+		}
 
 		// globals
 		try { stream(global_getnext(NULL)); } catch (int) {};
@@ -561,3 +729,1011 @@ size_t stream(FILE *fileptr,int opts)
 #define stream_type(T) extern "C" size_t stream_##T(void *ptr, size_t len, PROPERTY *prop) { return stream((T*)ptr,len); }
 #include "stream_type.h"
 #undef stream_type
+
+/** Save the object hashes used as the base of later incremental streams
+	@returns SUCCESS or FAILED
+ **/
+extern "C" STATUS stream_savehash(const char *hashfile)
+{
+	FILE *fh = fopen(hashfile,"wb");
+	if ( fh==NULL )
+	{
+		output_error("stream_savehash(hashfile='%s'): unable to open file for writing", hashfile);
+		/* TROUBLESHOOT
+			The checkpoint object hash file could not be created.  Check that the
+			checkpoint file folder is writable and try again.
+		 */
+		return FAILED;
+	}
+	// hashes are saved by object id so they do not depend on the order of the object list
+	OBJECT *obj;
+	size_t count = 0;
+	for ( obj=object_get_first() ; obj!=NULL ; obj=obj->next )
+	{
+		if ( obj->id>=count ) count = obj->id+1;
+	}
+	unsigned int64 *hash = (unsigned int64*)calloc(count+1,sizeof(unsigned int64));
+	STATUS status = ( hash!=NULL && fwrite(&count,sizeof(count),1,fh)==1 ) ? SUCCESS : FAILED;
+	if ( status==SUCCESS )
+	{
+		for ( obj=object_get_first() ; obj!=NULL ; obj=obj->next )
+			hash[obj->id] = stream_objecthash(obj);
+		if ( fwrite(hash,sizeof(unsigned int64),count,fh)!=count )
+			status = FAILED;
+	}
+	free(hash);
+	if ( fclose(fh)!=0 || status==FAILED )
+	{
+		output_error("stream_savehash(hashfile='%s'): write failed", hashfile);
+		/* TROUBLESHOOT
+			The checkpoint object hash file could not be written completely.  Check
+			that there is enough space available and try again.
+		 */
+		return FAILED;
+	}
+	return SUCCESS;
+}
+
+/** Stream only the objects that changed since a base stream was saved
+	@returns Bytes written, or -1 on failure
+ **/
+extern "C" size_t stream_incremental(FILE *fp, const char *basefile, const char *hashfile)
+{
+	size_t count = 0, len = (size_t)-1;
+	FILE *fh = fopen(hashfile,"rb");
+	if ( fh==NULL || fread(&count,sizeof(count),1,fh)!=1 )
+	{
+		output_error("stream_incremental(basefile='%s', hashfile='%s'): unable to read object hashes", basefile, hashfile);
+		/* TROUBLESHOOT
+			An incremental checkpoint requires the object hash file saved with the
+			last full checkpoint.  Check that the file was not removed and that
+			the checkpoint_keepall setting is consistent with incremental checkpoints.
+		 */
+		if ( fh!=NULL ) fclose(fh);
+		return len;
+	}
+	delta_basehash = (unsigned int64*)malloc(sizeof(unsigned int64)*(count+1));
+	if ( delta_basehash!=NULL && fread(delta_basehash,sizeof(unsigned int64),count,fh)==count )
+	{
+		delta_basefile = basefile;
+		delta_basecount = count;
+		len = stream(fp,SF_OUT|SF_DELTA);
+	}
+	else
+		output_error("stream_incremental(basefile='%s', hashfile='%s'): object hashes are incomplete", basefile, hashfile);
+		/* TROUBLESHOOT
+			The object hash file saved with the last full checkpoint is damaged or truncated.
+			The next full checkpoint will save a new one.
+		 */
+	fclose(fh);
+	free(delta_basehash);
+	delta_basehash = NULL;
+	delta_basefile = NULL;
+	delta_basecount = 0;
+	return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// COMPILED MODELS
+//
+// A compiled model (.glb) holds the object graph as it stands after a GLM load and before init.
+// Objects are recreated through their class create function and their published values are
+// copied straight from the stream, so restoring a model skips parsing, name resolution and most
+// string conversion.
+
+/* compiled model version - change this when the structure of the compiled model changes */
+#define MODEL_VERSION 1
+
+/* how a published property is carried in a compiled model */
+#define MP_COPY		0 /* raw value */
+#define MP_OBJECT	1 /* object reference, carried as the object's index in the model */
+#define MP_STRING	2 /* string value (the value holds pointers or its notifier must see the change) */
+
+typedef struct s_modelprop {
+	PROPERTY *prop;
+	uint mode; // MP_COPY, MP_OBJECT, or MP_STRING
+	uint size; // bytes in the value
+	uint offset; // offset of the value in the packed record (MP_COPY and MP_OBJECT only)
+} MODELPROP;
+
+typedef struct s_modelclass {
+	CLASS *oclass;
+	size_t count; // number of published properties
+	MODELPROP *prop;
+	size_t recsize; // size of the packed record of raw values
+} MODELCLASS;
+
+typedef struct s_modelheader {
+	int64 parent; // index of the parent plus one (0 if none)
+	char32 groupid;
+	OBJECTRANK rank;
+	TIMESTAMP clock, valid_to, schedule_skew, in_svc, out_svc, heartbeat;
+	unsigned int in_svc_micro, out_svc_micro, rng_state;
+	double in_svc_double, out_svc_double, latitude, longitude;
+	uint32 flags;
+} MODELHEADER;
+
+// globals that belong to the command line or process rather than to the model
+static const char *model_skipvars[] = {"compilefile","compileonly","savefile","quiet","warn","debug","debugger","gdb","verbose","test","pauseatexit",NULL};
+
+static uint model_propmode(PROPERTY *prop)
+{
+	if ( prop->notify!=NULL )
+		return MP_STRING;
+	switch ( prop->ptype ) {
+	case PT_double: case PT_complex: case PT_enumeration: case PT_set:
+	case PT_int16: case PT_int32: case PT_int64:
+	case PT_char8: case PT_char32: case PT_char256: case PT_char1024:
+	case PT_bool: case PT_timestamp: case PT_real: case PT_float:
+		return MP_COPY;
+	case PT_object:
+		return MP_OBJECT;
+	default:
+		return MP_STRING;
+	}
+}
+
+// build the list of published properties of a class and where they go in the packed record
+static MODELCLASS *model_class(CLASS *oclass)
+{
+	MODELCLASS *mc = (MODELCLASS*)malloc(sizeof(MODELCLASS));
+	if ( mc==NULL ) throw "memory";
+	memset(mc,0,sizeof(MODELCLASS));
+	mc->oclass = oclass;
+	CLASS *pclass;
+	PROPERTY *prop;
+	for ( pclass=oclass ; pclass!=NULL ; pclass=pclass->parent )
+		for ( prop=pclass->pmap ; prop!=NULL ; prop=prop->next ) // properties added by the model are at the end of the chain
+			if ( prop->oclass==pclass && prop->ptype!=PT_void ) mc->count++;
+	mc->prop = (MODELPROP*)malloc(sizeof(MODELPROP)*(mc->count+1));
+	if ( mc->prop==NULL ) throw "memory";
+	size_t n = 0;
+	for ( pclass=oclass ; pclass!=NULL ; pclass=pclass->parent )
+	{
+		for ( prop=pclass->pmap ; prop!=NULL ; prop=prop->next )
+		{
+			if ( prop->oclass!=pclass || prop->ptype==PT_void ) continue;
+			MODELPROP *mp = &mc->prop[n++];
+			mp->prop = prop;
+			mp->mode = model_propmode(prop);
+			mp->size = (prop->size>1?prop->size:1)*prop->width;
+			mp->offset = (uint)mc->recsize;
+			if ( mp->mode!=MP_STRING )
+				mc->recsize += mp->mode==MP_OBJECT ? sizeof(int64) : mp->size;
+		}
+	}
+	return mc;
+}
+
+static void model_class_free(MODELCLASS **mc, size_t count)
+{
+	size_t n;
+	if ( mc==NULL ) return;
+	for ( n=0 ; n<count ; n++ )
+	{
+		if ( mc[n]==NULL ) continue;
+		free(mc[n]->prop);
+		free(mc[n]);
+	}
+	free(mc);
+}
+
+// objects in model order (index+1 is the reference used in the stream)
+static OBJECT **model_obj = NULL;
+static size_t model_nobj = 0;
+
+static int64 model_index(OBJECT *obj)
+{
+	if ( obj==NULL )
+		return 0;
+	size_t n = (size_t)(obj->id - model_obj[0]->id);
+	if ( n<model_nobj && model_obj[n]==obj )
+		return (int64)n+1;
+	for ( n=0 ; n<model_nobj ; n++ )
+	{
+		if ( model_obj[n]==obj )
+			return (int64)n+1;
+	}
+	throw "object reference";
+}
+
+static OBJECT *model_object(int64 index)
+{
+	if ( index==0 )
+		return NULL;
+	if ( index<0 || (size_t)index>model_nobj ) throw "object reference";
+	return model_obj[index-1];
+}
+
+static int model_compare_address(const void *a, const void *b)
+{
+	OBJECT *x = *(OBJECT**)a, *y = *(OBJECT**)b;
+	return x<y ? -1 : (x>y ? 1 : 0);
+}
+
+// find the object and property that own an address (used for transform sources)
+static OBJECT **model_byaddr = NULL;
+static PROPERTY *model_find_address(void *addr, OBJECT **owner)
+{
+	if ( model_byaddr==NULL )
+	{
+		model_byaddr = (OBJECT**)malloc(sizeof(OBJECT*)*(model_nobj+1));
+		if ( model_byaddr==NULL ) throw "memory";
+		memcpy(model_byaddr,model_obj,sizeof(OBJECT*)*model_nobj);
+		qsort(model_byaddr,model_nobj,sizeof(OBJECT*),model_compare_address);
+	}
+	size_t lo = 0, hi = model_nobj;
+	while ( lo<hi ) // find the last object that starts at or before the address
+	{
+		size_t mid = (lo+hi)/2;
+		if ( (char*)model_byaddr[mid]<=(char*)addr ) lo = mid+1; else hi = mid;
+	}
+	if ( lo==0 ) return NULL;
+	OBJECT *obj = model_byaddr[lo-1];
+	if ( (char*)addr>=(char*)(obj+1)+obj->oclass->size ) return NULL;
+	CLASS *pclass;
+	PROPERTY *prop;
+	for ( pclass=obj->oclass ; pclass!=NULL ; pclass=pclass->parent )
+		for ( prop=pclass->pmap ; prop!=NULL && prop->oclass==pclass ; prop=prop->next )
+			if ( (char*)(obj+1)+(int64)prop->addr==(char*)addr )
+			{
+				*owner = obj;
+				return prop;
+			}
+	return NULL;
+}
+
+// module list
+static void model_modules(void)
+{
+	stream("MOD");
+	size_t count = module_getcount();
+	stream(count);
+	MODULE *mod = module_get_first();
+	size_t n;
+	for ( n=0 ; n<count ; n++ )
+	{
+		char name[1024]; if ( flags&SF_OUT ) strcpy(name,mod->name);
+		stream(name,sizeof(name));
+		if ( flags&SF_OUT ) 
+			mod = mod->next;
+		else if ( module_find(name)==NULL && module_load(name,0,NULL)==NULL )
+		{
+			output_error("compiled model requires module '%s', which could not be loaded", name);
+			/* TROUBLESHOOT
+				A module that was loaded when the model was compiled is not available now.
+				Check that GLPATH includes the folder that holds the module and try again.
+			 */
+			throw "module";
+		}
+	}
+	stream("/MOD");
+}
+
+// timezone (set by the clock block rather than by a global)
+static void model_timezone(void)
+{
+	char tz[64];
+	if ( flags&SF_OUT )
+		strncpy(tz,timestamp_current_timezone(),sizeof(tz)-1), tz[sizeof(tz)-1]='\0';
+	stream(tz,sizeof(tz));
+	if ( flags&SF_IN && strcmp(tz,"")!=0 && strcmp(tz,timestamp_current_timezone())!=0 && timestamp_set_tz(tz)==NULL )
+		output_warning("compiled model timezone %s is not defined", tz);
+		/* TROUBLESHOOT
+			The timezone used by the compiled model is not defined in the timezone file <code>.../etc/tzinfo.txt</code>.  
+			Add the timezone to the timezone file or recompile the model and try again.
+		 */
+}
+
+// global variables (only the ones that differ are set when restoring)
+static void model_globals(void)
+{
+	stream("VAR");
+	size_t count = global_getcount();
+	stream(count);
+	GLOBALVAR *var = global_getnext(NULL);
+	size_t n;
+	for ( n=0 ; n<count ; n++ )
+	{
+		PROPERTYNAME name; 
+		PROPERTYTYPE ptype;
+		char unit[64];
+		char value[1025]; // raw value of plain types, string value of the others
+		uint size = 0;
+		if ( flags&SF_OUT )
+		{
+			strcpy(name,var->prop->name);
+			ptype = var->prop->ptype;
+			strcpy(unit,var->prop->unit?var->prop->unit->name:"");
+			size = property_size(var->prop);
+			if ( model_propmode(var->prop)==MP_COPY && var->callback==NULL && size<=sizeof(value) )
+				memcpy(value,var->prop->addr,size);
+			else if ( global_getvar(name,value,sizeof(value))!=NULL )
+				size = 0;
+			else
+				size = 0, strcpy(value,"");
+			var = var->next;
+		}
+		stream(name,sizeof(name));
+		stream(ptype);
+		stream(unit,sizeof(unit));
+		stream(size);
+		if ( size>0 )
+			stream((void*)value,size);
+		else
+			stream(value,sizeof(value));
+		if ( flags&SF_IN )
+		{
+			const char **skip;
+			for ( skip=model_skipvars ; *skip!=NULL && strcmp(*skip,name)!=0 ; skip++ ) {}
+			if ( *skip!=NULL ) continue;
+			GLOBALVAR *item = global_find(name);
+			if ( item==NULL )
+			{
+				// declared by the model
+				item = global_create(name,ptype,NULL,PT_SIZE,1,PT_ACCESS,PA_PUBLIC,NULL);
+				if ( item==NULL ) throw "global";
+				if ( strcmp(unit,"")!=0 ) item->prop->unit = unit_find(unit);
+			}
+			else if ( item->prop->access==PA_REFERENCE || item->prop->ptype!=ptype )
+				continue;
+			if ( size>0 )
+			{
+				if ( item->callback==NULL && size==property_size(item->prop) )
+				{
+					memcpy(item->prop->addr,value,size);
+					continue;
+				}
+				char raw[sizeof(value)];
+				memcpy(raw,value,size);
+				if ( class_property_to_string(item->prop,raw,value,sizeof(value))<0 ) continue;
+			}
+			char current[1025];
+			if ( global_getvar(name,current,sizeof(current))!=NULL && strcmp(current,value)==0 )
+				continue;
+			if ( global_setvar(name,value,NULL)==FAILED ) 
+				output_warning("compiled model global '%s' could not be set to '%s'", name, value);
+				/* TROUBLESHOOT
+					A global variable saved in the compiled model could not be restored.  The simulation
+					continues with the current value.  Recompile the model if the global is important.
+				 */
+		}
+	}
+	stream("/VAR");
+}
+
+// schedules
+static void model_schedules(void)
+{
+	stream("SCH");
+	size_t count = 0;
+	SCHEDULE *sch;
+	if ( flags&SF_OUT )
+		for ( sch=schedule_getfirst() ; sch!=NULL ; sch=schedule_getnext(sch) ) count++;
+	stream(count);
+	sch = schedule_getfirst();
+	size_t n;
+	for ( n=0 ; n<count ; n++ )
+	{
+		char name[64]; if ( flags&SF_OUT ) strcpy(name,sch->name);
+		stream(name,sizeof(name));
+		size_t len; if ( flags&SF_OUT ) len = strlen(sch->definition);
+		stream(len);
+		if ( flags&SF_OUT )
+		{
+			stream((void*)sch->definition,len,true);
+			sch = schedule_getnext(sch);
+		}
+		else
+		{
+			char *definition = (char*)malloc(len+1);
+			if ( definition==NULL ) throw "memory";
+			stream(definition,len+1,true);
+			definition[len] = '\0';
+			if ( schedule_find_byname(name)==NULL && schedule_create(name,definition)==NULL )
+			{
+				free(definition);
+				output_error("compiled model schedule '%s' could not be created", name);
+				throw "schedule";
+			}
+			free(definition);
+		}
+	}
+	stream("/SCH");
+}
+
+// class layouts (restoring fails if a class no longer matches the one the model was compiled with)
+static MODELCLASS **model_classes(size_t &count)
+{
+	MODELCLASS **mc = NULL;
+	CLASS *oclass;
+	stream("CLS");
+	if ( flags&SF_OUT )
+	{
+		// only the classes that have objects
+		size_t total = class_get_count(), n;
+		mc = (MODELCLASS**)malloc(sizeof(MODELCLASS*)*(total+1));
+		if ( mc==NULL ) throw "memory";
+		count = 0;
+		for ( oclass=class_get_first_class() ; oclass!=NULL ; oclass=oclass->next )
+		{
+			for ( n=0 ; n<model_nobj && model_obj[n]->oclass!=oclass ; n++ ) {}
+			if ( n<model_nobj ) mc[count++] = model_class(oclass);
+		}
+	}
+	stream(count);
+	if ( flags&SF_IN )
+	{
+		mc = (MODELCLASS**)malloc(sizeof(MODELCLASS*)*(count+1));
+		if ( mc==NULL ) throw "memory";
+		memset(mc,0,sizeof(MODELCLASS*)*(count+1));
+	}
+	size_t n;
+	for ( n=0 ; n<count ; n++ )
+	{
+		CLASSNAME name; if ( flags&SF_OUT ) strcpy(name,mc[n]->oclass->name);
+		stream(name,sizeof(name));
+		uint size; if ( flags&SF_OUT ) size = mc[n]->oclass->size;
+		stream(size);
+		size_t nprops; if ( flags&SF_OUT ) nprops = mc[n]->count;
+		stream(nprops);
+		CLASSNAME parent = ""; // set for classes declared by the model rather than by a module
+		if ( flags&SF_OUT && mc[n]->oclass->module==NULL )
+			strcpy(parent,mc[n]->oclass->parent?mc[n]->oclass->parent->name:"-");
+		stream(parent,sizeof(parent));
+		bool match = true;
+		if ( flags&SF_IN )
+		{
+			oclass = class_get_class_from_classname(name);
+			if ( oclass==NULL && strcmp(parent,"")!=0 )
+			{
+				// redeclare the class the way the loader does
+				oclass = class_register(NULL,name,0,0x00);
+				if ( oclass!=NULL && strcmp(parent,"-")!=0 )
+					oclass->parent = class_get_class_from_classname(parent);
+			}
+			if ( oclass==NULL )
+			{
+				model_class_free(mc,count);
+				output_error("compiled model class '%s' is not defined by any loaded module", name);
+				/* TROUBLESHOOT
+					The compiled model uses a class that is not available.  Check that the
+					modules used by the model are installed and recompile the model.
+				 */
+				throw "class";
+			}
+		}
+
+		// properties the model added to the class
+		size_t nextended = 0;
+		PROPERTY *prop = NULL;
+		if ( flags&SF_OUT )
+		{
+			oclass = mc[n]->oclass;
+			for ( prop=oclass->pmap ; prop!=NULL ; prop=prop->next )
+				if ( prop->oclass==oclass && prop->flags&PF_EXTENDED ) nextended++;
+			prop = oclass->pmap;
+		}
+		stream(nextended);
+		size_t m;
+		for ( m=0 ; m<nextended ; m++ )
+		{
+			if ( flags&SF_OUT )
+				while ( prop->oclass!=oclass || !(prop->flags&PF_EXTENDED) ) prop = prop->next;
+			PROPERTYNAME pname; if ( flags&SF_OUT ) strcpy(pname,prop->name);
+			stream(pname,sizeof(pname));
+			PROPERTYTYPE ptype; if ( flags&SF_OUT ) ptype = prop->ptype;
+			stream(ptype);
+			char unit[64]; if ( flags&SF_OUT ) strcpy(unit,prop->unit?prop->unit->name:"");
+			stream(unit,sizeof(unit));
+			if ( flags&SF_OUT )
+				prop = prop->next;
+			else if ( class_find_property(oclass,pname)==NULL )
+				class_add_extended_property(oclass,pname,ptype,strcmp(unit,"")==0?NULL:unit);
+		}
+
+		if ( flags&SF_IN )
+		{
+			mc[n] = model_class(oclass);
+			match = ( size==oclass->size && nprops==mc[n]->count );
+		}
+		for ( m=0 ; m<nprops ; m++ )
+		{
+			MODELPROP item; if ( flags&SF_OUT ) item = mc[n]->prop[m];
+			PROPERTYNAME pname; if ( flags&SF_OUT ) strcpy(pname,item.prop->name);
+			stream(pname,sizeof(pname));
+			PROPERTYTYPE ptype; if ( flags&SF_OUT ) ptype = item.prop->ptype;
+			stream(ptype);
+			int64 addr; if ( flags&SF_OUT ) addr = (int64)item.prop->addr;
+			stream(addr);
+			stream(item.mode);
+			stream(item.size);
+			if ( flags&SF_IN && match )
+			{
+				MODELPROP *mp = &mc[n]->prop[m];
+				match = ( strcmp(pname,mp->prop->name)==0 && ptype==mp->prop->ptype && addr==(int64)mp->prop->addr && item.mode==mp->mode && item.size==mp->size );
+			}
+		}
+		if ( !match )
+		{
+			model_class_free(mc,count);
+			output_error("compiled model class '%s' does not match the class now defined by its module", name);
+			/* TROUBLESHOOT
+				The module that implements the class has changed since the model was compiled.
+				Compile the model again with the current version of the module.
+			 */
+			throw "class";
+		}
+	}
+	stream("/CLS");
+	return mc;
+}
+
+static MODELCLASS *model_find_class(MODELCLASS **mc, size_t count, CLASS *oclass, uint32 &index)
+{
+	if ( index<count && mc[index]->oclass==oclass )
+		return mc[index];
+	for ( index=0 ; index<count ; index++ )
+	{
+		if ( mc[index]->oclass==oclass )
+			return mc[index];
+	}
+	throw "class";
+}
+
+// objects (created first so that object references can be patched when the values are read)
+static void model_objects(MODELCLASS **mc, size_t nclasses)
+{
+	stream("OBJ");
+	stream(model_nobj);
+	if ( flags&SF_IN )
+	{
+		model_obj = (OBJECT**)malloc(sizeof(OBJECT*)*(model_nobj+1));
+		if ( model_obj==NULL ) throw "memory";
+	}
+	size_t n;
+	uint32 index = 0;
+	for ( n=0 ; n<model_nobj ; n++ )
+	{
+		OBJECT *obj = model_obj[n];
+		if ( flags&SF_OUT ) model_find_class(mc,nclasses,obj->oclass,index);
+		stream(index);
+		char name[1024]; if ( flags&SF_OUT ) strcpy(name,obj->name?obj->name:"");
+		stream(name,sizeof(name));
+		if ( flags&SF_IN )
+		{
+			if ( index>=nclasses ) throw "class";
+			CLASS *oclass = mc[index]->oclass;
+			unsigned int before = object_get_count();
+			obj = NULL;
+			if ( oclass->create!=NULL )
+			{
+				if ( (*oclass->create)(&obj,NULL)==0 ) obj = NULL;
+			}
+			else
+				obj = object_create_single(oclass);
+			if ( obj==NULL || object_get_count()!=before+1 )
+			{
+				output_error("compiled model object %d (%s) could not be recreated", n, oclass->name);
+				/* TROUBLESHOOT
+					The object's class failed to create it, or created other objects along with it.
+					Models that use such classes cannot be restored from a compiled model; load the
+					GLM file instead.
+				 */
+				throw "object";
+			}
+			if ( strcmp(name,"")!=0 && object_set_name(obj,name)==NULL )
+				throw "object name";
+			model_obj[n] = obj;
+		}
+	}
+	stream("/OBJ");
+}
+
+// object header and property values
+static void model_values(MODELCLASS **mc, size_t nclasses)
+{
+	stream("DAT");
+	size_t recsize = 0, n, m;
+	for ( n=0 ; n<nclasses ; n++ )
+		if ( mc[n]->recsize>recsize ) recsize = mc[n]->recsize;
+	char *rec = (char*)malloc(recsize+1);
+	OBJECTRANK *rank = (OBJECTRANK*)malloc(sizeof(OBJECTRANK)*(model_nobj+1));
+	if ( rec==NULL || rank==NULL ) 
+	{
+		free(rec);
+		free(rank);
+		throw "memory";
+	}
+	uint32 index = 0;
+	for ( n=0 ; n<model_nobj ; n++ )
+	{
+		OBJECT *obj = model_obj[n];
+		MODELCLASS *oc = model_find_class(mc,nclasses,obj->oclass,index);
+		MODELHEADER hdr;
+		if ( flags&SF_OUT )
+		{
+			memset(&hdr,0,sizeof(hdr));
+			hdr.parent = model_index(obj->parent);
+			strcpy(hdr.groupid,obj->groupid);
+			hdr.rank = obj->rank;
+			hdr.clock = obj->clock;
+			hdr.valid_to = obj->valid_to;
+			hdr.schedule_skew = obj->schedule_skew;
+			hdr.in_svc = obj->in_svc;
+			hdr.out_svc = obj->out_svc;
+			hdr.heartbeat = obj->heartbeat;
+			hdr.in_svc_micro = obj->in_svc_micro;
+			hdr.out_svc_micro = obj->out_svc_micro;
+			hdr.rng_state = obj->rng_state;
+			hdr.in_svc_double = obj->in_svc_double;
+			hdr.out_svc_double = obj->out_svc_double;
+			hdr.latitude = obj->latitude;
+			hdr.longitude = obj->longitude;
+			hdr.flags = obj->flags;
+		}
+		stream(&hdr,sizeof(hdr));
+		if ( flags&SF_IN )
+		{
+			OBJECT *parent = model_object(hdr.parent);
+			if ( parent!=NULL && object_set_parent(obj,parent)<0 ) throw "parent";
+			strcpy(obj->groupid,hdr.groupid);
+			rank[n] = hdr.rank;
+			obj->clock = hdr.clock;
+			obj->valid_to = hdr.valid_to;
+			obj->schedule_skew = hdr.schedule_skew;
+			obj->in_svc = hdr.in_svc;
+			obj->out_svc = hdr.out_svc;
+			obj->heartbeat = hdr.heartbeat;
+			obj->in_svc_micro = hdr.in_svc_micro;
+			obj->out_svc_micro = hdr.out_svc_micro;
+			obj->rng_state = hdr.rng_state;
+			obj->in_svc_double = hdr.in_svc_double;
+			obj->out_svc_double = hdr.out_svc_double;
+			obj->latitude = hdr.latitude;
+			obj->longitude = hdr.longitude;
+			obj->flags = hdr.flags;
+		}
+
+		// raw values go in one packed record
+		if ( flags&SF_OUT )
+		{
+			for ( m=0 ; m<oc->count ; m++ )
+			{
+				MODELPROP *mp = &oc->prop[m];
+				void *addr = (char*)(obj+1)+(int64)mp->prop->addr;
+				if ( mp->mode==MP_COPY )
+					memcpy(rec+mp->offset,addr,mp->size);
+				else if ( mp->mode==MP_OBJECT )
+				{
+					int64 ref = model_index(*(OBJECT**)addr);
+					memcpy(rec+mp->offset,&ref,sizeof(ref));
+				}
+			}
+		}
+		if ( oc->recsize>0 )
+			stream((void*)rec,oc->recsize);
+		for ( m=0 ; m<oc->count ; m++ )
+		{
+			MODELPROP *mp = &oc->prop[m];
+			void *addr = (char*)(obj+1)+(int64)mp->prop->addr;
+			if ( mp->mode==MP_STRING )
+			{
+				char value[1025];
+				if ( flags&SF_OUT && class_property_to_string(mp->prop,addr,value,sizeof(value))<0 )
+					strcpy(value,"");
+				stream(value,sizeof(value));
+				if ( flags&SF_IN )
+				{
+					// only values that differ from what create() gave are set, as the loader would have
+					char current[1025];
+					if ( class_property_to_string(mp->prop,addr,current,sizeof(current))>=0 && strcmp(current,value)==0 )
+						continue;
+					int ok = mp->prop->access==PA_PUBLIC ? object_set_value_by_addr(obj,addr,value,mp->prop) : class_string_to_property(mp->prop,addr,value);
+					if ( ok==0 )
+						output_warning("compiled model property %s of object %d (%s) could not be set to '%s'", mp->prop->name, n, obj->oclass->name, value);
+						/* TROUBLESHOOT
+							A property value saved in the compiled model could not be restored.  The simulation
+							continues with the default value.  Recompile the model or load the GLM file instead.
+						 */
+				}
+			}
+			else if ( flags&SF_IN )
+			{
+				if ( mp->mode==MP_OBJECT )
+				{
+					int64 ref;
+					memcpy(&ref,rec+mp->offset,sizeof(ref));
+					*(OBJECT**)addr = model_object(ref);
+				}
+				else if ( memcmp(addr,rec+mp->offset,mp->size)!=0 )
+					memcpy(addr,rec+mp->offset,mp->size);
+			}
+		}
+	}
+
+	// ranks are restored last because setting a parent may raise them
+	if ( flags&SF_IN )
+		for ( n=0 ; n<model_nobj ; n++ )
+			model_obj[n]->rank = rank[n];
+	free(rec);
+	free(rank);
+	stream("/DAT");
+}
+
+// linear transforms (the transform list is written oldest first so restoring keeps its order)
+static void model_transforms(void)
+{
+	stream("XFM");
+	size_t count = 0, n;
+	TRANSFORM **list = NULL;
+	if ( flags&SF_OUT )
+	{
+		TRANSFORM *xform;
+		for ( xform=transform_getnext(NULL) ; xform!=NULL ; xform=transform_getnext(xform) )
+			count++;
+		list = (TRANSFORM**)malloc(sizeof(TRANSFORM*)*(count+1));
+		if ( list==NULL ) throw "memory";
+		for ( xform=transform_getnext(NULL), n=count ; xform!=NULL ; xform=transform_getnext(xform) )
+			list[--n] = xform;
+	}
+	stream(count);
+	for ( n=0 ; n<count ; n++ )
+	{
+		TRANSFORM *xform = list ? list[n] : NULL;
+		int stype; 
+		double scale, bias;
+		int64 target;
+		PROPERTYNAME tprop;
+		char source[1024]; // schedule name, or property name of the source object
+		int64 sobj = 0;
+		if ( flags&SF_OUT )
+		{
+			if ( xform->function_type!=XT_LINEAR )
+			{
+				free(list);
+				output_error("compiled models only support linear transforms");
+				/* TROUBLESHOOT
+					The model uses a filter or external transform, which a compiled model cannot restore.
+					Load the GLM file instead.
+				 */
+				throw "transform";
+			}
+			stype = xform->source_type;
+			scale = xform->scale;
+			bias = xform->bias;
+			target = model_index(xform->target_obj);
+			strcpy(tprop,xform->target_prop->name);
+			if ( xform->source_schedule!=NULL )
+				strcpy(source,xform->source_schedule->name);
+			else
+			{
+				OBJECT *owner = NULL;
+				PROPERTY *prop = model_find_address(xform->source_addr,&owner);
+				if ( prop==NULL )
+				{
+					free(list);
+					output_error("compiled model transform source of %s could not be found", tprop);
+					/* TROUBLESHOOT
+						A transform reads a value that is neither a schedule nor a published object property.
+						Load the GLM file instead.
+					 */
+					throw "transform";
+				}
+				sobj = model_index(owner);
+				strcpy(source,prop->name);
+			}
+		}
+		stream(stype);
+		stream(scale);
+		stream(bias);
+		stream(target);
+		stream(tprop,sizeof(tprop));
+		stream(sobj);
+		stream(source,sizeof(source));
+		if ( flags&SF_IN )
+		{
+			OBJECT *obj = model_object(target);
+			PROPERTY *prop = obj ? object_get_property(obj,tprop,NULL) : NULL;
+			SCHEDULE *sch = NULL;
+			double *addr = NULL;
+			if ( sobj==0 )
+			{
+				sch = schedule_find_byname(source);
+				addr = (double*)sch; // the loader does the same (the value is the first member)
+			}
+			else
+			{
+				OBJECT *from = model_object(sobj);
+				PROPERTY *sprop = object_get_property(from,source,NULL);
+				addr = sprop ? (double*)((char*)(from+1)+(int64)sprop->addr) : NULL;
+			}
+			if ( prop==NULL || addr==NULL || !transform_add_linear((TRANSFORMSOURCE)stype,addr,(char*)(obj+1)+(int64)prop->addr,scale,bias,obj,prop,sch) )
+				throw "transform";
+		}
+	}
+	free(list);
+	stream("/XFM");
+}
+
+static void model_free(MODELCLASS **mc, size_t nclasses)
+{
+	model_class_free(mc,nclasses);
+	free(model_obj);
+	model_obj = NULL;
+	model_nobj = 0;
+	free(model_byaddr);
+	model_byaddr = NULL;
+}
+
+/** Compile the loaded model to a binary model file
+	@returns SUCCESS or FAILED
+ **/
+extern "C" STATUS stream_compile(const char *filename)
+{
+	const char *what = class_get_first_runtime()!=NULL ? "runtime class" : load_get_uncompilable();
+	if ( what!=NULL )
+	{
+		output_error("stream_compile(filename='%s'): the model uses '%s', which a compiled model cannot reproduce", filename, what);
+		/* TROUBLESHOOT
+			Compiled models hold modules, globals, schedules, objects and linear transforms.  Models that
+			use runtime classes, imports, externs, filters, links, scripts, instances, namespaces or load methods
+			must be loaded from their GLM file.
+		 */
+		return FAILED;
+	}
+	MODELCLASS **mc = NULL;
+	size_t nclasses = 0;
+	OBJECT *obj;
+	model_nobj = object_get_count();
+	model_obj = (OBJECT**)malloc(sizeof(OBJECT*)*(model_nobj+1));
+	if ( model_obj==NULL )
+	{
+		output_error("stream_compile(filename='%s'): memory allocation failed", filename);
+		return FAILED;
+	}
+	size_t n = 0;
+	for ( obj=object_get_first() ; obj!=NULL && n<model_nobj ; obj=obj->next )
+	{
+		if ( obj->space!=NULL || obj->forecast!=NULL )
+		{
+			output_error("stream_compile(filename='%s'): object %d (%s) uses namespaces or forecasts, which a compiled model cannot reproduce", filename, obj->id, obj->oclass->name);
+			model_free(mc,nclasses);
+			return FAILED;
+		}
+		model_obj[n++] = obj;
+	}
+	model_nobj = n;
+
+	fp = fopen(filename,"wb");
+	if ( fp==NULL )
+	{
+		output_error("stream_compile(filename='%s'): unable to open file for writing", filename);
+		model_free(mc,nclasses);
+		return FAILED;
+	}
+	double t0 = exec_wallclock();
+	stream_pos = 0;
+	flags = SF_OUT;
+	stream_map = NULL;
+	STATUS status = SUCCESS;
+	try {
+		char header[8] = "GLB";
+		stream(header,sizeof(header)-1);
+		uint version = MODEL_VERSION;
+		stream(version);
+		uint wordsize = sizeof(void*);
+		stream(wordsize);
+		model_modules();
+		model_timezone();
+		model_globals();
+		model_schedules();
+		mc = model_classes(nclasses);
+		model_objects(mc,nclasses);
+		model_values(mc,nclasses);
+		model_transforms();
+		stream("END");
+	}
+	catch (const char *msg)
+	{
+		output_error("stream_compile(filename='%s'): unexpected %s at offset %lld", filename, msg, (int64)stream_pos);
+		status = FAILED;
+	}
+	catch (...)
+	{
+		output_error("stream_compile(filename='%s'): write failed at offset %lld", filename, (int64)stream_pos);
+		status = FAILED;
+	}
+	if ( fclose(fp)!=0 )
+		status = FAILED;
+	fp = NULL;
+	if ( status==SUCCESS )
+		output_verbose("compiled %d objects to '%s' (%.3f MB) in %.3f s", model_nobj, filename, stream_pos/1e6, exec_wallclock()-t0);
+	model_free(mc,nclasses);
+	return status;
+}
+
+/** Load a compiled model file
+	@returns SUCCESS or FAILED
+ **/
+extern "C" STATUS stream_load_compiled(const char *filename)
+{
+	MODELCLASS **mc = NULL;
+	size_t nclasses = 0;
+	double t0 = exec_wallclock();
+	stream_map = NULL;
+	stream_maplen = 0;
+#if !defined WIN32 && !defined _DEBUG
+	// the release stream format can be read straight from memory
+	int fd = open(filename,O_RDONLY);
+	struct stat st;
+	if ( fd>=0 && fstat(fd,&st)==0 && st.st_size>0 )
+	{
+		void *data = mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+		if ( data!=MAP_FAILED )
+		{
+			stream_map = (const char*)data;
+			stream_maplen = (size_t)st.st_size;
+		}
+	}
+	if ( fd>=0 ) close(fd);
+#endif
+	fp = NULL;
+	if ( stream_map==NULL && (fp=fopen(filename,"rb"))==NULL )
+	{
+		output_error("stream_load_compiled(filename='%s'): unable to open file for reading", filename);
+		return FAILED;
+	}
+	stream_pos = 0;
+	flags = SF_IN;
+	STATUS status = SUCCESS;
+	try {
+		char header[8];
+		stream(header,sizeof(header)-1);
+		if ( strcmp(header,"GLB")!=0 ) throw "header";
+		uint version, wordsize;
+		stream(version);
+		stream(wordsize);
+		if ( version!=MODEL_VERSION || wordsize!=sizeof(void*) )
+		{
+			output_error("stream_load_compiled(filename='%s'): compiled model version %d (%d-bit) cannot be loaded by this version (%d, %d-bit)", filename, version, wordsize*8, MODEL_VERSION, (int)sizeof(void*)*8);
+			/* TROUBLESHOOT
+				The compiled model was made by a different version or build of GridLAB-D.  Compile the
+				model again with the version you are running.
+			 */
+			throw "version";
+		}
+		model_modules();
+		model_timezone();
+		model_globals();
+		model_schedules();
+		mc = model_classes(nclasses);
+		model_objects(mc,nclasses);
+		model_values(mc,nclasses);
+		model_transforms();
+		stream("END");
+	}
+	catch (const char *msg)
+	{
+		output_error("stream_load_compiled(filename='%s'): unexpected %s at offset %lld", filename, msg, (int64)stream_pos);
+		status = FAILED;
+	}
+	catch (...)
+	{
+		output_error("stream_load_compiled(filename='%s'): read failed at offset %lld", filename, (int64)stream_pos);
+		status = FAILED;
+	}
+	if ( status==SUCCESS )
+		output_verbose("restored %d objects from '%s' (%.3f MB) in %.3f s", model_nobj, filename, stream_pos/1e6, exec_wallclock()-t0);
+#ifndef WIN32
+	if ( stream_map!=NULL )
+		munmap((void*)stream_map,stream_maplen);
+#endif
+	stream_map = NULL;
+	stream_maplen = 0;
+	if ( fp!=NULL )
+		fclose(fp);
+	fp = NULL;
+	model_free(mc,nclasses);
+	return status;
+}
@@ -14,6 +14,7 @@
 #define SF_IN		0x0001
 #define SF_OUT		0x0002
 #define SF_STR		0x0004
+#define SF_DELTA	0x0008 /* only objects changed since the base stream (see stream_incremental) */
 
 typedef const char *TOKEN;
 typedef unsigned int uint;
@@ -34,7 +35,11 @@ typedef size_t (*STREAMCALLBACK)(void*,size_t,bool,void*);
 typedef size_t (*STREAMCALL)(int flags,STREAMCALLBACK call);
 void stream_register(STREAMCALL);
 size_t stream(FILE *fp, int flags);
+size_t stream_incremental(FILE *fp, const char *basefile, const char *hashfile);
+STATUS stream_savehash(const char *hashfile);
 char* stream_context();
+STATUS stream_compile(const char *filename);
+STATUS stream_load_compiled(const char *filename);
 #endif
 
 #define stream_type(T) size_t stream_##T(void*,size_t,PROPERTY*p)
@@ -243,8 +243,10 @@ MTI *mti_init(const char *name, MTIFUNCTIONS *fn, size_t minitems)
 				item = fn->get(item);
 			}
 
-			/* create thread to handle the list */
-			proc->enabled  = ( pthread_create(&proc->thread_id,NULL,(void*(*)(void*))iterator_proc,proc)==0 );
+			/* create thread to handle the list (enabled first so the thread does not exit before it starts) */
+			proc->enabled = TRUE;
+			if ( pthread_create(&proc->thread_id,NULL,(void*(*)(void*))iterator_proc,proc)!=0 )
+				proc->enabled = FALSE;
 			mti_debug(mti,"proc=%d; enabled=%d, nitems=%d", p, proc->enabled, proc->n_items);
 		}
 	}
@@ -312,3 +314,389 @@ int mti_run(MTIDATA result, MTI *mti, MTIDATA input)
 	mti->runtime += (clock_t)exec_clock() - t0;
 	return 1;
 }
+
+/***************************************************************************
+ * WORK-STEALING POOL
+ ***************************************************************************/
+
+#include "lock.h"
+
+#define WSP_MAXCHUNKS 8 /* default number of chunks per thread per job */
+
+/** per-thread chunk deque (padded to avoid false sharing) */
+typedef struct s_wspdeque {
+	unsigned int lock;	/**< deque lock */
+	volatile size_t head;	/**< next chunk taken by the owner */
+	volatile size_t tail;	/**< one past the last chunk (stolen from this end) */
+	char pad[64];		/**< keeps deques on separate cache lines */
+} WSPDEQUE;
+
+/** pool thread info */
+typedef struct s_wspthread {
+	unsigned int id;	/**< pool thread id */
+	pthread_t thread_id;	/**< pthread handle/id */
+	unsigned int generation; /**< last job generation processed */
+} WSPTHREAD;
+
+static struct {
+	unsigned int n_threads;		/**< number of threads (including the caller) */
+	WSPTHREAD *thread;		/**< helper thread list (element 0 is the caller) */
+	WSPDEQUE *deque;		/**< deque for each thread */
+	pthread_mutex_t lock;		/**< job start/stop lock */
+	pthread_cond_t start;		/**< job start condition */
+	pthread_cond_t stop;		/**< job stop condition */
+	pthread_cond_t idle;		/**< pool idle condition */
+	unsigned int generation;	/**< job generation counter */
+	unsigned int pending;		/**< number of helpers still working on the job */
+	int enabled;			/**< pool is running */
+	int busy;			/**< a job is in progress */
+	pthread_t caller;		/**< thread that started the job in progress */
+	/* current job */
+	WSPCALLFN call;
+	void *data;
+	size_t n_items;
+	size_t chunksize;
+	WSPSTATS stats;
+} wsp = {0};
+
+/** nested job - a wsp_run() call made while a job item is being processed,
+	which is run by the caller and by any pool thread that is idle waiting
+	for the outer job to finish **/
+static struct {
+	WSPCALLFN call;			/**< item call function (NULL if no nested job) */
+	void *data;
+	size_t n_items;
+	size_t next;			/**< next item to process */
+	unsigned int active;	/**< number of threads processing items */
+	pthread_cond_t done;	/**< all items done condition */
+} wsp_nested = {0};
+static pthread_key_t wsp_key; /**< pool thread info of the calling thread (NULL for the caller of the outer job) */
+
+/* a nested job has items waiting for a helper (call with wsp.lock held) */
+#define WSP_NESTED_WAITING (wsp_nested.call!=NULL && wsp_nested.next<wsp_nested.n_items)
+
+/* take a chunk from the front of a deque (owner) or the back (thief) */
+static int wsp_take(WSPDEQUE *dq, size_t *chunk, int steal)
+{
+	int ok = 0;
+	if ( dq->head>=dq->tail ) /* quick check without lock */
+		return 0;
+	wlock(&dq->lock);
+	if ( dq->head<dq->tail )
+	{
+		*chunk = steal ? --dq->tail : dq->head++;
+		ok = 1;
+	}
+	wunlock(&dq->lock);
+	return ok;
+}
+
+/* process the current job until no chunks remain anywhere */
+static void wsp_work(unsigned int id)
+{
+	size_t chunk;
+	int64 chunks=0, steals=0;
+	unsigned int n;
+	for ( ;; )
+	{
+		int found = wsp_take(&wsp.deque[id],&chunk,0);
+		for ( n=1 ; !found && n<wsp.n_threads ; n++ )
+		{
+			found = wsp_take(&wsp.deque[(id+n)%wsp.n_threads],&chunk,1);
+			if ( found ) steals++;
+		}
+		if ( !found )
+			break;
+		else
+		{
+			size_t item = chunk*wsp.chunksize;
+			size_t last = item+wsp.chunksize;
+			if ( last>wsp.n_items ) last = wsp.n_items;
+			for ( ; item<last ; item++ )
+				wsp.call(id,item,wsp.data);
+			chunks++;
+		}
+	}
+	pthread_mutex_lock(&wsp.lock);
+	wsp.stats.chunks += chunks;
+	wsp.stats.steals += steals;
+	pthread_mutex_unlock(&wsp.lock);
+}
+
+/* process items of the nested job until none remain (call with wsp.lock held after joining the job) */
+static void wsp_nested_work(unsigned int id)
+{
+	for ( ;; )
+	{
+		size_t item;
+		if ( wsp_nested.next>=wsp_nested.n_items )
+		{
+			if ( --wsp_nested.active==0 )
+				pthread_cond_signal(&wsp_nested.done);
+			break;
+		}
+		item = wsp_nested.next++;
+		pthread_mutex_unlock(&wsp.lock);
+		wsp_nested.call(id,item,wsp_nested.data);
+		pthread_mutex_lock(&wsp.lock);
+	}
+}
+
+/* run a nested job (call with wsp.lock held, returns with it released), returns 0 if another nested job is already running */
+static int wsp_nested_run(WSPCALLFN call, void *data, size_t n_items, unsigned int id)
+{
+	if ( wsp_nested.call!=NULL )
+	{
+		pthread_mutex_unlock(&wsp.lock);
+		return 0;
+	}
+	wsp_nested.call = call;
+	wsp_nested.data = data;
+	wsp_nested.n_items = n_items;
+	wsp_nested.next = 0;
+	wsp_nested.active = 1;
+	wsp.stats.jobs++;
+	pthread_cond_broadcast(&wsp.start); /* wakes idle helpers */
+	pthread_cond_broadcast(&wsp.stop); /* wakes the caller of the outer job */
+
+	/* caller works too, then waits for the helpers that joined */
+	wsp_nested_work(id);
+	while ( wsp_nested.active>0 )
+		pthread_cond_wait(&wsp_nested.done,&wsp.lock);
+	wsp_nested.call = NULL;
+	pthread_mutex_unlock(&wsp.lock);
+	return 1;
+}
+
+static void *wsp_proc(void *arg)
+{
+	WSPTHREAD *tp = (WSPTHREAD*)arg;
+	pthread_setspecific(wsp_key,tp);
+	for ( ;; )
+	{
+		/* wait for a new job, helping with nested jobs meanwhile */
+		pthread_mutex_lock(&wsp.lock);
+		while ( wsp.enabled && tp->generation==wsp.generation )
+		{
+			if ( WSP_NESTED_WAITING )
+			{
+				wsp_nested.active++;
+				wsp_nested_work(tp->id);
+			}
+			else
+				pthread_cond_wait(&wsp.start,&wsp.lock);
+		}
+		if ( !wsp.enabled )
+		{
+			pthread_mutex_unlock(&wsp.lock);
+			break;
+		}
+		tp->generation = wsp.generation;
+		pthread_mutex_unlock(&wsp.lock);
+
+		wsp_work(tp->id);
+
+		/* signal completion */
+		pthread_mutex_lock(&wsp.lock);
+		if ( --wsp.pending==0 )
+			pthread_cond_signal(&wsp.stop);
+		pthread_mutex_unlock(&wsp.lock);
+	}
+	return NULL;
+}
+
+/** Create the work-stealing pool
+	@returns the number of threads in the pool, or 0 on failure
+ **/
+int wsp_init(unsigned int n_threads) /**< number of threads including the caller (0 for processor count) */
+{
+	unsigned int n;
+	if ( wsp.enabled )
+		return wsp.n_threads;
+	if ( n_threads==0 )
+		n_threads = processor_count();
+	wsp.thread = (WSPTHREAD*)malloc(sizeof(WSPTHREAD)*n_threads);
+	wsp.deque = (WSPDEQUE*)malloc(sizeof(WSPDEQUE)*n_threads);
+	if ( wsp.thread==NULL || wsp.deque==NULL )
+	{
+		output_error("wsp_init memory allocation failed");
+		/* TROUBLESHOOT
+		   Memory allocation failed while creating the work-stealing thread pool.
+		   Free up memory and try again.
+		 */
+		return 0;
+	}
+	memset(wsp.thread,0,sizeof(WSPTHREAD)*n_threads);
+	memset(wsp.deque,0,sizeof(WSPDEQUE)*n_threads);
+	pthread_mutex_init(&wsp.lock,NULL);
+	pthread_cond_init(&wsp.start,NULL);
+	pthread_cond_init(&wsp.stop,NULL);
+	pthread_cond_init(&wsp.idle,NULL);
+	pthread_cond_init(&wsp_nested.done,NULL);
+	pthread_key_create(&wsp_key,NULL);
+	wsp.generation = 0;
+	wsp.enabled = 1;
+	wsp.n_threads = 1;
+	for ( n=1 ; n<n_threads ; n++ )
+	{
+		WSPTHREAD *tp = &wsp.thread[n];
+		tp->id = n;
+		if ( pthread_create(&tp->thread_id,NULL,wsp_proc,tp)!=0 )
+		{
+			output_error("wsp_init unable to create thread %d; pool will use %d threads", n, wsp.n_threads);
+			/* TROUBLESHOOT
+			   The system refused to create a worker thread for the work-stealing pool.
+			   The simulation will continue with fewer threads.  Reduce the threadcount
+			   or free up system resources and try again.
+			 */
+			break;
+		}
+		wsp.n_threads++;
+	}
+	memset(&wsp.stats,0,sizeof(wsp.stats));
+	wsp.stats.n_threads = wsp.n_threads;
+	return wsp.n_threads;
+}
+
+/* run a job serially on the calling thread */
+static size_t wsp_serial(WSPCALLFN call, void *data, size_t n_items, unsigned int id)
+{
+	size_t item;
+	for ( item=0 ; item<n_items ; item++ )
+		call(id,item,data);
+	return n_items;
+}
+
+/** Run a job on the work-stealing pool
+	@returns the number of items processed
+ **/
+size_t wsp_run(WSPCALLFN call, /**< item call function */
+			void *data, /**< data passed to each call */
+			size_t n_items, /**< number of items in job */
+			size_t chunksize) /**< number of items per chunk (0 for automatic) */
+{
+	WSPTHREAD *tp;
+	size_t n_chunks, first = 0;
+	unsigned int n;
+
+	if ( n_items==0 )
+		return 0;
+
+	/* no pool */
+	if ( !wsp.enabled || wsp.n_threads<2 )
+		return wsp_serial(call,data,n_items,0);
+
+	/* a job started by this thread or run by a pool thread is nested, any other caller waits for the pool */
+	tp = (WSPTHREAD*)pthread_getspecific(wsp_key);
+	pthread_mutex_lock(&wsp.lock);
+	while ( wsp.busy )
+	{
+		if ( tp!=NULL || pthread_equal(wsp.caller,pthread_self()) )
+		{
+			unsigned int id = tp!=NULL ? tp->id : 0;
+			if ( n_items>1 && wsp_nested_run(call,data,n_items,id) )
+				return n_items;
+			if ( n_items<2 )
+				pthread_mutex_unlock(&wsp.lock);
+			return wsp_serial(call,data,n_items,id);
+		}
+		pthread_cond_wait(&wsp.idle,&wsp.lock);
+	}
+	wsp.busy = 1;
+	wsp.caller = pthread_self();
+
+	/* single item runs on the caller */
+	if ( n_items<2 )
+	{
+		pthread_mutex_unlock(&wsp.lock);
+		wsp_serial(call,data,n_items,0);
+		pthread_mutex_lock(&wsp.lock);
+		wsp.busy = 0;
+		pthread_cond_broadcast(&wsp.idle);
+		pthread_mutex_unlock(&wsp.lock);
+		return n_items;
+	}
+
+	/* split job into chunks */
+	if ( chunksize==0 )
+		chunksize = n_items/(wsp.n_threads*WSP_MAXCHUNKS);
+	if ( chunksize==0 )
+		chunksize = 1;
+	n_chunks = (n_items+chunksize-1)/chunksize;
+
+	/* deal chunks to threads in contiguous blocks */
+	for ( n=0 ; n<wsp.n_threads ; n++ )
+	{
+		size_t last = n_chunks*(n+1)/wsp.n_threads;
+		wsp.deque[n].head = first;
+		wsp.deque[n].tail = last;
+		first = last;
+	}
+
+	/* start helpers */
+	wsp.call = call;
+	wsp.data = data;
+	wsp.n_items = n_items;
+	wsp.chunksize = chunksize;
+	wsp.pending = wsp.n_threads-1;
+	wsp.generation++;
+	wsp.stats.jobs++;
+	pthread_cond_broadcast(&wsp.start);
+	pthread_mutex_unlock(&wsp.lock);
+
+	/* caller works as thread 0 */
+	wsp_work(0);
+
+	/* wait for helpers (barrier), helping with nested jobs meanwhile */
+	pthread_mutex_lock(&wsp.lock);
+	while ( wsp.pending>0 )
+	{
+		if ( WSP_NESTED_WAITING )
+		{
+			wsp_nested.active++;
+			wsp_nested_work(0);
+		}
+		else
+			pthread_cond_wait(&wsp.stop,&wsp.lock);
+	}
+	wsp.busy = 0;
+	pthread_cond_broadcast(&wsp.idle);
+	pthread_mutex_unlock(&wsp.lock);
+	return n_items;
+}
+
+/** Destroy the work-stealing pool **/
+void wsp_term(void)
+{
+	unsigned int n;
+	if ( !wsp.enabled )
+		return;
+	pthread_mutex_lock(&wsp.lock);
+	wsp.enabled = 0;
+	pthread_cond_broadcast(&wsp.start);
+	pthread_mutex_unlock(&wsp.lock);
+	for ( n=1 ; n<wsp.n_threads ; n++ )
+		pthread_join(wsp.thread[n].thread_id,NULL);
+	pthread_mutex_destroy(&wsp.lock);
+	pthread_cond_destroy(&wsp.start);
+	pthread_cond_destroy(&wsp.stop);
+	pthread_cond_destroy(&wsp.idle);
+	pthread_cond_destroy(&wsp_nested.done);
+	pthread_key_delete(wsp_key);
+	free(wsp.thread);
+	free(wsp.deque);
+	wsp.thread = NULL;
+	wsp.deque = NULL;
+}
+
+/** Get the number of threads in the pool (1 if the pool is not running) **/
+unsigned int wsp_get_threadcount(void)
+{
+	return wsp.enabled ? wsp.n_threads : 1;
+}
+
+/** Get the pool statistics **/
+WSPSTATS *wsp_get_stats(void)
+{
+	return &wsp.stats;
+}
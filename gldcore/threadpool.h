@@ -158,6 +158,57 @@ int mti_run(MTIDATA result,   /**< result of iterator */
             MTIDATA input);   /**< data to send to iterator call function */
 
 int processor_count(void);
+
+/** @} **/
+
+/** @defgroup wsp Work-stealing Pool
+    @ingroup core
+
+    The work-stealing pool (WSP) is a single set of persistent worker threads
+    that is shared by every parallel loop in the core.  Unlike an MTI, a WSP
+    job is not bound to a fixed list of items, so the same threads can be used
+    for every rank of every pass.
+
+    A job is a range of item indices [0,n_items) that is split into chunks.
+    The chunks are dealt out in contiguous blocks to per-thread deques.  Each
+    thread pops chunks from the front of its own deque, and when it runs out
+    it steals chunks from the back of other threads' deques.  The calling
+    thread participates as thread 0, and #wsp_run() does not return until
+    every item has been processed (i.e., it is a barrier).
+
+    The pool is created with #wsp_init() using #global_threadcount threads
+    (including the caller) and destroyed with #wsp_term().  A #wsp_run() call
+    made by an item of a running job (a nested job) is shared between the
+    caller and the pool threads that are idle waiting for the running job to
+    finish.  Only one nested job runs at a time; a nested call made while
+    another nested job is running is processed serially by its caller.  A
+    #wsp_run() call made by a thread outside the pool while a job is running
+    waits until the pool is idle, so that thread ids are never shared.
+
+ @{
+ **/
+
+/** Work-stealing pool call function prototype
+    @param thread the id of the pool thread making the call (0..wsp_get_threadcount()-1)
+    @param item the index of the item to process
+    @param data the job data given to #wsp_run()
+ **/
+typedef void (*WSPCALLFN)(unsigned int thread, size_t item, void *data);
+
+/** Work-stealing pool statistics */
+typedef struct s_wspstats {
+	unsigned int n_threads;	/**< number of threads in the pool (including the caller) */
+	int64 jobs;				/**< number of jobs run */
+	int64 chunks;			/**< number of chunks processed */
+	int64 steals;			/**< number of chunks stolen from other threads */
+} WSPSTATS;
+
+int wsp_init(unsigned int n_threads);
+size_t wsp_run(WSPCALLFN call, void *data, size_t n_items, size_t chunksize);
+void wsp_term(void);
+unsigned int wsp_get_threadcount(void);
+WSPSTATS *wsp_get_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
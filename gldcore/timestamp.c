@@ -35,6 +35,7 @@
 #include "output.h"
 #include "globals.h"
 #include "lock.h"
+#include "pthread.h"
 
 #ifndef WIN32
 	#define _tzname tzname
@@ -63,11 +64,58 @@ static char *dow[] = {"Sun","Mon","Tue","Wed","Thu","Fri","Sat"};
 #define DOW0 (4) /* 1/1/1970 is a Thursday (day 4) */
 
 static int tzvalid=0;
+static unsigned int tzgeneration=0; /* incremented each time the timezone rules change */
 static TIMESTAMP tszero[1000] = {-1}; /* zero timestamp offset for each year */
+static pthread_once_t tszero_once = PTHREAD_ONCE_INIT;
 static TIMESTAMP dststart[1000], dstend[1000];
+static char dstwrap[1000]; /* DST starts and ends in different years (southern hemisphere) */
 static TIMESTAMP tzoffset;
 static char current_tzname[64], tzstd[32], tzdst[32];
 
+/* first day of each month from Jan 1 for normal and leap years */
+static unsigned short monthstart[2][13] = {
+	{0,31,59,90,120,151,181,212,243,273,304,334,365},
+	{0,31,60,91,121,152,182,213,244,274,305,335,366},
+};
+
+/* last conversions done by each thread, which usually repeat for every object at the same clock */
+typedef struct s_tscache {
+	unsigned int tzgeneration; /* timezone rules used for the cached values */
+	TIMESTAMP ts; /* last timestamp converted by local_datetime() */
+	DATETIME dt; /* result of the last local_datetime() */
+	DATETIME str_dt; /* last datetime formatted by strdatetime() */
+	int str_format; /* date format used for str */
+	int str_len; /* length of str, 0 if none */
+	char str[64]; /* result of the last strdatetime() */
+} TSCACHE;
+static pthread_key_t tscache_key;
+static pthread_once_t tscache_once = PTHREAD_ONCE_INIT;
+
+static void tscache_init(void)
+{
+	pthread_key_create(&tscache_key,free);
+}
+
+/** Get the conversion cache of the calling thread
+	@return the cache, or NULL if none could be allocated
+ **/
+static TSCACHE *tscache_get(void)
+{
+	TSCACHE *cache;
+	pthread_once(&tscache_once,tscache_init);
+	cache = (TSCACHE*)pthread_getspecific(tscache_key);
+	if ( cache==NULL )
+	{
+		cache = (TSCACHE*)calloc(1,sizeof(TSCACHE));
+		if ( cache!=NULL && pthread_setspecific(tscache_key,cache)!=0 )
+		{
+			free(cache);
+			cache = NULL;
+		}
+	}
+	return cache;
+}
+
 #define LOCALTIME(T) ((T)-tzoffset+(isdst((T))?3600:0))
 #define GMTIME(T) ((T)+tzoffset-(isdst((T)+tzoffset)?3600:0))
 
@@ -78,29 +126,28 @@ char *timestamp_current_timezone(void){
 	return current_tzname;
 }
 
+/* compute the zero timestamp of each year */
+static void tszero_init(void)
+{
+	TIMESTAMP ts = 0;
+	int year0 = YEAR0;
+	int n = (365 + YEAR0_ISLY) * DAY; /* n ticks in year */
+	while (ts < TS_MAX && year0 < 2969){
+		tszero[year0-YEAR0] = ts;
+		ts += n; /* add n ticks from ts */
+		year0++; /* add to year */
+		n = (ISLEAPYEAR(year0) ? 366 : 365) * DAY; /* n ticks is next year */
+	}
+}
+
 /** Determine the year of a GMT timestamp
 	Apply remainder if given
  **/
 int timestamp_year(TIMESTAMP ts, TIMESTAMP *remainder)
 {
-#ifdef USE_TS_CACHE
-	static int year = 0; /* reuse last result */
-#else
 	unsigned int year = (unsigned int)(ts/86400/365.24); /* estimate the year */
-#endif
-	int tsyear = 0;
-
-	if (tszero[0] == -1){	/* need to initialize tszero array */
-		TIMESTAMP ts = 0;
-		int year0 = YEAR0;
-		int n = (365 + YEAR0_ISLY) * DAY; /* n ticks in year */
-		while (ts < TS_MAX && year0 < 2969){
-			tszero[year0-YEAR0] = ts;
-			ts += n; /* add n ticks from ts */
-			year0++; /* add to year */
-			n = (ISLEAPYEAR(year0) ? 366 : 365) * DAY; /* n ticks is next year */
-		}
-	}
+
+	pthread_once(&tszero_once,tszero_init); /* initializes tszero array */
 
 	while(year > 0 && ts <= tszero[year]){
 		year--;
@@ -129,17 +176,13 @@ int timestamp_year(TIMESTAMP ts, TIMESTAMP *remainder)
  **/
 int isdst(TIMESTAMP t)
 {
-	int DSTstart_year, DSTend_year;
 	int year = timestamp_year(t + tzoffset, NULL) - YEAR0;
 
 	//Preliminary check to make sure something exists
 	if (dststart[year]>=0)	//If it's -1, no sense going forth
 	{
-		DSTstart_year = timestamp_year(dststart[year],NULL);
-		DSTend_year = timestamp_year(dstend[year],NULL);
-
 		//Southern hemisphere DST-oriented check
-		if (DSTstart_year != DSTend_year)
+		if (dstwrap[year])
 		{
 			//See if we're in the "late-year" DST region
 			if (dststart[year] <= t)
@@ -189,36 +232,20 @@ int isdst(TIMESTAMP t)
  **/
 int local_tzoffset(TIMESTAMP t)
 {
-#ifdef USE_TS_CACHE
-	static old_t = 0;
-	static old_tzoffset = 0;
-	if (old_t==0 || old_t!=t)
-	{
-		old_tzoffset = tzoffset + isdst(t)?3600:0;
-		old_t = t;
-	}
-	return old_tzoffset;
-#else
 	return (int)(tzoffset + (isdst(t)?3600:0));
-#endif
 }
 
 /** Converts a GMT timestamp to local datetime struct
-	Adjusts to TZ if possible
+	Adjusts to TZ if possible.  The last result of each thread is
+	reused when the same timestamp is converted again.
  **/
 int local_datetime(TIMESTAMP ts, DATETIME *dt)
 {
 
-	int64 n;
 	TIMESTAMP rem = 0;
 	TIMESTAMP local;
-	int tsyear;
-
-#ifdef USE_TS_CACHE
-	/* allow caching */
-	static TIMESTAMP old_ts =0;
-	static DATETIME old_dt;
-#endif
+	int tsyear, dst, leap, yearday;
+	TSCACHE *cache;
 
 	if( ts == TS_NEVER || ts==TS_ZERO )
 		return 0;
@@ -228,15 +255,17 @@ int local_datetime(TIMESTAMP ts, DATETIME *dt)
 		output_error("local_datetime(ts=%lli,...): invalid local_datetime request",ts);
 		return 0;
 	}
-#ifdef USE_TS_CACHE
+
 	/* check cache */
-	if (old_ts == ts && old_ts!=0)
-		memcpy(dt,&old_dt,sizeof(DATETIME));
-	else
-		old_ts = 0;
-#endif
+	cache = tscache_get();
+	if ( cache!=NULL && cache->ts==ts && cache->tzgeneration==tzgeneration )
+	{
+		memcpy(dt,&cache->dt,sizeof(DATETIME));
+		return 1;
+	}
 
-	local = LOCALTIME(ts);
+	dst = isdst(ts);
+	local = ts - tzoffset + (dst?3600:0);
 	tsyear = timestamp_year(local, &rem);
 
 	if (rem < 0)
@@ -265,42 +294,36 @@ int local_datetime(TIMESTAMP ts, DATETIME *dt)
 	dt->timestamp = ts;
 
 	/* DST? */
-	dt->is_dst = (tzvalid && isdst(ts));
+	dt->is_dst = (tzvalid && dst);
 
 	/* compute year */
 	dt->year = tsyear;
 
 	/* yearday and weekday */
-	dt->yearday = (unsigned short)(rem / DAY);
+	yearday = (int)(rem / DAY);
+	dt->yearday = (unsigned short)yearday;
 	dt->weekday = (unsigned short)((local / DAY + DOW0 + 7) % 7);
 
 	/* compute month */
-	dt->month = 0;
-	n = daysinmonth[0] * DAY;
-	while(rem >= n){
-		rem -= n; /* subtract n ticks from ts */
-		dt->month++; /* add to month */
-		if(dt->month == 12){
-			dt->month = 0;
-			++dt->year;
-		}
-		n = (daysinmonth[dt->month] + ((dt->month == 1 && ISLEAPYEAR(dt->year)) ? 1:0)) * 86400 * TS_SECOND;
-		if(n < 86400 * 28){ /**/
-			output_fatal("Breaking an infinite loop in local_datetime! (ts = %"FMT_INT64"ds", ts);
-			/*	TROUBLESHOOT
-				An internal protection against infinite loops in the time calculation
-				module has encountered a critical problem.  This is often caused by
-				an incorrectly initialized timezone system, a missing timezone specification before
-				a timestamp was used, or a missing timezone localization in your system.
-				Correct the timezone problem and try again.
-			 */
-			return 0;
-		}
+	leap = ISLEAPYEAR(dt->year) ? 1 : 0;
+	if ( yearday >= monthstart[leap][12] )
+	{
+		output_fatal("Breaking an infinite loop in local_datetime! (ts = %"FMT_INT64"ds", ts);
+		/*	TROUBLESHOOT
+			An internal protection against infinite loops in the time calculation
+			module has encountered a critical problem.  This is often caused by
+			an incorrectly initialized timezone system, a missing timezone specification before
+			a timestamp was used, or a missing timezone localization in your system.
+			Correct the timezone problem and try again.
+		 */
+		return 0;
 	}
-	dt->month++; /* Jan=1 */
+	dt->month = 1; /* Jan=1 */
+	while ( yearday >= monthstart[leap][dt->month] )
+		dt->month++;
 
 	/* compute day */
-	dt->day = (unsigned short)(rem / DAY + 1);
+	dt->day = (unsigned short)(yearday - monthstart[leap][dt->month-1] + 1);
 	rem %= DAY;
 
 	/* compute hour */
@@ -322,13 +345,15 @@ int local_datetime(TIMESTAMP ts, DATETIME *dt)
 	strncpy(dt->tz, tzvalid ? (dt->is_dst ? tzdst : tzstd) : "GMT", sizeof(dt->tz));
 
 	/* timezone offset in seconds */
-	dt->tzoffset = (int)(tzoffset - (isdst(dt->timestamp)?3600:0));
+	dt->tzoffset = (int)(tzoffset - (dst?3600:0));
 
-#ifdef USE_TS_CACHE
 	/* cache result */
-	old_ts = ts;
-	memcpy(&old_dt,dt,sizeof(old_dt));
-#endif
+	if ( cache!=NULL )
+	{
+		cache->ts = ts;
+		cache->tzgeneration = tzgeneration;
+		memcpy(&cache->dt,dt,sizeof(DATETIME));
+	}
 	return 1;
 }
 
@@ -344,7 +369,7 @@ TIMESTAMP mkdatetime(DATETIME *dt)
 	}
 
 	/* start with year */
-	timestamp_year(0,NULL); /* initializes tszero */
+	pthread_once(&tszero_once,tszero_init); /* initializes tszero */
 	if(dt->year < YEAR0 || dt->year >= YEAR0 + sizeof(tszero) / sizeof(tszero[0]) ){
 		return TS_INVALID;
 	}
@@ -406,6 +431,8 @@ TIMESTAMP mkdatetime(DATETIME *dt)
 int strdatetime(DATETIME *t, char *buffer, int size){
 	int len;
 	char tbuffer[1024];
+	TSCACHE *cache;
+	int cached = 0;
 
 	if(t == NULL){
 		output_error("strdatetime: null DATETIME pointer passed in");
@@ -417,8 +444,20 @@ int strdatetime(DATETIME *t, char *buffer, int size){
 		return 0;
 	}
 
+	/* reuse the last string of this thread when the same time is formatted again */
+	cache = tscache_get();
+	if ( cache!=NULL && cache->str_len>0 && cache->str_format==global_dateformat
+		&& cache->str_dt.year==t->year && cache->str_dt.month==t->month && cache->str_dt.day==t->day
+		&& cache->str_dt.hour==t->hour && cache->str_dt.minute==t->minute && cache->str_dt.second==t->second
+		&& cache->str_dt.nanosecond==t->nanosecond && strncmp(cache->str_dt.tz,t->tz,sizeof(t->tz))==0 )
+	{
+		len = cache->str_len;
+		strcpy(tbuffer, cache->str);
+		cached = 1;
+	}
+
 	/* choose best format */
-	if(global_dateformat == DF_ISO){
+	else if(global_dateformat == DF_ISO){
 		if(t->nanosecond != 0){
 			len = sprintf(tbuffer, "%04d-%02d-%02d %02d:%02d:%02d.%09d %s",
 				t->year, t->month, t->day, t->hour, t->minute, t->second, t->nanosecond, t->tz);
@@ -451,6 +490,14 @@ int strdatetime(DATETIME *t, char *buffer, int size){
 		 */
 	}
 
+	if ( cache!=NULL && !cached && len<(int)sizeof(cache->str) )
+	{
+		memcpy(&cache->str_dt,t,sizeof(DATETIME));
+		cache->str_format = global_dateformat;
+		cache->str_len = len;
+		strcpy(cache->str,tbuffer);
+	}
+
 	if(len < size){
 		strncpy(buffer, tbuffer, len+1);
 		return len;
@@ -699,15 +746,20 @@ void set_tzspec(int year, char *tzname, SPEC *pStart, SPEC *pEnd){
 			{
 				dststart[y] = compute_dstevent(y + YEAR0, pStart, tzoffset);
 				dstend[y] = compute_dstevent(y + YEAR0 + 1, pEnd, tzoffset) - 1;
+				dstwrap[y] = 1;
 			}
 			else	//"Standard" northern hemisphere rules
 			{
 				dststart[y] = compute_dstevent(y + YEAR0, pStart, tzoffset);
 				dstend[y] = compute_dstevent(y + YEAR0, pEnd, tzoffset) - 1;
+				dstwrap[y] = 0;
 			}
 		}
 		else
+		{
 			dststart[y] = dstend[y] = -1;
+			dstwrap[y] = 0;
+		}
 	}
 }
 
@@ -760,6 +812,7 @@ void load_tzspecs(char *tz){
 	// zero previous DST start/end times
 	for (y = 0; y < sizeof(tszero) / sizeof(tszero[0]); y++){
 		dststart[y] = dstend[y] = -1;
+		dstwrap[y] = 0;
 	}
 
 	while(fgets(buffer,sizeof(buffer),fp)){
@@ -832,6 +885,7 @@ void load_tzspecs(char *tz){
 	}
 
 	fclose(fp);
+	tzgeneration++;
 	tzvalid = 1;
 }
 
@@ -393,12 +393,19 @@ TIMESTAMP transform_apply(TIMESTAMP t1, TRANSFORM *xform, double *source)
 {
 	char buffer[1024];
 	TIMESTAMP t2;
+	char last[sizeof(complex)];
+	uint32 size;
 	switch (xform->function_type) {
 	case XT_LINEAR:
 #ifdef _DEBUG
 		output_debug("running linear transform for %s:%s", object_name(xform->target_obj,buffer,sizeof(buffer)), xform->target_prop->name);
 #endif
+		size = property_size(xform->target_prop);
+		if ( size>sizeof(last) ) size = sizeof(last);
+		memcpy(last,xform->target,size);
 		cast_from_double(xform->target_prop->ptype, xform->target, (source?(*source):(*(xform->source))) * xform->scale + xform->bias);
+		if ( memcmp(last,xform->target,size)!=0 )
+			exec_wake(xform->target_obj);
 		t2 = TS_NEVER;
 		break;
 	case XT_EXTERNAL:
@@ -406,6 +413,7 @@ TIMESTAMP transform_apply(TIMESTAMP t1, TRANSFORM *xform, double *source)
 		output_debug("running external transform for %s:%s", object_name(xform->target_obj,buffer,sizeof(buffer)), xform->target_prop->name);
 #endif
 		xform->retval = (*xform->function)(xform->nlhs, xform->plhs, xform->nrhs, xform->prhs);
+		exec_wake(xform->target_obj);
 		if ( xform->retval==-1 ) /* error */
 			t2 = TS_ZERO;
 		else if ( xform->retval==0 ) /* no timer */
@@ -418,7 +426,10 @@ TIMESTAMP transform_apply(TIMESTAMP t1, TRANSFORM *xform, double *source)
 		output_debug("running filter transform for %s:%s", object_name(xform->target_obj,buffer,sizeof(buffer)), xform->target_prop->name);
 #endif
 		if ( xform->t2 <= t1 )
+		{
 			xform->t2 = apply_filter(xform->tf,xform->source,xform->x,xform->y,t1);
+			exec_wake(xform->target_obj);
+		}
 		t2 = xform->t2;
 		break;
 	default:
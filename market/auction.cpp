@@ -11,11 +11,18 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <algorithm>
 
 #include "gridlabd.h"
 #include "auction.h"
 #include "stubauction.h"
 
+#ifdef WIN32
+#define atomic_increment(ptr) InterlockedIncrement((volatile long*)(ptr))
+#else
+#define atomic_increment(ptr) __sync_add_and_fetch(ptr,1)
+#endif
+
 CLASS *auction::oclass = NULL;
 auction *auction::defaults = NULL;
 STATISTIC *auction::stats = NULL;
@@ -223,6 +230,12 @@ int auction::create(void)
 	warmup = 1;
 	market_id = 1;
 	clearing_scalar = 0.5;
+	stage = new BIDSTAGE[MAXBIDSTAGES];
+	memset(stage,0,sizeof(BIDSTAGE)*MAXBIDSTAGES);
+	for ( unsigned int n=0 ; n<MAXBIDSTAGES ; n++ )
+		stage[n].bid_count = new std::map<KEY,unsigned int>;
+	stage_order = new std::vector< std::pair<const STAGEDBID*,const char*> >;
+	stage_serial = 0;
 	/* process dynamic statistics */
 	if(statistic_check == -1){
 		int rv;
@@ -869,6 +882,9 @@ void auction::clear_market(void)
 
 	memset(&unresponsive, 0, sizeof(unresponsive));
 
+	/* collect the bids staged since the last clearing */
+	merge_bids();
+
 	/* handle unbidding capacity */
 	if(capacity_reference_property != NULL && special_mode != MD_FIXED_BUYER){
 		char name[256];
@@ -919,7 +935,7 @@ void auction::clear_market(void)
 		}
 		else if (unresponsive.quantity > 0.001)
 		{
-			submit_nolock(unresponsive.from, -unresponsive.quantity, unresponsive.price, unresponsive.bid_id, BS_ON, false, market_id);
+			submit_nolock(unresponsive.from, -unresponsive.quantity, unresponsive.price, unresponsive.bid_id, BS_ON, false, market_id, gl_globalclock);
 			gl_verbose("capacity_reference_property %s has %.3f unresponsive load", gl_name(linkref,name,sizeof(name)), -unresponsive.quantity);
 		}
 	}
@@ -942,7 +958,7 @@ void auction::clear_market(void)
 					sprintf(msg, "capacity_reference_property %s uses units of %s and is incompatible with auction units (%s)", capacity_reference_property->name, capacity_reference_property->unit->name, unit.get_string());
 					throw msg;
 				} else {
-					submit_nolock((char *)OBJECTHDR(this)->name, max_capacity_reference_bid_quantity, capacity_reference_bid_price, (int64)OBJECTHDR(this)->id, BS_ON, false, market_id);
+					submit_nolock((char *)OBJECTHDR(this)->name, max_capacity_reference_bid_quantity, capacity_reference_bid_price, (int64)OBJECTHDR(this)->id, BS_ON, false, market_id, gl_globalclock);
 					if (verbose) gl_output("Capacity reference object: %s bids %.2f at %.2f", capacity_reference_object->name, max_capacity_reference_bid_quantity, capacity_reference_bid_price);
 				}
 			}
@@ -1060,7 +1076,7 @@ void auction::clear_market(void)
 				gl_warning("Seller-only auction was given purchasing bids");
 			}
 			asks.clear();
-			submit((char *)OBJECTHDR(this)->name, -fixed_quantity, fixed_price, (int64)OBJECTHDR(this)->id, BS_ON, false, market_id);
+			submit_nolock((char *)OBJECTHDR(this)->name, -fixed_quantity, fixed_price, (int64)OBJECTHDR(this)->id, BS_ON, false, market_id, gl_globalclock);
 			break;
 		case MD_FIXED_BUYER:
 			asks.sort(true);
@@ -1068,7 +1084,7 @@ void auction::clear_market(void)
 				gl_warning("Buyer-only auction was given offering bids");
 			}
 			offers.clear();
-			submit((char *)OBJECTHDR(this)->name, fixed_quantity, fixed_price, (int64)OBJECTHDR(this)->id, BS_ON, false, market_id);
+			submit_nolock((char *)OBJECTHDR(this)->name, fixed_quantity, fixed_price, (int64)OBJECTHDR(this)->id, BS_ON, false, market_id, gl_globalclock);
 			break;
 		case MD_NONE:
 			offers.sort(false);
@@ -1443,7 +1459,7 @@ void auction::clear_market(void)
 	}
 }
 
-void auction::record_bid(char *from, double quantity, double real_price, BIDDERSTATE state){
+void auction::record_bid(char *from, double quantity, double real_price, BIDDERSTATE state, TIMESTAMP submit_time){
 	char name_buffer[256];
 	char *unkState = "unknown";
 	char *offState = "off";
@@ -1454,7 +1470,6 @@ void auction::record_bid(char *from, double quantity, double real_price, BIDDERS
 	char *pState;
 	char *tStr;
 	DATETIME dt;
-	TIMESTAMP submit_time = gl_globalclock;
 	if(trans_file){ // copied from version below
 		if((this->trans_log_max <= 0) || (trans_log_count > 0)){
 			gl_localtime(submit_time,&dt);
@@ -1481,15 +1496,171 @@ void auction::record_bid(char *from, double quantity, double real_price, BIDDERS
 	}
 }
 
+/* Bids are not added to the curves when they are submitted.  Each bid is checked
+   and written to the stage of its bid id so bidders running in parallel rarely
+   contend for a lock, and the stages are merged into the curves when the market
+   clears.
+ */
 int auction::submit(char *from, double quantity, double real_price, KEY key, BIDDERSTATE state, bool rebid, int64 mkt_id)
 {
-	gld_wlock lock(my());
-	return submit_nolock(from,quantity,real_price,key,state, rebid, mkt_id);
+	BIDSTAGE *my_stage = stage + (unsigned int)((unsigned int64)key%MAXBIDSTAGES);
+	char myname[64];
+	if ( from==NULL ) from = "";
+	size_t len = strlen(from)+1;
+
+	if ( mkt_id>market_id )
+	{
+		gl_error("%s: bidding into future markets is not yet supported", from);
+		/* TROUBLESHOOT
+			Tracking bids input markets other than the immediately open one will be supported in the future.
+			The bid has been rejected.
+			*/
+		return 0;
+	}
+	else if ( mkt_id<market_id )
+	{
+		if ( verbose )
+			gl_output(" ... %s receives %s from object %s for a previously cleared market",
+				gl_name(OBJECTHDR(this),myname,sizeof(myname)),quantity<0?"ask":"offer",from);
+		return 1;
+	}
+
+	::wlock(&my_stage->lock);
+
+	/* a rebid must identify at most one bid in the market */
+	if ( my_stage->market_id!=mkt_id )
+	{
+		my_stage->bid_count->clear();
+		my_stage->market_id = mkt_id;
+	}
+	unsigned int &n_bids = (*my_stage->bid_count)[key];
+	if ( rebid && n_bids>1 )
+	{
+		::wunlock(&my_stage->lock);
+		gl_error("%s: there is more than one bid with the bid id %" FMT_INT64 "d in market %" FMT_INT64 "d", from, key, mkt_id);
+		/* TROUBLESHOOT
+			A bid was flagged as a rebid but the bid id given identifies more than one bid in the
+			current market, so it is not known which bid is replaced.  The rebid has been rejected.
+			Make sure each bidder uses a bid id that no other bidder uses.
+		 */
+		return 0;
+	}
+
+	STAGEBUFFER *buf = my_stage->buffer + my_stage->current;
+	if ( buf->n_bids==buf->max_bids )
+	{
+		unsigned int max_bids = buf->max_bids>0 ? buf->max_bids*2 : 64;
+		STAGEDBID *bid = (STAGEDBID*)realloc(buf->bid,sizeof(STAGEDBID)*max_bids);
+		if ( bid==NULL )
+		{
+			::wunlock(&my_stage->lock);
+			gl_error("auction::submit(): unable to grow bid stage");
+			/* TROUBLESHOOT
+				The auction could not allocate memory to hold a bid until the next market clearing.
+				The bid has been rejected.  Reduce the size of the model or free up memory.
+			 */
+			return 0;
+		}
+		buf->bid = bid;
+		buf->max_bids = max_bids;
+	}
+	if ( buf->n_name+len>buf->max_name )
+	{
+		size_t max_name = buf->max_name>0 ? buf->max_name*2 : 1024;
+		while ( buf->n_name+len>max_name ) max_name *= 2;
+		char *name = (char*)realloc(buf->name,max_name);
+		if ( name==NULL )
+		{
+			::wunlock(&my_stage->lock);
+			gl_error("auction::submit(): unable to grow bid stage");
+			return 0;
+		}
+		buf->name = name;
+		buf->max_name = max_name;
+	}
+	STAGEDBID *bid = buf->bid + buf->n_bids++;
+	bid->from = buf->n_name;
+	memcpy(buf->name+buf->n_name,from,len);
+	buf->n_name += len;
+	bid->quantity = quantity;
+	bid->price = real_price;
+	bid->key = key;
+	bid->state = state;
+	bid->rebid = rebid;
+	bid->market_id = mkt_id;
+	bid->submit_time = gl_globalclock;
+	bid->serial = atomic_increment(&stage_serial);
+
+	/* a new bid, or a rebid for which there is no bid yet, adds a bid to the market and a zero rebid removes it */
+	if ( quantity!=0 && (!rebid || n_bids==0) )
+		n_bids++;
+	else if ( quantity==0 && rebid )
+		n_bids = 0;
+	::wunlock(&my_stage->lock);
+	return 1;
+}
+
+/* Orders staged bids by bid id and bidder name, which does not depend on which thread
+   received them.  The serial number only decides between bids from the same bidder,
+   which are always submitted one after the other.
+ */
+class staged_bid_order {
+public:
+	inline bool operator()(const std::pair<const STAGEDBID*,const char*> &a, const std::pair<const STAGEDBID*,const char*> &b) const
+	{
+		if ( a.first->key!=b.first->key )
+			return a.first->key<b.first->key;
+		int c = strcmp(a.second,b.second);
+		if ( c!=0 )
+			return c<0;
+		return a.first->serial<b.first->serial;
+	}
+};
+
+void auction::merge_bids(void)
+{
+	// take the filled buffer from each stage and give it an empty one
+	unsigned int n, n_bids = 0;
+	STAGEBUFFER *filled[MAXBIDSTAGES];
+	for ( n=0 ; n<MAXBIDSTAGES ; n++ )
+	{
+		BIDSTAGE *s = stage+n;
+		::wlock(&s->lock);
+		filled[n] = s->buffer + s->current;
+		s->current ^= 1;
+		s->buffer[s->current].n_bids = 0;
+		s->buffer[s->current].n_name = 0;
+		::wunlock(&s->lock);
+		n_bids += filled[n]->n_bids;
+	}
+	if ( n_bids==0 )
+		return;
+
+	// put the bids in an order that does not depend on the thread that received them
+	std::vector< std::pair<const STAGEDBID*,const char*> > &order = *stage_order;
+	order.clear();
+	order.reserve(n_bids);
+	for ( n=0 ; n<MAXBIDSTAGES ; n++ )
+	{
+		for ( unsigned int m=0 ; m<filled[n]->n_bids ; m++ )
+		{
+			STAGEDBID *bid = filled[n]->bid+m;
+			order.push_back(std::pair<const STAGEDBID*,const char*>(bid,filled[n]->name+bid->from));
+		}
+	}
+	std::sort(order.begin(),order.end(),staged_bid_order());
+
+	// the names stay in the buffer until the next merge so the curves may refer to them
+	for ( std::vector< std::pair<const STAGEDBID*,const char*> >::iterator i=order.begin() ; i!=order.end() ; i++ )
+	{
+		const STAGEDBID *bid = i->first;
+		submit_nolock((char*)i->second,bid->quantity,bid->price,bid->key,bid->state,bid->rebid,bid->market_id,bid->submit_time);
+	}
 }
-int auction::submit_nolock(char *from, double quantity, double real_price, KEY key, BIDDERSTATE state, bool rebid, int64 mkt_id)
+
+int auction::submit_nolock(char *from, double quantity, double real_price, KEY key, BIDDERSTATE state, bool rebid, int64 mkt_id, TIMESTAMP submit_time)
 {
 	char myname[64];
-	TIMESTAMP submit_time = gl_globalclock;
 	DATETIME dt;
 	double price;
 	gl_localtime(submit_time,&dt);
@@ -1532,6 +1703,7 @@ int auction::submit_nolock(char *from, double quantity, double real_price, KEY k
 		/* TROUBLESHOOT
 			Tracking bids input markets other than the immediately open one will be supported in the future.
 			*/
+		return 0;
 	}
 	else if (mkt_id == market_id && rebid == true) // resubmit
 	{
@@ -1563,7 +1735,7 @@ int auction::submit_nolock(char *from, double quantity, double real_price, KEY k
 			return 0;
 		}
 
-		record_bid(from, quantity, real_price, state);
+		record_bid(from, quantity, real_price, state, submit_time);
 		return 1;
 	} else if (mkt_id == market_id && rebid == false){
 		char myname[64];
@@ -1588,7 +1760,7 @@ int auction::submit_nolock(char *from, double quantity, double real_price, KEY k
 		biddef.bid_type = (quantity > 0 ? BID_SELL : BID_BUY);
 		write_bid(out, biddef.market, biddef.bid, biddef.bid_type);
 		// interject transaction log file writing here
-		record_bid(from, quantity, real_price, state);
+		record_bid(from, quantity, real_price, state, submit_time);
 		biddef.raw = out;
 		return 1;
 	} else { // key between cleared market and 'market_id' ~ points to an old market
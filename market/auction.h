@@ -11,6 +11,8 @@
 #define _auction_H
 
 #include <stdarg.h>
+#include <vector>
+#include <map>
 #include "gridlabd.h"
 #include "market.h"
 #include "bid.h"
@@ -45,6 +47,46 @@ typedef struct s_market_frame{
 	double *statistics;
 } MARKETFRAME;
 
+#define MAXBIDSTAGES 64 /**< number of bid staging buffers per auction */
+
+/** Bid received by auction::submit() and held until the next clearing */
+typedef struct s_staged_bid {
+	size_t from;			/**< offset of bidder name in the buffer name pool */
+	double quantity;		/**< bid quantity as submitted */
+	double price;			/**< bid price as submitted */
+	KEY key;				/**< bid id */
+	BIDDERSTATE state;		/**< bidder state */
+	bool rebid;				/**< bid replaces an earlier bid */
+	int64 market_id;		/**< market the bid is for */
+	TIMESTAMP submit_time;	/**< time of submission */
+	unsigned int serial;	/**< submission order (only compared between bids of the same bidder) */
+} STAGEDBID;
+
+/** Buffer of staged bids */
+typedef struct s_stage_buffer {
+	STAGEDBID *bid;			/**< staged bids */
+	unsigned int n_bids;	/**< number of staged bids */
+	unsigned int max_bids;	/**< capacity of bid */
+	char *name;				/**< pool of bidder names */
+	size_t n_name;			/**< bytes used in name pool */
+	size_t max_name;		/**< capacity of name pool */
+} STAGEBUFFER;
+
+/** Bid staging area
+
+	Bids are staged by bid id, so every bid from a bidder goes to the same
+	stage and the stage lock covers both the validation of the bid against
+	the earlier bids with that id and the staging itself.  Bids are written
+	to buffer[current] while the merge reads from the other buffer.
+ **/
+typedef struct s_bid_stage {
+	unsigned int lock;			/**< stage lock */
+	unsigned int current;		/**< buffer receiving bids */
+	STAGEBUFFER buffer[2];		/**< receiving and merging buffers */
+	int64 market_id;			/**< market the bid counts are for */
+	std::map<KEY,unsigned int> *bid_count; /**< number of bids in the market for each bid id */
+} BIDSTAGE;
+
 typedef enum {
 	AM_NONE=0,
 	AM_DENY=1,
@@ -72,12 +114,15 @@ private:
 	int push_market_frame(TIMESTAMP t1);
 	int check_next_market(TIMESTAMP t1);
 	TIMESTAMP pop_market_frame(TIMESTAMP t1);
-	void record_bid(char *from, double quantity, double real_price, BIDDERSTATE state);
+	void record_bid(char *from, double quantity, double real_price, BIDDERSTATE state, TIMESTAMP submit_time);
 	void record_curve(double, double);
 	// variables
 	curve asks;			/**< demand curve */ 
 	curve offers;		/**< supply curve */
 	int retry;
+	BIDSTAGE *stage;	/**< bid staging areas */
+	std::vector< std::pair<const STAGEDBID*,const char*> > *stage_order; /**< merge order of staged bids */
+	unsigned int stage_serial; /**< counter used to order staged bids */
 	BID next;			/**< next clearing result */
 protected:
 public:
@@ -156,7 +201,8 @@ private:
 public:
 	int submit(char *from, double quantity, double real_price, KEY key, BIDDERSTATE state, bool rebid, int64 mkt_id);
 private:
-	int submit_nolock(char *from, double quantity, double real_price, KEY key, BIDDERSTATE state, bool rebid, int64 mkt_id);
+	int submit_nolock(char *from, double quantity, double real_price, KEY key, BIDDERSTATE state, bool rebid, int64 mkt_id, TIMESTAMP submit_time);
+	void merge_bids(void);
 public:
 	TIMESTAMP nextclear() const;
 private:
@@ -13,7 +13,7 @@ CLASS* controller::oclass = NULL;
 controller::controller(MODULE *module){
 	if (oclass==NULL)
 	{
-		oclass = gl_register_class(module,"controller",sizeof(controller),PC_PRETOPDOWN|PC_BOTTOMUP|PC_POSTTOPDOWN|PC_AUTOLOCK);
+		oclass = gl_register_class(module,"controller",sizeof(controller),PC_PRETOPDOWN|PC_BOTTOMUP|PC_POSTTOPDOWN|PC_AUTOLOCK|PC_UNSAFE_INIT);
 		if (oclass==NULL)
 			throw "unable to register class controller";
 		else
@@ -10,6 +10,7 @@ curve::curve(void)
 	bids = NULL;
 	keys = NULL;
 	bid_ids = NULL;
+	scratch = NULL;
 	n_bids = 0;
 	total = 0;
 }
@@ -19,6 +20,7 @@ curve::~curve(void)
 	delete [] bids;
 	delete [] keys;
 	delete [] bid_ids;
+	delete [] scratch;
 }
 
 void curve::clear(void)
@@ -34,31 +36,36 @@ BID *curve::getbid(KEY n)
 	return bids+keys[n];
 }
 
-KEY curve::submit(BID *bid)
+/* The bid list keeps its storage when the curve is cleared, so once it has
+   grown to the number of bids in a market no further allocation is needed. */
+void curve::grow(void)
 {
-	if (len==0) // create the bid list
-	{
-		len = 8;
-		bids = new BID[len];
-		keys = new KEY[len];
-		bid_ids = new KEY[len];
-	}
-	else if (n_bids==len) // grow the bid list
+	int newlen = len==0 ? 8 : len*2;
+	BID *newbids = new BID[newlen];
+	KEY *newkeys = new KEY[newlen];
+	KEY *newbid_ids = new KEY[newlen];
+	KEY *newscratch = new KEY[newlen];
+	if (len>0)
 	{
-		BID *newbids = new BID[len*2];
-		KEY *newkeys = new KEY[len*2];
-		KEY *newbid_ids = new KEY[len*2];
 		memcpy(newbids,bids,len*sizeof(BID));
 		memcpy(newkeys,keys,len*sizeof(KEY));
 		memcpy(newbid_ids,bid_ids,len*sizeof(KEY));
-		delete[] bids;
-		delete[] keys;
-		delete[] bid_ids;
-		bids = newbids;
-		keys = newkeys;
-		bid_ids = newbid_ids;
-		len*=2;
 	}
+	delete[] bids;
+	delete[] keys;
+	delete[] bid_ids;
+	delete[] scratch;
+	bids = newbids;
+	keys = newkeys;
+	bid_ids = newbid_ids;
+	scratch = newscratch;
+	len = newlen;
+}
+
+KEY curve::submit(BID *bid)
+{
+	if (n_bids==len)
+		grow();
 	keys[n_bids] = n_bids;
 	bid_ids[n_bids] = bid->bid_id;
 	BID *next = bids + n_bids;
@@ -95,29 +102,8 @@ KEY curve::resubmit(BID *bid)
 	}
 	if(bid_hitcount == 0) {
 		gl_warning("The bid was flagged as a rebid but there is no bid in the bid curve with the bid id provided. Submitting the bid.");
-		if (len==0) // create the bid list
-		{
-			len = 8;
-			bids = new BID[len];
-			keys = new KEY[len];
-			bid_ids = new KEY[len];
-		}
-		else if (n_bids==len) // grow the bid list
-		{
-			BID *newbids = new BID[len*2];
-			KEY *newkeys = new KEY[len*2];
-			KEY *newbid_ids = new KEY[len*2];
-			memcpy(newbids,bids,len*sizeof(BID));
-			memcpy(newkeys,keys,len*sizeof(KEY));
-			memcpy(newbid_ids,bid_ids,len*sizeof(KEY));
-			delete[] bids;
-			delete[] keys;
-			delete[] bid_ids;
-			bids = newbids;
-			keys = newkeys;
-			bid_ids = newbid_ids;
-			len*=2;
-		}
+		if (n_bids==len)
+			grow();
 		keys[n_bids] = n_bids;
 		bid_ids[n_bids] = bid->bid_id;
 		BID *next = bids + n_bids;
@@ -195,27 +181,12 @@ int curve::remove_bid(KEY bid_id)
 			break;
 		}
 		total -= old->quantity;
-		/* copy all other bids into new curve */
-		BID *newbids = new BID[len];
-		KEY *newkeys = new KEY[len];
-		KEY *newbid_ids = new KEY[len];
-		for(i = 0; i <= len; i++){
-			if(i < bid_index){
-				newkeys[i] = keys[i];
-				newbids[i] = bids[i];
-				newbid_ids[i] = bid_ids[i];
-			} else if(i>bid_index){
-				newkeys[i-1] = keys[i];
-				newbids[i-1] = bids[i];
-				newbid_ids[i-1] = bid_ids[i];
-			}
+		/* shift the remaining bids down (keys are not sorted until the market clears) */
+		memmove(bids+bid_index,bids+bid_index+1,(n_bids-bid_index-1)*sizeof(BID));
+		memmove(bid_ids+bid_index,bid_ids+bid_index+1,(n_bids-bid_index-1)*sizeof(KEY));
+		for(i = bid_index; i < n_bids-1; i++){
+			keys[i] = i;
 		}
-		delete[] bids;
-		delete[] keys;
-		delete[] bid_ids;
-		bids = newbids;
-		keys = newkeys;
-		bid_ids = newbid_ids;
 		n_bids--;
 		return n_bids;
 	} else {
@@ -224,20 +195,19 @@ int curve::remove_bid(KEY bid_id)
 }
 void curve::sort(bool reverse)
 {
-	sort(bids, keys, n_bids, reverse);
+	sort(bids, keys, scratch, n_bids, reverse);
 }
 
-void curve::sort(BID *list, KEY *key, const int len, const bool reverse)
+void curve::sort(BID *list, KEY *key, KEY *scratch, const int len, const bool reverse)
 {
 	//merge sort
 	if (len>1)
 	{
 		int split = len/2;
 		KEY *a = key, *b = key+split;
-		if (split>1) sort(list,a,split,reverse);
-		if (len-split>1) sort(list,b,len-split,reverse);
-		KEY *res = new KEY[len];
-		KEY *p = res;
+		if (split>1) sort(list,a,scratch,split,reverse);
+		if (len-split>1) sort(list,b,scratch,len-split,reverse);
+		KEY *p = scratch;
 		do {
 			bool altb = list[*a].price < list[*b].price;
 			if ((reverse && !altb) || (!reverse && altb))
@@ -249,8 +219,7 @@ void curve::sort(BID *list, KEY *key, const int len, const bool reverse)
 			*p++ = *a++;
 		while (b<key+len)
 			*p++ = *b++;
-		memcpy(key,res,sizeof(KEY)*len);
-		delete[] res;
+		memcpy(key,scratch,sizeof(KEY)*len);
 	}
 }
 
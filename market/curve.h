@@ -13,11 +13,13 @@ private:
 	BID *bids;
 	KEY *keys;
 	KEY *bid_ids;
+	KEY *scratch;	/**< merge buffer used by sort() */
 	double total;
 	double total_on;
 	double total_off;
 private:
-	static void sort(BID *list, KEY *keys, const int len, const bool reverse);
+	void grow(void);
+	static void sort(BID *list, KEY *keys, KEY *scratch, const int len, const bool reverse);
 public:
 	curve(void);
 	~curve(void);
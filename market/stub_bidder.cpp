@@ -20,6 +20,7 @@ stub_bidder::stub_bidder(MODULE *module)
 				PT_double, "price", PADDR(price),
 				PT_double, "quantity", PADDR(quantity),
 				PT_int64, "bid_id", PADDR(bid_id),
+				PT_int64, "market_offset", PADDR(market_offset),
 				NULL)<1) 
 			GL_THROW("unable to publish properties in %s",__FILE__);
 		
@@ -33,6 +34,7 @@ int stub_bidder::create()
 	controller_bid.state = BS_UNKNOWN;
 	controller_bid.bid_accepted = true;
 	bid_id = -1;
+	market_offset = 0;
 	return SUCCESS;
 }
 
@@ -81,7 +83,7 @@ TIMESTAMP stub_bidder::sync(TIMESTAMP t0, TIMESTAMP t1)
 			controller_bid.rebid = false;
 			lastmkt_id = *thismkt_id;
 		}
-		controller_bid.market_id = lastmkt_id;
+		controller_bid.market_id = lastmkt_id + market_offset;
 		controller_bid.price = price;
 		if(role == BUYER){
 			controller_bid.quantity = -quantity;
@@ -28,6 +28,7 @@ public:
 	double quantity;
 	int64 *thismkt_id;
 	int64 bid_id;
+	int64 market_offset; // added to the market id of each bid (used to test rejected bids)
 	BIDINFO controller_bid;
 private:
 	int64 next_t;
@@ -65,12 +65,15 @@ database::database(MODULE *module)
 				PT_KEYWORD,"NOCREATE",(int64)DBO_NOCREATE,PT_DESCRIPTION,"prevent automatic creation of non-existent schemas",
 				PT_KEYWORD,"NEWDB",(int64)DBO_DROPSCHEMA,PT_DESCRIPTION,"destroy existing schemas before use them (risky)",
 				PT_KEYWORD,"OVERWRITE",(int64)DBO_OVERWRITE,PT_DESCRIPTION,"destroy existing files before output dump/backup results (risky)",
+				PT_KEYWORD,"ASYNCFLUSH",(int64)DBO_ASYNCFLUSH,PT_DESCRIPTION,"send buffered recorder inserts from a separate flush thread",
 			PT_char1024,"on_init",get_on_init_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"SQL script to run when initializing",
 			PT_char1024,"on_sync",get_on_sync_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"SQL script to run when synchronizing",
 			PT_char1024,"on_term",get_on_term_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"SQL script to run when terminating",
 			PT_double,"sync_interval[s]",get_sync_interval_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"interval at which on_sync is called",
 			PT_int32,"tz_offset",get_tz_offset_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"timezone offset used by timestamp in the database",
 			PT_bool,"uses_dst",get_uses_dst_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"timestamps in database include summer time offsets",
+			PT_int32,"batch_size",get_batch_size_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"number of recorder rows sent in each INSERT (0 or 1 sends each row immediately)",
+			PT_double,"flush_interval[s]",get_flush_interval_offset(),PT_ACCESS,PA_PUBLIC,PT_DESCRIPTION,"maximum simulation time recorder rows are held before being sent (0 for no limit)",
 			NULL)<1){
 				char msg[256];
 				sprintf(msg, "unable to publish properties in %s",__FILE__);
@@ -92,6 +95,9 @@ int database::create(void)
 	port = default_port;
 	strcpy(socketname,default_socketname);
 	clientflags = default_clientflags;
+	flush_mysql = NULL;
+	flush_queue = NULL;
+	flush_running = false;
 	last_database = this;
 
 	// term list
@@ -172,11 +178,16 @@ int database::init(OBJECT *parent)
 		if ( res<=0 )
 			exception("on_init script '%s' failed at line %d: %s", get_on_init(), -res, get_last_error());
 	}
+
+	// start flush thread
+	if ( get_options()&DBO_ASYNCFLUSH )
+		start_flush();
 	return 1;
 }
 
 void database::term(void)
 {	
+	stop_flush();
 	if ( strcmp(get_on_term(),"")!=0 )
 	{
 		gl_verbose("%s running on_term script '%s'", get_name(), get_on_term());
@@ -367,6 +378,119 @@ bool database::query(char *fmt,...)
 	return true;
 }
 
+bool database::query_buffer(const char *command, size_t len)
+{
+	// query mysql without the length limit of query()
+	gl_debug("%s->query_buffer[%.*s] (%u bytes)", get_name(), len<256?(int)len:256, command, (unsigned int)len);
+	check_schema();
+	if ( mysql_real_query(mysql,command,(unsigned long)len)!=0 )
+		exception("%s->query_buffer[%.*s] (%u bytes) failed - %s", get_name(), len<256?(int)len:256, command, (unsigned int)len, mysql_error(mysql));
+	else if ( get_options()&DBO_SHOWQUERY )
+		gl_verbose("%s->query_buffer[%.*s] (%u bytes) ok", get_name(), len<256?(int)len:256, command, (unsigned int)len);
+	return true;
+}
+
+void database::submit(std::string &command)
+{
+	if ( flush_running )
+	{
+		// hand the statement to the flush thread
+		pthread_mutex_lock(&flush_lock);
+		flush_queue->push_back(std::string());
+		flush_queue->back().swap(command);
+		pthread_cond_signal(&flush_ready);
+		pthread_mutex_unlock(&flush_lock);
+	}
+	else
+		query_buffer(command.c_str(),command.size());
+}
+
+void database::start_flush(void)
+{
+	// the flush thread uses its own connection so the main connection remains usable
+	flush_mysql = mysql_init(NULL);
+	if ( flush_mysql==NULL )
+		exception("unable to initialize mysql client for flush thread");
+	if ( mysql_real_connect(flush_mysql,hostname,username,strcmp(password,"")?password:NULL,get_schema(),port,socketname,(unsigned long)clientflags)==NULL )
+	{
+		gl_warning("%s flush thread connect failed - %s; recorder inserts will be sent synchronously", get_name(), mysql_error(flush_mysql));
+		/* TROUBLESHOOT
+			The database could not open a second connection for the ASYNCFLUSH flush thread.
+			The recorder inserts will be sent on the main connection instead.  Check that
+			the server permits more than one connection for the user.
+		 */
+		mysql_close(flush_mysql);
+		flush_mysql = NULL;
+		return;
+	}
+	flush_queue = new std::deque<std::string>;
+	pthread_mutex_init(&flush_lock,NULL);
+	pthread_cond_init(&flush_ready,NULL);
+	flush_running = true;
+	if ( pthread_create(&flush_thread,NULL,flush_proc,(void*)this)!=0 )
+	{
+		gl_warning("%s flush thread create failed; recorder inserts will be sent synchronously", get_name());
+		flush_running = false;
+		mysql_close(flush_mysql);
+		flush_mysql = NULL;
+		return;
+	}
+	gl_verbose("%s flush thread started", get_name());
+}
+
+void database::stop_flush(void)
+{
+	if ( !flush_running )
+		return;
+
+	// the flush thread drains the queue before it exits
+	pthread_mutex_lock(&flush_lock);
+	flush_running = false;
+	pthread_cond_signal(&flush_ready);
+	pthread_mutex_unlock(&flush_lock);
+	pthread_join(flush_thread,NULL);
+	mysql_close(flush_mysql);
+	flush_mysql = NULL;
+	delete flush_queue;
+	flush_queue = NULL;
+	pthread_cond_destroy(&flush_ready);
+	pthread_mutex_destroy(&flush_lock);
+	gl_verbose("%s flush thread stopped", get_name());
+}
+
+void *database::flush_proc(void *arg)
+{
+	database *db = (database*)arg;
+	mysql_thread_init();
+	std::string command;
+	while ( true )
+	{
+		pthread_mutex_lock(&db->flush_lock);
+		while ( db->flush_queue->empty() && db->flush_running )
+			pthread_cond_wait(&db->flush_ready,&db->flush_lock);
+		if ( db->flush_queue->empty() )
+		{
+			pthread_mutex_unlock(&db->flush_lock);
+			break;
+		}
+		command.swap(db->flush_queue->front());
+		db->flush_queue->pop_front();
+		pthread_mutex_unlock(&db->flush_lock);
+
+		if ( mysql_real_query(db->flush_mysql,command.c_str(),(unsigned long)command.size())!=0 )
+			gl_error("%s flush thread query (%u bytes) failed - %s", db->get_name(), (unsigned int)command.size(), mysql_error(db->flush_mysql));
+			/* TROUBLESHOOT
+				A batched recorder insert sent by the ASYNCFLUSH flush thread failed.  The rows
+				in that batch are lost.  Check the error message from the server for the cause.
+			 */
+		else if ( db->get_options()&DBO_SHOWQUERY )
+			gl_verbose("%s flush thread query (%u bytes) ok", db->get_name(), (unsigned int)command.size());
+		command.clear();
+	}
+	mysql_thread_end();
+	return NULL;
+}
+
 MYSQL_RES *database::select(char *fmt,...)
 {
 	char command[1024];
@@ -26,6 +26,9 @@
 #endif
 
 #include <mysql.h>
+#include <pthread.h>
+#include <string>
+#include <deque>
 
 #ifdef DLMAIN
 #define EXTERN
@@ -49,6 +52,7 @@ EXTERN char default_table_prefix[256] INIT(""); ///< table prefix
 #define DBO_NOCREATE 0x0002 ///< prevent automatic creation of schema
 #define DBO_DROPSCHEMA 0x0004 ///< drop schema before using it
 #define DBO_OVERWRITE 0x0008	///< overwrite existing file when dumping and backing up
+#define DBO_ASYNCFLUSH 0x0010	///< send buffered inserts from a separate flush thread
 
 class database : public gld_object {
 public:
@@ -66,6 +70,8 @@ public:
 	GL_ATOMIC(double,sync_interval);
 	GL_ATOMIC(int32,tz_offset);
 	GL_ATOMIC(bool,uses_dst);
+	GL_ATOMIC(int32,batch_size);
+	GL_ATOMIC(double,flush_interval);
 
 	// mysql handle
 private:
@@ -73,6 +79,18 @@ private:
 public:
 	inline MYSQL *get_handle() { return mysql; };
 
+	// flush thread (used by ASYNCFLUSH)
+private:
+	MYSQL *flush_mysql; ///< separate connection used by the flush thread
+	pthread_t flush_thread;
+	pthread_mutex_t flush_lock;
+	pthread_cond_t flush_ready;
+	std::deque<std::string> *flush_queue;
+	bool flush_running;
+	static void *flush_proc(void *arg);
+	void start_flush(void);
+	void stop_flush(void);
+
 	// term list
 private:
 	database *next;
@@ -100,6 +118,8 @@ public:
 	const char *get_last_error(void);
 	bool table_exists(char *table);
 	bool query(char *query,...);
+	bool query_buffer(const char *command, size_t len);
+	void submit(std::string &command);
 	unsigned int64 get_last_index(void);
 	MYSQL_RES *select(char *query,...);
 	MYSQL_RES get_next(MYSQL_RES*res);
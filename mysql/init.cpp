@@ -55,6 +55,7 @@ EXPORT CLASS *init(CALLBACKS *fntable, MODULE *module, int argc, char *argv[])
 EXPORT void term(void)
 {
 	database *db;
+	recorder::flush_all();
 	for ( db=database::get_first() ; db!=NULL ; db=db->get_next() )
 		db->term();
 }
@@ -1266,10 +1266,13 @@ bool export_schedules(MYSQL *mysql)
 		return false;
 	for ( SCHEDULE *schedule=gl_schedule_getfirst() ; schedule!=NULL ; schedule=schedule->next )
 	{
-		char quoted[sizeof(schedule->definition)*2+1];
-		mysql_real_escape_string(mysql,quoted,schedule->definition,strlen(schedule->definition));
-		if ( !query(mysql,"REPLACE INTO `%s` (`name`,`definition`) VALUES (\"%s\",\"%s\")", get_table_name("schedules"),
-				schedule->name, quoted) )
+		size_t len = strlen(schedule->definition);
+		char *quoted = new char[len*2+1];
+		mysql_real_escape_string(mysql,quoted,schedule->definition,len);
+		bool ok = query(mysql,"REPLACE INTO `%s` (`name`,`definition`) VALUES (\"%s\",\"%s\")", get_table_name("schedules"),
+				schedule->name, quoted);
+		delete [] quoted;
+		if ( !ok )
 			return false;
 	}
 	return true;
@@ -14,6 +14,7 @@ EXPORT_COMMIT(recorder);
 
 CLASS *recorder::oclass = NULL;
 recorder *recorder::defaults = NULL;
+recorder *recorder::first = NULL;
 using namespace std;
 
 vector<string> split(char* str, const char* delim)
@@ -74,6 +75,15 @@ int recorder::create(void)
 	db = last_database;
 	strcpy(datetime_fieldname,"t");
 	strcpy(recordid_fieldname,"id");
+	insert_prefix = NULL;
+	batch = NULL;
+	batch_rows = 0;
+	batch_start = TS_ZERO;
+	n_records = 0;
+
+	// flush list
+	next = first;
+	first = this;
 	return 1; /* return 1 on success, 0 on failure */
 }
 
@@ -259,6 +269,25 @@ int recorder::init(OBJECT *parent)
 		return 0;
 	}
 
+	// prepare the insert statement prefix
+	insert_prefix = new string;
+	insert_prefix->append("INSERT INTO `").append(get_table()).append("` (`").append(datetime_fieldname).append("`");
+	if ( header_fieldnames[0]!='\0' )
+		insert_prefix->append(",").append(header_fieldnames);
+	for ( size_t n = 0 ; n < property_target.size() ; n++ )
+	{
+		insert_prefix->append(",`").append(property_target[n].get_name());
+		if ( property_unit[n].is_valid() )
+			insert_prefix->append("[").append(property_unit[n].get_name()).append("]");
+		insert_prefix->append("`");
+	}
+	insert_prefix->append(") VALUES ");
+	batch = new string;
+	batch_rows = 0;
+	n_records = 0;
+	if ( db->get_batch_size()>1 )
+		gl_verbose("%s: inserting up to %d rows per statement", get_name(), db->get_batch_size());
+
 	// set heartbeat
 	if ( interval>0 )
 	{
@@ -324,30 +353,46 @@ TIMESTAMP recorder::commit(TIMESTAMP t0, TIMESTAMP t1)
 	{
 		gl_debug("header_fieldname=[%s]", (const char*)header_fieldnames);
 		gl_debug("header_fielddata=[%s]", header_data);
-		char fieldlist[65536] = "", valuelist[65536] = "";
-		size_t fieldlen = 0;
-		if ( header_fieldnames[0]!='\0' )
-			fieldlen = sprintf(fieldlist,",%s",(const char*)header_fieldnames);
-		strcpy(valuelist,header_data);
-		size_t valuelen = strlen(valuelist);
+		char valuelist[65536];
+		size_t valuelen = sprintf(valuelist,"(from_unixtime('%"FMT_INT64"d')%s", db->convert_to_dbtime(gl_globalclock), header_data);
 		for ( size_t n = 0 ; n < property_target.size() ; n++ )
 		{
 			char buffer[1024] = "NULL";
-			if ( property_unit[n].is_valid() )
-				fieldlen += sprintf(fieldlist+fieldlen,",`%s[%s]`", property_target[n].get_name(), property_unit[n].get_name());
-			else
-				fieldlen += sprintf(fieldlist+fieldlen,",`%s`", property_target[n].get_name());
 			db->get_sqldata(buffer, sizeof(buffer), property_target[n], &property_unit[n]);
 			valuelen += sprintf(valuelist+valuelen,", %s", buffer);
 		}
-		db->query("INSERT INTO `%s` (`%s`%s) VALUES (from_unixtime('%"FMT_INT64"d')%s)",
-			get_table(), (const char*)datetime_fieldname, fieldlist, db->convert_to_dbtime(gl_globalclock),  valuelist);
+		valuelen += sprintf(valuelist+valuelen,")");
+		n_records++;
+
+		// unbuffered insert
+		if ( db->get_batch_size()<=1 && !(db->get_options()&DBO_ASYNCFLUSH) )
+		{
+			string command(*insert_prefix);
+			command.append(valuelist,valuelen);
+			db->query_buffer(command.c_str(),command.size());
+		}
+
+		// buffered insert
+		else
+		{
+			if ( batch_rows==0 )
+				batch_start = gl_globalclock;
+			else
+				batch->append(",");
+			batch->append(valuelist,valuelen);
+			batch_rows++;
 
+			// flush on batch size or age
+			if ( batch_rows>=(size_t)db->get_batch_size() 
+				|| ( db->get_flush_interval()>0 && gl_globalclock-batch_start>=(TIMESTAMP)db->get_flush_interval() ) )
+				flush();
+		}
 
-		// check limit
-		if ( get_limit()>0 && db->get_last_index()>=get_limit() )
+		// check limit (rows recorded by this recorder, whether sent yet or not)
+		if ( get_limit()>0 && n_records>=get_limit() )
 		{
 			// shut off recorder
+			flush();
 			enabled=false;
 			gl_verbose("table '%s' size limit %d reached", get_table(), get_limit());
 		}
@@ -358,4 +403,32 @@ TIMESTAMP recorder::commit(TIMESTAMP t0, TIMESTAMP t1)
 	return TS_NEVER;
 }
 
+void recorder::flush(void)
+{
+	if ( batch_rows==0 )
+		return;
+	gl_debug("%s: flushing %u rows to table '%s'", get_name(), (unsigned int)batch_rows, get_table());
+	string command;
+	command.reserve(insert_prefix->size()+batch->size());
+	command.append(*insert_prefix).append(*batch);
+	batch->clear();
+	batch_rows = 0;
+	db->submit(command);
+}
+
+void recorder::flush_all(void)
+{
+	recorder *rec;
+	for ( rec=first ; rec!=NULL ; rec=rec->next )
+	{
+		try {
+			rec->flush();
+		}
+		catch (const char *msg)
+		{
+			gl_error("%s", msg);
+		}
+	}
+}
+
 #endif // HAVE_MYSQL
@@ -36,9 +36,22 @@ private:
 	std::vector<gld_property> property_target;
 	std::vector<gld_unit> property_unit;
 	char header_data[1024];
+	std::string *insert_prefix; ///< INSERT statement up to VALUES
+	std::string *batch; ///< rows waiting to be sent
+	size_t batch_rows; ///< number of rows in batch
+	TIMESTAMP batch_start; ///< time of first row in batch
+	int64 n_records; ///< number of rows recorded so far
 public:
 	inline bool get_trigger_on(void) { return trigger_on; };
 	inline bool get_enabled(void) { return enabled; };
+	void flush(void);
+
+	// flush list
+private:
+	recorder *next;
+	static recorder *first;
+public:
+	static void flush_all(void);
 public:
 	recorder(MODULE *module);
 	int create(void);
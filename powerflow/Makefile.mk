@@ -81,6 +81,7 @@ powerflow_powerflow_la_SOURCES += powerflow/sectionalizer.h
 powerflow_powerflow_la_SOURCES += powerflow/series_reactor.cpp
 powerflow_powerflow_la_SOURCES += powerflow/series_reactor.h
 powerflow_powerflow_la_SOURCES += powerflow/solver_nr.cpp
+powerflow_powerflow_la_SOURCES += powerflow/solver_nr_complex.cpp
 powerflow_powerflow_la_SOURCES += powerflow/solver_nr.h
 powerflow_powerflow_la_SOURCES += powerflow/substation.cpp
 powerflow_powerflow_la_SOURCES += powerflow/substation.h
@@ -80,8 +80,15 @@ EXPORT CLASS *init(CALLBACKS *fntable, MODULE *module, int argc, char *argv[])
 	gl_global_create("powerflow::line_limits",PT_bool,&use_link_limits,NULL);
 	gl_global_create("powerflow::lu_solver",PT_char256,&LUSolverName,NULL);
 	gl_global_create("powerflow::NR_iteration_limit",PT_int64,&NR_iteration_limit,NULL);
+	gl_global_create("powerflow::NR_iteration_count",PT_int64,&NR_iteration_count,PT_DESCRIPTION,"Number of Newton-Raphson iterations the last converged powerflow solution took",NULL);
 	gl_global_create("powerflow::NR_deltamode_iteration_limit",PT_int64,&NR_delta_iteration_limit,NULL);
 	gl_global_create("powerflow::NR_superLU_procs",PT_int32,&NR_superLU_procs,NULL);
+	gl_global_create("powerflow::NR_symbolic_reuse",PT_bool,&NR_symbolic_reuse,PT_DESCRIPTION,"Flag to reuse the superLU column ordering and elimination tree while the admittance matrix pattern is unchanged",NULL);
+	gl_global_create("powerflow::NR_symbolic_skips",PT_int64,&NR_symbolic_skips,PT_DESCRIPTION,"Number of superLU factorizations that skipped the symbolic phase",NULL);
+	gl_global_create("powerflow::NR_island_solve",PT_bool,&NR_island_solve,PT_DESCRIPTION,"Flag to solve electrically isolated islands as separate systems, concurrently when there are threads",NULL);
+	gl_global_create("powerflow::NR_island_count",PT_int32,&NR_island_count,PT_DESCRIPTION,"Number of electrically isolated islands solved separately by the NR solver",NULL);
+	gl_global_create("powerflow::NR_admittance_inplace",PT_bool,&NR_admittance_inplace,PT_DESCRIPTION,"Flag to apply branch admittance value changes, like regulator tap changes, in place instead of rebuilding the admittance matrix",NULL);
+	gl_global_create("powerflow::NR_admittance_updates",PT_int64,&NR_admittance_updates,PT_DESCRIPTION,"Number of admittance changes the NR solver applied in place",NULL);
 	gl_global_create("powerflow::default_maximum_voltage_error",PT_double,&default_maximum_voltage_error,NULL);
 	gl_global_create("powerflow::default_maximum_power_error",PT_double,&default_maximum_power_error,NULL);
 	gl_global_create("powerflow::NR_admit_change",PT_bool,&NR_admit_change,NULL);
@@ -305,6 +312,9 @@ EXPORT SIMULATIONMODE interupdate(MODULE *module, TIMESTAMP t0, unsigned int64 d
 
 			//Put in try/catch, since GL_THROWs inside solver_nr tend to be a little upsetting
 			try {
+				//Post the childed nodes' loads up to their parents
+				node::NR_post_child_loads();
+
 				//Call solver_nr
 				pf_result = solver_nr(NR_bus_count, NR_busdata, NR_branch_count, NR_branchdata, &NR_powerflow, powerflow_type, NULL, &bad_computation);
 			}
@@ -111,7 +111,7 @@ link_object::link_object(MODULE *mod) : powerflow_object(mod)
 	if (oclass==NULL)
 	{
 		pclass = powerflow_object::oclass;
-		oclass = gl_register_class(mod,"link",sizeof(link_object),PC_PRETOPDOWN|PC_BOTTOMUP|PC_POSTTOPDOWN|PC_UNSAFE_OVERRIDE_OMIT|PC_AUTOLOCK);
+		oclass = gl_register_class(mod,"link",sizeof(link_object),PC_PRETOPDOWN|PC_BOTTOMUP|PC_POSTTOPDOWN|PC_UNSAFE_OVERRIDE_OMIT|PC_AUTOLOCK|PC_UNSAFE_INIT|PC_NONREENTRANT);
 		if (oclass==NULL)
 			throw "unable to register class link";
 		else
@@ -7716,6 +7716,9 @@ int link_object::link_fault_on(OBJECT **protect_obj, char *fault_type, int *impl
 			//***** NOTE -- Better approach?? ****/
 			pf_mesh_fault_values.NodeRefNum = NR_branchdata[NR_branch_reference].to;
 
+			//Post any pending childed node loads to their parents
+			node::NR_post_child_loads();
+
 			//Call the powerflow/impednace creater
 			pf_resultval = solver_nr(NR_bus_count, NR_busdata, NR_branch_count, NR_branchdata, &NR_powerflow, pf_solvermode, &pf_mesh_fault_values, &pf_badcompute);
 
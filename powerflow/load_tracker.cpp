@@ -249,7 +249,7 @@ TIMESTAMP load_tracker::postsync(TIMESTAMP t0, TIMESTAMP t1)
 	// After both the powerflow solve has completed and the
 	// measurments have been updated we check the output error
 	// and see if we need to trigger another iteration.
-	if ((solver_method == SM_FBS) || (solver_method == SM_NR && NR_admit_change == false))
+	if ((solver_method == SM_FBS) || (solver_method == SM_NR && NR_admit_change == false && NR_admit_update == false))
 	{
 		update_feedback_variable();
 
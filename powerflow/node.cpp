@@ -99,7 +99,7 @@ node::node(MODULE *mod) : powerflow_object(mod)
 	if(oclass == NULL)
 	{
 		pclass = powerflow_object::oclass;
-		oclass = gl_register_class(mod,"node",sizeof(node),PC_PRETOPDOWN|PC_BOTTOMUP|PC_POSTTOPDOWN|PC_UNSAFE_OVERRIDE_OMIT|PC_AUTOLOCK);
+		oclass = gl_register_class(mod,"node",sizeof(node),PC_PRETOPDOWN|PC_BOTTOMUP|PC_POSTTOPDOWN|PC_UNSAFE_OVERRIDE_OMIT|PC_AUTOLOCK|PC_UNSAFE_INIT|PC_NONREENTRANT);
 		if (oclass==NULL)
 			throw "unable to register class node";
 		else
@@ -244,6 +244,7 @@ int node::create(void)
 	NR_connected_links[0] = NR_connected_links[1] = 0;
 	NR_number_child_nodes[0] = NR_number_child_nodes[1] = 0;
 	NR_child_nodes = NULL;
+	NR_child_post_pending = false;
 
 	NR_node_reference = -1;	//Newton-Raphson bus index, set to -1 initially
 	house_present = false;	//House attachment flag
@@ -708,6 +709,16 @@ int node::init(OBJECT *parent)
 			{
 				matrix_solver_method=MM_SUPERLU;	//This is the default, but we'll set it here anyways
 			}
+			else if (strcmp(LUSolverName.get_string(),"superlu_complex")==0)	//Built-in complex formulation
+			{
+				gl_verbose("Complex superLU formulation selected for NR");
+				/*  TROUBLESHOOT
+				The built-in complex superLU solver was selected with lu_solver, so NR will fold the real
+				current-injection system into a complex system half its order before factoring it.
+				*/
+
+				matrix_solver_method=MM_SUPERLU_COMPLEX;
+			}
 			else	//Something is there, see if we can find it
 			{
 				//Initialize the global
@@ -1877,8 +1888,6 @@ TIMESTAMP node::presync(TIMESTAMP t0)
 //Put in place so deltamode can call it and properly udpate
 void node::NR_node_sync_fxn(OBJECT *obj)
 {
-	int loop_index_var;
-
 	//Reliability check - sets and removes voltages (theory being previous answer better than starting at 0)
 	unsigned char phase_checks_var;
 
@@ -2019,182 +2028,199 @@ void node::NR_node_sync_fxn(OBJECT *obj)
 			}//End Phase checks for reliability
 		}//End normal node
 
-		if (SubNode==CHILD)
-		{
-			//Post our loads up to our parent
-			node *ParToLoad = OBJECTDATA(SubNodeParent,node);
+		//Childed nodes leave their loads where they are - the parent's children are posted up, without locking the
+		//parent, just before the solver runs (NR_post_child_loads)
+		if ((SubNode==CHILD) || (SubNode==DIFF_CHILD))
+			NR_child_post_pending = true;
+	}//end not uninitialized
+}
 
-			if (gl_object_isa(SubNodeParent,"load","powerflow"))	//Load gets cleared at every presync, so reaggregate :(
-			{
-				//Lock the parent for accumulation
-				LOCK_OBJECT(SubNodeParent);
+//Posts a childed node's loads up to its parent - called for the parent's children by NR_post_child_loads, so
+//no two threads ever write into the same parent
+void node::NR_node_post_child(void)
+{
+	OBJECT *obj = OBJECTHDR(this);
+	int loop_index_var;
 
-				//Import power and "load" characteristics
-				ParToLoad->power[0]+=power[0];
-				ParToLoad->power[1]+=power[1];
-				ParToLoad->power[2]+=power[2];
+	if (SubNode==CHILD)
+	{
+		//Post our loads up to our parent
+		node *ParToLoad = OBJECTDATA(SubNodeParent,node);
 
-				ParToLoad->shunt[0]+=shunt[0];
-				ParToLoad->shunt[1]+=shunt[1];
-				ParToLoad->shunt[2]+=shunt[2];
+		if (gl_object_isa(SubNodeParent,"load","powerflow"))	//Load gets cleared at every presync, so reaggregate :(
+		{
+			//Import power and "load" characteristics
+			ParToLoad->power[0]+=power[0];
+			ParToLoad->power[1]+=power[1];
+			ParToLoad->power[2]+=power[2];
 
-				ParToLoad->current[0]+=current[0];
-				ParToLoad->current[1]+=current[1];
-				ParToLoad->current[2]+=current[2];
+			ParToLoad->shunt[0]+=shunt[0];
+			ParToLoad->shunt[1]+=shunt[1];
+			ParToLoad->shunt[2]+=shunt[2];
 
-				//Accumulate the unrotated values too
-				ParToLoad->pre_rotated_current[0] += pre_rotated_current[0];
-				ParToLoad->pre_rotated_current[1] += pre_rotated_current[1];
-				ParToLoad->pre_rotated_current[2] += pre_rotated_current[2];
+			ParToLoad->current[0]+=current[0];
+			ParToLoad->current[1]+=current[1];
+			ParToLoad->current[2]+=current[2];
 
-				//Do the same for explicit delta/wye portions
-				for (loop_index_var=0; loop_index_var<6; loop_index_var++)
-				{
-					ParToLoad->power_dy[loop_index_var] += power_dy[loop_index_var];
-					ParToLoad->shunt_dy[loop_index_var] += shunt_dy[loop_index_var];
-					ParToLoad->current_dy[loop_index_var] += current_dy[loop_index_var];
-				}
+			//Accumulate the unrotated values too
+			ParToLoad->pre_rotated_current[0] += pre_rotated_current[0];
+			ParToLoad->pre_rotated_current[1] += pre_rotated_current[1];
+			ParToLoad->pre_rotated_current[2] += pre_rotated_current[2];
 
-				//All done, unlock
-				UNLOCK_OBJECT(SubNodeParent);
+			//Do the same for explicit delta/wye portions
+			for (loop_index_var=0; loop_index_var<6; loop_index_var++)
+			{
+				ParToLoad->power_dy[loop_index_var] += power_dy[loop_index_var];
+				ParToLoad->shunt_dy[loop_index_var] += shunt_dy[loop_index_var];
+				ParToLoad->current_dy[loop_index_var] += current_dy[loop_index_var];
 			}
-			else if (gl_object_isa(SubNodeParent,"node","powerflow"))	//"parented" node - update values - This has to go to the bottom
-			{												//since load/meter share with node (and load handles power in presync)
-				//Lock the parent for accumulation
-				LOCK_OBJECT(SubNodeParent);
-
-				//Import power and "load" characteristics
-				ParToLoad->power[0]+=power[0]-last_child_power[0][0];
-				ParToLoad->power[1]+=power[1]-last_child_power[0][1];
-				ParToLoad->power[2]+=power[2]-last_child_power[0][2];
-
-				ParToLoad->shunt[0]+=shunt[0]-last_child_power[1][0];
-				ParToLoad->shunt[1]+=shunt[1]-last_child_power[1][1];
-				ParToLoad->shunt[2]+=shunt[2]-last_child_power[1][2];
-
-				ParToLoad->current[0]+=current[0]-last_child_power[2][0];
-				ParToLoad->current[1]+=current[1]-last_child_power[2][1];
-				ParToLoad->current[2]+=current[2]-last_child_power[2][2];
-
-				ParToLoad->pre_rotated_current[0] += pre_rotated_current[0]-last_child_power[3][0];
-				ParToLoad->pre_rotated_current[1] += pre_rotated_current[1]-last_child_power[3][1];
-				ParToLoad->pre_rotated_current[2] += pre_rotated_current[2]-last_child_power[3][2];
-
-				//Do the same for the explicit delta/wye loads - last_child_power is set up as columns of ZIP, not ABC
-				for (loop_index_var=0; loop_index_var<6; loop_index_var++)
-				{
-					ParToLoad->power_dy[loop_index_var] += power_dy[loop_index_var] - last_child_power_dy[loop_index_var][0];
-					ParToLoad->shunt_dy[loop_index_var] += shunt_dy[loop_index_var] - last_child_power_dy[loop_index_var][1];
-					ParToLoad->current_dy[loop_index_var] += current_dy[loop_index_var] - last_child_power_dy[loop_index_var][2];
-				}
-
-				if (has_phase(PHASE_S))	//Triplex gets another term as well
-				{
-					ParToLoad->current12 +=current12-last_child_current12;
-				}
-
-				//See if we have a house!
-				if (house_present==true)	//Add our values into our parent's accumulator!
-				{
-					ParToLoad->nom_res_curr[0] += nom_res_curr[0];
-					ParToLoad->nom_res_curr[1] += nom_res_curr[1];
-					ParToLoad->nom_res_curr[2] += nom_res_curr[2];
-				}
-
-				//Unlock the parent now that we are done
-				UNLOCK_OBJECT(SubNodeParent);
+		}
+		else if (gl_object_isa(SubNodeParent,"node","powerflow"))	//"parented" node - update values - This has to go to the bottom
+		{												//since load/meter share with node (and load handles power in presync)
+			//Import power and "load" characteristics
+			ParToLoad->power[0]+=power[0]-last_child_power[0][0];
+			ParToLoad->power[1]+=power[1]-last_child_power[0][1];
+			ParToLoad->power[2]+=power[2]-last_child_power[0][2];
+
+			ParToLoad->shunt[0]+=shunt[0]-last_child_power[1][0];
+			ParToLoad->shunt[1]+=shunt[1]-last_child_power[1][1];
+			ParToLoad->shunt[2]+=shunt[2]-last_child_power[1][2];
+
+			ParToLoad->current[0]+=current[0]-last_child_power[2][0];
+			ParToLoad->current[1]+=current[1]-last_child_power[2][1];
+			ParToLoad->current[2]+=current[2]-last_child_power[2][2];
+
+			ParToLoad->pre_rotated_current[0] += pre_rotated_current[0]-last_child_power[3][0];
+			ParToLoad->pre_rotated_current[1] += pre_rotated_current[1]-last_child_power[3][1];
+			ParToLoad->pre_rotated_current[2] += pre_rotated_current[2]-last_child_power[3][2];
+
+			//Do the same for the explicit delta/wye loads - last_child_power is set up as columns of ZIP, not ABC
+			for (loop_index_var=0; loop_index_var<6; loop_index_var++)
+			{
+				ParToLoad->power_dy[loop_index_var] += power_dy[loop_index_var] - last_child_power_dy[loop_index_var][0];
+				ParToLoad->shunt_dy[loop_index_var] += shunt_dy[loop_index_var] - last_child_power_dy[loop_index_var][1];
+				ParToLoad->current_dy[loop_index_var] += current_dy[loop_index_var] - last_child_power_dy[loop_index_var][2];
 			}
-			else
+
+			if (has_phase(PHASE_S))	//Triplex gets another term as well
 			{
-				GL_THROW("NR: Object %d is a child of something that it shouldn't be!",obj->id);
-				/*  TROUBLESHOOT
-				A Newton-Raphson object is childed to something it should not be (not a load, node, or meter).
-				This should have been caught earlier and is likely a bug.  Submit your code and a bug report using the trac website.
-				*/
+				ParToLoad->current12 +=current12-last_child_current12;
 			}
 
-			//Update previous power tracker
-			last_child_power[0][0] = power[0];
-			last_child_power[0][1] = power[1];
-			last_child_power[0][2] = power[2];
+			//See if we have a house!
+			if (house_present==true)	//Add our values into our parent's accumulator!
+			{
+				ParToLoad->nom_res_curr[0] += nom_res_curr[0];
+				ParToLoad->nom_res_curr[1] += nom_res_curr[1];
+				ParToLoad->nom_res_curr[2] += nom_res_curr[2];
+			}
+		}
+		else
+		{
+			GL_THROW("NR: Object %d is a child of something that it shouldn't be!",obj->id);
+			/*  TROUBLESHOOT
+			A Newton-Raphson object is childed to something it should not be (not a load, node, or meter).
+			This should have been caught earlier and is likely a bug.  Submit your code and a bug report using the trac website.
+			*/
+		}
 
-			last_child_power[1][0] = shunt[0];
-			last_child_power[1][1] = shunt[1];
-			last_child_power[1][2] = shunt[2];
+		//Update previous power tracker
+		last_child_power[0][0] = power[0];
+		last_child_power[0][1] = power[1];
+		last_child_power[0][2] = power[2];
 
-			last_child_power[2][0] = current[0];
-			last_child_power[2][1] = current[1];
-			last_child_power[2][2] = current[2];
+		last_child_power[1][0] = shunt[0];
+		last_child_power[1][1] = shunt[1];
+		last_child_power[1][2] = shunt[2];
 
-			last_child_power[3][0] = pre_rotated_current[0];
-			last_child_power[3][1] = pre_rotated_current[1];
-			last_child_power[3][2] = pre_rotated_current[2];
+		last_child_power[2][0] = current[0];
+		last_child_power[2][1] = current[1];
+		last_child_power[2][2] = current[2];
 
-			//Do the same for delta/wye explicit loads
-			for (loop_index_var=0; loop_index_var<6; loop_index_var++)
-			{
-				last_child_power_dy[loop_index_var][0] = power_dy[loop_index_var];
-				last_child_power_dy[loop_index_var][1] = shunt_dy[loop_index_var];
-				last_child_power_dy[loop_index_var][2] = current_dy[loop_index_var];
-			}
+		last_child_power[3][0] = pre_rotated_current[0];
+		last_child_power[3][1] = pre_rotated_current[1];
+		last_child_power[3][2] = pre_rotated_current[2];
 
-			if (has_phase(PHASE_S))		//Triplex extra current update
-				last_child_current12 = current12;
+		//Do the same for delta/wye explicit loads
+		for (loop_index_var=0; loop_index_var<6; loop_index_var++)
+		{
+			last_child_power_dy[loop_index_var][0] = power_dy[loop_index_var];
+			last_child_power_dy[loop_index_var][1] = shunt_dy[loop_index_var];
+			last_child_power_dy[loop_index_var][2] = current_dy[loop_index_var];
 		}
 
-		//Accumulations for "differently connected nodes" is still basically the same for delta/wye combination loads
-		if (SubNode==DIFF_CHILD)
-		{
-			//Post our loads up to our parent - in the appropriate fashion
-			node *ParToLoad = OBJECTDATA(SubNodeParent,node);
+		if (has_phase(PHASE_S))		//Triplex extra current update
+			last_child_current12 = current12;
+	}
 
-			//Lock the parent for accumulation
-			LOCK_OBJECT(SubNodeParent);
+	//Accumulations for "differently connected nodes" is still basically the same for delta/wye combination loads
+	if (SubNode==DIFF_CHILD)
+	{
+		//Post our loads up to our parent - in the appropriate fashion
+		node *ParToLoad = OBJECTDATA(SubNodeParent,node);
 
-			//Update post them.  Row 1 is power, row 2 is admittance, row 3 is current
-			ParToLoad->Extra_Data[0] += power[0];
-			ParToLoad->Extra_Data[1] += power[1];
-			ParToLoad->Extra_Data[2] += power[2];
+		//Update post them.  Row 1 is power, row 2 is admittance, row 3 is current
+		ParToLoad->Extra_Data[0] += power[0];
+		ParToLoad->Extra_Data[1] += power[1];
+		ParToLoad->Extra_Data[2] += power[2];
 
-			ParToLoad->Extra_Data[3] += shunt[0];
-			ParToLoad->Extra_Data[4] += shunt[1];
-			ParToLoad->Extra_Data[5] += shunt[2];
+		ParToLoad->Extra_Data[3] += shunt[0];
+		ParToLoad->Extra_Data[4] += shunt[1];
+		ParToLoad->Extra_Data[5] += shunt[2];
 
-			ParToLoad->Extra_Data[6] += current[0];
-			ParToLoad->Extra_Data[7] += current[1];
-			ParToLoad->Extra_Data[8] += current[2];
+		ParToLoad->Extra_Data[6] += current[0];
+		ParToLoad->Extra_Data[7] += current[1];
+		ParToLoad->Extra_Data[8] += current[2];
 
-			//Add in the unrotated stuff too -- it should never be subject to "connectivity"
-			ParToLoad->pre_rotated_current[0] += pre_rotated_current[0];
-			ParToLoad->pre_rotated_current[1] += pre_rotated_current[1];
-			ParToLoad->pre_rotated_current[2] += pre_rotated_current[2];
+		//Add in the unrotated stuff too -- it should never be subject to "connectivity"
+		ParToLoad->pre_rotated_current[0] += pre_rotated_current[0];
+		ParToLoad->pre_rotated_current[1] += pre_rotated_current[1];
+		ParToLoad->pre_rotated_current[2] += pre_rotated_current[2];
 
-			//Import power and "load" characteristics for explicit delta/wye portions
-			for (loop_index_var=0; loop_index_var<6; loop_index_var++)
-			{
-				ParToLoad->power_dy[loop_index_var] += power_dy[loop_index_var];
-				ParToLoad->shunt_dy[loop_index_var] += shunt_dy[loop_index_var];
-				ParToLoad->current_dy[loop_index_var] += current_dy[loop_index_var];
-			}
+		//Import power and "load" characteristics for explicit delta/wye portions
+		for (loop_index_var=0; loop_index_var<6; loop_index_var++)
+		{
+			ParToLoad->power_dy[loop_index_var] += power_dy[loop_index_var];
+			ParToLoad->shunt_dy[loop_index_var] += shunt_dy[loop_index_var];
+			ParToLoad->current_dy[loop_index_var] += current_dy[loop_index_var];
+		}
 
-			//Finished, unlock parent
-			UNLOCK_OBJECT(SubNodeParent);
+		//Update our tracking variable
+		for (loop_index_var=0; loop_index_var<6; loop_index_var++)
+		{
+			last_child_power_dy[loop_index_var][0] = power_dy[loop_index_var];
+			last_child_power_dy[loop_index_var][1] = shunt_dy[loop_index_var];
+			last_child_power_dy[loop_index_var][2] = current_dy[loop_index_var];
+		}
 
-			//Update our tracking variable
-			for (loop_index_var=0; loop_index_var<6; loop_index_var++)
-			{
-				last_child_power_dy[loop_index_var][0] = power_dy[loop_index_var];
-				last_child_power_dy[loop_index_var][1] = shunt_dy[loop_index_var];
-				last_child_power_dy[loop_index_var][2] = current_dy[loop_index_var];
-			}
+		//Store the unrotated too
+		last_child_power[3][0] = pre_rotated_current[0];
+		last_child_power[3][1] = pre_rotated_current[1];
+		last_child_power[3][2] = pre_rotated_current[2];
 
-			//Store the unrotated too
-			last_child_power[3][0] = pre_rotated_current[0];
-			last_child_power[3][1] = pre_rotated_current[1];
-			last_child_power[3][2] = pre_rotated_current[2];
+	}//End differently connected child
 
-		}//End differently connected child
-	}//end not uninitialized
+	NR_child_post_pending = false;
+}
+
+//Posts the pending loads of all childed nodes to their parents - done once all the nodes have synced, right before the solver
+void node::NR_post_child_loads(void)
+{
+	unsigned int bus_index, child_index;
+	node *ParNode;
+
+	for (bus_index=0; bus_index<NR_bus_count; bus_index++)
+	{
+		ParNode = OBJECTDATA(NR_busdata[bus_index].obj,node);
+
+		for (child_index=0; child_index<ParNode->NR_number_child_nodes[1]; child_index++)
+		{
+			if (ParNode->NR_child_nodes[child_index]->NR_child_post_pending == true)
+			{
+				ParNode->NR_child_nodes[child_index]->NR_node_post_child();
+			}
+		}
+	}
 }
 
 TIMESTAMP node::sync(TIMESTAMP t0)
@@ -2501,6 +2527,9 @@ TIMESTAMP node::sync(TIMESTAMP t0)
 					powerflow_type = PF_NORMAL;
 				}
 
+				//Everyone has synced - post the childed nodes' loads up to their parents
+				NR_post_child_loads();
+
 				int64 result = solver_nr(NR_bus_count, NR_busdata, NR_branch_count, NR_branchdata, &NR_powerflow, powerflow_type, NULL, &bad_computation);
 
 				//De-flag the change - no contention should occur
@@ -2525,7 +2554,10 @@ TIMESTAMP node::sync(TIMESTAMP t0)
 					NR_retval=t0;
 				}
 				else
+				{
+					NR_iteration_count = result + 1;	//solver_nr returns the index of the converged iteration
 					NR_retval=t1;
+				}
 
 				//See where we wanted to go
 				return NR_retval;
@@ -204,6 +204,7 @@ public:
 	unsigned int NR_connected_links[2];	/// Counter for number of connected links in the system
 	unsigned int NR_number_child_nodes[2];	/// Counter for number of childed nodes we have (for later NR linking)
 	node **NR_child_nodes;	/// Pointer to childed nodes list
+	bool NR_child_post_pending;	/// Flag for a childed node whose loads have not been posted to its parent yet (NR)
 	int *NR_link_table;		/// Pointer to link list table
 	
 	double mean_repair_time;	/// Node's mean repair time - mainly for swing at this point
@@ -231,6 +232,8 @@ public:
 	//Functionalized portions for deltamode calls -- allows updates
 	TIMESTAMP NR_node_presync_fxn(TIMESTAMP t0_val);
 	void NR_node_sync_fxn(OBJECT *obj);
+	void NR_node_post_child(void);
+	static void NR_post_child_loads(void);
 	void BOTH_node_postsync_fxn(OBJECT *obj);
 	OBJECT *NR_master_swing_search(char *node_type_value,bool main_swing);
 
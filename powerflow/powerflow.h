@@ -29,7 +29,7 @@ void print_matrix(complex mat[3][3]);
 #define IMPORT_CLASS(name) extern CLASS *name##_class
 
 typedef enum {SM_FBS=0, SM_GS=1, SM_NR=2} SOLVERMETHOD;		/**< powerflow solver methodology */
-typedef enum {MM_SUPERLU=0, MM_EXTERN=1} MATRIXSOLVERMETHOD;	/**< NR matrix solver methodlogy */
+typedef enum {MM_SUPERLU=0, MM_EXTERN=1, MM_SUPERLU_COMPLEX=2} MATRIXSOLVERMETHOD;	/**< NR matrix solver methodlogy */
 typedef enum {
 	MD_NONE=0,			///< No matrix dump desired
 	MD_ONCE=1,			///< Single matrix dump desired
@@ -51,7 +51,7 @@ typedef struct s_ext_fxn {
 	void *ext_destroy;
 } EXT_LU_FXN_CALLS;
 
-GLOBAL char256 LUSolverName INIT("");				/**< filename for external LU solver */
+GLOBAL char256 LUSolverName INIT("");				/**< filename for external LU solver - "superlu_complex" selects the built-in complex formulation */
 GLOBAL EXT_LU_FXN_CALLS LUSolverFcns;				/**< links to external LU solver functions */
 GLOBAL SOLVERMETHOD solver_method INIT(SM_FBS);		/**< powerflow solver methodology */
 GLOBAL char256 MDFileName INIT("");					/**< filename for matrix dump */
@@ -68,9 +68,17 @@ GLOBAL NR_SOLVER_STRUCT NR_powerflow;				/**< Newton-Raphson solver working vari
 GLOBAL int NR_curr_bus INIT(-1);					/**< Newton-Raphson current bus indicator - used to populate NR_busdata */
 GLOBAL int NR_curr_branch INIT(-1);					/**< Newton-Raphson current branch indicator - used to populate NR_branchdata */
 GLOBAL int64 NR_iteration_limit INIT(500);			/**< Newton-Raphson iteration limit (per GridLAB-D iteration) */
+GLOBAL int64 NR_iteration_count INIT(0);			/**< Newton-Raphson iterations the last converged powerflow solution took */
 GLOBAL bool NR_dyn_first_run INIT(true);			/**< Newton-Raphson first run indicator - used by deltamode functionality for initialization powerflow */
 GLOBAL bool NR_admit_change INIT(true);				/**< Newton-Raphson admittance matrix change detector - used to prevent complete recalculation of admittance at every timestep */
+GLOBAL bool NR_admit_update INIT(false);				/**< Newton-Raphson branch admittance value change detector - only the changed branches are updated (see NR_branch_admittance_update) */
 GLOBAL int NR_superLU_procs INIT(1);				/**< Newton-Raphson related - superLU MT processor count to request - separate from thread_count */
+GLOBAL bool NR_symbolic_reuse INIT(false);			/**< Newton-Raphson related - reuse the superLU column ordering and elimination tree while the admittance pattern is unchanged */
+GLOBAL int64 NR_symbolic_skips INIT(0);				/**< Newton-Raphson related - number of superLU factorizations that skipped the symbolic phase */
+GLOBAL bool NR_island_solve INIT(true);				/**< Newton-Raphson related - solve electrically isolated islands as separate systems (concurrently, when there are threads) */
+GLOBAL int32 NR_island_count INIT(0);				/**< Newton-Raphson related - number of islands the system was split into */
+GLOBAL bool NR_admittance_inplace INIT(true);		/**< Newton-Raphson related - apply branch admittance value changes (regulator taps) in place instead of rebuilding the admittance */
+GLOBAL int64 NR_admittance_updates INIT(0);			/**< Newton-Raphson related - number of admittance changes applied in place */
 GLOBAL TIMESTAMP NR_retval INIT(TS_NEVER);			/**< Newton-Raphson current return value - if t0 objects know we aren't going anywhere */
 GLOBAL OBJECT *NR_swing_bus INIT(NULL);				/**< Newton-Raphson swing bus */
 GLOBAL int NR_swing_bus_reference INIT(-1);			/**< Newton-Raphson swing bus index reference in NR_busdata */
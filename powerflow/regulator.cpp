@@ -807,9 +807,9 @@ TIMESTAMP regulator::presync(TIMESTAMP t0)
 		//accesses the NR memory space, this won't cause any issues.
 		if ((prev_tap[0] != tap[0]) || (prev_tap[1] != tap[1]) || (prev_tap[2] != tap[2]))	//Change has occurred
 		{
-			//Flag an update
+			//Flag an update - only our admittance values changed, so the solver can update them in place
 			LOCK_OBJECT(NR_swing_bus);	//Lock SWING since we'll be modifying this
-			NR_admit_change = true;
+			NR_branch_admittance_update(NR_branch_reference);
 			UNLOCK_OBJECT(NR_swing_bus);	//Unlock
 
 			//Update our previous tap positions
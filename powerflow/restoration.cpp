@@ -11,6 +11,7 @@
 using namespace std;
 
 #include "restoration.h"
+#include "node.h"
 
 //////////////////////////////////////////////////////////////////////////
 // restoration CLASS FUNCTIONS
@@ -3298,6 +3299,9 @@ int restoration::runPowerFlow(void)
 	try {
 
 		//Copied, more or less, from node.cpp call to solver_nr
+		//Post any pending childed node loads to their parents
+		node::NR_post_child_loads();
+
 		//Call the powerflow routine
 		PFresult = solver_nr(NR_bus_count, NR_busdata, NR_branch_count, NR_branchdata, &NR_powerflow, powerflow_type, NULL, &bad_computation);
 
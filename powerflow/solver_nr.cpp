@@ -46,26 +46,67 @@ Initialization after returning to service?
 /* access to module global variables */
 #include "powerflow.h"
 
-//Generic solver variables
-NR_SOLVER_VARS matrices_LU;
-
-//SuperLU variables
-int *perm_c, *perm_r;
-SuperMatrix A_LU,B_LU;
-
-//External solver global
-void *ext_solver_glob_vars;
+//LU solver working state - one per system solved, so electrically isolated islands can be solved independently
+struct s_nr_solver_lu {
+	NR_SOLVER_VARS matrices_LU;		///< Generic solver variables
+	int *perm_c, *perm_r;			///< SuperLU permutations
+	SuperMatrix A_LU,B_LU;			///< SuperLU matrices
+	void *ext_solver_glob_vars;		///< External solver working variables
+#ifdef MT
+	//SuperLU_MT factorization state - kept between calls when NR_symbolic_reuse is set
+	//While the admittance pattern is unchanged, the column ordering (perm_c), the elimination tree and the
+	//L/U storage of the last factorization are reused, so only a numeric refactorization is done
+	//(refact=YES and usepr=YES - the superLU_MT equivalent of SamePattern_SameRowPerm)
+	superlumt_options_t superLU_options;
+	SuperMatrix superLU_L, superLU_U;
+	bool superLU_symbolic_valid;
+	unsigned int superLU_pattern_id;
+	int superLU_size;
+#endif
+	//Complex formulation (MM_SUPERLU_COMPLEX) - the real 2n*2n system folded into an n*n complex one
+	//Each bus keeps its phases together, so the complex pattern is made of the (up to) 3x3 bus blocks
+	NR_COMPLEX_LU *complex_LU;			///< Complex superLU_MT working state
+	bool complex_pattern_valid;			///< Flag indicating the complex pattern matches Y_Amatrix
+	unsigned int complex_pattern_id;	///< Y_Amatrix pattern the complex pattern was built from
+	int complex_size;					///< Order of the complex system
+	int complex_nnz;					///< Number of elements in the complex pattern
+	int *complex_map;					///< Real index of each complex index - [2*i] first half, [2*i+1] second half
+	int *complex_colptr, *complex_rowind;	///< Complex pattern (compressed sparse column)
+	int *complex_diag;					///< Position of each diagonal element in the complex pattern
+	double *complex_value;				///< Complex values - interleaved real/imaginary
+	double *complex_rhs;				///< Complex right-hand side, then solution - interleaved real/imaginary
+	int *complex_target;				///< complex_value index each Y_Amatrix pattern element folds into
+	double *complex_scale;				///< Weight each Y_Amatrix pattern element folds with
+};
+
+//The superLU ordering and memory routines keep static state, so only one system is factored at a time
+static unsigned int NR_superLU_lock = 0;
+
+//Holds NR_superLU_lock until the end of the scope, so the lock is released however the solve exits
+class NR_superLU_wlock {
+	/// Constructor
+public: inline NR_superLU_wlock(void) {WRITELOCK(&NR_superLU_lock);};
+	/// Destructor
+public: inline ~NR_superLU_wlock(void) {WRITEUNLOCK(&NR_superLU_lock);};
+};
 
 //Initialize the sparse notation
 void sparse_init(SPARSE* sm, int nels, int ncols)
 {
-	int indexval;
-	
-	//Allocate the column pointer GLD heap
-	sm->cols = (SP_E**)gl_malloc(ncols*sizeof(SP_E*));
-
-	//Check it
-	if (sm->cols == NULL)
+	//Allocate the input element storage on the GLD heap
+	sm->row_in = (int*)gl_malloc(nels*sizeof(int));
+	sm->col_in = (int*)gl_malloc(nels*sizeof(int));
+	sm->val_in = (double*)gl_malloc(nels*sizeof(double));
+	sm->slot = (int*)gl_malloc(nels*sizeof(int));
+
+	//Allocate the column-sorted pattern
+	sm->colptr = (int*)gl_malloc((ncols+1)*sizeof(int));
+	sm->rowind = (int*)gl_malloc(nels*sizeof(int));
+	sm->value = (double*)gl_malloc(nels*sizeof(double));
+	sm->work = (int*)gl_malloc(nels*sizeof(int));
+
+	//Check them
+	if ((sm->row_in == NULL) || (sm->col_in == NULL) || (sm->val_in == NULL) || (sm->slot == NULL) || (sm->colptr == NULL) || (sm->rowind == NULL) || (sm->value == NULL) || (sm->work == NULL))
 	{
 		GL_THROW("NR: Sparse matrix allocation failed");
 		/*  TROUBLESHOOT
@@ -73,1959 +114,2463 @@ void sparse_init(SPARSE* sm, int nels, int ncols)
 		Please try again.  If the error persists, please submit your code and a bug report via the ticketing system.
 		*/
 	}
-	else	//Zero it, for giggles
-	{
-		for (indexval=0; indexval<ncols; indexval++)
-		{
-			sm->cols[indexval] = NULL;
-		}
-	}
-
-	//Allocate the elements on the GLD heap
-	sm->llheap = (SP_E*)gl_malloc(nels*sizeof(SP_E));
-
-	//Check it
-	if (sm->llheap == NULL)
-	{
-		GL_THROW("NR: Sparse matrix allocation failed");
-		//Defined above
-	}
-	else	//Zero it, for giggles
-	{
-		for (indexval=0; indexval<nels; indexval++)
-		{
-			sm->llheap[indexval].next = NULL;
-			sm->llheap[indexval].row_ind = -1;	//Invalid, so it gets upset if we use this (intentional)
-			sm->llheap[indexval].value = 0.0;
-		}
-	}
 
-	//Init others
-	sm->llptr = 0;
+	//Init others - pattern gets built on the first pass
+	sm->nels = nels;
 	sm->ncols = ncols;
+	sm->nnz = 0;
+	sm->pattern_nnz = 0;
+	sm->pattern_id = 0;
+	sm->pattern_valid = false;
 }
 
 //Free up/clear the sparse allocations
 void sparse_clear(SPARSE* sm)
 {
 	//Clear them up
-	gl_free(sm->llheap);
-	gl_free(sm->cols);
+	gl_free(sm->row_in);
+	gl_free(sm->col_in);
+	gl_free(sm->val_in);
+	gl_free(sm->slot);
+	gl_free(sm->colptr);
+	gl_free(sm->rowind);
+	gl_free(sm->value);
+	gl_free(sm->work);
 
 	//Null them, because I'm paranoid
-	sm->llheap = NULL;
-	sm->cols = NULL;
-
-	//Zero the last one
+	sm->row_in = NULL;
+	sm->col_in = NULL;
+	sm->val_in = NULL;
+	sm->slot = NULL;
+	sm->colptr = NULL;
+	sm->rowind = NULL;
+	sm->value = NULL;
+	sm->work = NULL;
+
+	//Zero the sizes
+	sm->nels = 0;
 	sm->ncols = 0;
+	sm->nnz = 0;
+	sm->pattern_nnz = 0;
+	sm->pattern_valid = false;
 }
 
 void sparse_reset(SPARSE* sm, int ncols)
 {
-	int indexval;
-
-	//Set the size
-	sm->ncols = ncols;
-
-	//Do brute force way, for paranoia
-	for (indexval=0; indexval<ncols; indexval++)
+	//A different size invalidates the pattern
+	if (sm->ncols != (unsigned int)ncols)
 	{
-		sm->cols[indexval] = NULL;
+		sm->ncols = ncols;
+		sm->pattern_valid = false;
 	}
-	
+
 	//Set the location pointer
-	sm->llptr = 0;
+	sm->nnz = 0;
 }
 
 //Add in new elements to the sparse notation
 inline void sparse_add(SPARSE* sm, int row, int col, double value)
 {
-	SP_E* insertion_point = sm->cols[col];
-	SP_E* new_list_element = &(sm->llheap[sm->llptr++]);
+	unsigned int k = sm->nnz++;
+
+	//If the key differs from the one stored here last time, the pattern is stale
+	if (sm->pattern_valid && ((sm->row_in[k] != row) || (sm->col_in[k] != col)))
+		sm->pattern_valid = false;
+
+	sm->row_in[k] = row;
+	sm->col_in[k] = col;
+	sm->val_in[k] = value;
+}
+
+//Number of patterns built - used to give each one a unique id
+//Islands build their patterns concurrently, so the count is bumped atomically
+static volatile unsigned int sparse_pattern_count = 0;
+#if defined(WIN32) && !defined(__MINGW32__)
+#define sparse_pattern_next() ((unsigned int)InterlockedIncrement((volatile long*)&sparse_pattern_count))
+#else
+#define sparse_pattern_next() __sync_add_and_fetch(&sparse_pattern_count,1)
+#endif
+
+//Rebuild the column-sorted pattern from the added keys
+//Counting sort by row, then a stable counting sort by column, so rows end up sorted within each column
+void sparse_pattern(SPARSE* sm)
+{
+	unsigned int indexval, kindex;
+	int *count = sm->colptr;
+
+	//Sort by row into work - colptr is borrowed for the counts
+	for (indexval=0; indexval<=sm->ncols; indexval++)
+		count[indexval] = 0;
+	for (kindex=0; kindex<sm->nnz; kindex++)
+		count[sm->row_in[kindex]+1]++;
+	for (indexval=0; indexval<sm->ncols; indexval++)
+		count[indexval+1] += count[indexval];
+	for (kindex=0; kindex<sm->nnz; kindex++)
+		sm->work[count[sm->row_in[kindex]]++] = kindex;
+
+	//Now column counts into colptr
+	for (indexval=0; indexval<=sm->ncols; indexval++)
+		sm->colptr[indexval] = 0;
+	for (kindex=0; kindex<sm->nnz; kindex++)
+		sm->colptr[sm->col_in[kindex]+1]++;
+	for (indexval=0; indexval<sm->ncols; indexval++)
+		sm->colptr[indexval+1] += sm->colptr[indexval];
+
+	//Stable placement by column - colptr is used as the insertion cursor
+	for (kindex=0; kindex<sm->nnz; kindex++)
+	{
+		unsigned int entry = sm->work[kindex];
+		int col = sm->col_in[entry];
+		int pos = sm->colptr[col]++;
+
+		sm->rowind[pos] = sm->row_in[entry];
+		sm->slot[entry] = pos;
+	}
 
-	new_list_element->next = NULL;
-	new_list_element->row_ind = row;
-	new_list_element->value = value;
+	//Shift colptr back to column starts
+	for (indexval=sm->ncols; indexval>0; indexval--)
+		sm->colptr[indexval] = sm->colptr[indexval-1];
+	sm->colptr[0] = 0;
 
-	//if there's a non empty list, traverse to find our rightful insertion point
-	if(insertion_point != NULL)
+	//Duplicate check -- adjacent rows within a column
+	for (indexval=0; indexval<sm->ncols; indexval++)
 	{
-		if(insertion_point->row_ind > new_list_element->row_ind)
-		{
-			//insert the new list element at the first position
-			new_list_element->next = insertion_point;
-			sm->cols[col] = new_list_element;
-		}
-		else
+		for (kindex=sm->colptr[indexval]+1; kindex<(unsigned int)sm->colptr[indexval+1]; kindex++)
 		{
-			while((insertion_point->next != NULL) && (insertion_point->next->row_ind < new_list_element->row_ind))
-			{
-				insertion_point = insertion_point->next;
-			}
-
-			//Duplicate check -- see how we exited
-			if (insertion_point->next != NULL)	//We exited because the next element is GEQ to the new element
-			{
-				if (insertion_point->next->row_ind == new_list_element->row_ind)	//Same entry (by column), so bad
-				{
-					GL_THROW("NR: duplicate admittance entry found - check for parallel circuits between common nodes!");
-					/*  TROUBLESHOOT
-					While building up the admittance matrix for the Newton-Raphson solver, a duplicate entry was found.
-					This is often caused by having multiple lines on the same phases in parallel between two nodes.  Please
-					reconcile this model difference and try again.
-					*/
-				}
-			}
-			else	//No next item, so see if our value matches
+			if (sm->rowind[kindex] == sm->rowind[kindex-1])	//Same entry (by column), so bad
 			{
-				if (insertion_point->row_ind == new_list_element->row_ind)	//Same entry (by column), so bad
-				{
-					GL_THROW("NR: duplicate admittance entry found - check for parallel circuits between common nodes!");
-					//Defined above
-				}
+				GL_THROW("NR: duplicate admittance entry found - check for parallel circuits between common nodes!");
+				/*  TROUBLESHOOT
+				While building up the admittance matrix for the Newton-Raphson solver, a duplicate entry was found.
+				This is often caused by having multiple lines on the same phases in parallel between two nodes.  Please
+				reconcile this model difference and try again.
+				*/
 			}
-
-			//insert the new list element at the next position
-			new_list_element->next = insertion_point->next;
-			insertion_point->next = new_list_element;
 		}
 	}
-	else
-		sm->cols[col] = new_list_element;
+
+	sm->pattern_nnz = sm->nnz;
+	sm->pattern_id = sparse_pattern_next();
+	sm->pattern_valid = true;
+}
+
+//Finish an assembly pass - rebuild the pattern if needed, then scatter the values into it
+void sparse_build(SPARSE* sm)
+{
+	unsigned int kindex;
+
+	if (!sm->pattern_valid || (sm->pattern_nnz != sm->nnz))
+		sparse_pattern(sm);
+
+	for (kindex=0; kindex<sm->nnz; kindex++)
+		sm->value[sm->slot[kindex]] = sm->val_in[kindex];
 }
 
 void sparse_tonr(SPARSE* sm, NR_SOLVER_VARS *matrices_LU)
 {
-	//traverse each linked list, which are in order, and copy values into new array
-	unsigned int rowidx = 0;
+	//copy the column-sorted pattern and values into the solver arrays (empty columns are skipped)
 	unsigned int colidx = 0;
 	unsigned int i;
-	SP_E* LL_pointer;
 
 	matrices_LU->cols_LU[0] = 0;
-	LL_pointer = NULL;
 	for(i = 0; i < sm->ncols; i++)
 	{
-		LL_pointer = sm->cols[i];
-		if(LL_pointer != NULL)
-		{
-			matrices_LU->cols_LU[colidx++] = rowidx;
-		}		
-		while(LL_pointer != NULL)
+		if (sm->colptr[i+1] > sm->colptr[i])
 		{
-			matrices_LU->rows_LU[rowidx] = LL_pointer->row_ind; // row pointers of non zero values
-			matrices_LU->a_LU[rowidx] = LL_pointer->value;
-			++rowidx;
-			LL_pointer = LL_pointer->next;
-		}		
+			matrices_LU->cols_LU[colidx++] = sm->colptr[i];
+		}
 	}
+	memcpy(matrices_LU->rows_LU,sm->rowind,sm->nnz*sizeof(int));
+	memcpy(matrices_LU->a_LU,sm->value,sm->nnz*sizeof(double));
 }
 
-/** Newton-Raphson solver
-	Solves a power flow problem using the Newton-Raphson method
-	
-	@return n=0 on failure to complete a single iteration, 
-	n>0 to indicate success after n interations, or 
-	n<0 to indicate failure after n iterations
- **/
-int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count, BRANCHDATA *branch, NR_SOLVER_STRUCT *powerflow_values, NRSOLVERMODE powerflow_type , NR_MESHFAULT_IMPEDANCE *mesh_imped_vals, bool *bad_computations)
+#ifdef MT
+//Release the stored elimination tree and factors
+void NR_superLU_release(NR_SOLVER_LU *LU)
 {
-	//Internal iteration counter - just NR limits
-	int64 Iteration;
-
-	//File pointer for debug outputs
-	FILE *FPoutVal;
+	if (LU->superLU_symbolic_valid)
+	{
+		SUPERLU_FREE(LU->superLU_options.etree);
+		SUPERLU_FREE(LU->superLU_options.colcnt_h);
+		SUPERLU_FREE(LU->superLU_options.part_super_h);
 
-	//A matrix size variable
-	unsigned int size_Amatrix;
+		/* superLU matrix types must be destroyed, otherwise they balloon fast (65 MB norma becomes 1.5 GB) */
+		Destroy_SuperNode_SCP(&LU->superLU_L);
+		Destroy_CompCol_NCP(&LU->superLU_U);
 
-	//Voltage mismatch tracking variable
-	double Maxmismatch;
+		LU->superLU_symbolic_valid = false;
+	}
+}
 
-	//Saturation mismatch tracking variable
-	bool SaturationMismatchPresent;
-	int func_result_val;
+//Factor A and solve A*X=B - B is overwritten with X (same steps as pdgssv, but with reuse of the symbolic phase)
+void NR_superLU_solve(NR_SOLVER_LU *LU, SuperMatrix *A, SuperMatrix *B, SPARSE *sm, int *info)
+{
+	SuperMatrix AC;
+	Gstat_t Gstat;
+	int n = A->ncol;
+	int panel_size = sp_ienv(1);
+	int relax = sp_ienv(2);
+	yes_no_t refact;
+	NR_superLU_wlock lock;
+
+	//See if the last factorization was for this same pattern
+	if (NR_symbolic_reuse && LU->superLU_symbolic_valid && (LU->superLU_pattern_id == sm->pattern_id) && (LU->superLU_size == n))
+	{
+		refact = YES;
+		NR_symbolic_skips++;
+	}
+	else	//Full factorization - new column ordering
+	{
+		NR_superLU_release(LU);
+		get_perm_c(1, A, LU->perm_c);
+		refact = NO;
+	}
 
-	//Phase collapser variable
-	unsigned char phase_worka, phase_workb, phase_workc, phase_workd, phase_worke;
+	StatAlloc(n, NR_superLU_procs, panel_size, relax, &Gstat);
+	StatInit(n, NR_superLU_procs, &Gstat);
 
-	//Temporary calculation variables
-	double tempIcalcReal, tempIcalcImag;
-	double tempPbus; //tempPbus store the temporary value of active power load at each bus
-	double tempQbus; //tempQbus store the temporary value of reactive power load at each bus
+	//Apply perm_c to A (and build the elimination tree if refact is NO), then factor and solve
+	pdgstrf_init(NR_superLU_procs, EQUILIBRATE, NOTRANS, refact, panel_size, relax, 1.0, refact, 0.0, LU->perm_c, LU->perm_r, NULL, 0, A, &AC, &LU->superLU_options, &Gstat);
+	pdgstrf(&LU->superLU_options, &AC, LU->perm_r, &LU->superLU_L, &LU->superLU_U, &Gstat, info);
 
-	//Miscellaneous index variable
-	unsigned int indexer, tempa, tempb, jindexer, kindexer;
-	char jindex, kindex;
-	char temp_index, temp_index_b;
-	unsigned int temp_index_c;
+	if (*info == 0)
+	{
+		dgstrs(NOTRANS, &LU->superLU_L, &LU->superLU_U, LU->perm_r, LU->perm_c, B, &Gstat, info);
+	}
 
-	//Working matrix for admittance collapsing/determinations
-	complex tempY[3][3];
+	Destroy_CompCol_Permuted(&AC);
+	StatFree(&Gstat);
 
-	//Working matrix for mesh fault impedance storage, prior to "reconstruction"
-	double temp_z_store[6][6];
+	//Factors and elimination tree now belong to this pattern
+	LU->superLU_symbolic_valid = true;
+	LU->superLU_pattern_id = sm->pattern_id;
+	LU->superLU_size = n;
 
-	//Miscellaneous flag variables
-	bool Full_Mat_A, Full_Mat_B, proceed_flag;
+	//Only keep them if they are going to be reused
+	if ((NR_symbolic_reuse == false) || (*info != 0))
+	{
+		NR_superLU_release(LU);
+	}
+}
+#endif
 
-	//Iteration flag
-	bool newiter;
+//Get the LU working state of a system, allocating it on first use
+static NR_SOLVER_LU *NR_get_LU_state(NR_SOLVER_STRUCT *powerflow_values)
+{
+	if (powerflow_values->LU_state == NULL)
+	{
+		powerflow_values->LU_state = (NR_SOLVER_LU *)gl_malloc(sizeof(NR_SOLVER_LU));
 
-	//Deltamode pass flag - changes how SWING buses are handled
-	//Multiple SWING-bus attached generators may cause issues, but no good way to detect
-	bool swing_is_a_swing;
+		//Make sure it worked
+		if (powerflow_values->LU_state == NULL)
+			GL_THROW("NR: One of the SuperLU solver matrices failed to allocate");
+			//Defined below
 
-	//Deltamode initial dynamics run - swing convergence flag (symmetry)
-	bool swing_converged;
+		memset(powerflow_values->LU_state,0,sizeof(NR_SOLVER_LU));
+	}
+	return powerflow_values->LU_state;
+}
 
-	//Deltamode intermediate variables
-	complex temp_complex_0, temp_complex_1, temp_complex_2, temp_complex_3, temp_complex_4, temp_complex_5;
-	complex aval, avalsq;
+//Free the complex pattern of a system
+static void NR_complex_pattern_free(NR_SOLVER_LU *LU)
+{
+	gl_free(LU->complex_map);
+	gl_free(LU->complex_colptr);
+	gl_free(LU->complex_rowind);
+	gl_free(LU->complex_diag);
+	gl_free(LU->complex_value);
+	gl_free(LU->complex_rhs);
+	gl_free(LU->complex_target);
+	gl_free(LU->complex_scale);
+
+	LU->complex_map = LU->complex_colptr = LU->complex_rowind = LU->complex_diag = LU->complex_target = NULL;
+	LU->complex_value = LU->complex_rhs = LU->complex_scale = NULL;
+	LU->complex_pattern_valid = false;
+}
 
-	//Temporary size variable
-	char temp_size, temp_size_b, temp_size_c;
+//Build the complex pattern from the column-sorted Y_Amatrix pattern
+//A bus with Matrix_Loc L and s phases uses real rows/columns 2L..2L+s-1 (first half) and 2L+s..2L+2s-1 (second half)
+//and complex rows/columns L..L+s-1.  With Y=G+jB, each real 2x2 group is [B G; G -B] (rows imaginary/real current,
+//columns real/imaginary voltage), so a group [p q; r t] folds into the complex value (q+r)/2 + j(p-t)/2.
+static void NR_complex_pattern(NR_SOLVER_LU *LU, unsigned int bus_count, BUSDATA *bus, NR_SOLVER_STRUCT *powerflow_values)
+{
+	SPARSE *sm = powerflow_values->Y_Amatrix;
+	int size = powerflow_values->total_variables;
+	int nnz = sm->colptr[sm->ncols];
+	int *fold, *position;
+	int cindex, rindex, half, col_half, kindex, jindex, start, temp_row;
+	unsigned int indexer;
+
+	NR_complex_pattern_free(LU);
+
+	LU->complex_map = (int *)gl_malloc(2*size*sizeof(int));
+	LU->complex_colptr = (int *)gl_malloc((size+1)*sizeof(int));
+	LU->complex_rowind = (int *)gl_malloc(nnz*sizeof(int));
+	LU->complex_diag = (int *)gl_malloc(size*sizeof(int));
+	LU->complex_value = (double *)gl_malloc(2*nnz*sizeof(double));
+	LU->complex_rhs = (double *)gl_malloc(2*size*sizeof(double));
+	LU->complex_target = (int *)gl_malloc(nnz*sizeof(int));
+	LU->complex_scale = (double *)gl_malloc(nnz*sizeof(double));
+	fold = (int *)gl_malloc(sm->ncols*sizeof(int));
+	position = (int *)gl_malloc(size*sizeof(int));
+
+	//Make sure it worked
+	if ((LU->complex_map == NULL) || (LU->complex_colptr == NULL) || (LU->complex_rowind == NULL) || (LU->complex_diag == NULL) || (LU->complex_value == NULL) || (LU->complex_rhs == NULL) || (LU->complex_target == NULL) || (LU->complex_scale == NULL) || (fold == NULL) || (position == NULL))
+		GL_THROW("NR: One of the SuperLU solver matrices failed to allocate");
+		//Defined above
 
-	//Temporary admittance variables
-	complex Temp_Ad_A[3][3];
-	complex Temp_Ad_B[3][3];
+	//Real index of each complex index, and complex index/half of each real index
+	for (indexer=0; indexer<sm->ncols; indexer++)
+		fold[indexer] = -1;
 
-	//Temporary load calculation variables
-	complex undeltacurr[3];
-	complex delta_current[3], voltageDel[3];
-	complex temp_current[3], temp_power[3], temp_store[3];
-	complex adjusted_constant_current[6];
-	complex adjust_temp_nominal_voltage[6];
-	double adjust_temp_voltage_mag[6];
-	double adjust_nominal_voltage_val, adjust_nominal_voltaged_val;
+	for (indexer=0; indexer<bus_count; indexer++)
+	{
+		for (jindex=0; jindex<powerflow_values->BA_diag[indexer].size; jindex++)
+		{
+			cindex = bus[indexer].Matrix_Loc + jindex;
+			LU->complex_map[2*cindex] = 2*bus[indexer].Matrix_Loc + jindex;
+			LU->complex_map[2*cindex+1] = 2*bus[indexer].Matrix_Loc + powerflow_values->BA_diag[indexer].size + jindex;
+			fold[LU->complex_map[2*cindex]] = 2*cindex;
+			fold[LU->complex_map[2*cindex+1]] = 2*cindex + 1;
+		}
+	}
 
-	//DV checking array
-	complex DVConvCheck[3];
-	double CurrConvVal;
+	//Complex rows of each column - both real columns of a complex column land in it
+	for (cindex=0; cindex<size; cindex++)
+		position[cindex] = -1;
 
-	//Miscellaneous counter tracker
-	unsigned int index_count = 0;
+	LU->complex_nnz = 0;
+	LU->complex_colptr[0] = 0;
+	for (cindex=0; cindex<size; cindex++)
+	{
+		start = LU->complex_nnz;
+		LU->complex_diag[cindex] = -1;
 
-	//Miscellaneous working variable
-	double work_vals_double_0, work_vals_double_1,work_vals_double_2,work_vals_double_3,work_vals_double_4;
-	char work_vals_char_0;
+		for (half=0; half<2; half++)
+		{
+			jindex = LU->complex_map[2*cindex+half];
+			for (kindex=sm->colptr[jindex]; kindex<sm->colptr[jindex+1]; kindex++)
+			{
+				if (fold[sm->rowind[kindex]] < 0)
+				{
+					GL_THROW("NR: An error occurred folding the admittance matrix into complex form");
+					/*  TROUBLESHOOT
+					While building the complex form of the Newton-Raphson admittance matrix, an element was found
+					that does not belong to any bus.  Please submit your code and a bug report via the ticketing system.
+					*/
+				}
 
-	//SuperLU variables
-	SuperMatrix L_LU,U_LU;
-	NCformat *Astore;
-	DNformat *Bstore;
-	int nnz, info;
-	unsigned int m,n;
-	double *sol_LU;
+				rindex = fold[sm->rowind[kindex]] >> 1;
+				if (position[rindex] != cindex)
+				{
+					position[rindex] = cindex;
+					LU->complex_rowind[LU->complex_nnz++] = rindex;
+				}
+			}
+		}
 
-	//Spare notation variable - for output
-	SP_E *temp_element;
-	int row, col;
-	double value;
-	
-#ifndef MT
-	superlu_options_t options;	//Additional variables for sequential superLU
-	SuperLUStat_t stat;
-#endif
+		//Sort the rows of the column (only a few bus blocks in each)
+		for (kindex=start+1; kindex<LU->complex_nnz; kindex++)
+		{
+			temp_row = LU->complex_rowind[kindex];
+			for (jindex=kindex; (jindex>start) && (LU->complex_rowind[jindex-1] > temp_row); jindex--)
+				LU->complex_rowind[jindex] = LU->complex_rowind[jindex-1];
+			LU->complex_rowind[jindex] = temp_row;
+		}
 
-	//Ensure bad computations flag is set first
-	*bad_computations = false;
+		LU->complex_colptr[cindex+1] = LU->complex_nnz;
+	}
 
-	//Determine special circumstances of SWING bus -- do we want it to truly participate right
-	if (powerflow_type != PF_NORMAL)
+	//Where each real element folds into
+	for (cindex=0; cindex<size; cindex++)
 	{
-		if (powerflow_type == PF_DYNCALC)	//Parse the list -- anything that is a swing and a generator, deflag it out of principle (and to make it work right)
+		for (kindex=LU->complex_colptr[cindex]; kindex<LU->complex_colptr[cindex+1]; kindex++)
 		{
-			//Set the master swing flag
-			swing_is_a_swing = false;
+			position[LU->complex_rowind[kindex]] = kindex;
+			if (LU->complex_rowind[kindex] == cindex)
+				LU->complex_diag[cindex] = kindex;
+		}
 
-			//Check the buses
-			for (indexer=0; indexer<bus_count; indexer++)
+		for (col_half=0; col_half<2; col_half++)
+		{
+			jindex = LU->complex_map[2*cindex+col_half];
+			for (kindex=sm->colptr[jindex]; kindex<sm->colptr[jindex+1]; kindex++)
 			{
-				//See if we're a swing-flagged bus
-				if ((bus[indexer].type > 1) && (bus[indexer].swing_functions_enabled == true))
+				rindex = fold[sm->rowind[kindex]] >> 1;
+				half = fold[sm->rowind[kindex]] & 1;
+
+				if (half == col_half)	//p or t - imaginary part
 				{
-					//See if we're "generator ready"
-					if ((*bus[indexer].dynamics_enabled==true) && (bus[indexer].full_Y != NULL) && (bus[indexer].DynCurrent != NULL))
-					{
-						//Deflag us back to "PQ" status
-						bus[indexer].swing_functions_enabled = false;
-					}
+					LU->complex_target[kindex] = 2*position[rindex] + 1;
+					LU->complex_scale[kindex] = (half == 0) ? 0.5 : -0.5;
 				}
-				//Default else -- normal bus
-			}//End bus traversion loop
-		}//Handle running dynamics differently
-		else	//Must be PF_DYNINIT
-		{
-			//Flag us as true, initially
-			swing_is_a_swing = true;
+				else	//q or r - real part
+				{
+					LU->complex_target[kindex] = 2*position[rindex];
+					LU->complex_scale[kindex] = 0.5;
+				}
+			}
 		}
-	}//End not normal
-	else	//Must be normal
+	}
+
+	gl_free(fold);
+	gl_free(position);
+
+	LU->complex_size = size;
+	LU->complex_pattern_id = sm->pattern_id;
+	LU->complex_pattern_valid = true;
+}
+
+//Fold the real system into the complex one - values and right-hand side
+static void NR_complex_fold(NR_SOLVER_LU *LU, unsigned int bus_count, BUSDATA *bus, NR_SOLVER_STRUCT *powerflow_values)
+{
+	SPARSE *sm = powerflow_values->Y_Amatrix;
+	unsigned int indexer;
+	int kindex, jindex, cindex;
+
+	//Pattern only changes with Y_Amatrix
+	if (!LU->complex_pattern_valid || (LU->complex_pattern_id != sm->pattern_id) || (LU->complex_size != (int)powerflow_values->total_variables) || powerflow_values->NR_realloc_needed)
+		NR_complex_pattern(LU, bus_count, bus, powerflow_values);
+
+	memset(LU->complex_value,0,2*LU->complex_nnz*sizeof(double));
+	for (kindex=0; kindex<sm->colptr[sm->ncols]; kindex++)
+		LU->complex_value[LU->complex_target[kindex]] += LU->complex_scale[kindex]*sm->value[kindex];
+
+	//The SWING large admittance only pins the real formulation (it has no complex-linear part), so put it back in
+	for (indexer=0; indexer<bus_count; indexer++)
 	{
-		swing_is_a_swing = true;	//Flag as a swing, even though this shouldn't do anything
+		if ((bus[indexer].type > 1) && (bus[indexer].swing_functions_enabled == true))
+		{
+			for (jindex=0; jindex<powerflow_values->BA_diag[indexer].size; jindex++)
+			{
+				cindex = bus[indexer].Matrix_Loc + jindex;
+				if (LU->complex_diag[cindex] >= 0)
+					LU->complex_value[2*LU->complex_diag[cindex]] += 1e10;	// swing bus gets large admittance
+			}
+		}
 	}
 
-	//Populate aval, if necessary
-	if (powerflow_type == PF_DYNINIT)
+	//Current injection - first half is the imaginary part, second half the real part
+	for (cindex=0; cindex<LU->complex_size; cindex++)
 	{
-		//Conversion variables - 1@120-deg
-		aval = complex(-0.5,(sqrt(3.0)/2.0));
-		avalsq = aval*aval;	//squared value is used a couple places too
+		LU->complex_rhs[2*cindex] = powerflow_values->deltaI_NR[LU->complex_map[2*cindex+1]];
+		LU->complex_rhs[2*cindex+1] = powerflow_values->deltaI_NR[LU->complex_map[2*cindex]];
 	}
-	else	//Zero it, just in case something uses it (what would???)
+}
+
+//Unfold the complex voltage updates into the real solution layout - first half real part, second half imaginary part
+static void NR_complex_unfold(NR_SOLVER_LU *LU, double *sol)
+{
+	int cindex;
+
+	for (cindex=0; cindex<LU->complex_size; cindex++)
 	{
-		aval = 0.0;
-		avalsq = 0.0;
+		sol[LU->complex_map[2*cindex]] = LU->complex_rhs[2*cindex];
+		sol[LU->complex_map[2*cindex+1]] = LU->complex_rhs[2*cindex+1];
 	}
+}
 
-	if (matrix_solver_method==MM_EXTERN)
+//Build the self admittance of a bus (its BA_diag entry) from the branches connected to it
+//The BA_diag location (row_ind/col_ind) is left to the caller
+static void NR_bus_self_admittance(unsigned int indexer, BUSDATA *bus, BRANCHDATA *branch, NR_SOLVER_STRUCT *powerflow_values, NRSOLVERMODE powerflow_type)
+{
+	unsigned char phase_worka, phase_workb, phase_workc, phase_workd, phase_worke;
+	unsigned int jindexer, kindexer;
+	char jindex, kindex;
+	complex tempY[3][3];
+
+	//Determine the size we need
+	if ((bus[indexer].phases & 0x80) == 0x80)	//Split phase
+		powerflow_values->BA_diag[indexer].size = 2;
+	else										//Other cases, figure out how big they are
 	{
-		//Call the initialization routine
-		ext_solver_glob_vars = ((void *(*)(void *))(LUSolverFcns.ext_init))(ext_solver_glob_vars);
+		phase_worka = 0;
+		for (jindex=0; jindex<3; jindex++)		//Accumulate number of phases
+		{
+			phase_worka += ((bus[indexer].phases & (0x01 << jindex)) >> jindex);
+		}
+		powerflow_values->BA_diag[indexer].size = phase_worka;
+	}
 
-		//Make sure it worked (allocation check)
-		if (ext_solver_glob_vars==NULL)
+	//Ensure the admittance matrix is zeroed
+	for (jindex=0; jindex<3; jindex++)
+	{
+		for (kindex=0; kindex<3; kindex++)
 		{
-			GL_THROW("External LU matrix solver failed to allocate memory properly!");
-			/*  TROUBLESHOOT
-			While attempting to allocate memory for the external LU solver, an error occurred.
-			Please try again.  If the error persists, ensure your external LU solver is behaving correctly
-			and coordinate with their development team as necessary.
-			*/
+			powerflow_values->BA_diag[indexer].Y[jindex][kindex] = 0;
+			tempY[jindex][kindex] = 0;
 		}
 	}
 
-	if (NR_admit_change)	//If an admittance update was detected, fix it
+	//If we're in any deltamode, store out self-admittance as well, if it exists
+	if ((powerflow_type!=PF_NORMAL) && (bus[indexer].full_Y != NULL))
 	{
-		//Build the diagnoal elements of the bus admittance matrix - this should only happen once no matter what
-		if (powerflow_values->BA_diag == NULL)
+		//Loop and add
+		for (jindex=0; jindex<3; jindex++)
 		{
-			powerflow_values->BA_diag = (Bus_admit *)gl_malloc(bus_count *sizeof(Bus_admit));   //BA_diag store the location and value of diagonal elements of Bus Admittance matrix
-
-			//Make sure it worked
-			if (powerflow_values->BA_diag == NULL)
+			for (kindex=0; kindex<3; kindex++)
 			{
-				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
-				/*  TROUBLESHOOT
-				During the allocation stage of the NR algorithm, one of the matrices failed to be allocated.
-				Please try again and if this bug persists, submit your code and a bug report using the trac
-				website.
-				*/
+				tempY[jindex][kindex] = bus[indexer].full_Y[jindex*3+kindex];	//Adds in any self-admittance terms (generators)
 			}
 		}
-		
-		for (indexer=0; indexer<bus_count; indexer++) // Construct the diagonal elements of Bus admittance matrix.
-		{
-			//Determine the size we need
-			if ((bus[indexer].phases & 0x80) == 0x80)	//Split phase
-				powerflow_values->BA_diag[indexer].size = 2;
-			else										//Other cases, figure out how big they are
-			{
-				phase_worka = 0;
-				for (jindex=0; jindex<3; jindex++)		//Accumulate number of phases
-				{
-					phase_worka += ((bus[indexer].phases & (0x01 << jindex)) >> jindex);
-				}
-				powerflow_values->BA_diag[indexer].size = phase_worka;
-			}
+	}
 
-			//Ensure the admittance matrix is zeroed
-			for (jindex=0; jindex<3; jindex++)
-			{
-				for (kindex=0; kindex<3; kindex++)
-				{
-					powerflow_values->BA_diag[indexer].Y[jindex][kindex] = 0;
-					tempY[jindex][kindex] = 0;
-				}
-			}
+	//Now go through all of the branches to get the self admittance information (hinges on size)
+	for (kindexer=0; kindexer<(bus[indexer].Link_Table_Size);kindexer++)
+	{ 
+		//Assign jindexer as intermediate variable (easier for me this way)
+		jindexer = bus[indexer].Link_Table[kindexer];
 
-			//If we're in any deltamode, store out self-admittance as well, if it exists
-			if ((powerflow_type!=PF_NORMAL) && (bus[indexer].full_Y != NULL))
+		if ((branch[jindexer].from == indexer) || (branch[jindexer].to == indexer))	//Bus is the from or to side of things - not sure how it would be in link table otherwise, but meh
+		{
+			if ((bus[indexer].phases & 0x07) == 0x07)		//Full three phase
 			{
-				//Loop and add
-				for (jindex=0; jindex<3; jindex++)
+				for (jindex=0; jindex<3; jindex++)	//Add in all three phase values
 				{
-					for (kindex=0; kindex<3; kindex++)
-					{
-						tempY[jindex][kindex] = bus[indexer].full_Y[jindex*3+kindex];	//Adds in any self-admittance terms (generators)
-					}
-				}
-			}
-
-			//Now go through all of the branches to get the self admittance information (hinges on size)
-			for (kindexer=0; kindexer<(bus[indexer].Link_Table_Size);kindexer++)
-			{ 
-				//Assign jindexer as intermediate variable (easier for me this way)
-				jindexer = bus[indexer].Link_Table[kindexer];
+					//See if this phase is valid
+					phase_workb = 0x04 >> jindex;
 
-				if ((branch[jindexer].from == indexer) || (branch[jindexer].to == indexer))	//Bus is the from or to side of things - not sure how it would be in link table otherwise, but meh
-				{
-					if ((bus[indexer].phases & 0x07) == 0x07)		//Full three phase
+					if ((phase_workb & branch[jindexer].phases) == phase_workb)
 					{
-						for (jindex=0; jindex<3; jindex++)	//Add in all three phase values
+						for (kindex=0; kindex<3; kindex++)
 						{
-							//See if this phase is valid
-							phase_workb = 0x04 >> jindex;
-
-							if ((phase_workb & branch[jindexer].phases) == phase_workb)
-							{
-								for (kindex=0; kindex<3; kindex++)
-								{
-									//Check phase
-									phase_workd = 0x04 >> kindex;
+							//Check phase
+							phase_workd = 0x04 >> kindex;
 
-									if ((phase_workd & branch[jindexer].phases) == phase_workd)
-									{
-										if (branch[jindexer].from == indexer)	//We're the from version
-										{
-											tempY[jindex][kindex] += branch[jindexer].YSfrom[jindex*3+kindex];
-										}
-										else									//Must be the to version
-										{
-											tempY[jindex][kindex] += branch[jindexer].YSto[jindex*3+kindex];
-										}
-									}//End valid column phase
-								}
-							}//End valid row phase
-						}
-					}
-					else if ((bus[indexer].phases & 0x80) == 0x80)	//Split phase - add in 2x2 element to upper left 2x2
-					{
-						if (branch[jindexer].from == indexer)	//From branch
-						{
-							//End of SPCT transformer requires slightly different Diagonal components (so when it's the To bus of SPCT and from for other triplex
-							if ((bus[indexer].phases & 0x20) == 0x20)	//Special case
-							{
-								//Other triplexes need to be negated to match sign conventions
-								tempY[0][0] -= branch[jindexer].YSfrom[0];
-								tempY[0][1] -= branch[jindexer].YSfrom[1];
-								tempY[1][0] -= branch[jindexer].YSfrom[3];
-								tempY[1][1] -= branch[jindexer].YSfrom[4];
-							}
-							else										//Just a normal to bus
+							if ((phase_workd & branch[jindexer].phases) == phase_workd)
 							{
-								tempY[0][0] += branch[jindexer].YSfrom[0];
-								tempY[0][1] += branch[jindexer].YSfrom[1];
-								tempY[1][0] += branch[jindexer].YSfrom[3];
-								tempY[1][1] += branch[jindexer].YSfrom[4];
-							}
-						}
-						else									//To branch
-						{
-							tempY[0][0] += branch[jindexer].YSto[0];
-							tempY[0][1] += branch[jindexer].YSto[1];
-							tempY[1][0] += branch[jindexer].YSto[3];
-							tempY[1][1] += branch[jindexer].YSto[4];
-						}
-					}
-					else	//We must be a single or two-phase line - always populate the upper left portion of matrix (easier for later)
-					{
-						switch(bus[indexer].phases & 0x07) {
-							case 0x00:	//No phases (we've been faulted out
-								{
-									break;	//Just get us outta here
-								}
-							case 0x01:	//Only C
-								{
-									if ((branch[jindexer].phases & 0x01) == 0x01)	//Phase C valid on branch
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[8];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[8];
-										}
-									}//End valid phase C
-									break;
-								}
-							case 0x02:	//Only B
-								{
-									if ((branch[jindexer].phases & 0x02) == 0x02)	//Phase B valid on branch
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[4];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[4];
-										}
-									}//End valid phase B
-									break;
-								}
-							case 0x03:	//B & C
-								{
-									phase_worka = (branch[jindexer].phases & 0x03);	//Extract branch phases
-
-									if (phase_worka == 0x03)	//Full B & C
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[4];
-											tempY[0][1] += branch[jindexer].YSfrom[5];
-											tempY[1][0] += branch[jindexer].YSfrom[7];
-											tempY[1][1] += branch[jindexer].YSfrom[8];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[4];
-											tempY[0][1] += branch[jindexer].YSto[5];
-											tempY[1][0] += branch[jindexer].YSto[7];
-											tempY[1][1] += branch[jindexer].YSto[8];
-										}
-									}//End valid B & C
-									else if (phase_worka == 0x01)	//Only C branch
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[1][1] += branch[jindexer].YSfrom[8];
-										}
-										else									//To branch
-										{
-											tempY[1][1] += branch[jindexer].YSto[8];
-										}
-									}//end valid C
-									else if (phase_worka == 0x02)	//Only B branch
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[4];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[4];
-										}
-									}//end valid B
-									else	//Must be nothing then - all phases must be faulted, or something
-										;
-									break;
-								}
-							case 0x04:	//Only A
-								{
-									if ((branch[jindexer].phases & 0x04) == 0x04)	//Phase A is valid
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[0];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[0];
-										}
-									}//end valid phase A
-									break;
-								}
-							case 0x05:	//A & C
-								{
-									phase_worka = branch[jindexer].phases & 0x05;	//Extract phases
-
-									if (phase_worka == 0x05)	//Both A & C valid
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[0];
-											tempY[0][1] += branch[jindexer].YSfrom[2];
-											tempY[1][0] += branch[jindexer].YSfrom[6];
-											tempY[1][1] += branch[jindexer].YSfrom[8];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[0];
-											tempY[0][1] += branch[jindexer].YSto[2];
-											tempY[1][0] += branch[jindexer].YSto[6];
-											tempY[1][1] += branch[jindexer].YSto[8];
-										}
-									}//End A & C valid
-									else if (phase_worka == 0x04)	//Only A valid
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[0];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[0];
-										}
-									}//end only A valid
-									else if (phase_worka == 0x01)	//Only C valid
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[1][1] += branch[jindexer].YSfrom[8];
-										}
-										else									//To branch
-										{
-											tempY[1][1] += branch[jindexer].YSto[8];
-										}
-									}//end only C valid
-									else	//No connection - must be faulted
-										;
-									break;
-								}
-							case 0x06:	//A & B
+								if (branch[jindexer].from == indexer)	//We're the from version
 								{
-									phase_worka = branch[jindexer].phases & 0x06;	//Extract phases
-
-									if (phase_worka == 0x06)	//Valid A & B phase
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[0];
-											tempY[0][1] += branch[jindexer].YSfrom[1];
-											tempY[1][0] += branch[jindexer].YSfrom[3];
-											tempY[1][1] += branch[jindexer].YSfrom[4];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[0];
-											tempY[0][1] += branch[jindexer].YSto[1];
-											tempY[1][0] += branch[jindexer].YSto[3];
-											tempY[1][1] += branch[jindexer].YSto[4];
-										}
-									}//End valid A & B
-									else if (phase_worka == 0x04)	//Only valid A
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[0][0] += branch[jindexer].YSfrom[0];
-										}
-										else									//To branch
-										{
-											tempY[0][0] += branch[jindexer].YSto[0];
-										}
-									}//end valid A
-									else if (phase_worka == 0x02)	//Only valid B
-									{
-										if (branch[jindexer].from == indexer)	//From branch
-										{
-											tempY[1][1] += branch[jindexer].YSfrom[4];
-										}
-										else									//To branch
-										{
-											tempY[1][1] += branch[jindexer].YSto[4];
-										}
-									}//end valid B
-									else	//Default - must be already handled
-										;
-									break;
+									tempY[jindex][kindex] += branch[jindexer].YSfrom[jindex*3+kindex];
 								}
-							default:	//How'd we get here?
+								else									//Must be the to version
 								{
-									GL_THROW("Unknown phase connection in NR self admittance diagonal");
-									/*  TROUBLESHOOT
-									An unknown phase condition was encountered in the NR solver when constructing
-									the self admittance diagonal.  Please report this bug and submit your code to 
-									the trac system.
-									*/
-								break;
+									tempY[jindex][kindex] += branch[jindexer].YSto[jindex*3+kindex];
 								}
-						}	//switch end
-					}	//1 or 2 phase end
-				}	//phase accumulation end
-				else		//It's nothing (no connnection)
-					;
-			}//branch traversion end
-
-			//Store the self admittance into BA_diag.  Also update the indices for possible use later
-			powerflow_values->BA_diag[indexer].col_ind = powerflow_values->BA_diag[indexer].row_ind = index_count;	// Store the row and column starting information (square matrices)
-			bus[indexer].Matrix_Loc = index_count;								//Store our location so we know where we go
-			index_count += powerflow_values->BA_diag[indexer].size;				// Update the index for this matrix's size, so next one is in appropriate place
-
-
-			//Store the admittance values into the BA_diag matrix structure
-			for (jindex=0; jindex<powerflow_values->BA_diag[indexer].size; jindex++)
-			{
-				for (kindex=0; kindex<powerflow_values->BA_diag[indexer].size; kindex++)			//Store values - assume square matrix - don't bother parsing what doesn't exist.
-				{
-					powerflow_values->BA_diag[indexer].Y[jindex][kindex] = tempY[jindex][kindex];// Store the self admittance terms.
+							}//End valid column phase
+						}
+					}//End valid row phase
 				}
 			}
-
-			//Copy values into node-specific link (if needed)
-			if (bus[indexer].full_Y_all != NULL)
+			else if ((bus[indexer].phases & 0x80) == 0x80)	//Split phase - add in 2x2 element to upper left 2x2
 			{
-				for (jindex=0; jindex<powerflow_values->BA_diag[indexer].size; jindex++)
+				if (branch[jindexer].from == indexer)	//From branch
 				{
-					for (kindex=0; kindex<powerflow_values->BA_diag[indexer].size; kindex++)			//Store values - assume square matrix - don't bother parsing what doesn't exist.
+					//End of SPCT transformer requires slightly different Diagonal components (so when it's the To bus of SPCT and from for other triplex
+					if ((bus[indexer].phases & 0x20) == 0x20)	//Special case
+					{
+						//Other triplexes need to be negated to match sign conventions
+						tempY[0][0] -= branch[jindexer].YSfrom[0];
+						tempY[0][1] -= branch[jindexer].YSfrom[1];
+						tempY[1][0] -= branch[jindexer].YSfrom[3];
+						tempY[1][1] -= branch[jindexer].YSfrom[4];
+					}
+					else										//Just a normal to bus
 					{
-						bus[indexer].full_Y_all[jindex*3+kindex] = tempY[jindex][kindex];// Store the self admittance terms.
+						tempY[0][0] += branch[jindexer].YSfrom[0];
+						tempY[0][1] += branch[jindexer].YSfrom[1];
+						tempY[1][0] += branch[jindexer].YSfrom[3];
+						tempY[1][1] += branch[jindexer].YSfrom[4];
 					}
 				}
-			}//End self-admittance update
-		}//End diagonal construction
-
-		//Store the size of the diagonal, since it represents how many variables we are solving (useful later)
-		powerflow_values->total_variables=index_count;
-
-		//Check to see if we've exceeded our max.  If so, reallocate!
-		if (powerflow_values->total_variables > powerflow_values->max_total_variables)
-			powerflow_values->NR_realloc_needed = true;
-
-		/// Build the off_diagonal_PQ bus elements of 6n*6n Y_NR matrix.Equation (12). All the value in this part will not be updated at each iteration.
-		//Constructed using sparse methodology, non-zero elements are the only thing considered (and non-PV)
-		//No longer necessarily 6n*6n any more either,
-		powerflow_values->size_offdiag_PQ = 0;
-		for (jindexer=0; jindexer<branch_count;jindexer++)	//Parse all of the branches
-		{
-			tempa  = branch[jindexer].from;
-			tempb  = branch[jindexer].to;
-
-			//Preliminary check to make sure we weren't missed in the initialization
-			if ((bus[tempa].Matrix_Loc == -1) || (bus[tempb].Matrix_Loc == -1))
-			{
-				GL_THROW("An element in NR line:%d was not properly localized");
-				/*  TROUBLESHOOT
-				When parsing the bus list, the Newton-Raphson solver found a bus that did not
-				appear to have a location within the overall admittance/Jacobian matrix.  Please
-				submit this as a bug with your code on the Trac site.
-				*/
-			}
-
-			if (((branch[jindexer].phases & 0x80) == 0x80) && (branch[jindexer].v_ratio==1.0))	//Triplex, but not SPCT
-			{
-				for (jindex=0; jindex<2; jindex++)			//rows
+				else									//To branch
 				{
-					for (kindex=0; kindex<2; kindex++)		//columns
-					{
-						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))
-							powerflow_values->size_offdiag_PQ += 1; 
-
-						if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))  
-							powerflow_values->size_offdiag_PQ += 1; 
-
-						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
-							powerflow_values->size_offdiag_PQ += 1; 
-
-						if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
-							powerflow_values->size_offdiag_PQ += 1; 
-					}//end columns of split phase
-				}//end rows of split phase
-			}//end traversion of split-phase
-			else											//Three phase or some variety
+					tempY[0][0] += branch[jindexer].YSto[0];
+					tempY[0][1] += branch[jindexer].YSto[1];
+					tempY[1][0] += branch[jindexer].YSto[3];
+					tempY[1][1] += branch[jindexer].YSto[4];
+				}
+			}
+			else	//We must be a single or two-phase line - always populate the upper left portion of matrix (easier for later)
 			{
-				//Make sure we aren't SPCT, otherwise things get jacked
-				if ((branch[jindexer].phases & 0x80) != 0x80)	//SPCT, but v_ratio not = 1
-				{
-					for (jindex=0; jindex<3; jindex++)			//rows
-					{
-						//See if this phase is valid
-						phase_workb = 0x04 >> jindex;
-
-						if ((phase_workb & branch[jindexer].phases) == phase_workb)	//Row check
+				switch(bus[indexer].phases & 0x07) {
+					case 0x00:	//No phases (we've been faulted out
 						{
-							for (kindex=0; kindex<3; kindex++)		//columns
-							{
-								//Check this phase as well
-								phase_workd = 0x04 >> kindex;
-
-								if ((phase_workd & branch[jindexer].phases) == phase_workd)	//Column validity check
-								{
-									if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))
-										powerflow_values->size_offdiag_PQ += 1; 
-
-									if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))  
-										powerflow_values->size_offdiag_PQ += 1; 
-
-									if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
-										powerflow_values->size_offdiag_PQ += 1; 
-
-									if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
-										powerflow_values->size_offdiag_PQ += 1; 
-								}//end column validity check
-							}//end columns of 3 phase
-						}//End row validity check
-					}//end rows of 3 phase
-				}//end not SPCT
-				else	//SPCT inmplementation
-				{
-					for (jindex=0; jindex<3; jindex++)			//rows
-					{
-						//See if this phase is valid
-						phase_workb = 0x04 >> jindex;
-
-						if ((phase_workb & branch[jindexer].phases) == phase_workb)	//Row check
+							break;	//Just get us outta here
+						}
+					case 0x01:	//Only C
 						{
-							for (kindex=0; kindex<3; kindex++)		//Row valid, traverse all columns for SPCT Yfrom
+							if ((branch[jindexer].phases & 0x01) == 0x01)	//Phase C valid on branch
 							{
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))
-									powerflow_values->size_offdiag_PQ += 1; 
-
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
-									powerflow_values->size_offdiag_PQ += 1; 
-							}//end columns traverse
-
-							//If row is valid, now traverse the rows of that column for Yto
-							for (kindex=0; kindex<3; kindex++)
-							{
-								if (((branch[jindexer].Yto[kindex*3+jindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))  
-									powerflow_values->size_offdiag_PQ += 1; 
-
-								if (((branch[jindexer].Yto[kindex*3+jindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
-									powerflow_values->size_offdiag_PQ += 1; 
-							}//end rows traverse
-						}//End row validity check
-					}//end rows of 3 phase
-				}//End SPCT
-			}//end three phase
-		}//end line traversion
-
-		//Allocate the space - double the number found (each element goes in two places)
-		if (powerflow_values->Y_offdiag_PQ == NULL)
-		{
-			powerflow_values->Y_offdiag_PQ = (Y_NR *)gl_malloc((powerflow_values->size_offdiag_PQ*2) *sizeof(Y_NR));   //powerflow_values->Y_offdiag_PQ store the row,column and value of off_diagonal elements of Bus Admittance matrix in which all the buses are not PV buses. 
-
-			//Make sure it worked
-			if (powerflow_values->Y_offdiag_PQ == NULL)
-				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
-
-			//Save our size
-			powerflow_values->max_size_offdiag_PQ = powerflow_values->size_offdiag_PQ;	//Don't care about the 2x, since we'll be comparing it against itself
-		}
-		else if (powerflow_values->size_offdiag_PQ > powerflow_values->max_size_offdiag_PQ)	//Something changed and we are bigger!!
-		{
-			//Destroy us!
-			gl_free(powerflow_values->Y_offdiag_PQ);
-
-			//Rebuild us, we have the technology
-			powerflow_values->Y_offdiag_PQ = (Y_NR *)gl_malloc((powerflow_values->size_offdiag_PQ*2) *sizeof(Y_NR));
-
-			//Make sure it worked
-			if (powerflow_values->Y_offdiag_PQ == NULL)
-				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
-
-			//Store the new size
-			powerflow_values->max_size_offdiag_PQ = powerflow_values->size_offdiag_PQ;
-
-			//Flag for a reallocation
-			powerflow_values->NR_realloc_needed = true;
-		}
-
-		indexer = 0;
-		for (jindexer=0; jindexer<branch_count;jindexer++)	//Parse through all of the branches
-		{
-			//Extract both ends
-			tempa  = branch[jindexer].from;
-			tempb  = branch[jindexer].to;
-
-			phase_worka = 0;
-			phase_workb = 0;
-			for (jindex=0; jindex<3; jindex++)		//Accumulate number of phases
-			{
-				phase_worka += ((bus[tempa].phases & (0x01 << jindex)) >> jindex);
-				phase_workb += ((bus[tempb].phases & (0x01 << jindex)) >> jindex);
-			}
-
-			if ((phase_worka==3) && (phase_workb==3))	//Both ends are full three phase, normal operations
-			{
-				for (jindex=0; jindex<3; jindex++)		//Loop through rows of admittance matrices				
-				{
-					//See if this row is valid for this branch
-					phase_workd = 0x04 >> jindex;
-
-					if ((branch[jindexer].phases & phase_workd) == phase_workd)	//Validity check
-					{
-						for (kindex=0; kindex<3; kindex++)	//Loop through columns of admittance matrices
+								if (branch[jindexer].from == indexer)	//From branch
+								{
+									tempY[0][0] += branch[jindexer].YSfrom[8];
+								}
+								else									//To branch
+								{
+									tempY[0][0] += branch[jindexer].YSto[8];
+								}
+							}//End valid phase C
+							break;
+						}
+					case 0x02:	//Only B
 						{
-							//Extract column information
-							phase_worke = 0x04 >> kindex;
-
-							if ((branch[jindexer].phases & phase_worke) == phase_worke)	//Valid column too!
+							if ((branch[jindexer].phases & 0x02) == 0x02)	//Phase B valid on branch
 							{
-								//Indices counted out from Self admittance above.  needs doubling due to complex separation
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
-									indexer += 1;
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[0][0] += branch[jindexer].YSfrom[4];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Im());
-									indexer += 1;
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[0][0] += branch[jindexer].YSto[4];
 								}
+							}//End valid phase B
+							break;
+						}
+					case 0x03:	//B & C
+						{
+							phase_worka = (branch[jindexer].phases & 0x03);	//Extract branch phases
 
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+							if (phase_worka == 0x03)	//Full B & C
+							{
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[0][0] += branch[jindexer].YSfrom[4];
+									tempY[0][1] += branch[jindexer].YSfrom[5];
+									tempY[1][0] += branch[jindexer].YSfrom[7];
+									tempY[1][1] += branch[jindexer].YSfrom[8];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 3;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[0][0] += branch[jindexer].YSto[4];
+									tempY[0][1] += branch[jindexer].YSto[5];
+									tempY[1][0] += branch[jindexer].YSto[7];
+									tempY[1][1] += branch[jindexer].YSto[8];
 								}
-							}//End valid column
-						}//column end
-					}//End valid row
-				}//row end
-			}//if all 3 end
-			else if (((bus[tempa].phases & 0x80) == 0x80) || ((bus[tempb].phases & 0x80) == 0x80))	//Someone's a triplex
-			{
-				if (((bus[tempa].phases & 0x80) == 0x80) && ((bus[tempb].phases & 0x80) == 0x80))	//Both are triplex, easy case
-				{
-					for (jindex=0; jindex<2; jindex++)		//Loop through rows of admittance matrices (only 2x2)
-					{
-						for (kindex=0; kindex<2; kindex++)	//Loop through columns of admittance matrices (only 2x2)
-						{
-							//Make sure one end of us isn't a SPCT transformer To node (they are different)
-							if (((bus[tempa].phases & 0x20) & (bus[tempb].phases & 0x20)) == 0x20)	//Both ends are SPCT tos
-							{
-								GL_THROW("NR: SPCT to SPCT via triplex connections are unsupported at this time.");
-								/*  TROUBLESHOOT
-								The Newton-Raphson solve does not currently support running a triplex line between the low-voltage
-								side of two different split-phase center tapped transformers.  This functionality may be added if needed
-								in the future.
-								*/
-							}//end both ends SPCT to
-							else if ((bus[tempa].phases & 0x20) == 0x20)	//From end is a SPCT to
+							}//End valid B & C
+							else if (phase_worka == 0x01)	//Only C branch
 							{
-								//Indices counted out from Self admittance above.  needs doubling due to complex separation
-
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(branch[jindexer].Yfrom[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[1][1] += branch[jindexer].YSfrom[8];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Im());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[1][1] += branch[jindexer].YSto[8];
 								}
-
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+							}//end valid C
+							else if (phase_worka == 0x02)	//Only B branch
+							{
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[0][0] += branch[jindexer].YSfrom[4];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1 && bus[tempb].type != 1))	//To reals
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[0][0] += branch[jindexer].YSto[4];
 								}
-							}//end From end SPCT to
-							else if ((bus[tempb].phases & 0x20) == 0x20)	//To end is a SPCT to
+							}//end valid B
+							else	//Must be nothing then - all phases must be faulted, or something
+								;
+							break;
+						}
+					case 0x04:	//Only A
+						{
+							if ((branch[jindexer].phases & 0x04) == 0x04)	//Phase A is valid
 							{
-								//Indices counted out from Self admittance above.  needs doubling due to complex separation
-
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[0][0] += branch[jindexer].YSfrom[0];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yto[jindex*3+kindex]).Im());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(branch[jindexer].Yto[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[0][0] += branch[jindexer].YSto[0];
 								}
+							}//end valid phase A
+							break;
+						}
+					case 0x05:	//A & C
+						{
+							phase_worka = branch[jindexer].phases & 0x05;	//Extract phases
 
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+							if (phase_worka == 0x05)	//Both A & C valid
+							{
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[0][0] += branch[jindexer].YSfrom[0];
+									tempY[0][1] += branch[jindexer].YSfrom[2];
+									tempY[1][0] += branch[jindexer].YSfrom[6];
+									tempY[1][1] += branch[jindexer].YSfrom[8];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1 && bus[tempb].type != 1))	//To reals
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[0][0] += branch[jindexer].YSto[0];
+									tempY[0][1] += branch[jindexer].YSto[2];
+									tempY[1][0] += branch[jindexer].YSto[6];
+									tempY[1][1] += branch[jindexer].YSto[8];
 								}
-							}//end To end SPCT to
-							else											//Plain old ugly line
+							}//End A & C valid
+							else if (phase_worka == 0x04)	//Only A valid
 							{
-								//Indices counted out from Self admittance above.  needs doubling due to complex separation
-
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[0][0] += branch[jindexer].YSfrom[0];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Im());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[jindex*3+kindex]).Im();
-									indexer += 1;
+									tempY[0][0] += branch[jindexer].YSto[0];
 								}
-
-								if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+							}//end only A valid
+							else if (phase_worka == 0x01)	//Only C valid
+							{
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[1][1] += branch[jindexer].YSfrom[8];
 								}
-
-								if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1 && bus[tempb].type != 1))	//To reals
+								else									//To branch
 								{
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;
-									
-									powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
-									powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
-									powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
-									indexer += 1;	
+									tempY[1][1] += branch[jindexer].YSto[8];
 								}
-							}//end Normal triplex branch
-						}//column end
-					}//row end
-				}//end both triplexy
-				else if ((bus[tempa].phases & 0x80) == 0x80)	//From is the triplex - this implies transformer with or something, we don't support this
-				{
-					GL_THROW("NR does not support triplex to 3-phase connections.");
-					/*  TROUBLESHOOT
-					The Newton-Raphson solver does not have any implementation elements
-					to support the connection of a split-phase or triplex node to a three-phase
-					node.  The opposite (3-phase to triplex) is available as the split-phase-center-
-					tapped transformer model.  See if that will work for your implementation.
-					*/
-				}//end from triplexy
-				else	//Only option left is the to must be the triplex - implies SPCT xformer - so only one phase on the three-phase side (we just need to figure out where)
-				{
-					//Extract the line phase
-					phase_workc = (branch[jindexer].phases & 0x07);
-
-					//Reset temp_index and size, just in case
-					temp_index = -1;
-					temp_size = -1;
+							}//end only C valid
+							else	//No connection - must be faulted
+								;
+							break;
+						}
+					case 0x06:	//A & B
+						{
+							phase_worka = branch[jindexer].phases & 0x06;	//Extract phases
 
-					//Figure out what the offset on the from side is (how many phases and which one we are)
-					switch(bus[tempa].phases & 0x07)
-					{
-						case 0x01:	//C
+							if (phase_worka == 0x06)	//Valid A & B phase
 							{
-								temp_size = 1;	//Single phase matrix
-
-								if (phase_workc==0x01)	//Line is phase C
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									//Only C in the node, so no offset
-									temp_index = 0;
+									tempY[0][0] += branch[jindexer].YSfrom[0];
+									tempY[0][1] += branch[jindexer].YSfrom[1];
+									tempY[1][0] += branch[jindexer].YSfrom[3];
+									tempY[1][1] += branch[jindexer].YSfrom[4];
 								}
-								else if (phase_workc==0x02)	//Line is phase B
+								else									//To branch
 								{
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-									/*  TROUBLESHOOT
-									A split-phase, center-tapped transformer in the Newton-Raphson solver is somehow attached
-									to a node that is missing the required phase of the transformer.  This should have been caught.
-									Please submit your code and a bug report using the trac website.
-									*/
+									tempY[0][0] += branch[jindexer].YSto[0];
+									tempY[0][1] += branch[jindexer].YSto[1];
+									tempY[1][0] += branch[jindexer].YSto[3];
+									tempY[1][1] += branch[jindexer].YSto[4];
 								}
-								else					//Has to be phase A
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-
-								break;
-							}
-						case 0x02:	//B
+							}//End valid A & B
+							else if (phase_worka == 0x04)	//Only valid A
 							{
-								temp_size = 1;	//Single phase matrix
-
-								if (phase_workc==0x01)	//Line is phase C
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-								else if (phase_workc==0x02)	//Line is phase B
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									//Only B in the node, so no offset
-									temp_index = 0;
+									tempY[0][0] += branch[jindexer].YSfrom[0];
 								}
-								else					//Has to be phase A
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-
-								break;
-							}
-						case 0x03:	//BC
+								else									//To branch
+								{
+									tempY[0][0] += branch[jindexer].YSto[0];
+								}
+							}//end valid A
+							else if (phase_worka == 0x02)	//Only valid B
 							{
-								temp_size = 2;	//Two phase matrix
-
-								if (phase_workc==0x01)	//Line is phase C
+								if (branch[jindexer].from == indexer)	//From branch
 								{
-									//BC in the node, so offset by 1
-									temp_index = 1;
+									tempY[1][1] += branch[jindexer].YSfrom[4];
 								}
-								else if (phase_workc==0x02)	//Line is phase B
+								else									//To branch
 								{
-									//BC in the node, so offset by 0
-									temp_index = 0;
+									tempY[1][1] += branch[jindexer].YSto[4];
 								}
-								else					//Has to be phase A
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-
-								break;
-							}
-						case 0x04:	//A
-							{
-								temp_size = 1;	//Single phase matrix
+							}//end valid B
+							else	//Default - must be already handled
+								;
+							break;
+						}
+					default:	//How'd we get here?
+						{
+							GL_THROW("Unknown phase connection in NR self admittance diagonal");
+							/*  TROUBLESHOOT
+							An unknown phase condition was encountered in the NR solver when constructing
+							the self admittance diagonal.  Please report this bug and submit your code to 
+							the trac system.
+							*/
+						break;
+						}
+				}	//switch end
+			}	//1 or 2 phase end
+		}	//phase accumulation end
+		else		//It's nothing (no connnection)
+			;
+	}//branch traversion end
 
-								if (phase_workc==0x01)	//Line is phase C
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-								else if (phase_workc==0x02)	//Line is phase B
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-								else					//Has to be phase A
-								{
-									//Only A in the node, so no offset
-									temp_index = 0;
-								}
 
-								break;
-							}
-						case 0x05:	//AC
-							{
-								temp_size = 2;	//Two phase matrix
+	//Store the admittance values into the BA_diag matrix structure
+	for (jindex=0; jindex<powerflow_values->BA_diag[indexer].size; jindex++)
+	{
+		for (kindex=0; kindex<powerflow_values->BA_diag[indexer].size; kindex++)			//Store values - assume square matrix - don't bother parsing what doesn't exist.
+		{
+			powerflow_values->BA_diag[indexer].Y[jindex][kindex] = tempY[jindex][kindex];// Store the self admittance terms.
+		}
+	}
 
-								if (phase_workc==0x01)	//Line is phase C
-								{
-									//AC in the node, so offset by 1
-									temp_index = 1;
-								}
-								else if (phase_workc==0x02)	//Line is phase B
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-								else					//Has to be phase A
-								{
-									//AC in the node, so offset by 0
-									temp_index = 0;
-								}
+	//Copy values into node-specific link (if needed)
+	if (bus[indexer].full_Y_all != NULL)
+	{
+		for (jindex=0; jindex<powerflow_values->BA_diag[indexer].size; jindex++)
+		{
+			for (kindex=0; kindex<powerflow_values->BA_diag[indexer].size; kindex++)			//Store values - assume square matrix - don't bother parsing what doesn't exist.
+			{
+				bus[indexer].full_Y_all[jindex*3+kindex] = tempY[jindex][kindex];// Store the self admittance terms.
+			}
+		}
+	}//End self-admittance update
+}
 
-								break;
-							}
-						case 0x06:	//AB
-							{
-								temp_size = 2;	//Two phase matrix
+//Count the off-diagonal admittance entries of a branch (each of them goes in two places of Y_offdiag_PQ)
+static unsigned int NR_branch_offdiag_count(unsigned int jindexer, BUSDATA *bus, BRANCHDATA *branch)
+{
+	unsigned char phase_workb, phase_workd;
+	unsigned int tempa, tempb;
+	char jindex, kindex;
+	unsigned int count = 0;
 
-								if (phase_workc==0x01)	//Line is phase C
-									GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-								else if (phase_workc==0x02)	//Line is phase B
-								{
-									//BC in the node, so offset by 1
-									temp_index = 1;
-								}
-								else					//Has to be phase A
-								{
-									//AB in the node, so offset by 0
-									temp_index = 0;
-								}
+	tempa  = branch[jindexer].from;
+	tempb  = branch[jindexer].to;
 
-								break;
-							}
-						case 0x07:	//ABC
-							{
-								temp_size = 3;	//Three phase matrix
+	//Preliminary check to make sure we weren't missed in the initialization
+	if ((bus[tempa].Matrix_Loc == -1) || (bus[tempb].Matrix_Loc == -1))
+	{
+		GL_THROW("An element in NR line:%d was not properly localized");
+		/*  TROUBLESHOOT
+		When parsing the bus list, the Newton-Raphson solver found a bus that did not
+		appear to have a location within the overall admittance/Jacobian matrix.  Please
+		submit this as a bug with your code on the Trac site.
+		*/
+	}
 
-								if (phase_workc==0x01)	//Line is phase C
-								{
-									//ABC in the node, so offset by 2
-									temp_index = 2;
-								}
-								else if (phase_workc==0x02)	//Line is phase B
-								{
-									//ABC in the node, so offset by 1
-									temp_index = 1;
-								}
-								else					//Has to be phase A
-								{
-									//ABC in the node, so offset by 0
-									temp_index = 0;
-								}
+	if (((branch[jindexer].phases & 0x80) == 0x80) && (branch[jindexer].v_ratio==1.0))	//Triplex, but not SPCT
+	{
+		for (jindex=0; jindex<2; jindex++)			//rows
+		{
+			for (kindex=0; kindex<2; kindex++)		//columns
+			{
+				if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))
+					count += 1; 
 
-								break;
-							}
-						default:
-							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
-							break;
-					}//end switch
-					if ((temp_index==-1) || (temp_size==-1))	//Should never get here
-						GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+				if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))  
+					count += 1; 
+
+				if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
+					count += 1; 
+
+				if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
+					count += 1; 
+			}//end columns of split phase
+		}//end rows of split phase
+	}//end traversion of split-phase
+	else											//Three phase or some variety
+	{
+		//Make sure we aren't SPCT, otherwise things get jacked
+		if ((branch[jindexer].phases & 0x80) != 0x80)	//SPCT, but v_ratio not = 1
+		{
+			for (jindex=0; jindex<3; jindex++)			//rows
+			{
+				//See if this phase is valid
+				phase_workb = 0x04 >> jindex;
+
+				if ((phase_workb & branch[jindexer].phases) == phase_workb)	//Row check
+				{
+					for (kindex=0; kindex<3; kindex++)		//columns
+					{
+						//Check this phase as well
+						phase_workd = 0x04 >> kindex;
+
+						if ((phase_workd & branch[jindexer].phases) == phase_workd)	//Column validity check
+						{
+							if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))
+								count += 1; 
+
+							if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))  
+								count += 1; 
+
+							if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
+								count += 1; 
+
+							if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
+								count += 1; 
+						}//end column validity check
+					}//end columns of 3 phase
+				}//End row validity check
+			}//end rows of 3 phase
+		}//end not SPCT
+		else	//SPCT inmplementation
+		{
+			for (jindex=0; jindex<3; jindex++)			//rows
+			{
+				//See if this phase is valid
+				phase_workb = 0x04 >> jindex;
 
-					//Determine first index
-					if (phase_workc==0x01)	//Line is phase C
+				if ((phase_workb & branch[jindexer].phases) == phase_workb)	//Row check
+				{
+					for (kindex=0; kindex<3; kindex++)		//Row valid, traverse all columns for SPCT Yfrom
 					{
-						jindex=2;
-					}//end line C if
-					else if (phase_workc==0x02)	//Line is phase B
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))
+							count += 1; 
+
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
+							count += 1; 
+					}//end columns traverse
+
+					//If row is valid, now traverse the rows of that column for Yto
+					for (kindex=0; kindex<3; kindex++)
 					{
-						jindex=1;
-					}//end line B if
-					else						//Line has to be phase A
+						if (((branch[jindexer].Yto[kindex*3+jindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))  
+							count += 1; 
+
+						if (((branch[jindexer].Yto[kindex*3+jindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1)) 
+							count += 1; 
+					}//end rows traverse
+				}//End row validity check
+			}//end rows of 3 phase
+		}//End SPCT
+	}//end three phase
+
+	return count;
+}
+
+//Store the off-diagonal admittance entries of a branch into Y_offdiag_PQ, starting at indexer
+//Returns the index past the last entry stored
+static unsigned int NR_branch_offdiag(unsigned int jindexer, BUSDATA *bus, BRANCHDATA *branch, Y_NR *Y_offdiag_PQ, unsigned int indexer)
+{
+	unsigned char phase_worka, phase_workb, phase_workc, phase_workd, phase_worke;
+	unsigned int tempa, tempb;
+	char jindex, kindex;
+	char temp_index, temp_index_b;
+	char temp_size, temp_size_b, temp_size_c;
+	bool Full_Mat_A, Full_Mat_B;
+	complex Temp_Ad_A[3][3];
+	complex Temp_Ad_B[3][3];
+
+	//Extract both ends
+	tempa  = branch[jindexer].from;
+	tempb  = branch[jindexer].to;
+
+	phase_worka = 0;
+	phase_workb = 0;
+	for (jindex=0; jindex<3; jindex++)		//Accumulate number of phases
+	{
+		phase_worka += ((bus[tempa].phases & (0x01 << jindex)) >> jindex);
+		phase_workb += ((bus[tempb].phases & (0x01 << jindex)) >> jindex);
+	}
+
+	if ((phase_worka==3) && (phase_workb==3))	//Both ends are full three phase, normal operations
+	{
+		for (jindex=0; jindex<3; jindex++)		//Loop through rows of admittance matrices				
+		{
+			//See if this row is valid for this branch
+			phase_workd = 0x04 >> jindex;
+
+			if ((branch[jindexer].phases & phase_workd) == phase_workd)	//Validity check
+			{
+				for (kindex=0; kindex<3; kindex++)	//Loop through columns of admittance matrices
+				{
+					//Extract column information
+					phase_worke = 0x04 >> kindex;
+
+					if ((branch[jindexer].phases & phase_worke) == phase_worke)	//Valid column too!
 					{
-						jindex=0;
-					}//End line A if
+						//Indices counted out from Self admittance above.  needs doubling due to complex separation
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+						{
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
+							indexer += 1;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 3;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 3;
+							Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
+							indexer += 1;
+						}
 
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+						{
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Im());
+							indexer += 1;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 3;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 3;
+							Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[jindex*3+kindex]).Im();
+							indexer += 1;
+						}
 
-					//Indices counted out from Self admittance above.  needs doubling due to complex separation
-					for (kindex=0; kindex<2; kindex++)	//Loop through columns of admittance matrices (only 2x2)
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+						{
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 3;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							indexer += 1;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 3;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							indexer += 1;	
+						}
+
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+						{
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 3;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
+							indexer += 1;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 3;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
+							indexer += 1;	
+						}
+					}//End valid column
+				}//column end
+			}//End valid row
+		}//row end
+	}//if all 3 end
+	else if (((bus[tempa].phases & 0x80) == 0x80) || ((bus[tempb].phases & 0x80) == 0x80))	//Someone's a triplex
+	{
+		if (((bus[tempa].phases & 0x80) == 0x80) && ((bus[tempb].phases & 0x80) == 0x80))	//Both are triplex, easy case
+		{
+			for (jindex=0; jindex<2; jindex++)		//Loop through rows of admittance matrices (only 2x2)
+			{
+				for (kindex=0; kindex<2; kindex++)	//Loop through columns of admittance matrices (only 2x2)
+				{
+					//Make sure one end of us isn't a SPCT transformer To node (they are different)
+					if (((bus[tempa].phases & 0x20) & (bus[tempb].phases & 0x20)) == 0x20)	//Both ends are SPCT tos
+					{
+						GL_THROW("NR: SPCT to SPCT via triplex connections are unsupported at this time.");
+						/*  TROUBLESHOOT
+						The Newton-Raphson solve does not currently support running a triplex line between the low-voltage
+						side of two different split-phase center tapped transformers.  This functionality may be added if needed
+						in the future.
+						*/
+					}//end both ends SPCT to
+					else if ((bus[tempa].phases & 0x20) == 0x20)	//From end is a SPCT to
 					{
+						//Indices counted out from Self admittance above.  needs doubling due to complex separation
 
 						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
 						{
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
 							indexer += 1;
 							
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = -(branch[jindexer].Yfrom[jindex*3+kindex]).Im();
 							indexer += 1;
 						}
 
-						if (((branch[jindexer].Yto[kindex*3+jindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
 						{
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[kindex*3+jindex]).Im());
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Im());
 							indexer += 1;
 							
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[kindex*3+jindex]).Im();
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[jindex*3+kindex]).Im();
 							indexer += 1;
 						}
 
 						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
 						{
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
 							indexer += 1;
 							
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
 							indexer += 1;	
 						}
 
-						if (((branch[jindexer].Yto[kindex*3+jindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1 && bus[tempb].type != 1))	//To reals
 						{
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[kindex*3+jindex]).Re());
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
 							indexer += 1;
 							
-							powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex;
-							powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
-							powerflow_values->Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[kindex*3+jindex]).Re());
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
 							indexer += 1;	
 						}
-					}//secondary index end
+					}//end From end SPCT to
+					else if ((bus[tempb].phases & 0x20) == 0x20)	//To end is a SPCT to
+					{
+						//Indices counted out from Self admittance above.  needs doubling due to complex separation
 
-				}//end to triplexy
-			}//end triplex in here
-			else					//Some combination of not-3 phase
-			{
-				//Clear working variables, just in case
-				temp_index = temp_index_b = -1;
-				temp_size = temp_size_b = temp_size_c = -1;
-				Full_Mat_A = Full_Mat_B = false;
-
-				//Intermediate store the admittance matrices so they can be directly indexed later
-				switch(branch[jindexer].phases & 0x07) {
-					case 0x00:	//No phases (open switch or reliability excluded item)
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
 						{
-							temp_size_c = -99;	//Arbitrary flag
-							break;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
+							indexer += 1;
+							
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
+							indexer += 1;
 						}
-					case 0x01:	//C only
+
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
 						{
-							Temp_Ad_A[0][0] = branch[jindexer].Yfrom[8];
-							Temp_Ad_B[0][0] = branch[jindexer].Yto[8];
-							temp_size_c = 1;
-							break;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yto[jindex*3+kindex]).Im());
+							indexer += 1;
+							
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = -(branch[jindexer].Yto[jindex*3+kindex]).Im();
+							indexer += 1;
 						}
-					case 0x02:	//B only
+
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
 						{
-							Temp_Ad_A[0][0] = branch[jindexer].Yfrom[4];
-							Temp_Ad_B[0][0] = branch[jindexer].Yto[4];
-							temp_size_c = 1;
-							break;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							indexer += 1;
+							
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							indexer += 1;	
 						}
-					case 0x03:	//BC only
+
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1 && bus[tempb].type != 1))	//To reals
 						{
-							Temp_Ad_A[0][0] = branch[jindexer].Yfrom[4];
-							Temp_Ad_A[0][1] = branch[jindexer].Yfrom[5];
-							Temp_Ad_A[1][0] = branch[jindexer].Yfrom[7];
-							Temp_Ad_A[1][1] = branch[jindexer].Yfrom[8];
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yto[jindex*3+kindex]).Re());
+							indexer += 1;
 							
-							Temp_Ad_B[0][0] = branch[jindexer].Yto[4];
-							Temp_Ad_B[0][1] = branch[jindexer].Yto[5];
-							Temp_Ad_B[1][0] = branch[jindexer].Yto[7];
-							Temp_Ad_B[1][1] = branch[jindexer].Yto[8];
-
-							temp_size_c = 2;
-							break;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = ((branch[jindexer].Yto[jindex*3+kindex]).Re());
+							indexer += 1;	
 						}
-					case 0x04:	//A only
+					}//end To end SPCT to
+					else											//Plain old ugly line
+					{
+						//Indices counted out from Self admittance above.  needs doubling due to complex separation
+
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
 						{
-							Temp_Ad_A[0][0] = branch[jindexer].Yfrom[0];
-							Temp_Ad_B[0][0] = branch[jindexer].Yto[0];
-							temp_size_c = 1;
-							break;
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
+							indexer += 1;
+							
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
+							indexer += 1;
 						}
-					case 0x05:	//AC only
+
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
 						{
-							Temp_Ad_A[0][0] = branch[jindexer].Yfrom[0];
-							Temp_Ad_A[0][1] = branch[jindexer].Yfrom[2];
-							Temp_Ad_A[1][0] = branch[jindexer].Yfrom[6];
-							Temp_Ad_A[1][1] = branch[jindexer].Yfrom[8];
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Im());
+							indexer += 1;
 							
-							Temp_Ad_B[0][0] = branch[jindexer].Yto[0];
-							Temp_Ad_B[0][1] = branch[jindexer].Yto[2];
-							Temp_Ad_B[1][0] = branch[jindexer].Yto[6];
-							Temp_Ad_B[1][1] = branch[jindexer].Yto[8];
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[jindex*3+kindex]).Im();
+							indexer += 1;
+						}
 
-							temp_size_c = 2;
-							break;
+						if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+						{
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							indexer += 1;
+							
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+							indexer += 1;	
 						}
-					case 0x06:	//AB only
+
+						if (((branch[jindexer].Yto[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1 && bus[tempb].type != 1))	//To reals
 						{
-							Temp_Ad_A[0][0] = branch[jindexer].Yfrom[0];
-							Temp_Ad_A[0][1] = branch[jindexer].Yfrom[1];
-							Temp_Ad_A[1][0] = branch[jindexer].Yfrom[3];
-							Temp_Ad_A[1][1] = branch[jindexer].Yfrom[4];
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex + 2;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
+							indexer += 1;
 							
-							Temp_Ad_B[0][0] = branch[jindexer].Yto[0];
-							Temp_Ad_B[0][1] = branch[jindexer].Yto[1];
-							Temp_Ad_B[1][0] = branch[jindexer].Yto[3];
-							Temp_Ad_B[1][1] = branch[jindexer].Yto[4];
+							Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + jindex;
+							Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + kindex + 2;
+							Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[jindex*3+kindex]).Re());
+							indexer += 1;	
+						}
+					}//end Normal triplex branch
+				}//column end
+			}//row end
+		}//end both triplexy
+		else if ((bus[tempa].phases & 0x80) == 0x80)	//From is the triplex - this implies transformer with or something, we don't support this
+		{
+			GL_THROW("NR does not support triplex to 3-phase connections.");
+			/*  TROUBLESHOOT
+			The Newton-Raphson solver does not have any implementation elements
+			to support the connection of a split-phase or triplex node to a three-phase
+			node.  The opposite (3-phase to triplex) is available as the split-phase-center-
+			tapped transformer model.  See if that will work for your implementation.
+			*/
+		}//end from triplexy
+		else	//Only option left is the to must be the triplex - implies SPCT xformer - so only one phase on the three-phase side (we just need to figure out where)
+		{
+			//Extract the line phase
+			phase_workc = (branch[jindexer].phases & 0x07);
 
-							temp_size_c = 2;
-							break;
+			//Reset temp_index and size, just in case
+			temp_index = -1;
+			temp_size = -1;
+
+			//Figure out what the offset on the from side is (how many phases and which one we are)
+			switch(bus[tempa].phases & 0x07)
+			{
+				case 0x01:	//C
+					{
+						temp_size = 1;	//Single phase matrix
+
+						if (phase_workc==0x01)	//Line is phase C
+						{
+							//Only C in the node, so no offset
+							temp_index = 0;
 						}
-					default:
+						else if (phase_workc==0x02)	//Line is phase B
 						{
-							break;
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+							/*  TROUBLESHOOT
+							A split-phase, center-tapped transformer in the Newton-Raphson solver is somehow attached
+							to a node that is missing the required phase of the transformer.  This should have been caught.
+							Please submit your code and a bug report using the trac website.
+							*/
 						}
-				}//end line switch/case
+						else					//Has to be phase A
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
 
-				if (temp_size_c==-99)
-				{
-					continue;	//Next iteration of branch loop
-				}
+						break;
+					}
+				case 0x02:	//B
+					{
+						temp_size = 1;	//Single phase matrix
 
-				if (temp_size_c==-1)	//Make sure it is right
-				{
-					GL_THROW("NR: A line's phase was flagged as not full three-phase, but wasn't");
-					/*  TROUBLESHOOT
-					A line inside the powerflow model was flagged as not being full three-phase or
-					triplex in any form.  It failed the other cases though, so it must have been.
-					Please submit your code and a bug report to the trac website.
-					*/
-				}
+						if (phase_workc==0x01)	//Line is phase C
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+						else if (phase_workc==0x02)	//Line is phase B
+						{
+							//Only B in the node, so no offset
+							temp_index = 0;
+						}
+						else					//Has to be phase A
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
 
-				//Check the from side and get all appropriate offsets
-				switch(bus[tempa].phases & 0x07) {
-					case 0x01:	//C
+						break;
+					}
+				case 0x03:	//BC
+					{
+						temp_size = 2;	//Two phase matrix
+
+						if (phase_workc==0x01)	//Line is phase C
 						{
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_size = 1;		//Single size
-								temp_index = 0;		//No offset (only 1 big)
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-								/*  TROUBLESHOOT
-								One of the lines in the powerflow model has an invalid phase in
-								reference to its to and from ends.  This should have been caught
-								earlier, so submit your code and a bug report using the trac website.
-								*/
-							}
-							break;
-						}//end 0x01
-					case 0x02:	//B
+							//BC in the node, so offset by 1
+							temp_index = 1;
+						}
+						else if (phase_workc==0x02)	//Line is phase B
 						{
-							if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_size = 1;		//Single size
-								temp_index = 0;		//No offset (only 1 big)
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x02
-					case 0x03:	//BC
+							//BC in the node, so offset by 0
+							temp_index = 0;
+						}
+						else					//Has to be phase A
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+
+						break;
+					}
+				case 0x04:	//A
+					{
+						temp_size = 1;	//Single phase matrix
+
+						if (phase_workc==0x01)	//Line is phase C
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+						else if (phase_workc==0x02)	//Line is phase B
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+						else					//Has to be phase A
 						{
-							temp_size = 2;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_index = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_index = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
-							{
-								temp_index = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x03
-					case 0x04:	//A
+							//Only A in the node, so no offset
+							temp_index = 0;
+						}
+
+						break;
+					}
+				case 0x05:	//AC
+					{
+						temp_size = 2;	//Two phase matrix
+
+						if (phase_workc==0x01)	//Line is phase C
 						{
-							if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_size = 1;		//Single size
-								temp_index = 0;		//No offset (only 1 big)
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x04
-					case 0x05:	//AC
+							//AC in the node, so offset by 1
+							temp_index = 1;
+						}
+						else if (phase_workc==0x02)	//Line is phase B
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+						else					//Has to be phase A
 						{
-							temp_size = 2;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_index = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_index = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
-							{
-								temp_index = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x05
-					case 0x06:	//AB
-						{
-							temp_size = 2;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_index = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_index = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
-							{
-								temp_index = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x06
-					case 0x07:	//ABC
-						{
-							temp_size = 3;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_index = 2;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_index = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
-							{
-								temp_index = 1;
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_index = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
-							{
-								temp_index = 0;
-								Full_Mat_A = true;		//Flag so we know C needs to be gapped
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
-							{
-								temp_index = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x07
-					default:
-						{
-							break;
+							//AC in the node, so offset by 0
+							temp_index = 0;
 						}
-				}//End switch/case for from
 
-				//Check the to side and get all appropriate offsets
-				switch(bus[tempb].phases & 0x07) {
-					case 0x01:	//C
-						{
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_size_b = 1;		//Single size
-								temp_index_b = 0;		//No offset (only 1 big)
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-								/*  TROUBLESHOOT
-								One of the lines in the powerflow model has an invalid phase in
-								reference to its to and from ends.  This should have been caught
-								earlier, so submit your code and a bug report using the trac website.
-								*/
-							}
-							break;
-						}//end 0x01
-					case 0x02:	//B
-						{
-							if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_size_b = 1;		//Single size
-								temp_index_b = 0;		//No offset (only 1 big)
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x02
-					case 0x03:	//BC
-						{
-							temp_size_b = 2;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_index_b = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_index_b = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
-							{
-								temp_index_b = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x03
-					case 0x04:	//A
+						break;
+					}
+				case 0x06:	//AB
+					{
+						temp_size = 2;	//Two phase matrix
+
+						if (phase_workc==0x01)	//Line is phase C
+							GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+						else if (phase_workc==0x02)	//Line is phase B
 						{
-							if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_size_b = 1;		//Single size
-								temp_index_b = 0;		//No offset (only 1 big)
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x04
-					case 0x05:	//AC
+							//BC in the node, so offset by 1
+							temp_index = 1;
+						}
+						else					//Has to be phase A
 						{
-							temp_size_b = 2;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_index_b = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_index_b = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
-							{
-								temp_index_b = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x05
-					case 0x06:	//AB
+							//AB in the node, so offset by 0
+							temp_index = 0;
+						}
+
+						break;
+					}
+				case 0x07:	//ABC
+					{
+						temp_size = 3;	//Three phase matrix
+
+						if (phase_workc==0x01)	//Line is phase C
 						{
-							temp_size_b = 2;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_index_b = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_index_b = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
-							{
-								temp_index_b = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x06
-					case 0x07:	//ABC
+							//ABC in the node, so offset by 2
+							temp_index = 2;
+						}
+						else if (phase_workc==0x02)	//Line is phase B
 						{
-							temp_size_b = 3;	//Size of this matrix's admittance
-							if ((branch[jindexer].phases & 0x07) == 0x01)	//C
-							{
-								temp_index_b = 2;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
-							{
-								temp_index_b = 1;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
-							{
-								temp_index_b = 1;
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
-							{
-								temp_index_b = 0;		//offset
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
-							{
-								temp_index_b = 0;
-								Full_Mat_B = true;		//Flag so we know C needs to be gapped
-							}
-							else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
-							{
-								temp_index_b = 0;
-							}
-							else
-							{
-								GL_THROW("NR: One of the lines has invalid phase parameters");
-							}
-							break;
-						}//end 0x07
-					default:
+							//ABC in the node, so offset by 1
+							temp_index = 1;
+						}
+						else					//Has to be phase A
 						{
-							break;
+							//ABC in the node, so offset by 0
+							temp_index = 0;
 						}
-				}//End switch/case for to
 
-				//Make sure everything was set before proceeding
-				if ((temp_index==-1) || (temp_index_b==-1) || (temp_size==-1) || (temp_size_b==-1) || (temp_size_c==-1))
-				{
-					GL_THROW("NR: Failure to construct single/double phase line indices");
-					/*  TROUBLESHOOT
-					A single or double phase line (e.g., just A or AB) has failed to properly initialize all of the indices
-					necessary to form the admittance matrix.  Please submit a bug report, with your code, to the trac site.
-					*/
-				}
+						break;
+					}
+				default:
+					GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+					break;
+			}//end switch
+			if ((temp_index==-1) || (temp_size==-1))	//Should never get here
+				GL_THROW("NR: A center-tapped transformer has an invalid phase matching");
+
+			//Determine first index
+			if (phase_workc==0x01)	//Line is phase C
+			{
+				jindex=2;
+			}//end line C if
+			else if (phase_workc==0x02)	//Line is phase B
+			{
+				jindex=1;
+			}//end line B if
+			else						//Line has to be phase A
+			{
+				jindex=0;
+			}//End line A if
+
+
+			//Indices counted out from Self admittance above.  needs doubling due to complex separation
+			for (kindex=0; kindex<2; kindex++)	//Loop through columns of admittance matrices (only 2x2)
+			{
+
+				if (((branch[jindexer].Yfrom[jindex*3+kindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+				{
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+					Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Im());
+					indexer += 1;
+					
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+					Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yfrom[jindex*3+kindex]).Im();
+					indexer += 1;
+				}
+
+				if (((branch[jindexer].Yto[kindex*3+jindex]).Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+				{
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index;
+					Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[kindex*3+jindex]).Im());
+					indexer += 1;
+					
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
+					Y_offdiag_PQ[indexer].Y_value = (branch[jindexer].Yto[kindex*3+jindex]).Im();
+					indexer += 1;
+				}
+
+				if (((branch[jindexer].Yfrom[jindex*3+kindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+				{
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex;
+					Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+					indexer += 1;
+					
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+					Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yfrom[jindex*3+kindex]).Re());
+					indexer += 1;	
+				}
+
+				if (((branch[jindexer].Yto[kindex*3+jindex]).Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+				{
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex + 2;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index;
+					Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[kindex*3+jindex]).Re());
+					indexer += 1;
+					
+					Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + kindex;
+					Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + temp_size;
+					Y_offdiag_PQ[indexer].Y_value = -((branch[jindexer].Yto[kindex*3+jindex]).Re());
+					indexer += 1;	
+				}
+			}//secondary index end
+
+		}//end to triplexy
+	}//end triplex in here
+	else					//Some combination of not-3 phase
+	{
+		//Clear working variables, just in case
+		temp_index = temp_index_b = -1;
+		temp_size = temp_size_b = temp_size_c = -1;
+		Full_Mat_A = Full_Mat_B = false;
+
+		//Intermediate store the admittance matrices so they can be directly indexed later
+		switch(branch[jindexer].phases & 0x07) {
+			case 0x00:	//No phases (open switch or reliability excluded item)
+				{
+					temp_size_c = -99;	//Arbitrary flag
+					break;
+				}
+			case 0x01:	//C only
+				{
+					Temp_Ad_A[0][0] = branch[jindexer].Yfrom[8];
+					Temp_Ad_B[0][0] = branch[jindexer].Yto[8];
+					temp_size_c = 1;
+					break;
+				}
+			case 0x02:	//B only
+				{
+					Temp_Ad_A[0][0] = branch[jindexer].Yfrom[4];
+					Temp_Ad_B[0][0] = branch[jindexer].Yto[4];
+					temp_size_c = 1;
+					break;
+				}
+			case 0x03:	//BC only
+				{
+					Temp_Ad_A[0][0] = branch[jindexer].Yfrom[4];
+					Temp_Ad_A[0][1] = branch[jindexer].Yfrom[5];
+					Temp_Ad_A[1][0] = branch[jindexer].Yfrom[7];
+					Temp_Ad_A[1][1] = branch[jindexer].Yfrom[8];
+					
+					Temp_Ad_B[0][0] = branch[jindexer].Yto[4];
+					Temp_Ad_B[0][1] = branch[jindexer].Yto[5];
+					Temp_Ad_B[1][0] = branch[jindexer].Yto[7];
+					Temp_Ad_B[1][1] = branch[jindexer].Yto[8];
+
+					temp_size_c = 2;
+					break;
+				}
+			case 0x04:	//A only
+				{
+					Temp_Ad_A[0][0] = branch[jindexer].Yfrom[0];
+					Temp_Ad_B[0][0] = branch[jindexer].Yto[0];
+					temp_size_c = 1;
+					break;
+				}
+			case 0x05:	//AC only
+				{
+					Temp_Ad_A[0][0] = branch[jindexer].Yfrom[0];
+					Temp_Ad_A[0][1] = branch[jindexer].Yfrom[2];
+					Temp_Ad_A[1][0] = branch[jindexer].Yfrom[6];
+					Temp_Ad_A[1][1] = branch[jindexer].Yfrom[8];
+					
+					Temp_Ad_B[0][0] = branch[jindexer].Yto[0];
+					Temp_Ad_B[0][1] = branch[jindexer].Yto[2];
+					Temp_Ad_B[1][0] = branch[jindexer].Yto[6];
+					Temp_Ad_B[1][1] = branch[jindexer].Yto[8];
+
+					temp_size_c = 2;
+					break;
+				}
+			case 0x06:	//AB only
+				{
+					Temp_Ad_A[0][0] = branch[jindexer].Yfrom[0];
+					Temp_Ad_A[0][1] = branch[jindexer].Yfrom[1];
+					Temp_Ad_A[1][0] = branch[jindexer].Yfrom[3];
+					Temp_Ad_A[1][1] = branch[jindexer].Yfrom[4];
+					
+					Temp_Ad_B[0][0] = branch[jindexer].Yto[0];
+					Temp_Ad_B[0][1] = branch[jindexer].Yto[1];
+					Temp_Ad_B[1][0] = branch[jindexer].Yto[3];
+					Temp_Ad_B[1][1] = branch[jindexer].Yto[4];
+
+					temp_size_c = 2;
+					break;
+				}
+			default:
+				{
+					break;
+				}
+		}//end line switch/case
+
+		if (temp_size_c==-99)
+		{
+			return indexer;	//Nothing stored for this branch
+		}
+
+		if (temp_size_c==-1)	//Make sure it is right
+		{
+			GL_THROW("NR: A line's phase was flagged as not full three-phase, but wasn't");
+			/*  TROUBLESHOOT
+			A line inside the powerflow model was flagged as not being full three-phase or
+			triplex in any form.  It failed the other cases though, so it must have been.
+			Please submit your code and a bug report to the trac website.
+			*/
+		}
+
+		//Check the from side and get all appropriate offsets
+		switch(bus[tempa].phases & 0x07) {
+			case 0x01:	//C
+				{
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_size = 1;		//Single size
+						temp_index = 0;		//No offset (only 1 big)
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+						/*  TROUBLESHOOT
+						One of the lines in the powerflow model has an invalid phase in
+						reference to its to and from ends.  This should have been caught
+						earlier, so submit your code and a bug report using the trac website.
+						*/
+					}
+					break;
+				}//end 0x01
+			case 0x02:	//B
+				{
+					if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_size = 1;		//Single size
+						temp_index = 0;		//No offset (only 1 big)
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x02
+			case 0x03:	//BC
+				{
+					temp_size = 2;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_index = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_index = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
+					{
+						temp_index = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x03
+			case 0x04:	//A
+				{
+					if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_size = 1;		//Single size
+						temp_index = 0;		//No offset (only 1 big)
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x04
+			case 0x05:	//AC
+				{
+					temp_size = 2;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_index = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_index = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
+					{
+						temp_index = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x05
+			case 0x06:	//AB
+				{
+					temp_size = 2;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_index = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_index = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
+					{
+						temp_index = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x06
+			case 0x07:	//ABC
+				{
+					temp_size = 3;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_index = 2;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_index = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
+					{
+						temp_index = 1;
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_index = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
+					{
+						temp_index = 0;
+						Full_Mat_A = true;		//Flag so we know C needs to be gapped
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
+					{
+						temp_index = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x07
+			default:
+				{
+					break;
+				}
+		}//End switch/case for from
+
+		//Check the to side and get all appropriate offsets
+		switch(bus[tempb].phases & 0x07) {
+			case 0x01:	//C
+				{
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_size_b = 1;		//Single size
+						temp_index_b = 0;		//No offset (only 1 big)
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+						/*  TROUBLESHOOT
+						One of the lines in the powerflow model has an invalid phase in
+						reference to its to and from ends.  This should have been caught
+						earlier, so submit your code and a bug report using the trac website.
+						*/
+					}
+					break;
+				}//end 0x01
+			case 0x02:	//B
+				{
+					if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_size_b = 1;		//Single size
+						temp_index_b = 0;		//No offset (only 1 big)
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x02
+			case 0x03:	//BC
+				{
+					temp_size_b = 2;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_index_b = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_index_b = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
+					{
+						temp_index_b = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x03
+			case 0x04:	//A
+				{
+					if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_size_b = 1;		//Single size
+						temp_index_b = 0;		//No offset (only 1 big)
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x04
+			case 0x05:	//AC
+				{
+					temp_size_b = 2;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_index_b = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_index_b = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
+					{
+						temp_index_b = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x05
+			case 0x06:	//AB
+				{
+					temp_size_b = 2;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_index_b = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_index_b = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
+					{
+						temp_index_b = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x06
+			case 0x07:	//ABC
+				{
+					temp_size_b = 3;	//Size of this matrix's admittance
+					if ((branch[jindexer].phases & 0x07) == 0x01)	//C
+					{
+						temp_index_b = 2;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x02)	//B
+					{
+						temp_index_b = 1;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x03)	//BC
+					{
+						temp_index_b = 1;
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x04)	//A
+					{
+						temp_index_b = 0;		//offset
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x05)	//AC
+					{
+						temp_index_b = 0;
+						Full_Mat_B = true;		//Flag so we know C needs to be gapped
+					}
+					else if ((branch[jindexer].phases & 0x07) == 0x06)	//AB
+					{
+						temp_index_b = 0;
+					}
+					else
+					{
+						GL_THROW("NR: One of the lines has invalid phase parameters");
+					}
+					break;
+				}//end 0x07
+			default:
+				{
+					break;
+				}
+		}//End switch/case for to
+
+		//Make sure everything was set before proceeding
+		if ((temp_index==-1) || (temp_index_b==-1) || (temp_size==-1) || (temp_size_b==-1) || (temp_size_c==-1))
+		{
+			GL_THROW("NR: Failure to construct single/double phase line indices");
+			/*  TROUBLESHOOT
+			A single or double phase line (e.g., just A or AB) has failed to properly initialize all of the indices
+			necessary to form the admittance matrix.  Please submit a bug report, with your code, to the trac site.
+			*/
+		}
+
+		if (Full_Mat_A)	//From side is a full ABC and we have AC
+		{
+			for (jindex=0; jindex<temp_size_c; jindex++)		//Loop through rows of admittance matrices				
+			{
+				for (kindex=0; kindex<temp_size_c; kindex++)	//Loop through columns of admittance matrices
+				{
+					//Indices counted out from Self admittance above.  needs doubling due to complex separation
+					if ((Temp_Ad_A[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Im());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2 + temp_size;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
+						Y_offdiag_PQ[indexer].Y_value = (Temp_Ad_A[jindex][kindex].Im());
+						indexer += 1;
+					}
+
+					if ((Temp_Ad_B[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Im());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2 + temp_size;
+						Y_offdiag_PQ[indexer].Y_value = Temp_Ad_B[jindex][kindex].Im();
+						indexer += 1;
+					}
+
+					if ((Temp_Ad_A[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2 + temp_size;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
+						indexer += 1;	
+					}
+
+					if ((Temp_Ad_B[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2 + temp_size;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
+						indexer += 1;	
+					}
+				}//column end
+			}//row end
+		}//end full ABC for from AC
+
+		if (Full_Mat_B)	//To side is a full ABC and we have AC
+		{
+			for (jindex=0; jindex<temp_size_c; jindex++)		//Loop through rows of admittance matrices				
+			{
+				for (kindex=0; kindex<temp_size_c; kindex++)	//Loop through columns of admittance matrices
+				{
+					//Indices counted out from Self admittance above.  needs doubling due to complex separation
+					if ((Temp_Ad_A[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Im());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2 + temp_size_b;
+						Y_offdiag_PQ[indexer].Y_value = (Temp_Ad_A[jindex][kindex].Im());
+						indexer += 1;
+					}
+
+					if ((Temp_Ad_B[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Im());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2 + temp_size_b;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
+						Y_offdiag_PQ[indexer].Y_value = Temp_Ad_B[jindex][kindex].Im();
+						indexer += 1;
+					}
+
+					if ((Temp_Ad_A[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2 + temp_size_b;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
+						indexer += 1;	
+					}
+
+					if ((Temp_Ad_B[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2 + temp_size_b;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
+						indexer += 1;	
+					}
+				}//column end
+			}//row end
+		}//end full ABC for to AC
+
+		if ((!Full_Mat_A) && (!Full_Mat_B))	//Neither is a full ABC, or we aren't doing AC, so we don't care
+		{
+			for (jindex=0; jindex<temp_size_c; jindex++)		//Loop through rows of admittance matrices				
+			{
+				for (kindex=0; kindex<temp_size_c; kindex++)	//Loop through columns of admittance matrices
+				{
+					//Indices counted out from Self admittance above.  needs doubling due to complex separation
+					if ((Temp_Ad_A[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Im());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
+						Y_offdiag_PQ[indexer].Y_value = (Temp_Ad_A[jindex][kindex].Im());
+						indexer += 1;
+					}
+
+					if ((Temp_Ad_B[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Im());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
+						Y_offdiag_PQ[indexer].Y_value = Temp_Ad_B[jindex][kindex].Im();
+						indexer += 1;
+					}
+
+					if ((Temp_Ad_A[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
+						indexer += 1;	
+					}
+
+					if ((Temp_Ad_B[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
+					{
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
+						indexer += 1;
+						
+						Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
+						Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
+						Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
+						indexer += 1;	
+					}
+				}//column end
+			}//row end
+		}//end not full ABC with AC on either side case
+	}//end all others else
+
+	return indexer;
+}
+
+//Count the fixed diagonal admittance entries of a bus (each of them goes in two places of Y_diag_fixed)
+static unsigned int NR_bus_diag_fixed_count(unsigned int jindexer, BUSDATA *bus, Bus_admit *BA_diag)
+{
+	char jindex, kindex;
+	unsigned int count = 0;
+
+	for (jindex=0; jindex<3; jindex++)
+	{
+		for (kindex=0; kindex<3; kindex++)
+		{		 
+		  if ((BA_diag[jindexer].Y[jindex][kindex]).Re() != 0 && bus[jindexer].type != 1 && jindex!=kindex)  
+			  count += 1; 
+		  if ((BA_diag[jindexer].Y[jindex][kindex]).Im() != 0 && bus[jindexer].type != 1 && jindex!=kindex) 
+			  count += 1; 
+		  else {}
+		 }
+	}
+
+	return count;
+}
+
+//Store the fixed diagonal admittance entries of a bus into Y_diag_fixed, starting at indexer
+//Returns the index past the last entry stored
+static unsigned int NR_bus_diag_fixed(unsigned int jindexer, BUSDATA *bus, Bus_admit *BA_diag, Y_NR *Y_diag_fixed, unsigned int indexer)
+{
+	char jindex, kindex;
+
+	for (jindex=0; jindex<BA_diag[jindexer].size; jindex++)
+	{
+		for (kindex=0; kindex<BA_diag[jindexer].size; kindex++)
+		{					
+			if ((BA_diag[jindexer].Y[jindex][kindex]).Im() != 0 && bus[jindexer].type != 1 && jindex!=kindex)
+			{
+				Y_diag_fixed[indexer].row_ind = 2*BA_diag[jindexer].row_ind + jindex;
+				Y_diag_fixed[indexer].col_ind = 2*BA_diag[jindexer].col_ind + kindex;
+				Y_diag_fixed[indexer].Y_value = (BA_diag[jindexer].Y[jindex][kindex]).Im();
+				indexer += 1;
+
+				Y_diag_fixed[indexer].row_ind = 2*BA_diag[jindexer].row_ind + jindex +BA_diag[jindexer].size;
+				Y_diag_fixed[indexer].col_ind = 2*BA_diag[jindexer].col_ind + kindex +BA_diag[jindexer].size;
+				Y_diag_fixed[indexer].Y_value = -(BA_diag[jindexer].Y[jindex][kindex]).Im();
+				indexer += 1;
+			}
+
+			if ((BA_diag[jindexer].Y[jindex][kindex]).Re() != 0 && bus[jindexer].type != 1 && jindex!=kindex)
+			{
+				Y_diag_fixed[indexer].row_ind = 2*BA_diag[jindexer].row_ind + jindex;
+				Y_diag_fixed[indexer].col_ind = 2*BA_diag[jindexer].col_ind + kindex +BA_diag[jindexer].size;
+				Y_diag_fixed[indexer].Y_value = (BA_diag[jindexer].Y[jindex][kindex]).Re();
+				indexer += 1;
+				
+				Y_diag_fixed[indexer].row_ind = 2*BA_diag[jindexer].row_ind + jindex +BA_diag[jindexer].size;
+				Y_diag_fixed[indexer].col_ind = 2*BA_diag[jindexer].col_ind + kindex;
+				Y_diag_fixed[indexer].Y_value = (BA_diag[jindexer].Y[jindex][kindex]).Re();
+				indexer += 1;
+			}
+		}
+	}
+
+	return indexer;
+}
+
+//Largest number of fixed admittance entries of one branch or bus - 3x3 phases, from and to, real and imaginary,
+//each of them in two places
+#define NR_MAX_ENTRIES 72
+
+//Copy the values of freshly built admittance entries over the stored ones, if they are in the same places
+static bool NR_admittance_entries_update(Y_NR *stored, Y_NR *built, unsigned int count)
+{
+	unsigned int index;
+
+	for (index=0; index<count; index++)
+	{
+		if ((stored[index].row_ind != built[index].row_ind) || (stored[index].col_ind != built[index].col_ind))
+			return false;
+	}
+	for (index=0; index<count; index++)
+		stored[index].Y_value = built[index].Y_value;
+
+	return true;
+}
+
+//In-place admittance updates applied - guarded, since islands are solved concurrently
+static unsigned int NR_admittance_update_lock = 0;
+
+//Apply admittance value changes of some branches (e.g., regulator taps) without rebuilding the whole admittance
+//The self admittance of their end buses, and the fixed entries of the branches and of those buses, are rebuilt in place
+//Returns false if the new entries don't line up with the stored ones (the structure changed) - the caller has to do a full rebuild
+static bool NR_admittance_update(BUSDATA *bus, BRANCHDATA *branch, NR_SOLVER_STRUCT *powerflow_values, NRSOLVERMODE powerflow_type, const int *branch_updates, unsigned int branch_update_count)
+{
+	Y_NR work[NR_MAX_ENTRIES];
+	unsigned int index, end_index, bus_index, start, count;
+	int jindexer;
+	char size;
+
+	//Nothing to update in place until the admittance has been built once
+	if ((powerflow_values->BA_diag == NULL) || (powerflow_values->branch_offdiag_start == NULL) || (powerflow_values->bus_diag_fixed_start == NULL))
+		return false;
+
+	for (index=0; index<branch_update_count; index++)
+	{
+		jindexer = branch_updates[index];
+
+		//Self admittance of both ends - the size (and so every matrix location) has to stay the same
+		for (end_index=0; end_index<2; end_index++)
+		{
+			bus_index = (end_index == 0) ? branch[jindexer].from : branch[jindexer].to;
+			size = powerflow_values->BA_diag[bus_index].size;
+			NR_bus_self_admittance(bus_index, bus, branch, powerflow_values, powerflow_type);
+			if (powerflow_values->BA_diag[bus_index].size != size)
+				return false;
+		}
+
+		//Off-diagonal entries of the branch - rebuilt over a copy of the stored ones, then compared
+		start = powerflow_values->branch_offdiag_start[jindexer];
+		count = powerflow_values->branch_offdiag_start[jindexer+1] - start;
+		if ((count > NR_MAX_ENTRIES) || (2*NR_branch_offdiag_count(jindexer, bus, branch) != count))
+			return false;
+		memcpy(work, &powerflow_values->Y_offdiag_PQ[start], count*sizeof(Y_NR));
+		if ((NR_branch_offdiag(jindexer, bus, branch, work, 0) != count) || !NR_admittance_entries_update(&powerflow_values->Y_offdiag_PQ[start], work, count))
+			return false;
+
+		//Fixed diagonal entries of both ends
+		for (end_index=0; end_index<2; end_index++)
+		{
+			bus_index = (end_index == 0) ? branch[jindexer].from : branch[jindexer].to;
+			start = powerflow_values->bus_diag_fixed_start[bus_index];
+			count = powerflow_values->bus_diag_fixed_start[bus_index+1] - start;
+			if ((count > NR_MAX_ENTRIES) || (2*NR_bus_diag_fixed_count(bus_index, bus, powerflow_values->BA_diag) != count))
+				return false;
+			memcpy(work, &powerflow_values->Y_diag_fixed[start], count*sizeof(Y_NR));
+			if ((NR_bus_diag_fixed(bus_index, bus, powerflow_values->BA_diag, work, 0) != count) || !NR_admittance_entries_update(&powerflow_values->Y_diag_fixed[start], work, count))
+				return false;
+		}
+	}
+
+	WRITELOCK(&NR_admittance_update_lock);
+	NR_admittance_updates++;
+	WRITEUNLOCK(&NR_admittance_update_lock);
+
+	return true;
+}
+
+/** Newton-Raphson solver for a single system of buses and branches
+	(the whole network, or one electrically isolated island of it)
+	
+	@return n=0 on failure to complete a single iteration, 
+	n>0 to indicate success after n interations, or 
+	n<0 to indicate failure after n iterations
+ **/
+static int64 NR_solve_system(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count, BRANCHDATA *branch, NR_SOLVER_STRUCT *powerflow_values, NRSOLVERMODE powerflow_type , NR_MESHFAULT_IMPEDANCE *mesh_imped_vals, bool *bad_computations, bool admittance_change, const int *branch_updates, unsigned int branch_update_count)
+{
+	//LU solver working state of this system
+	NR_SOLVER_LU *LU = NR_get_LU_state(powerflow_values);
+	NR_SOLVER_VARS &matrices_LU = LU->matrices_LU;
+	int *&perm_c = LU->perm_c;
+	int *&perm_r = LU->perm_r;
+	SuperMatrix &A_LU = LU->A_LU;
+	SuperMatrix &B_LU = LU->B_LU;
+	void *&ext_solver_glob_vars = LU->ext_solver_glob_vars;
+
+	//Internal iteration counter - just NR limits
+	int64 Iteration;
+
+	//File pointer for debug outputs
+	FILE *FPoutVal;
+
+	//A matrix size variable
+	unsigned int size_Amatrix;
+
+	//Voltage mismatch tracking variable
+	double Maxmismatch;
+
+	//Saturation mismatch tracking variable
+	bool SaturationMismatchPresent;
+	int func_result_val;
+
+	//Phase collapser variable
+	unsigned char phase_worka;
+
+	//Temporary calculation variables
+	double tempIcalcReal, tempIcalcImag;
+	double tempPbus; //tempPbus store the temporary value of active power load at each bus
+	double tempQbus; //tempQbus store the temporary value of reactive power load at each bus
+
+	//Miscellaneous index variable
+	unsigned int indexer, tempa, jindexer, kindexer;
+	char jindex, kindex;
+	char temp_index, temp_index_b;
+	unsigned int temp_index_c;
+
+	//Working matrix for mesh fault impedance storage, prior to "reconstruction"
+	double temp_z_store[6][6];
+
+	//Miscellaneous flag variables
+	bool proceed_flag;
 
-				if (Full_Mat_A)	//From side is a full ABC and we have AC
-				{
-					for (jindex=0; jindex<temp_size_c; jindex++)		//Loop through rows of admittance matrices				
-					{
-						for (kindex=0; kindex<temp_size_c; kindex++)	//Loop through columns of admittance matrices
-						{
-							//Indices counted out from Self admittance above.  needs doubling due to complex separation
-							if ((Temp_Ad_A[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Im());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2 + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = (Temp_Ad_A[jindex][kindex].Im());
-								indexer += 1;
-							}
+	//Iteration flag
+	bool newiter;
 
-							if ((Temp_Ad_B[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Im());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2 + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = Temp_Ad_B[jindex][kindex].Im();
-								indexer += 1;
-							}
+	//Deltamode pass flag - changes how SWING buses are handled
+	//Multiple SWING-bus attached generators may cause issues, but no good way to detect
+	bool swing_is_a_swing;
 
-							if ((Temp_Ad_A[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2 + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
-								indexer += 1;	
-							}
+	//Deltamode initial dynamics run - swing convergence flag (symmetry)
+	bool swing_converged;
 
-							if ((Temp_Ad_B[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex*2 + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
-								indexer += 1;	
-							}
-						}//column end
-					}//row end
-				}//end full ABC for from AC
+	//Deltamode intermediate variables
+	complex temp_complex_0, temp_complex_1, temp_complex_2, temp_complex_3, temp_complex_4, temp_complex_5;
+	complex aval, avalsq;
 
-				if (Full_Mat_B)	//To side is a full ABC and we have AC
-				{
-					for (jindex=0; jindex<temp_size_c; jindex++)		//Loop through rows of admittance matrices				
-					{
-						for (kindex=0; kindex<temp_size_c; kindex++)	//Loop through columns of admittance matrices
-						{
-							//Indices counted out from Self admittance above.  needs doubling due to complex separation
-							if ((Temp_Ad_A[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Im());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2 + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = (Temp_Ad_A[jindex][kindex].Im());
-								indexer += 1;
-							}
+	//Temporary size variable
+	char temp_size;
 
-							if ((Temp_Ad_B[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Im());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2 + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = Temp_Ad_B[jindex][kindex].Im();
-								indexer += 1;
-							}
+	//Temporary load calculation variables
+	complex undeltacurr[3];
+	complex delta_current[3], voltageDel[3];
+	complex temp_current[3], temp_power[3], temp_store[3];
+	complex adjusted_constant_current[6];
+	complex adjust_temp_nominal_voltage[6];
+	double adjust_temp_voltage_mag[6];
+	double adjust_nominal_voltage_val, adjust_nominal_voltaged_val;
 
-							if ((Temp_Ad_A[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex*2 + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
-								indexer += 1;	
-							}
+	//DV checking array
+	complex DVConvCheck[3];
+	double CurrConvVal;
 
-							if ((Temp_Ad_B[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2 + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex*2;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
-								indexer += 1;	
-							}
-						}//column end
-					}//row end
-				}//end full ABC for to AC
+	//Miscellaneous counter tracker
+	unsigned int index_count = 0;
+
+	//Miscellaneous working variable
+	double work_vals_double_0, work_vals_double_1,work_vals_double_2,work_vals_double_3,work_vals_double_4;
+	char work_vals_char_0;
 
-				if ((!Full_Mat_A) && (!Full_Mat_B))	//Neither is a full ABC, or we aren't doing AC, so we don't care
+	//SuperLU variables
+#ifndef MT
+	SuperMatrix L_LU,U_LU;	//superLU_MT factors are held by NR_superLU_solve
+#endif
+	NCformat *Astore;
+	DNformat *Bstore;
+	int nnz, info;
+	unsigned int m,n;
+	double *sol_LU;
+
+	//Spare notation variable - for output
+	int row, col;
+	double value;
+	
+#ifndef MT
+	superlu_options_t options;	//Additional variables for sequential superLU
+	SuperLUStat_t stat;
+#endif
+
+	//Ensure bad computations flag is set first
+	*bad_computations = false;
+
+	//Determine special circumstances of SWING bus -- do we want it to truly participate right
+	if (powerflow_type != PF_NORMAL)
+	{
+		if (powerflow_type == PF_DYNCALC)	//Parse the list -- anything that is a swing and a generator, deflag it out of principle (and to make it work right)
+		{
+			//Set the master swing flag
+			swing_is_a_swing = false;
+
+			//Check the buses
+			for (indexer=0; indexer<bus_count; indexer++)
+			{
+				//See if we're a swing-flagged bus
+				if ((bus[indexer].type > 1) && (bus[indexer].swing_functions_enabled == true))
 				{
-					for (jindex=0; jindex<temp_size_c; jindex++)		//Loop through rows of admittance matrices				
+					//See if we're "generator ready"
+					if ((*bus[indexer].dynamics_enabled==true) && (bus[indexer].full_Y != NULL) && (bus[indexer].DynCurrent != NULL))
 					{
-						for (kindex=0; kindex<temp_size_c; kindex++)	//Loop through columns of admittance matrices
-						{
-							//Indices counted out from Self admittance above.  needs doubling due to complex separation
-							if ((Temp_Ad_A[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From imags
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Im());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = (Temp_Ad_A[jindex][kindex].Im());
-								indexer += 1;
-							}
+						//Deflag us back to "PQ" status
+						bus[indexer].swing_functions_enabled = false;
+					}
+				}
+				//Default else -- normal bus
+			}//End bus traversion loop
+		}//Handle running dynamics differently
+		else	//Must be PF_DYNINIT
+		{
+			//Flag us as true, initially
+			swing_is_a_swing = true;
+		}
+	}//End not normal
+	else	//Must be normal
+	{
+		swing_is_a_swing = true;	//Flag as a swing, even though this shouldn't do anything
+	}
 
-							if ((Temp_Ad_B[jindex][kindex].Im() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To imags
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Im());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = Temp_Ad_B[jindex][kindex].Im();
-								indexer += 1;
-							}
+	//Populate aval, if necessary
+	if (powerflow_type == PF_DYNINIT)
+	{
+		//Conversion variables - 1@120-deg
+		aval = complex(-0.5,(sqrt(3.0)/2.0));
+		avalsq = aval*aval;	//squared value is used a couple places too
+	}
+	else	//Zero it, just in case something uses it (what would???)
+	{
+		aval = 0.0;
+		avalsq = 0.0;
+	}
 
-							if ((Temp_Ad_A[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//From reals
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempa].Matrix_Loc + temp_index + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + kindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_A[jindex][kindex].Re());
-								indexer += 1;	
-							}
+	if (matrix_solver_method==MM_EXTERN)
+	{
+		//Call the initialization routine
+		ext_solver_glob_vars = ((void *(*)(void *))(LUSolverFcns.ext_init))(ext_solver_glob_vars);
 
-							if ((Temp_Ad_B[jindex][kindex].Re() != 0) && (bus[tempa].type != 1) && (bus[tempb].type != 1))	//To reals
-							{
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex + temp_size_b;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
-								indexer += 1;
-								
-								powerflow_values->Y_offdiag_PQ[indexer].row_ind = 2*bus[tempb].Matrix_Loc + temp_index_b + jindex;
-								powerflow_values->Y_offdiag_PQ[indexer].col_ind = 2*bus[tempa].Matrix_Loc + temp_index + kindex + temp_size;
-								powerflow_values->Y_offdiag_PQ[indexer].Y_value = -(Temp_Ad_B[jindex][kindex].Re());
-								indexer += 1;	
-							}
-						}//column end
-					}//row end
-				}//end not full ABC with AC on either side case
-			}//end all others else
-		}//end branch for
+		//Make sure it worked (allocation check)
+		if (ext_solver_glob_vars==NULL)
+		{
+			GL_THROW("External LU matrix solver failed to allocate memory properly!");
+			/*  TROUBLESHOOT
+			While attempting to allocate memory for the external LU solver, an error occurred.
+			Please try again.  If the error persists, ensure your external LU solver is behaving correctly
+			and coordinate with their development team as necessary.
+			*/
+		}
+	}
 
-		//Build the fixed part of the diagonal PQ bus elements of 6n*6n Y_NR matrix. This part will not be updated at each iteration. 
-		powerflow_values->size_diag_fixed = 0;
-		for (jindexer=0; jindexer<bus_count;jindexer++) 
+	//Branch admittance value changes alone are applied in place - the external solvers get a full update
+	if ((admittance_change == false) && (branch_update_count > 0))
+	{
+		if ((matrix_solver_method == MM_EXTERN) || !NR_admittance_update(bus, branch, powerflow_values, powerflow_type, branch_updates, branch_update_count))
+			admittance_change = true;
+	}
+
+	if (admittance_change)	//If an admittance update was detected, fix it
+	{
+		//Build the diagnoal elements of the bus admittance matrix - this should only happen once no matter what
+		if (powerflow_values->BA_diag == NULL)
 		{
-			for (jindex=0; jindex<3; jindex++)
+			powerflow_values->BA_diag = (Bus_admit *)gl_malloc(bus_count *sizeof(Bus_admit));   //BA_diag store the location and value of diagonal elements of Bus Admittance matrix
+
+			//Make sure it worked
+			if (powerflow_values->BA_diag == NULL)
 			{
-				for (kindex=0; kindex<3; kindex++)
-				{		 
-				  if ((powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Re() != 0 && bus[jindexer].type != 1 && jindex!=kindex)  
-					  powerflow_values->size_diag_fixed += 1; 
-				  if ((powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Im() != 0 && bus[jindexer].type != 1 && jindex!=kindex) 
-					  powerflow_values->size_diag_fixed += 1; 
-				  else {}
-				 }
+				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+				/*  TROUBLESHOOT
+				During the allocation stage of the NR algorithm, one of the matrices failed to be allocated.
+				Please try again and if this bug persists, submit your code and a bug report using the trac
+				website.
+				*/
 			}
 		}
+
+		//Same for the starts of each branch and bus in the fixed entries (used for in-place updates)
+		if (powerflow_values->branch_offdiag_start == NULL)
+		{
+			powerflow_values->branch_offdiag_start = (unsigned int *)gl_malloc((branch_count+1)*sizeof(unsigned int));
+			powerflow_values->bus_diag_fixed_start = (unsigned int *)gl_malloc((bus_count+1)*sizeof(unsigned int));
+
+			//Make sure it worked
+			if ((powerflow_values->branch_offdiag_start == NULL) || (powerflow_values->bus_diag_fixed_start == NULL))
+				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+				//Defined above
+		}
+		
+		for (indexer=0; indexer<bus_count; indexer++) // Construct the diagonal elements of Bus admittance matrix.
+		{
+			NR_bus_self_admittance(indexer, bus, branch, powerflow_values, powerflow_type);
+
+			//Update the indices for possible use later
+			powerflow_values->BA_diag[indexer].col_ind = powerflow_values->BA_diag[indexer].row_ind = index_count;	// Store the row and column starting information (square matrices)
+			bus[indexer].Matrix_Loc = index_count;								//Store our location so we know where we go
+			index_count += powerflow_values->BA_diag[indexer].size;				// Update the index for this matrix's size, so next one is in appropriate place
+		}//End diagonal construction
+
+		//Store the size of the diagonal, since it represents how many variables we are solving (useful later)
+		powerflow_values->total_variables=index_count;
+
+		//Check to see if we've exceeded our max.  If so, reallocate!
+		if (powerflow_values->total_variables > powerflow_values->max_total_variables)
+			powerflow_values->NR_realloc_needed = true;
+
+		/// Build the off_diagonal_PQ bus elements of 6n*6n Y_NR matrix.Equation (12). All the value in this part will not be updated at each iteration.
+		//Constructed using sparse methodology, non-zero elements are the only thing considered (and non-PV)
+		//No longer necessarily 6n*6n any more either,
+		powerflow_values->size_offdiag_PQ = 0;
+		for (jindexer=0; jindexer<branch_count;jindexer++)	//Parse all of the branches
+			powerflow_values->size_offdiag_PQ += NR_branch_offdiag_count(jindexer, bus, branch);
+
+		//Allocate the space - double the number found (each element goes in two places)
+		if (powerflow_values->Y_offdiag_PQ == NULL)
+		{
+			powerflow_values->Y_offdiag_PQ = (Y_NR *)gl_malloc((powerflow_values->size_offdiag_PQ*2) *sizeof(Y_NR));   //powerflow_values->Y_offdiag_PQ store the row,column and value of off_diagonal elements of Bus Admittance matrix in which all the buses are not PV buses. 
+
+			//Make sure it worked
+			if (powerflow_values->Y_offdiag_PQ == NULL)
+				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+
+			//Save our size
+			powerflow_values->max_size_offdiag_PQ = powerflow_values->size_offdiag_PQ;	//Don't care about the 2x, since we'll be comparing it against itself
+		}
+		else if (powerflow_values->size_offdiag_PQ > powerflow_values->max_size_offdiag_PQ)	//Something changed and we are bigger!!
+		{
+			//Destroy us!
+			gl_free(powerflow_values->Y_offdiag_PQ);
+
+			//Rebuild us, we have the technology
+			powerflow_values->Y_offdiag_PQ = (Y_NR *)gl_malloc((powerflow_values->size_offdiag_PQ*2) *sizeof(Y_NR));
+
+			//Make sure it worked
+			if (powerflow_values->Y_offdiag_PQ == NULL)
+				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+
+			//Store the new size
+			powerflow_values->max_size_offdiag_PQ = powerflow_values->size_offdiag_PQ;
+
+			//Flag for a reallocation
+			powerflow_values->NR_realloc_needed = true;
+		}
+
+		indexer = 0;
+		for (jindexer=0; jindexer<branch_count;jindexer++)	//Parse through all of the branches
+		{
+			powerflow_values->branch_offdiag_start[jindexer] = indexer;
+			indexer = NR_branch_offdiag(jindexer, bus, branch, powerflow_values->Y_offdiag_PQ, indexer);
+		}//end branch for
+		powerflow_values->branch_offdiag_start[branch_count] = indexer;
+
+		//Build the fixed part of the diagonal PQ bus elements of 6n*6n Y_NR matrix. This part will not be updated at each iteration. 
+		powerflow_values->size_diag_fixed = 0;
+		for (jindexer=0; jindexer<bus_count;jindexer++) 
+			powerflow_values->size_diag_fixed += NR_bus_diag_fixed_count(jindexer, bus, powerflow_values->BA_diag);
 		if (powerflow_values->Y_diag_fixed == NULL)
 		{
 			powerflow_values->Y_diag_fixed = (Y_NR *)gl_malloc((powerflow_values->size_diag_fixed*2) *sizeof(Y_NR));   //powerflow_values->Y_diag_fixed store the row,column and value of the fixed part of the diagonal PQ bus elements of 6n*6n Y_NR matrix.
@@ -2052,45 +2597,17 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			//Store the new size
 			powerflow_values->max_size_diag_fixed = powerflow_values->size_diag_fixed;
 
-			//Flag for a reallocation
-			powerflow_values->NR_realloc_needed = true;
-		}
-
-		indexer = 0;
-		for (jindexer=0; jindexer<bus_count;jindexer++)	//Parse through bus list
-		{ 
-			for (jindex=0; jindex<powerflow_values->BA_diag[jindexer].size; jindex++)
-			{
-				for (kindex=0; kindex<powerflow_values->BA_diag[jindexer].size; kindex++)
-				{					
-					if ((powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Im() != 0 && bus[jindexer].type != 1 && jindex!=kindex)
-					{
-						powerflow_values->Y_diag_fixed[indexer].row_ind = 2*powerflow_values->BA_diag[jindexer].row_ind + jindex;
-						powerflow_values->Y_diag_fixed[indexer].col_ind = 2*powerflow_values->BA_diag[jindexer].col_ind + kindex;
-						powerflow_values->Y_diag_fixed[indexer].Y_value = (powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Im();
-						indexer += 1;
-
-						powerflow_values->Y_diag_fixed[indexer].row_ind = 2*powerflow_values->BA_diag[jindexer].row_ind + jindex +powerflow_values->BA_diag[jindexer].size;
-						powerflow_values->Y_diag_fixed[indexer].col_ind = 2*powerflow_values->BA_diag[jindexer].col_ind + kindex +powerflow_values->BA_diag[jindexer].size;
-						powerflow_values->Y_diag_fixed[indexer].Y_value = -(powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Im();
-						indexer += 1;
-					}
+			//Flag for a reallocation
+			powerflow_values->NR_realloc_needed = true;
+		}
 
-					if ((powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Re() != 0 && bus[jindexer].type != 1 && jindex!=kindex)
-					{
-						powerflow_values->Y_diag_fixed[indexer].row_ind = 2*powerflow_values->BA_diag[jindexer].row_ind + jindex;
-						powerflow_values->Y_diag_fixed[indexer].col_ind = 2*powerflow_values->BA_diag[jindexer].col_ind + kindex +powerflow_values->BA_diag[jindexer].size;
-						powerflow_values->Y_diag_fixed[indexer].Y_value = (powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Re();
-						indexer += 1;
-						
-						powerflow_values->Y_diag_fixed[indexer].row_ind = 2*powerflow_values->BA_diag[jindexer].row_ind + jindex +powerflow_values->BA_diag[jindexer].size;
-						powerflow_values->Y_diag_fixed[indexer].col_ind = 2*powerflow_values->BA_diag[jindexer].col_ind + kindex;
-						powerflow_values->Y_diag_fixed[indexer].Y_value = (powerflow_values->BA_diag[jindexer].Y[jindex][kindex]).Re();
-						indexer += 1;
-					}
-				}
-			}
+		indexer = 0;
+		for (jindexer=0; jindexer<bus_count;jindexer++)	//Parse through bus list
+		{
+			powerflow_values->bus_diag_fixed_start[jindexer] = indexer;
+			indexer = NR_bus_diag_fixed(jindexer, bus, powerflow_values->BA_diag, powerflow_values->Y_diag_fixed, indexer);
 		}//End bus parse for fixed diagonal
+		powerflow_values->bus_diag_fixed_start[bus_count] = indexer;
 	}//End admittance update
 
 	//Reset saturation checks
@@ -3647,10 +4164,10 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 
 						//Effectively Zero out the components, regardless of normal run or not
 						//Should already be zerod, but do it again for paranoia sake
-						if (NR_busdata[indexer].BusHistTerm != NULL)	//See if we're "delta-capable"
+						if (bus[indexer].BusHistTerm != NULL)	//See if we're "delta-capable"
 						{
-							powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+powerflow_values->BA_diag[indexer].size + jindex] = NR_busdata[indexer].BusHistTerm[jindex].Re();
-							powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] = NR_busdata[indexer].BusHistTerm[jindex].Im();
+							powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+powerflow_values->BA_diag[indexer].size + jindex] = bus[indexer].BusHistTerm[jindex].Re();
+							powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] = bus[indexer].BusHistTerm[jindex].Im();
 						}
 						else
 						{
@@ -3670,10 +4187,10 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 							work_vals_double_2 = (bus[indexer].V[temp_index_b]).Im();
 
 							//See if deltamode needs to include extra term
-							if (NR_busdata[indexer].BusHistTerm != NULL)
+							if (bus[indexer].BusHistTerm != NULL)
 							{
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+ powerflow_values->BA_diag[indexer].size + jindex] = (tempPbus * work_vals_double_1 + tempQbus * work_vals_double_2)/ (work_vals_double_0) + NR_busdata[indexer].BusHistTerm[jindex].Re() - tempIcalcReal ; // equation(7), Real part of deltaI, left hand side of equation (11)
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] = (tempPbus * work_vals_double_2 - tempQbus * work_vals_double_1)/ (work_vals_double_0) + NR_busdata[indexer].BusHistTerm[jindex].Im() - tempIcalcImag; // Imaginary part of deltaI, left hand side of equation (11)
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+ powerflow_values->BA_diag[indexer].size + jindex] = (tempPbus * work_vals_double_1 + tempQbus * work_vals_double_2)/ (work_vals_double_0) + bus[indexer].BusHistTerm[jindex].Re() - tempIcalcReal ; // equation(7), Real part of deltaI, left hand side of equation (11)
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] = (tempPbus * work_vals_double_2 - tempQbus * work_vals_double_1)/ (work_vals_double_0) + bus[indexer].BusHistTerm[jindex].Im() - tempIcalcImag; // Imaginary part of deltaI, left hand side of equation (11)
 							}
 							else	//Nope
 							{
@@ -3682,18 +4199,18 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 							}
 
 							//Accumulate in any saturation current values as well, while we're here
-							if (NR_busdata[indexer].BusSatTerm != NULL)
+							if (bus[indexer].BusSatTerm != NULL)
 							{
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+ powerflow_values->BA_diag[indexer].size + jindex] -= NR_busdata[indexer].BusSatTerm[jindex].Re();
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] -= NR_busdata[indexer].BusSatTerm[jindex].Im();
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+ powerflow_values->BA_diag[indexer].size + jindex] -= bus[indexer].BusSatTerm[jindex].Re();
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] -= bus[indexer].BusSatTerm[jindex].Im();
 							}
 						}
 						else
 						{
-							if (NR_busdata[indexer].BusHistTerm != NULL)	//See if extra deltamode term needs to be included
+							if (bus[indexer].BusHistTerm != NULL)	//See if extra deltamode term needs to be included
 							{
-           						powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+powerflow_values->BA_diag[indexer].size + jindex] = NR_busdata[indexer].BusHistTerm[jindex].Re();
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] = NR_busdata[indexer].BusHistTerm[jindex].Im();
+           						powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+powerflow_values->BA_diag[indexer].size + jindex] = bus[indexer].BusHistTerm[jindex].Re();
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] = bus[indexer].BusHistTerm[jindex].Im();
 							}
 							else
 							{
@@ -3702,10 +4219,10 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 							}
 
 							//Accumulate in any saturation current values as well, while we're here
-							if (NR_busdata[indexer].BusSatTerm != NULL)
+							if (bus[indexer].BusSatTerm != NULL)
 							{
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+ powerflow_values->BA_diag[indexer].size + jindex] -= NR_busdata[indexer].BusSatTerm[jindex].Re();
-								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] -= NR_busdata[indexer].BusSatTerm[jindex].Im();
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc+ powerflow_values->BA_diag[indexer].size + jindex] -= bus[indexer].BusSatTerm[jindex].Re();
+								powerflow_values->deltaI_NR[2*bus[indexer].Matrix_Loc + jindex] -= bus[indexer].BusSatTerm[jindex].Im();
 							}
 						}
 					}//End normal bus handling
@@ -5053,7 +5570,7 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
 
 			//Initiliaze it
-			sparse_init(powerflow_values->Y_Amatrix, size_Amatrix, 6*NR_bus_count);
+			sparse_init(powerflow_values->Y_Amatrix, size_Amatrix, 6*bus_count);
 		}
 		else if (powerflow_values->NR_realloc_needed)	//If one of the above changed, we changed too
 		{
@@ -5061,12 +5578,12 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			sparse_clear(powerflow_values->Y_Amatrix);
 
 			//Create a new 
-			sparse_init(powerflow_values->Y_Amatrix, size_Amatrix, 6*NR_bus_count);
+			sparse_init(powerflow_values->Y_Amatrix, size_Amatrix, 6*bus_count);
 		}
 		else
 		{
 			//Just clear it out
-			sparse_reset(powerflow_values->Y_Amatrix, 6*NR_bus_count);
+			sparse_reset(powerflow_values->Y_Amatrix, 6*bus_count);
 		}
 
 		//integrate off diagonal components
@@ -5096,6 +5613,9 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			sparse_add(powerflow_values->Y_Amatrix, row, col, value);
 		}
 
+		//Sort into columns - only rebuilds the pattern if the entries moved
+		sparse_build(powerflow_values->Y_Amatrix);
+
 		//See if we want to dump out the matrix values
 		if (NRMatDumpMethod != MD_NONE)
 		{
@@ -5138,32 +5658,14 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 				//Header
 				fprintf(FPoutVal,"Matrix Information - row, column, value\n");
 
-				//Null temp variable
-				temp_element = NULL;
-
-				//Loop through the columns, extracting starting point each time
+				//Loop through the columns of the pattern
 				for (jindexer=0; jindexer<powerflow_values->Y_Amatrix->ncols; jindexer++)
 				{
-					//Extract the column starting point
-					temp_element = powerflow_values->Y_Amatrix->cols[jindexer];
-
-					//Check for nulling
-					if (temp_element != NULL)
+					for (kindexer=powerflow_values->Y_Amatrix->colptr[jindexer]; kindexer<(unsigned int)powerflow_values->Y_Amatrix->colptr[jindexer+1]; kindexer++)
 					{
-						//Print this value
-						fprintf(FPoutVal,"%d,%d,%f\n",temp_element->row_ind,jindexer,temp_element->value);
-
-						//Loop
-						while (temp_element->next != NULL)
-						{
-							//Get next element
-							temp_element = temp_element->next;
-
-							//Repeat the print
-							fprintf(FPoutVal,"%d,%d,%f\n",temp_element->row_ind,jindexer,temp_element->value);
-						}
+						fprintf(FPoutVal,"%d,%d,%f\n",powerflow_values->Y_Amatrix->rowind[kindexer],jindexer,powerflow_values->Y_Amatrix->value[kindexer]);
 					}
-					//If it is null, go next.  Implies we have an invalid matrix size, but that may be what we're looking for
+					//If it is empty, go next.  Implies we have an invalid matrix size, but that may be what we're looking for
 				}//End sparse matrix traversion for dump
 
 				//Print an extra line, so it looks nice for ALL/PERCALL
@@ -5249,7 +5751,17 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			else if (matrix_solver_method == MM_EXTERN)	//External routine
 			{
 				//Run allocation routine
-				((void (*)(void *,unsigned int, unsigned int, bool))(LUSolverFcns.ext_alloc))(ext_solver_glob_vars,n,n,NR_admit_change);
+				((void (*)(void *,unsigned int, unsigned int, bool))(LUSolverFcns.ext_alloc))(ext_solver_glob_vars,n,n,admittance_change);
+			}
+			else if (matrix_solver_method == MM_SUPERLU_COMPLEX)
+			{
+				//Complex matrices are sized with their pattern (NR_complex_fold) - rhs_LU holds the unfolded solution
+				if (LU->complex_LU == NULL)
+				{
+					LU->complex_LU = NR_complex_LU_create();
+					if (LU->complex_LU == NULL)
+						GL_THROW("NR: One of the SuperLU solver matrices failed to allocate");
+				}
 			}
 			else
 			{
@@ -5270,10 +5782,20 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 
 			if (matrix_solver_method==MM_SUPERLU)
 			{
+#ifdef MT
+				//Stored factors are for the old size
+				NR_superLU_release(LU);
+#endif
 				//Free up superLU matrices
 				gl_free(perm_r);
 				gl_free(perm_c);
 			}
+			else if (matrix_solver_method == MM_SUPERLU_COMPLEX)
+			{
+				//Stored factors are for the old size
+				if (LU->complex_LU != NULL)
+					NR_complex_LU_release(LU->complex_LU);
+			}
 			//Default else - don't care - destructions are presumed to be handled inside external LU's alloc function
 
 			/* Set aside space for the arrays. - Copied from above */
@@ -5322,7 +5844,17 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			else if (matrix_solver_method == MM_EXTERN)	//External routine
 			{
 				//Run allocation routine
-				((void (*)(void *,unsigned int, unsigned int, bool))(LUSolverFcns.ext_alloc))(ext_solver_glob_vars,n,n,NR_admit_change);
+				((void (*)(void *,unsigned int, unsigned int, bool))(LUSolverFcns.ext_alloc))(ext_solver_glob_vars,n,n,admittance_change);
+			}
+			else if (matrix_solver_method == MM_SUPERLU_COMPLEX)
+			{
+				//Complex matrices are sized with their pattern (NR_complex_fold) - rhs_LU holds the unfolded solution
+				if (LU->complex_LU == NULL)
+				{
+					LU->complex_LU = NR_complex_LU_create();
+					if (LU->complex_LU == NULL)
+						GL_THROW("NR: One of the SuperLU solver matrices failed to allocate");
+				}
 			}
 			else
 			{
@@ -5346,7 +5878,11 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			else if (matrix_solver_method == MM_EXTERN)	//External routine - call full reallocation, just in case
 			{
 				//Run allocation routine
-				((void (*)(void *,unsigned int, unsigned int, bool))(LUSolverFcns.ext_alloc))(ext_solver_glob_vars,n,n,NR_admit_change);
+				((void (*)(void *,unsigned int, unsigned int, bool))(LUSolverFcns.ext_alloc))(ext_solver_glob_vars,n,n,admittance_change);
+			}
+			else if (matrix_solver_method == MM_SUPERLU_COMPLEX)
+			{
+				//Complex matrices follow the pattern - nothing to update
 			}
 			else
 			{
@@ -5367,8 +5903,12 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 		//Default else - not superLU
 #endif
 		
-		sparse_tonr(powerflow_values->Y_Amatrix, &matrices_LU);
-		matrices_LU.cols_LU[n] = nnz ;// number of non-zeros;
+		//The complex formulation reads Y_Amatrix directly
+		if (matrix_solver_method != MM_SUPERLU_COMPLEX)
+		{
+			sparse_tonr(powerflow_values->Y_Amatrix, &matrices_LU);
+			matrices_LU.cols_LU[n] = nnz ;// number of non-zeros;
+		}
 
 		//Determine how to populate the rhs vector
 		if (mesh_imped_vals == NULL)	//Normal powerflow, copy in the values
@@ -5477,25 +6017,18 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 
 					//Do a solution to get this entry (copied from below - includes "destructors"
 #ifdef MT
-					//superLU_MT commands
-
-					//Populate perm_c
-					get_perm_c(1, &A_LU, perm_c);
-
-					//Solve the system 
-					pdgssv(NR_superLU_procs, &A_LU, perm_c, perm_r, &L_LU, &U_LU, &B_LU, &info);
-
-					/* De-allocate storage - superLU matrix types must be destroyed at every iteration, otherwise they balloon fast (65 MB norma becomes 1.5 GB) */
-					//superLU_MT commands
-					Destroy_SuperNode_SCP(&L_LU);
-					Destroy_CompCol_NCP(&U_LU);
+					//superLU_MT commands - factors are released inside unless they are being reused
+					NR_superLU_solve(LU, &A_LU, &B_LU, powerflow_values->Y_Amatrix, &info);
 #else
 					//sequential superLU
 
 					StatInit ( &stat );
 
 					// solve the system
-					dgssv(&options, &A_LU, perm_c, perm_r, &L_LU, &U_LU, &B_LU, &stat, &info);
+					{
+						NR_superLU_wlock lock;
+						dgssv(&options, &A_LU, perm_c, perm_r, &L_LU, &U_LU, &B_LU, &stat, &info);
+					}
 
 					/* De-allocate storage - superLU matrix types must be destroyed at every iteration, otherwise they balloon fast (65 MB norma becomes 1.5 GB) */
 					//sequential superLU commands
@@ -5624,20 +6157,18 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			else	//Nulled, "normal" powerflow
 			{
 #ifdef MT
-				//superLU_MT commands
-
-				//Populate perm_c
-				get_perm_c(1, &A_LU, perm_c);
-
-				//Solve the system
-				pdgssv(NR_superLU_procs, &A_LU, perm_c, perm_r, &L_LU, &U_LU, &B_LU, &info);
+				//superLU_MT commands - column ordering and elimination tree are reused if NR_symbolic_reuse is set
+				NR_superLU_solve(LU, &A_LU, &B_LU, powerflow_values->Y_Amatrix, &info);
 #else
 				//sequential superLU
 
 				StatInit ( &stat );
 
 				// solve the system
-				dgssv(&options, &A_LU, perm_c, perm_r, &L_LU, &U_LU, &B_LU, &stat, &info);
+				{
+					NR_superLU_wlock lock;
+					dgssv(&options, &A_LU, perm_c, perm_r, &L_LU, &U_LU, &B_LU, &stat, &info);
+				}
 #endif
 
 				sol_LU = (double*) ((DNformat*) B_LU.Store)->nzval;
@@ -5670,11 +6201,45 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			//Default else -- not mesh fault mode, so go like normal
 
 			//Call the solver
-			info = ((int (*)(void *,NR_SOLVER_VARS *, unsigned int, unsigned int))(LUSolverFcns.ext_solve))(ext_solver_glob_vars,&matrices_LU,n,1);
+			{
+				NR_superLU_wlock lock;
+				info = ((int (*)(void *,NR_SOLVER_VARS *, unsigned int, unsigned int))(LUSolverFcns.ext_solve))(ext_solver_glob_vars,&matrices_LU,n,1);
+			}
 
 			//Point the solution to the proper place
 			sol_LU = matrices_LU.rhs_LU;
 		}
+		else if (matrix_solver_method==MM_SUPERLU_COMPLEX)
+		{
+			//Mesh fault impedances are pulled from the real formulation
+			if (mesh_imped_vals != NULL)
+			{
+				gl_error("solver_nr: Mesh impedance attempted from unsupported LU solver");
+				//Defined above
+
+				//Set return code
+				mesh_imped_vals->return_code = 2;
+
+				//Flag bad computations, just because
+				*bad_computations = true;
+
+				//Exit
+				return 0;
+			}
+
+			//Fold into the complex system - the load terms that are not complex-linear are averaged in, so this is a quasi-Newton step
+			NR_complex_fold(LU, bus_count, bus, powerflow_values);
+
+			//Call the solver
+			{
+				NR_superLU_wlock lock;
+				info = NR_complex_LU_solve(LU->complex_LU, LU->complex_size, LU->complex_nnz, LU->complex_colptr, LU->complex_rowind, LU->complex_value, LU->complex_rhs, LU->complex_pattern_id);
+			}
+
+			//Back into the real layout for the voltage updates
+			NR_complex_unfold(LU, matrices_LU.rhs_LU);
+			sol_LU = matrices_LU.rhs_LU;
+		}
 		else
 		{
 			GL_THROW("Invalid matrix solution method specified for NR solver!");
@@ -5902,9 +6467,7 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 		{
 			/* De-allocate storage - superLU matrix types must be destroyed at every iteration, otherwise they balloon fast (65 MB norma becomes 1.5 GB) */
 #ifdef MT
-			//superLU_MT commands
-			Destroy_SuperNode_SCP(&L_LU);
-			Destroy_CompCol_NCP(&U_LU);
+			//superLU_MT commands - handled by NR_superLU_solve, which only keeps the factors for reuse
 #else
 			//sequential superLU commands
 			Destroy_SuperNode_Matrix( &L_LU );
@@ -5917,6 +6480,10 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 			//Call destruction routine
 			((void (*)(void *, bool))(LUSolverFcns.ext_destroy))(ext_solver_glob_vars,newiter);
 		}
+		else if (matrix_solver_method==MM_SUPERLU_COMPLEX)
+		{
+			//Complex factors are only kept for reuse - handled by NR_complex_LU_solve
+		}
 		else	//Not sure how we get here
 		{
 			GL_THROW("Invalid matrix solution method specified for NR solver!");
@@ -5951,6 +6518,10 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 		{
 			gl_verbose("External LU solver failed out with return value %d",info);
 		}
+		else if (matrix_solver_method==MM_SUPERLU_COMPLEX)
+		{
+			gl_verbose("Complex superLU failed out with return value %d",info);
+		}
 		//Defaulted else - shouldn't exist (or make it this far), but if it does, we're failing anyways
 
 		*bad_computations = true;	//Flag our output as bad
@@ -5959,3 +6530,596 @@ int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count,
 	else	//Must have converged 
 		return Iteration;
 }
+
+//Release the working variables of a system
+static void NR_solver_free(NR_SOLVER_STRUCT *powerflow_values)
+{
+	NR_SOLVER_LU *LU = powerflow_values->LU_state;
+
+	gl_free(powerflow_values->deltaI_NR);
+	gl_free(powerflow_values->BA_diag);
+	gl_free(powerflow_values->Y_offdiag_PQ);
+	gl_free(powerflow_values->Y_diag_fixed);
+	gl_free(powerflow_values->Y_diag_update);
+	gl_free(powerflow_values->branch_offdiag_start);
+	gl_free(powerflow_values->bus_diag_fixed_start);
+	if (powerflow_values->Y_Amatrix != NULL)
+	{
+		sparse_clear(powerflow_values->Y_Amatrix);
+		gl_free(powerflow_values->Y_Amatrix);
+	}
+
+	if (LU != NULL)
+	{
+#ifdef MT
+		NR_superLU_release(LU);
+#endif
+		gl_free(LU->matrices_LU.a_LU);
+		gl_free(LU->matrices_LU.rows_LU);
+		gl_free(LU->matrices_LU.cols_LU);
+		gl_free(LU->matrices_LU.rhs_LU);
+		gl_free(LU->perm_r);
+		gl_free(LU->perm_c);
+		gl_free(LU->A_LU.Store);
+		gl_free(LU->B_LU.Store);
+		NR_complex_pattern_free(LU);
+		NR_complex_LU_free(LU->complex_LU);
+		gl_free(LU);
+	}
+
+	memset(powerflow_values,0,sizeof(NR_SOLVER_STRUCT));
+}
+
+//Electrically isolated island - a set of buses connected through branches, solved as its own system
+typedef struct {
+	unsigned int bus_count;				///< Number of buses in the island
+	unsigned int branch_count;			///< Number of branches in the island
+	unsigned int *bus_index;			///< System index of each island bus
+	unsigned int *branch_index;			///< System index of each island branch
+	BUSDATA *bus;						///< Island copy of the bus data - link tables hold island branch indices
+	BRANCHDATA *branch;					///< Island copy of the branch data - from/to are island bus indices
+	int *link_tables;					///< Storage for the island link tables
+	int *branch_updates;				///< Island indices of the branches to update in place in this solution
+	unsigned int branch_update_count;
+	NR_SOLVER_STRUCT powerflow_values;	///< Solver working variables of the island
+	unsigned int admittance_generation;	///< Admittance update the island matrices were built for
+	int64 result;						///< Result of the last solution of the island
+	bool bad_computations;				///< Bad computation flag of the last solution of the island
+	bool skip;							///< Flag to skip the island in this solution (converged in the last one)
+	bool exception;						///< Flag that the last solution of the island threw an exception
+	char message[1024];					///< Message of the exception thrown by the last solution of the island
+} NR_ISLAND;
+
+//Islands of the system - rebuilt whenever solver_nr is called with a different system or admittance
+static struct {
+	BUSDATA *bus;						///< System bus data the islands were built from
+	BRANCHDATA *branch;					///< System branch data the islands were built from
+	unsigned int bus_count;
+	unsigned int branch_count;
+	unsigned int count;					///< Number of islands (1 if the system cannot be split)
+	NR_ISLAND *island;					///< Island list
+	NRSOLVERMODE powerflow_type;		///< Mode of the solution in progress
+	TIMESTAMP failed_at;				///< Time at which one of the islands last failed to converge
+	unsigned int admittance_generation;	///< Admittance rebuild the islands were built for
+	int *branch_island;					///< Island of each system branch (-1 for open branches between islands)
+	int *branch_local;					///< Island index of each system branch
+} NR_islands;
+
+//Admittance update counters - bumped every time solver_nr sees NR_admit_change (a rebuild), or branch updates
+//alone (in place), so the whole system and each island catch up once for every update, whichever of them is
+//solved next.  The branch updates are only kept for the solver_nr call that bumped the counter, so only a
+//system that is exactly one update behind during that call applies them in place, others rebuild.
+static unsigned int NR_admittance_generation = 1;
+static unsigned int NR_admittance_rebuild_generation = 1;
+static unsigned int NR_system_admittance_generation = 0;
+static bool NR_branch_updates_pending = false;	///< NR_branch_updates hold the changes of the current generation
+
+//Branches whose admittance values changed since the last solution (see NR_branch_admittance_update)
+static int *NR_branch_updates = NULL;
+static unsigned char *NR_branch_update_flags = NULL;
+static unsigned int NR_branch_update_count = 0;
+static unsigned int NR_branch_update_size = 0;
+
+//Bring the admittance generation of a system up to date - returns true if the system has to rebuild its
+//admittance, and sets in_place if it can apply the pending branch updates in place instead
+static bool NR_admittance_catch_up(unsigned int *generation, bool *in_place)
+{
+	bool rebuild = false;
+
+	*in_place = false;
+	if (*generation != NR_admittance_generation)
+	{
+		if (NR_branch_updates_pending && ((*generation + 1) == NR_admittance_generation) && (NR_admittance_rebuild_generation != NR_admittance_generation))
+			*in_place = true;
+		else
+			rebuild = true;
+		*generation = NR_admittance_generation;
+	}
+	return rebuild;
+}
+
+static void NR_free_islands(void)
+{
+	unsigned int index;
+
+	for (index=0; (NR_islands.island != NULL) && (index<NR_islands.count); index++)
+	{
+		NR_ISLAND *island = &NR_islands.island[index];
+		gl_free(island->bus_index);
+		gl_free(island->branch_index);
+		gl_free(island->bus);
+		gl_free(island->branch);
+		gl_free(island->link_tables);
+		gl_free(island->branch_updates);
+		NR_solver_free(&island->powerflow_values);
+	}
+	gl_free(NR_islands.island);
+	gl_free(NR_islands.branch_island);
+	gl_free(NR_islands.branch_local);
+	memset(&NR_islands,0,sizeof(NR_islands));
+}
+
+//Find the representative bus of a set - path halving
+static int NR_island_root(int *root, int index)
+{
+	while (root[index] != index)
+	{
+		root[index] = root[root[index]];
+		index = root[index];
+	}
+	return index;
+}
+
+//Split the system into islands - buses connected through a branch with any phase in service share an island
+//De-energized islands go along with the first energized one, and every energized island needs its own SWING bus
+static void NR_build_islands(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count, BRANCHDATA *branch)
+{
+	int *root, *bus_map, *branch_map, *island_of, *link_table;
+	unsigned int indexer, kindexer, count;
+	int energized_root;
+	NR_ISLAND *island;
+
+	NR_free_islands();
+	NR_islands.bus = bus;
+	NR_islands.branch = branch;
+	NR_islands.bus_count = bus_count;
+	NR_islands.branch_count = branch_count;
+	NR_islands.count = 1;
+	NR_islands.failed_at = TS_NEVER;
+	NR_islands.admittance_generation = NR_admittance_rebuild_generation;
+
+	//Make sure every branch is fully connected - if not, leave the system whole
+	if (bus_count < 2)
+		return;
+	for (indexer=0; indexer<branch_count; indexer++)
+	{
+		if ((branch[indexer].from < 0) || (branch[indexer].from >= (int)bus_count) || (branch[indexer].to < 0) || (branch[indexer].to >= (int)bus_count))
+			return;
+	}
+
+	root = (int *)gl_malloc(bus_count*sizeof(int));
+	bus_map = (int *)gl_malloc(bus_count*sizeof(int));
+	branch_map = (int *)gl_malloc((branch_count+1)*sizeof(int));
+	island_of = (int *)gl_malloc(bus_count*sizeof(int));
+	if ((root == NULL) || (bus_map == NULL) || (branch_map == NULL) || (island_of == NULL))
+		GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+		//Defined above
+
+	//Join the buses at both ends of each branch - the root of a set is its lowest bus index
+	for (indexer=0; indexer<bus_count; indexer++)
+		root[indexer] = indexer;
+	for (indexer=0; indexer<branch_count; indexer++)
+	{
+		int from_root, to_root;
+		if ((branch[indexer].phases & 0x87) == 0x00)	//Open on all phases - doesn't connect anything
+			continue;
+		from_root = NR_island_root(root,branch[indexer].from);
+		to_root = NR_island_root(root,branch[indexer].to);
+		if (from_root < to_root)
+			root[to_root] = from_root;
+		else if (to_root < from_root)
+			root[from_root] = to_root;
+	}
+
+	//Flag the islands with energized buses (bit 0) and SWING buses (bit 1) - island_of temporarily holds the flags
+	memset(island_of,0,bus_count*sizeof(int));
+	for (indexer=0; indexer<bus_count; indexer++)
+	{
+		kindexer = NR_island_root(root,indexer);
+		if ((bus[indexer].phases & 0x87) != 0x00)
+			island_of[kindexer] |= 0x01;
+		if (bus[indexer].type > 1)
+			island_of[kindexer] |= 0x02;
+	}
+	energized_root = -1;
+	for (indexer=0; indexer<bus_count; indexer++)
+	{
+		if (root[indexer] != (int)indexer)
+			continue;
+		if ((island_of[indexer] & 0x01) == 0x00)
+			continue;
+		if ((island_of[indexer] & 0x02) == 0x00)	//Energized with no SWING of its own - leave the system whole
+		{
+			energized_root = -1;
+			break;
+		}
+		if (energized_root < 0)
+			energized_root = indexer;
+	}
+	if (energized_root < 0)
+	{
+		gl_free(root);
+		gl_free(bus_map);
+		gl_free(branch_map);
+		gl_free(island_of);
+		return;
+	}
+	for (indexer=0; indexer<bus_count; indexer++)
+	{
+		if ((root[indexer] == (int)indexer) && ((island_of[indexer] & 0x01) == 0x00))
+			root[indexer] = energized_root;
+	}
+
+	//Number the islands in the order of their root bus (bus_map temporarily holds the island number)
+	count = 0;
+	for (indexer=0; indexer<bus_count; indexer++)
+	{
+		if (root[indexer] == (int)indexer)
+			bus_map[indexer] = count++;
+	}
+	for (indexer=0; indexer<bus_count; indexer++)
+		bus_map[indexer] = bus_map[NR_island_root(root,indexer)];
+
+	if (count > 1)
+	{
+		NR_islands.island = (NR_ISLAND *)gl_malloc(count*sizeof(NR_ISLAND));
+		if (NR_islands.island == NULL)
+			GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+		memset(NR_islands.island,0,count*sizeof(NR_ISLAND));
+		NR_islands.count = count;
+
+		//Size the islands
+		for (indexer=0; indexer<bus_count; indexer++)
+			NR_islands.island[bus_map[indexer]].bus_count++;
+		for (indexer=0; indexer<branch_count; indexer++)
+		{
+			if (bus_map[branch[indexer].from] == bus_map[branch[indexer].to])
+				NR_islands.island[bus_map[branch[indexer].from]].branch_count++;
+		}
+
+		for (indexer=0; indexer<count; indexer++)
+		{
+			island = &NR_islands.island[indexer];
+			island->bus_index = (unsigned int *)gl_malloc(island->bus_count*sizeof(unsigned int));
+			island->branch_index = (unsigned int *)gl_malloc((island->branch_count+1)*sizeof(unsigned int));
+			island->bus = (BUSDATA *)gl_malloc(island->bus_count*sizeof(BUSDATA));
+			island->branch = (BRANCHDATA *)gl_malloc((island->branch_count+1)*sizeof(BRANCHDATA));
+			island->branch_updates = (int *)gl_malloc((island->branch_count+1)*sizeof(int));
+			if ((island->bus_index == NULL) || (island->branch_index == NULL) || (island->bus == NULL) || (island->branch == NULL) || (island->branch_updates == NULL))
+				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+			island->bus_count = 0;
+			island->branch_count = 0;
+		}
+
+		NR_islands.branch_island = (int *)gl_malloc((branch_count+1)*sizeof(int));
+		NR_islands.branch_local = (int *)gl_malloc((branch_count+1)*sizeof(int));
+		if ((NR_islands.branch_island == NULL) || (NR_islands.branch_local == NULL))
+			GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+
+		//Assign the buses and branches in system order, mapping system indices to island indices
+		//Branches open on all phases between two islands belong to neither of them
+		for (indexer=0; indexer<bus_count; indexer++)
+		{
+			island_of[indexer] = bus_map[indexer];
+			island = &NR_islands.island[island_of[indexer]];
+			island->bus_index[island->bus_count] = indexer;
+			bus_map[indexer] = island->bus_count++;
+		}
+		for (indexer=0; indexer<branch_count; indexer++)
+		{
+			if (island_of[branch[indexer].from] != island_of[branch[indexer].to])
+			{
+				NR_islands.branch_island[indexer] = branch_map[indexer] = -1;
+				continue;
+			}
+			island = &NR_islands.island[island_of[branch[indexer].from]];
+			island->branch_index[island->branch_count] = indexer;
+			NR_islands.branch_island[indexer] = island_of[branch[indexer].from];
+			NR_islands.branch_local[indexer] = branch_map[indexer] = island->branch_count++;
+		}
+
+		//Make the island copies of the bus and branch data
+		for (kindexer=0; kindexer<count; kindexer++)
+		{
+			unsigned int link_count = 0;
+			island = &NR_islands.island[kindexer];
+			for (indexer=0; indexer<island->bus_count; indexer++)
+				link_count += bus[island->bus_index[indexer]].Link_Table_Size;
+			island->link_tables = (int *)gl_malloc((link_count+1)*sizeof(int));
+			if (island->link_tables == NULL)
+				GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+
+			link_table = island->link_tables;
+			for (indexer=0; indexer<island->bus_count; indexer++)
+			{
+				BUSDATA *sys_bus = &bus[island->bus_index[indexer]];
+				unsigned int link;
+				island->bus[indexer] = *sys_bus;
+				island->bus[indexer].Link_Table = link_table;
+				island->bus[indexer].Link_Table_Size = 0;
+				island->bus[indexer].Matrix_Loc = -1;
+				for (link=0; link<sys_bus->Link_Table_Size; link++)
+				{
+					if (branch_map[sys_bus->Link_Table[link]] >= 0)
+						link_table[island->bus[indexer].Link_Table_Size++] = branch_map[sys_bus->Link_Table[link]];
+				}
+				link_table += island->bus[indexer].Link_Table_Size;
+			}
+			for (indexer=0; indexer<island->branch_count; indexer++)
+			{
+				island->branch[indexer] = branch[island->branch_index[indexer]];
+				island->branch[indexer].from = bus_map[island->branch[indexer].from];
+				island->branch[indexer].to = bus_map[island->branch[indexer].to];
+			}
+		}
+	}
+
+	gl_free(root);
+	gl_free(bus_map);
+	gl_free(branch_map);
+	gl_free(island_of);
+}
+
+//Solve one island (called on the core thread pool)
+static void NR_island_solveproc(unsigned int thread, size_t item, void *data)
+{
+	NR_ISLAND *island = &NR_islands.island[item];
+	BUSDATA *sys_bus = NR_islands.bus;
+	BRANCHDATA *sys_branch = NR_islands.branch;
+	unsigned int indexer;
+	bool admittance_change, in_place;
+
+	if (island->skip)
+		return;
+
+	//Refresh the island copies - everything but the island link tables and matrix locations
+	for (indexer=0; indexer<island->bus_count; indexer++)
+	{
+		BUSDATA *bus = &island->bus[indexer];
+		int *link_table = bus->Link_Table;
+		unsigned int link_table_size = bus->Link_Table_Size;
+		unsigned int matrix_loc = bus->Matrix_Loc;
+		*bus = sys_bus[island->bus_index[indexer]];
+		bus->Link_Table = link_table;
+		bus->Link_Table_Size = link_table_size;
+		bus->Matrix_Loc = matrix_loc;
+	}
+	for (indexer=0; indexer<island->branch_count; indexer++)
+	{
+		BRANCHDATA *branch = &island->branch[indexer];
+		int from = branch->from, to = branch->to;
+		*branch = sys_branch[island->branch_index[indexer]];
+		branch->from = from;
+		branch->to = to;
+	}
+
+	//Exceptions can't leave the pool thread - keep the message for NR_solve_islands to throw again
+	island->bad_computations = false;
+	island->exception = false;
+	try {
+		admittance_change = NR_admittance_catch_up(&island->admittance_generation, &in_place);
+		island->result = NR_solve_system(island->bus_count, island->bus, island->branch_count, island->branch, &island->powerflow_values, NR_islands.powerflow_type, NULL, &island->bad_computations, admittance_change, island->branch_updates, in_place ? island->branch_update_count : 0);
+	}
+	catch (const char *msg)
+	{
+		strncpy(island->message,msg,sizeof(island->message)-1);
+		island->exception = true;
+	}
+	catch (...)
+	{
+		strcpy(island->message,"unknown exception");
+		island->exception = true;
+	}
+	if (island->exception)
+	{
+		island->message[sizeof(island->message)-1] = '\0';
+		island->result = -1;	//Solve it again on a retry, the system data is left as it was
+		return;
+	}
+
+	//Return the solver's updates to the system data
+	for (indexer=0; indexer<island->bus_count; indexer++)
+	{
+		BUSDATA *bus = &sys_bus[island->bus_index[indexer]];
+		int *link_table = bus->Link_Table;
+		unsigned int link_table_size = bus->Link_Table_Size;
+		unsigned int matrix_loc = bus->Matrix_Loc;
+		*bus = island->bus[indexer];
+		bus->Link_Table = link_table;
+		bus->Link_Table_Size = link_table_size;
+		bus->Matrix_Loc = matrix_loc;
+	}
+	for (indexer=0; indexer<island->branch_count; indexer++)
+	{
+		BRANCHDATA *branch = &sys_branch[island->branch_index[indexer]];
+		int from = branch->from, to = branch->to;
+		*branch = island->branch[indexer];
+		branch->from = from;
+		branch->to = to;
+	}
+}
+
+//Solve all the islands, in parallel when the core has a thread pool
+static int64 NR_solve_islands(NRSOLVERMODE powerflow_type, bool *bad_computations)
+{
+	unsigned int index;
+	int64 result = 0;
+	bool failed = false;
+
+	//When some islands failed to converge at this time, the ones that converged are not solved again
+	//(unless their admittance changed in the meantime)
+	bool retry = (powerflow_type == PF_NORMAL) && (NR_islands.failed_at == gl_globalclock);
+
+	for (index=0; index<NR_islands.count; index++)
+	{
+		NR_ISLAND *island = &NR_islands.island[index];
+		island->skip = retry && (island->result >= 0) && !island->bad_computations && (island->admittance_generation == NR_admittance_generation);
+		island->branch_update_count = 0;
+	}
+
+	//Hand the branch updates to their islands (open branches between islands don't matter to either)
+	for (index=0; index<NR_branch_update_count; index++)
+	{
+		int island_index = NR_islands.branch_island[NR_branch_updates[index]];
+		if (island_index >= 0)
+		{
+			NR_ISLAND *island = &NR_islands.island[island_index];
+			island->branch_updates[island->branch_update_count++] = NR_islands.branch_local[NR_branch_updates[index]];
+		}
+	}
+
+	NR_islands.powerflow_type = powerflow_type;
+	gl_parallel_run(NR_island_solveproc,NULL,NR_islands.count,1);
+
+	//Throw the first island exception on the calling thread, once all the islands are done
+	for (index=0; index<NR_islands.count; index++)
+	{
+		if (NR_islands.island[index].exception)
+		{
+			NR_islands.failed_at = gl_globalclock;
+			GL_THROW("%s",NR_islands.island[index].message);
+		}
+	}
+
+	//Combine the island results - the overall iteration count is the worst island's
+	for (index=0; index<NR_islands.count; index++)
+	{
+		NR_ISLAND *island = &NR_islands.island[index];
+		if (island->bad_computations)
+			*bad_computations = true;
+		else if (island->result < 0)
+		{
+			if (!failed || (island->result < result))
+				result = island->result;
+			failed = true;
+		}
+		else if (!failed && (island->result > result))
+			result = island->result;
+	}
+	NR_islands.failed_at = failed ? gl_globalclock : TS_NEVER;
+
+	if (*bad_computations)
+		return 0;
+	else
+		return result;
+}
+
+/** Flag a change of the admittance values of a branch that leaves the admittance structure alone (e.g., a
+	regulator tap change).  Rather than the full rebuild NR_admit_change causes, only the self admittance of the
+	end buses and the fixed admittance entries of the branch and of those buses are updated in the next solution.
+	Callers hold the swing bus lock, as they do to set NR_admit_change.
+ **/
+void NR_branch_admittance_update(int branch_index)
+{
+	unsigned int index;
+
+	if (!NR_admittance_inplace || (branch_index < 0) || ((unsigned int)branch_index >= NR_branch_count))
+	{
+		NR_admit_change = true;
+		return;
+	}
+
+	//Make room for every branch (each is only listed once)
+	if (NR_branch_update_size < NR_branch_count)
+	{
+		int *updates = (int *)gl_malloc(NR_branch_count*sizeof(int));
+		unsigned char *flags = (unsigned char *)gl_malloc(NR_branch_count*sizeof(unsigned char));
+		if ((updates == NULL) || (flags == NULL))
+			GL_THROW("NR: Failed to allocate memory for one of the necessary matrices");
+			//Defined above
+
+		memset(flags,0,NR_branch_count*sizeof(unsigned char));
+		for (index=0; index<NR_branch_update_count; index++)
+		{
+			updates[index] = NR_branch_updates[index];
+			flags[updates[index]] = 1;
+		}
+		gl_free(NR_branch_updates);
+		gl_free(NR_branch_update_flags);
+		NR_branch_updates = updates;
+		NR_branch_update_flags = flags;
+		NR_branch_update_size = NR_branch_count;
+	}
+
+	if (NR_branch_update_flags[branch_index] == 0)
+	{
+		NR_branch_update_flags[branch_index] = 1;
+		NR_branch_updates[NR_branch_update_count++] = branch_index;
+	}
+	NR_admit_update = true;
+}
+
+/** Newton-Raphson solver
+	Solves a power flow problem using the Newton-Raphson method.  When NR_island_solve
+	is set, electrically isolated islands of the system are solved as separate systems,
+	concurrently on the core thread pool, and each island converges on its own.
+	
+	@return n=0 on failure to complete a single iteration, 
+	n>0 to indicate success after n interations, or 
+	n<0 to indicate failure after n iterations
+ **/
+int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count, BRANCHDATA *branch, NR_SOLVER_STRUCT *powerflow_values, NRSOLVERMODE powerflow_type , NR_MESHFAULT_IMPEDANCE *mesh_imped_vals, bool *bad_computations)
+{
+	unsigned int index;
+	bool admittance_change, in_place;
+	bool islands = false;
+	int64 result;
+
+	//Ensure bad computations flag is set first
+	*bad_computations = false;
+
+	//A rebuild takes care of any branch updates too
+	NR_branch_updates_pending = false;
+	if (NR_admit_change)
+	{
+		NR_admittance_generation++;
+		NR_admittance_rebuild_generation = NR_admittance_generation;
+	}
+	else if (NR_branch_update_count > 0)
+	{
+		NR_admittance_generation++;
+		NR_branch_updates_pending = true;
+	}
+
+	//Mesh fault impedances and matrix dumps are defined on the whole system
+	if (NR_island_solve && (mesh_imped_vals == NULL) && (NRMatDumpMethod == MD_NONE))
+	{
+		//Switching changes the islands as well as the admittance
+		if ((NR_islands.bus != bus) || (NR_islands.bus_count != bus_count) || (NR_islands.branch != branch) || (NR_islands.branch_count != branch_count) || (NR_islands.admittance_generation != NR_admittance_rebuild_generation))
+		{
+			NR_build_islands(bus_count, bus, branch_count, branch);
+			if (NR_island_count != (int32)NR_islands.count)
+				gl_verbose("NR: system has %d island(s)", NR_islands.count);
+			NR_island_count = NR_islands.count;
+		}
+
+		islands = (NR_islands.count > 1);
+	}
+
+	if (islands)
+		result = NR_solve_islands(powerflow_type, bad_computations);
+	else
+	{
+		admittance_change = NR_admittance_catch_up(&NR_system_admittance_generation, &in_place);
+		result = NR_solve_system(bus_count, bus, branch_count, branch, powerflow_values, powerflow_type, mesh_imped_vals, bad_computations, admittance_change, NR_branch_updates, in_place ? NR_branch_update_count : 0);
+	}
+
+	//The branch updates have been applied (systems that missed them rebuild when they catch up)
+	for (index=0; index<NR_branch_update_count; index++)
+		NR_branch_update_flags[NR_branch_updates[index]] = 0;
+	NR_branch_update_count = 0;
+	NR_branch_updates_pending = false;
+	NR_admit_update = false;
+
+	return result;
+}
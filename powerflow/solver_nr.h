@@ -96,21 +96,30 @@ typedef enum {
 	PF_DYNCALC=2	///< Modified powerflow, for dynamics mode after initial powerflow
 	} NRSOLVERMODE;
 
-// Sparse element
-typedef struct SP_E {
-	struct SP_E* next;
-	int row_ind;  ///< row location of the element
-    double value; ///< value of the element
-} SP_E;
-
-// Sparse matrix
+// Sparse matrix - compressed sparse column (CSC) assembly
+// Entries are added in a fixed order every iteration.  The column-sorted pattern
+// (colptr/rowind) and the slot each entry lands in are only rebuilt when the
+// sequence of (row,col) keys changes, so a normal iteration is just a scatter.
 typedef struct {
-	SP_E** cols;
-	SP_E* llheap;
-	unsigned int llptr;
-	unsigned int ncols;
+	int *row_in;		///< row location of each added element, in the order it was added
+	int *col_in;		///< column location of each added element, in the order it was added
+	double *val_in;		///< value of each added element, in the order it was added
+	int *slot;			///< position of each added element in the column-sorted pattern
+	int *colptr;		///< start of each column in rowind/value (ncols+1 entries)
+	int *rowind;		///< row location of each pattern element (sorted within each column)
+	double *value;		///< value of each pattern element
+	int *work;			///< scratch space for the pattern sort (nels entries)
+	unsigned int nels;	///< number of elements allocated
+	unsigned int ncols;	///< number of columns (and rows) of the matrix
+	unsigned int nnz;	///< number of elements added since the last reset
+	unsigned int pattern_nnz;	///< number of elements in the current pattern
+	unsigned int pattern_id;	///< unique id of the current pattern - changes every time it is rebuilt
+	bool pattern_valid;	///< flag indicating the current pattern matches the added keys
 } SPARSE;
 
+typedef struct s_nr_solver_lu NR_SOLVER_LU;	///< LU solver working state (defined in solver_nr.cpp)
+typedef struct s_nr_complex_lu NR_COMPLEX_LU;	///< Complex LU solver working state (defined in solver_nr_complex.cpp)
+
 typedef struct {
 	double *deltaI_NR;					/// Storage array for current injection
 	unsigned int size_offdiag_PQ;		/// Number of fixed off-diagonal matrix elements
@@ -127,6 +136,9 @@ typedef struct {
 	Y_NR *Y_diag_fixed;					///Y_diag_fixed store the row,column and value of fixed diagonal elements of 6n*6n Y_NR matrix. No PV bus is included.
 	Y_NR *Y_diag_update;				///Y_diag_update store the row,column and value of updated diagonal elements of 6n*6n Y_NR matrix at each iteration. No PV bus is included.
 	SPARSE *Y_Amatrix;					///Y_Amatrix store all the elements of Amatrix in equation AX=B;
+	unsigned int *branch_offdiag_start;	///Start of each branch's elements in Y_offdiag_PQ (branch count + 1 entries) - used for in-place admittance updates
+	unsigned int *bus_diag_fixed_start;	///Start of each bus's elements in Y_diag_fixed (bus count + 1 entries) - used for in-place admittance updates
+	NR_SOLVER_LU *LU_state;				///LU solver matrices, permutations and factors of this system
 } NR_SOLVER_STRUCT;
 
 //Mesh-fault-related structure - passing information
@@ -142,6 +154,13 @@ typedef struct {
 //int ext_solver_solve(void *ext_array, NR_SOLVER_VARS *system_info_vars, unsigned int rowcount, unsigned int colcount);
 //void ext_solver_destroy(void *ext_array, bool new_iteration);
 
+//Complex superLU_MT interface (solver_nr_complex.cpp)
+NR_COMPLEX_LU *NR_complex_LU_create(void);
+void NR_complex_LU_release(NR_COMPLEX_LU *LU);
+void NR_complex_LU_free(NR_COMPLEX_LU *LU);
+int NR_complex_LU_solve(NR_COMPLEX_LU *LU, int n, int nnz, int *colptr, int *rowind, double *values, double *rhs, unsigned int pattern_id);
+
+void NR_branch_admittance_update(int branch_index);
 int64 solver_nr(unsigned int bus_count, BUSDATA *bus, unsigned int branch_count, BRANCHDATA *branch, NR_SOLVER_STRUCT *powerflow_values, NRSOLVERMODE powerflow_type , NR_MESHFAULT_IMPEDANCE *mesh_imped_vals, bool *bad_computations);
 
 #endif
@@ -0,0 +1,175 @@
+/* $Id
+ * Newton-Raphson solver - complex superLU_MT factorization
+ *
+ * The complex (z) routines of superLU_MT share type names with the real (d)
+ * routines used by solver_nr.cpp, so they are wrapped in their own file.
+ */
+
+#include "solver_nr.h"
+
+#include <pzsp_defs.h>	//superLU_MT - complex
+
+/* access to module global variables */
+#include "powerflow.h"
+
+//Complex LU solver working state - one per system solved
+struct s_nr_complex_lu {
+	int *perm_c, *perm_r;			///< SuperLU permutations
+	SuperMatrix A, B;				///< SuperLU matrices (stores point at the caller's arrays)
+	//Factorization state - kept between calls while the pattern is unchanged (same scheme as the real solver)
+	superlumt_options_t options;
+	SuperMatrix L, U;
+	bool symbolic_valid;
+	unsigned int pattern_id;
+	int size;						///< order of the last factorization
+	int perm_size;					///< allocated length of perm_c/perm_r
+};
+
+//Allocate the complex LU working state of a system
+NR_COMPLEX_LU *NR_complex_LU_create(void)
+{
+	NR_COMPLEX_LU *LU = (NR_COMPLEX_LU *)gl_malloc(sizeof(NR_COMPLEX_LU));
+
+	//Make sure it worked
+	if (LU == NULL)
+		return NULL;
+
+	memset(LU,0,sizeof(NR_COMPLEX_LU));
+
+	LU->A.Store = gl_malloc(sizeof(NCformat));
+	LU->B.Store = gl_malloc(sizeof(DNformat));
+	if ((LU->A.Store == NULL) || (LU->B.Store == NULL))
+	{
+		NR_complex_LU_free(LU);
+		return NULL;
+	}
+
+	LU->A.Stype = SLU_NC;
+	LU->A.Dtype = SLU_Z;
+	LU->A.Mtype = SLU_GE;
+
+	LU->B.Stype = SLU_DN;
+	LU->B.Dtype = SLU_Z;
+	LU->B.Mtype = SLU_GE;
+	LU->B.ncol = 1;
+
+	return LU;
+}
+
+//Release the stored elimination tree and factors
+void NR_complex_LU_release(NR_COMPLEX_LU *LU)
+{
+	if (LU->symbolic_valid)
+	{
+		SUPERLU_FREE(LU->options.etree);
+		SUPERLU_FREE(LU->options.colcnt_h);
+		SUPERLU_FREE(LU->options.part_super_h);
+
+		Destroy_SuperNode_SCP(&LU->L);
+		Destroy_CompCol_NCP(&LU->U);
+
+		LU->symbolic_valid = false;
+	}
+}
+
+//Free the complex LU working state
+void NR_complex_LU_free(NR_COMPLEX_LU *LU)
+{
+	if (LU == NULL)
+		return;
+
+	NR_complex_LU_release(LU);
+	gl_free(LU->perm_c);
+	gl_free(LU->perm_r);
+	gl_free(LU->A.Store);
+	gl_free(LU->B.Store);
+	gl_free(LU);
+}
+
+//Factor the n*n complex matrix (colptr/rowind/values - values are interleaved real/imaginary) and solve it
+//rhs (interleaved real/imaginary) is overwritten with the solution - returns the superLU info code
+//The caller serializes the calls - the superLU ordering and memory routines keep static state
+int NR_complex_LU_solve(NR_COMPLEX_LU *LU, int n, int nnz, int *colptr, int *rowind, double *values, double *rhs, unsigned int pattern_id)
+{
+	SuperMatrix AC;
+	Gstat_t Gstat;
+	NCformat *Astore;
+	DNformat *Bstore;
+	int procs = NR_superLU_procs;
+	int panel_size = sp_ienv(1);
+	int relax = sp_ienv(2);
+	int info = 0;
+	yes_no_t refact;
+
+	//Size the permutations
+	if (LU->perm_size < n)
+	{
+		NR_complex_LU_release(LU);
+		gl_free(LU->perm_c);
+		gl_free(LU->perm_r);
+
+		LU->perm_c = (int *)gl_malloc(n*sizeof(int));
+		LU->perm_r = (int *)gl_malloc(n*sizeof(int));
+		if ((LU->perm_c == NULL) || (LU->perm_r == NULL))
+		{
+			LU->perm_size = 0;
+			return -1;
+		}
+		LU->perm_size = n;
+	}
+
+	//Point the superLU matrices at the values
+	LU->A.nrow = n;
+	LU->A.ncol = n;
+	Astore = (NCformat*)LU->A.Store;
+	Astore->nnz = nnz;
+	Astore->nzval = values;
+	Astore->rowind = rowind;
+	Astore->colptr = colptr;
+
+	LU->B.nrow = n;
+	Bstore = (DNformat*)LU->B.Store;
+	Bstore->lda = n;
+	Bstore->nzval = rhs;
+
+	//See if the last factorization was for this same pattern
+	if (NR_symbolic_reuse && LU->symbolic_valid && (LU->pattern_id == pattern_id) && (LU->size == n))
+	{
+		refact = YES;
+		NR_symbolic_skips++;
+	}
+	else	//Full factorization - new column ordering
+	{
+		NR_complex_LU_release(LU);
+		get_perm_c(1, &LU->A, LU->perm_c);
+		refact = NO;
+	}
+
+	StatAlloc(n, procs, panel_size, relax, &Gstat);
+	StatInit(n, procs, &Gstat);
+
+	//Apply perm_c to A (and build the elimination tree if refact is NO), then factor and solve
+	pzgstrf_init(procs, EQUILIBRATE, NOTRANS, refact, panel_size, relax, 1.0, refact, 0.0, LU->perm_c, LU->perm_r, NULL, 0, &LU->A, &AC, &LU->options, &Gstat);
+	pzgstrf(&LU->options, &AC, LU->perm_r, &LU->L, &LU->U, &Gstat, &info);
+
+	if (info == 0)
+	{
+		zgstrs(NOTRANS, &LU->L, &LU->U, LU->perm_r, LU->perm_c, &LU->B, &Gstat, &info);
+	}
+
+	Destroy_CompCol_Permuted(&AC);
+	StatFree(&Gstat);
+
+	//Factors and elimination tree now belong to this pattern
+	LU->symbolic_valid = true;
+	LU->pattern_id = pattern_id;
+	LU->size = n;
+
+	//Only keep them if they are going to be reused
+	if ((NR_symbolic_reuse == false) || (info != 0))
+	{
+		NR_complex_LU_release(LU);
+	}
+
+	return info;
+}
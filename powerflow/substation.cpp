@@ -350,7 +350,7 @@ TIMESTAMP substation::sync(TIMESTAMP t0, TIMESTAMP t1)
 		}
 	}
 
-	if((solver_method == SM_NR && NR_admit_change == false) || solver_method == SM_FBS){
+	if((solver_method == SM_NR && NR_admit_change == false && NR_admit_update == false) || solver_method == SM_FBS){
 		distribution_power_A = voltageA * (~current_inj[0]);
 		distribution_power_B = voltageB * (~current_inj[1]);
 		distribution_power_C = voltageC * (~current_inj[2]);
@@ -126,6 +126,7 @@ typedef struct s_implicit_enduse_list {
 #include "elcap2010.h"
 #include "rbsa2014.h"
 static IMPLICITENDUSEDATA *implicit_enduse_data = elcap1990;
+static unsigned int house_init_lock = 0; ///< guards the lazy statics of house_e::init (objects may be initialized in parallel)
 
 EXPORT CIRCUIT *attach_enduse_house_e(OBJECT *obj, enduse *target, double breaker_amps, int is220)
 {
@@ -725,9 +726,10 @@ int house_e::init_climate()
 {
 	OBJECT *hdr = OBJECTHDR(this);
 
-	// link to climate data
+	// link to climate data (houses are initialized in parallel, so the first one finds the climates under the lock)
 	static FINDLIST *climates = NULL;
 	int not_found = 0;
+	::wlock(&house_init_lock);
 	if (climates==NULL && not_found==0) 
 	{
 		climates = gl_find_objects(FL_NEW,FT_CLASS,SAME,"climate",FT_END);
@@ -747,6 +749,7 @@ int house_e::init_climate()
 			gl_warning("house_e: %d climates found, using first one defined", climates->hit_count);
 		}
 	}
+	::wunlock(&house_init_lock);
 	if (climates!=NULL)
 	{
 		if (climates->hit_count==0)
@@ -1206,6 +1209,7 @@ int house_e::init(OBJECT *parent)
 	hdr->flags |= OF_SKIPSAFE;
 
 	heat_start = false;
+	etp_posted = false;
 
 	// local object name,	meter object name
 	struct {
@@ -1434,11 +1438,13 @@ int house_e::init(OBJECT *parent)
 	if(auxiliary_system_type != AT_NONE && heating_system_type == HT_NONE)
 	{	/* auxiliary heating and no normal heating?  crazy talk! */
 		static int aux_for_rst = 0;
+		::wlock(&house_init_lock);
 		if(aux_for_rst == 0){
 			gl_warning("house_e heating strategies with auxiliary heat but without normal heating modes are converted"
 				"to resistively heated houses, see house %s",obj->name);
 			aux_for_rst = 1;
 		}
+		::wunlock(&house_init_lock);
 		heating_system_type = HT_RESISTANCE;
 	}
 
@@ -2379,26 +2385,26 @@ TIMESTAMP house_e::sync(TIMESTAMP t0, TIMESTAMP t1)
 			if(t < thermostat_last_cycle_time + thermostat_cycle_time){
 				dt2 = (double)(thermostat_last_cycle_time + thermostat_cycle_time);
 			} else {
-				dt2 = e2solve(k1,r1,k2,r2,Teq-Tevent)*3600.0;
+				dt2 = solve_Tevent()*3600.0;
 			}
 		} else if(thermostat_off_cycle_time >= 0 && thermostat_on_cycle_time >= 0){
 			if(thermostat_last_off_cycle_time > thermostat_last_on_cycle_time){
 				if(t < thermostat_last_off_cycle_time + thermostat_off_cycle_time){
 					dt2 = (double)(thermostat_last_off_cycle_time + thermostat_off_cycle_time);
 				} else {
-					dt2 = e2solve(k1,r1,k2,r2,Teq-Tevent)*3600;
+					dt2 = solve_Tevent()*3600;
 				}
 			} else if(thermostat_last_off_cycle_time < thermostat_last_on_cycle_time){
 				if(t < thermostat_last_on_cycle_time + thermostat_on_cycle_time){
 					dt2 = (double)(thermostat_last_on_cycle_time + thermostat_on_cycle_time);
 				} else {
-					dt2 = e2solve(k1,r1,k2,r2,Teq-Tevent)*3600;
+					dt2 = solve_Tevent()*3600;
 				}
 			} else {
 				if(t < thermostat_last_cycle_time + thermostat_cycle_time){
 					dt2 = (double)(thermostat_last_cycle_time + thermostat_cycle_time);
 				} else {
-					dt2 = e2solve(k1,r1,k2,r2,Teq-Tevent)*3600;
+					dt2 = solve_Tevent()*3600;
 				}
 			}
 		} else {
@@ -2409,6 +2415,22 @@ TIMESTAMP house_e::sync(TIMESTAMP t0, TIMESTAMP t1)
 		dt2 = TS_NEVER;
 	}
 
+	// the thermal event is found in postsync once the batch solver has run
+	if (etp_posted)
+	{
+		etp_t2 = t2;
+		return TS_NEVER;
+	}
+	return next_event(t1,t2,dt2);
+}
+
+/** Combines the time dt2 (in seconds) to the next thermal event with the next event t2
+	found by sync, and enforces the dwell time.
+**/
+TIMESTAMP house_e::next_event(TIMESTAMP t1, TIMESTAMP t2, double dt2)
+{
+	TIMESTAMP t;
+
 	// if no solution is found or it has already occurred
 	if (isnan(dt2) || !isfinite(dt2) || dt2<0)
 	{
@@ -2484,10 +2506,30 @@ TIMESTAMP house_e::postsync(TIMESTAMP t0, TIMESTAMP t1)
 	if (obj->parent != NULL)
 		wunlock(obj->parent);
 
+	// the first house to get here on each thread solves the thermal events that thread posted
+	if (etp_posted)
+	{
+		etp_posted = false;
+		return next_event(t1,etp_t2,e2solve_result(&etp_item)*3600.0);
+	}
 	return TS_NEVER;
 }
 
 
+/** Solves for the time in hours to the next thermal event.  When residential::etp_batch
+	is set the equation is posted to the batch solver instead and NaN is returned.
+**/
+double house_e::solve_Tevent(void)
+{
+	if (etp_batch)
+	{
+		e2solve_post(&etp_item,k1,r1,k2,r2,Teq-Tevent);
+		etp_posted = true;
+		return NaN;
+	}
+	return e2solve(k1,r1,k2,r2,Teq-Tevent);
+}
+
 void house_e::update_Tevent()
 {
 	OBJECT *obj = OBJECTHDR(this);
@@ -15,6 +15,7 @@
 #include "enduse.h"
 #include "loadshape.h"
 #include "residential_enduse.h"
+#include "solvers.h"
 
 typedef struct s_implicit_enduse {
 	enduse load;
@@ -426,6 +427,10 @@ private:
 
 	complex load_values[3][3];	//Power, Current, and impedance (admittance) load accumulators for
 
+	E2BATCHITEM etp_item;	// thermal event equation posted to the batch solver
+	bool etp_posted;		// thermal event equation is waiting for the batch solver
+	TIMESTAMP etp_t2;		// next event found by sync before the thermal event is known
+
 public:
 	int error_flag;
 	static CLASS *oclass, *pclass;
@@ -444,6 +449,8 @@ public:
 	void update_model(double dt=0);
 	void check_controls(void);
 	void update_Tevent(void);
+	double solve_Tevent(void);
+	TIMESTAMP next_event(TIMESTAMP t1, TIMESTAMP t2, double dt2);
 
 	int init(OBJECT *parent);
 	int init_climate(void);
@@ -43,6 +43,7 @@ double default_outdoor_temperature = 74.0;
 double default_humidity = 75.0;
 double default_solar[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
 int64 default_etp_iterations = 100;
+bool etp_batch = false;	//Flag to solve the house ETP equations in batches
 
 EXPORT CLASS *init(CALLBACKS *fntable, MODULE *module, int argc, char *argv[])
 {
@@ -59,6 +60,7 @@ EXPORT CLASS *init(CALLBACKS *fntable, MODULE *module, int argc, char *argv[])
 	gl_global_create("residential::default_solar",PT_double,&default_solar,PT_SIZE,9,PT_UNITS,"Btu/sf",PT_DESCRIPTION,"solar gains when no climate data is found",NULL);
 	gl_global_create("residential::default_etp_iterations",PT_int64,&default_etp_iterations,PT_DESCRIPTION,"number of iterations ETP solver will run",NULL);
 	gl_global_create("residential::ANSI_voltage_check",PT_bool,&ANSI_voltage_check,PT_DESCRIPTION,"enable or disable messages about ANSI voltage limit violations in the house",NULL);
+	gl_global_create("residential::etp_batch",PT_bool,&etp_batch,PT_DESCRIPTION,"solve the house thermal event equations in batches after the sync pass",NULL);
 
 	new residential_enduse(module);
 	new appliance(module);
@@ -84,6 +86,11 @@ EXPORT CLASS *init(CALLBACKS *fntable, MODULE *module, int argc, char *argv[])
 	return residential_enduse::oclass;
 }
 
+EXPORT void term(void)
+{
+	e2solve_free();
+}
+
 CDECL int do_kill()
 {
 	/* if global memory needs to be released, this is a good time to do it */
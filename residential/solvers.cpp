@@ -4,6 +4,7 @@
 
 #define USE_GLSOLVERS
 #include "gridlabd.h"
+#include "solvers.h"
 
 #ifdef USE_NEWSOLVER
 
@@ -99,3 +100,175 @@ double e2solve(double a, double n, double b, double m, double c, double p, doubl
 }
 
 #endif
+
+/* Equations posted with e2solve_post are not solved right away.  Each thread posts
+   to its own stage, so objects running in parallel do not contend for a lock.  The
+   first e2solve_result a thread makes after the posts solves that thread's own stage 
+   with the etpbatch solver, so the stages are solved in parallel by the threads that
+   filled them.  A result from a stage that has not been solved yet solves that stage
+   on the calling thread.  Posts and results must come from different passes, e.g.,
+   posts in sync and results in postsync.
+ */
+#ifdef WIN32
+#define THREADLOCAL __declspec(thread)
+#define atomic_increment(ptr) InterlockedIncrement((volatile long*)(ptr))
+#else
+#define THREADLOCAL __thread
+#define atomic_increment(ptr) __sync_add_and_fetch(ptr,1)
+#endif
+#define MAXETPSTAGES 64
+
+extern int64 default_etp_iterations;
+
+typedef struct s_etpbatch {
+	unsigned int size;
+	double *t,*a,*n,*b,*m,*c,*p,*e;
+	unsigned char *s;
+	unsigned int i;
+} ETPBATCH;
+typedef struct s_etpstage {
+	unsigned int lock;
+	unsigned int generation; ///< batch held by the stage
+	volatile bool solved; ///< batch has been solved, next post starts a new batch
+	unsigned int max_size; ///< equations allocated
+	ETPBATCH data;
+} ETPSTAGE;
+static ETPSTAGE etp_stage[MAXETPSTAGES];
+static THREADLOCAL unsigned int etp_stage_slot = 0; // stage used by the current thread (0 until first post)
+static unsigned int etp_stage_count = 0;
+static unsigned int etp_solver_lock = 0;
+static glsolver * volatile etpbatch = NULL;
+
+static bool e2solve_grow(ETPBATCH *data, unsigned int max_size)
+{
+	double **array[] = {&data->t,&data->a,&data->n,&data->b,&data->m,&data->c,&data->p,&data->e};
+	for ( unsigned int k=0 ; k<sizeof(array)/sizeof(array[0]) ; k++ )
+	{
+		double *grown = (double*)realloc(*array[k],sizeof(double)*max_size);
+		if ( grown==NULL )
+			return false;
+		*array[k] = grown;
+	}
+	unsigned char *s = (unsigned char*)realloc(data->s,max_size);
+	if ( s==NULL )
+		return false;
+	data->s = s;
+	return true;
+}
+
+void e2solve_post(E2BATCHITEM *item, double a, double n, double b, double m, double c, double p)
+{
+	if ( etp_stage_slot==0 )
+		etp_stage_slot = atomic_increment(&etp_stage_count);
+	ETPSTAGE *stage = etp_stage + (etp_stage_slot-1)%MAXETPSTAGES;
+
+	::wlock(&stage->lock);
+	if ( stage->solved )
+	{
+		stage->data.size = 0;
+		stage->generation++;
+		stage->solved = false;
+	}
+	if ( stage->data.size==stage->max_size )
+	{
+		unsigned int max_size = stage->max_size>0 ? stage->max_size*2 : 256;
+		if ( !e2solve_grow(&stage->data,max_size) )
+		{
+			::wunlock(&stage->lock);
+			GL_THROW("e2solve_post(): unable to grow ETP batch stage");
+			/* TROUBLESHOOT
+				The ETP batch solver could not allocate memory to hold an equation until
+				the batch is solved.  Reduce the size of the model, free up memory, or
+				set residential::etp_batch to FALSE and try again.
+			 */
+		}
+		stage->max_size = max_size;
+	}
+	ETPBATCH *data = &stage->data;
+	unsigned int j = data->size++;
+	data->t[j] = 0;
+	data->a[j] = a;
+	data->n[j] = n;
+	data->b[j] = b;
+	data->m[j] = m;
+	data->c[j] = c;
+	data->p[j] = p;
+	data->s[j] = 0;
+	item->stage = (unsigned int)(stage-etp_stage);
+	item->index = j;
+	item->generation = stage->generation;
+	::wunlock(&stage->lock);
+}
+
+/* solves the batch held by a stage unless it already has been */
+static void e2solve_stage(ETPSTAGE *stage)
+{
+	if ( etpbatch==NULL )
+	{
+		::wlock(&etp_solver_lock);
+		try {
+			if ( etpbatch==NULL )
+			{
+				glsolver *solver = new glsolver("etpbatch");
+				unsigned int version;
+				if ( solver->get("version",&version,NULL)==0 || version!=1 )
+					throw "incorrect ETP batch solver version";
+				etpbatch = solver;
+			}
+		}
+		catch (...)
+		{
+			::wunlock(&etp_solver_lock);
+			throw;
+		}
+		::wunlock(&etp_solver_lock);
+	}
+	::wlock(&stage->lock);
+	if ( !stage->solved )
+	{
+		if ( stage->data.size>0 )
+		{
+			stage->data.i = (unsigned int)default_etp_iterations;
+			etpbatch->solve(&stage->data);
+		}
+		stage->solved = true;
+	}
+	::wunlock(&stage->lock);
+}
+
+double e2solve_result(E2BATCHITEM *item, double *e)
+{
+	// flush the stage this thread posted to before reading from any other stage
+	if ( etp_stage_slot>0 && !etp_stage[(etp_stage_slot-1)%MAXETPSTAGES].solved )
+		e2solve_stage(etp_stage+(etp_stage_slot-1)%MAXETPSTAGES);
+	ETPSTAGE *stage = etp_stage + item->stage;
+	if ( !stage->solved )
+		e2solve_stage(stage);
+	ETPBATCH *data = &stage->data;
+	if ( item->generation!=stage->generation || data->s[item->index]!=1 )
+		return NaN;
+	if ( e!=NULL )
+		*e = data->e[item->index];
+	return data->t[item->index];
+}
+
+/* releases the stage buffers and the batch solver */
+void e2solve_free(void)
+{
+	for ( unsigned int k=0 ; k<MAXETPSTAGES ; k++ )
+	{
+		ETPBATCH *data = &etp_stage[k].data;
+		double **array[] = {&data->t,&data->a,&data->n,&data->b,&data->m,&data->c,&data->p,&data->e};
+		for ( unsigned int n=0 ; n<sizeof(array)/sizeof(array[0]) ; n++ )
+		{
+			free(*array[n]);
+			*array[n] = NULL;
+		}
+		free(data->s);
+		data->s = NULL;
+		data->size = 0;
+		etp_stage[k].max_size = 0;
+	}
+	delete etpbatch;
+	etpbatch = NULL;
+}
@@ -10,4 +10,17 @@
 
 double e2solve( double a,double n,double b,double m,double c,double p=1e-8,double *e=NULL);
 
+/// Handle of an equation posted to the ETP batch solver
+typedef struct s_e2batchitem {
+	unsigned int stage; ///< stage of the thread that posted the equation
+	unsigned int index; ///< position of the equation in the stage
+	unsigned int generation; ///< batch to which the equation was posted
+} E2BATCHITEM;
+
+extern bool etp_batch; ///< residential::etp_batch, solve the house thermal event equations in batches
+
+void e2solve_post(E2BATCHITEM *item, double a,double n,double b,double m,double c,double p=1e-8);
+double e2solve_result(E2BATCHITEM *item, double *e=NULL);
+void e2solve_free(void);
+
 #endif
@@ -7,8 +7,11 @@ tape_tape_la_LDFLAGS =
 tape_tape_la_LDFLAGS += $(AM_LDFLAGS)
 
 tape_tape_la_LIBADD = -ldl
+tape_tape_la_LIBADD += $(PTHREAD_LIBS)
 
 tape_tape_la_SOURCES =
+tape_tape_la_SOURCES += tape/binary.c
+tape_tape_la_SOURCES += tape/binary.h
 tape_tape_la_SOURCES += tape/collector.c
 tape_tape_la_SOURCES += tape/file.c
 tape_tape_la_SOURCES += tape/file.h
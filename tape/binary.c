@@ -0,0 +1,1016 @@
+/** $Id$
+	Copyright (C) 2008 Battelle Memorial Institute
+	@file binary.c
+	@addtogroup binary Binary recorder output
+	@ingroup recorder
+
+	Recorders with \p filetype "bin" do not format their samples as text.
+	Instead the raw property values are copied into a shared queue and a
+	single background writer thread stores them in one columnar file per
+	run (named by the \p tape::binary_file global).  Each recorder becomes
+	a channel in that file:
+
+	- a channel record describes the recorder, its target and the type,
+	  size, unit and keywords of each column;
+	- a block record holds up to a few kilobytes of samples of one channel,
+	  stored as the timestamp column followed by each property column.
+
+	The queue is a bounded lock-free ring (see binary_push()) so recorders
+	running on different threads never wait on each other or on file I/O,
+	unless the writer falls a full ring behind.  The writer sleeps on a
+	condition variable while the ring is empty and producers only signal it
+	when it is asleep.
+
+	Binary files are converted to the usual recorder CSV files, one per
+	channel, by importing them into the tape module, e.g.
+
+	@verbatim
+	module tape;
+	import tape "recorder.bin";
+	@endverbatim
+
+	The converter uses the timezone and number formats of the model doing
+	the import, so set the clock timezone before the import.  Transient
+	recorders (interval -1) compare raw values, so changes smaller than the
+	printed precision are also recorded.  Triggers, multi-run files and deltamode sampling are not
+	supported by binary recorders.
+ @{
+ **/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include "gridlabd.h"
+
+#include "tape.h"
+#include "binary.h"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define atomic_compare_and_swap(ptr,cmp,xchg) (InterlockedCompareExchange((volatile long*)(ptr),(long)(xchg),(long)(cmp))==(long)(cmp))
+#define memory_barrier() MemoryBarrier()
+#define yield_thread() Sleep(0)
+#else
+#include <sched.h>
+#include <unistd.h>
+#define atomic_compare_and_swap __sync_bool_compare_and_swap
+#define memory_barrier() __sync_synchronize()
+#define yield_thread() sched_yield()
+#endif
+
+char1024 binary_file = "recorder.bin";
+int32 binary_queue_size = 16384;
+
+#define BINARY_MAGIC "GLDBIN01"
+#define BINARY_ENDIAN 0x01020304
+#define BINARY_BLOCKSIZE 8192 /* target bytes per block record */
+
+typedef enum {
+	BR_CHANNEL=1, /**< channel definition record */
+	BR_BLOCK=2, /**< sample block record */
+} BINARYRECORD;
+
+typedef enum {
+	BM_DEFINE=1, /**< channel definition (written as a channel record) */
+	BM_ROW=2, /**< one sample of a channel */
+	BM_CLOSE=3, /**< channel is closed */
+} BINARYMESSAGE;
+
+typedef struct s_binarycolumn {
+	PROPERTY *prop; /**< recorder property linked to the target */
+	UNIT *from, *to; /**< unit conversion done when sampling, if any */
+	unsigned int size; /**< bytes per value */
+	unsigned int offset; /**< offset of the value in a sample */
+} BINARYCOLUMN;
+
+typedef struct s_binarychannel {
+	unsigned int id;
+	unsigned int n_columns;
+	BINARYCOLUMN *column;
+	unsigned int rowsize; /**< bytes per sample, not counting the timestamp */
+	/* recorder side */
+	char *row; /**< current sample */
+	char *last; /**< last sample queued (for change detection) */
+	char *hold; /**< sample held until the clock advances (interval>0) */
+	int held;
+	/* writer side */
+	char *define; /**< serialized channel record */
+	unsigned int defsize;
+	char *assembly; /**< reassembly buffer for messages split across slots */
+	unsigned int capacity; /**< samples per block */
+	unsigned int n_rows; /**< samples in the current block */
+	TIMESTAMP *ts;
+	char *block; /**< column c starts at block+capacity*column[c].offset */
+	int closed;
+} BINARYCHANNEL;
+
+/* ring slots are 256 bytes, messages longer than SLOTDATA are split across slots */
+#define SLOTDATA (256-4*sizeof(unsigned int)-sizeof(BINARYCHANNEL*)-sizeof(TIMESTAMP))
+typedef struct s_binaryslot {
+	volatile unsigned int sequence; /**< ticket of the producer (pos) or consumer (pos+1) that may use the slot next */
+	unsigned int kind; /**< BINARYMESSAGE */
+	unsigned int offset; /**< offset of this part in the message */
+	unsigned int length; /**< length of this part */
+	BINARYCHANNEL *channel;
+	TIMESTAMP ts;
+	char data[SLOTDATA];
+} BINARYSLOT;
+
+static BINARYSLOT *ring = NULL;
+static unsigned int ring_mask = 0;
+static volatile unsigned int ring_head = 0; /* next ticket to claim (producers) */
+static unsigned int ring_tail = 0; /* next ticket to consume (writer only) */
+static volatile unsigned int ring_stalls = 0; /* producer waits on a full ring */
+
+static pthread_mutex_t binary_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_t writer_thread;
+static int writer_running = 0;
+static volatile int writer_stop = 0;
+static volatile int writer_asleep = 0; /* writer is waiting on writer_wakeup */
+static int writer_errno = 0;
+static FILE *writer_fp = NULL;
+static int64 writer_rows = 0;
+
+static BINARYCHANNEL **channels = NULL;
+static unsigned int n_channels = 0, max_channels = 0;
+
+/** Claim a ring slot, waiting for the writer if the ring is full
+	@return the claimed slot; its ticket is stored in \p pos
+ **/
+static BINARYSLOT *binary_claim(unsigned int *pos)
+{
+	unsigned int ticket = ring_head;
+	for ( ;; )
+	{
+		BINARYSLOT *slot = &ring[ticket&ring_mask];
+		int diff = (int)(slot->sequence-ticket);
+		if ( diff==0 )
+		{
+			if ( atomic_compare_and_swap(&ring_head,ticket,ticket+1) )
+			{
+				*pos = ticket;
+				return slot;
+			}
+		}
+		else if ( diff<0 )
+		{
+			/* ring is full */
+			ring_stalls++;
+			yield_thread();
+		}
+		ticket = ring_head;
+	}
+}
+
+/** Wake the writer if it is waiting for messages
+ **/
+static void binary_wakeup(void)
+{
+	/* the writer sets writer_asleep before it checks the ring one last time, so
+	   either it sees the new message or this sees it asleep */
+	memory_barrier();
+	if ( writer_asleep )
+	{
+		pthread_mutex_lock(&writer_lock);
+		pthread_cond_signal(&writer_wakeup);
+		pthread_mutex_unlock(&writer_lock);
+	}
+}
+
+/** Queue a message for the writer, splitting it across slots as needed
+ **/
+static void binary_push(BINARYCHANNEL *ch, BINARYMESSAGE kind, TIMESTAMP ts, const char *data, unsigned int size)
+{
+	unsigned int offset = 0;
+	do {
+		unsigned int pos;
+		unsigned int len = size-offset>SLOTDATA ? (unsigned int)SLOTDATA : size-offset;
+		BINARYSLOT *slot = binary_claim(&pos);
+		slot->kind = kind;
+		slot->offset = offset;
+		slot->length = len;
+		slot->channel = ch;
+		slot->ts = ts;
+		if ( len>0 )
+			memcpy(slot->data,data+offset,len);
+		memory_barrier();
+		slot->sequence = pos+1; /* hand the slot to the writer */
+		offset += len;
+	} while ( offset<size );
+	binary_wakeup();
+}
+
+/***************************************************************************
+ * WRITER THREAD
+ */
+
+static void binary_fwrite(const void *data, size_t size, size_t count)
+{
+	if ( count>0 && fwrite(data,size,count,writer_fp)!=count && writer_errno==0 )
+		writer_errno = errno ? errno : EIO;
+}
+
+static void binary_flush_block(BINARYCHANNEL *ch)
+{
+	unsigned int header[4], n;
+	if ( ch->n_rows==0 )
+		return;
+	header[0] = BR_BLOCK;
+	header[1] = 2*sizeof(unsigned int) + ch->n_rows*(sizeof(TIMESTAMP)+ch->rowsize);
+	header[2] = ch->id;
+	header[3] = ch->n_rows;
+	binary_fwrite(header,sizeof(header),1);
+	binary_fwrite(ch->ts,sizeof(TIMESTAMP),ch->n_rows);
+	for ( n=0 ; n<ch->n_columns ; n++ )
+	{
+		BINARYCOLUMN *c = ch->column+n;
+		binary_fwrite(ch->block+ch->capacity*c->offset,c->size,ch->n_rows);
+	}
+	ch->n_rows = 0;
+}
+
+static void binary_append(BINARYCHANNEL *ch, TIMESTAMP ts, const char *row)
+{
+	unsigned int n;
+	if ( ch->block==NULL )
+	{
+		ch->capacity = BINARY_BLOCKSIZE/(ch->rowsize+sizeof(TIMESTAMP));
+		if ( ch->capacity==0 ) ch->capacity = 1;
+		ch->ts = (TIMESTAMP*)malloc(sizeof(TIMESTAMP)*ch->capacity);
+		ch->block = (char*)malloc(ch->rowsize*ch->capacity);
+		if ( ch->ts==NULL || ch->block==NULL )
+		{
+			writer_errno = ENOMEM;
+			return;
+		}
+	}
+	ch->ts[ch->n_rows] = ts;
+	for ( n=0 ; n<ch->n_columns ; n++ )
+	{
+		BINARYCOLUMN *c = ch->column+n;
+		memcpy(ch->block+ch->capacity*c->offset+ch->n_rows*c->size,row+c->offset,c->size);
+	}
+	writer_rows++;
+	if ( ++ch->n_rows==ch->capacity )
+		binary_flush_block(ch);
+}
+
+static void binary_release(BINARYCHANNEL *ch)
+{
+	binary_flush_block(ch);
+	free(ch->ts);
+	free(ch->block);
+	free(ch->assembly);
+	ch->ts = NULL;
+	ch->block = NULL;
+	ch->assembly = NULL;
+	ch->closed = 1;
+}
+
+static void binary_receive(BINARYSLOT *slot)
+{
+	BINARYCHANNEL *ch = slot->channel;
+	unsigned int total = ( slot->kind==BM_DEFINE ? ch->defsize : ch->rowsize );
+	const char *data = slot->data;
+	if ( slot->kind==BM_CLOSE )
+	{
+		binary_release(ch);
+		return;
+	}
+	if ( slot->offset>0 || slot->length<total )
+	{
+		/* reassemble messages that did not fit in one slot */
+		memcpy(ch->assembly+slot->offset,slot->data,slot->length);
+		if ( slot->offset+slot->length<total )
+			return;
+		data = ch->assembly;
+	}
+	if ( slot->kind==BM_DEFINE )
+	{
+		unsigned int header[2] = {BR_CHANNEL, ch->defsize};
+		binary_fwrite(header,sizeof(header),1);
+		binary_fwrite(data,1,ch->defsize);
+	}
+	else
+		binary_append(ch,slot->ts,data);
+}
+
+static void *binary_writer(void *arg)
+{
+	unsigned int n;
+	for ( ;; )
+	{
+		BINARYSLOT *slot = &ring[ring_tail&ring_mask];
+		if ( slot->sequence==ring_tail+1 )
+		{
+			memory_barrier();
+			binary_receive(slot);
+			memory_barrier();
+			slot->sequence = ring_tail+ring_mask+1; /* hand the slot back to the producers */
+			ring_tail++;
+		}
+		else if ( writer_stop )
+		{
+			/* recheck after seeing the stop flag so the last messages are not lost */
+			memory_barrier();
+			if ( slot->sequence!=ring_tail+1 )
+				break;
+		}
+		else
+		{
+			/* wait for a producer, checking the ring again once they can see the writer is asleep */
+			pthread_mutex_lock(&writer_lock);
+			writer_asleep = 1;
+			memory_barrier();
+			if ( slot->sequence!=ring_tail+1 && !writer_stop )
+				pthread_cond_wait(&writer_wakeup,&writer_lock);
+			writer_asleep = 0;
+			pthread_mutex_unlock(&writer_lock);
+		}
+	}
+	for ( n=0 ; n<n_channels ; n++ )
+	{
+		if ( !channels[n]->closed )
+			binary_release(channels[n]);
+	}
+	return NULL;
+}
+
+/** Open the shared file and start the writer thread (binary_lock must be held)
+ **/
+static int binary_start(void)
+{
+	unsigned int n, size = 64;
+	unsigned int header[2] = {BINARY_ENDIAN, 1};
+	while ( size<(unsigned int)binary_queue_size && size<0x40000000 )
+		size <<= 1;
+	writer_fp = fopen(binary_file,"wb");
+	if ( writer_fp==NULL )
+	{
+		gl_error("binary recorder file %s: %s", binary_file, strerror(errno));
+		/* TROUBLESHOOT
+			The file named by the tape::binary_file global could not be created.
+			Check that the directory exists and is writable, or set tape::binary_file
+			to another location.
+		 */
+		return 0;
+	}
+	binary_fwrite(BINARY_MAGIC,1,8);
+	binary_fwrite(header,sizeof(header),1);
+	ring = (BINARYSLOT*)malloc(sizeof(BINARYSLOT)*size);
+	if ( ring==NULL )
+	{
+		gl_error("binary recorder queue: out of memory");
+		fclose(writer_fp);
+		writer_fp = NULL;
+		return 0;
+	}
+	for ( n=0 ; n<size ; n++ )
+		ring[n].sequence = n;
+	ring_mask = size-1;
+	ring_head = ring_tail = 0;
+	writer_stop = 0;
+	if ( pthread_create(&writer_thread,NULL,binary_writer,NULL)!=0 )
+	{
+		gl_error("binary recorder writer thread could not be started");
+		/* TROUBLESHOOT
+			The system refused to create the thread that writes binary recorder data.
+			Reduce the number of threads used by the simulation or use text recorders.
+		 */
+		free(ring);
+		ring = NULL;
+		fclose(writer_fp);
+		writer_fp = NULL;
+		return 0;
+	}
+	writer_running = 1;
+	gl_verbose("binary recorder writer started for '%s' (%u queue slots)", binary_file, size);
+	return 1;
+}
+
+/***************************************************************************
+ * RECORDER INTERFACE
+ */
+
+typedef struct {
+	char *data;
+	unsigned int size, alloc;
+} BINARYBUFFER;
+
+static int buffer_put(BINARYBUFFER *buf, const void *data, unsigned int size)
+{
+	if ( buf->size+size>buf->alloc )
+	{
+		unsigned int alloc = buf->alloc ? buf->alloc*2 : 256;
+		char *grow;
+		while ( alloc<buf->size+size ) alloc *= 2;
+		grow = (char*)realloc(buf->data,alloc);
+		if ( grow==NULL )
+			return 0;
+		buf->data = grow;
+		buf->alloc = alloc;
+	}
+	memcpy(buf->data+buf->size,data,size);
+	buf->size += size;
+	return 1;
+}
+
+static int buffer_putstr(BINARYBUFFER *buf, const char *str)
+{
+	unsigned short len = (unsigned short)strlen(str);
+	return buffer_put(buf,&len,sizeof(len)) && buffer_put(buf,str,len);
+}
+
+/** Describe the channel as it will appear in the channel record
+ **/
+static int binary_define(BINARYCHANNEL *ch, struct recorder *my, char *fname)
+{
+	OBJECT *obj = OBJECTHDR(my);
+	BINARYBUFFER buf = {NULL,0,0};
+	unsigned int n;
+	int64 interval = my->interval;
+	int32 format = my->format, limit = my->limit;
+	char target[256];
+	int ok;
+	sprintf(target,"%s %d",obj->parent->oclass->name,obj->parent->id);
+	ok = buffer_put(&buf,&ch->id,sizeof(ch->id))
+		&& buffer_put(&buf,&ch->n_columns,sizeof(ch->n_columns))
+		&& buffer_put(&buf,&format,sizeof(format))
+		&& buffer_put(&buf,&limit,sizeof(limit))
+		&& buffer_put(&buf,&interval,sizeof(interval))
+		&& buffer_putstr(&buf,fname)
+		&& buffer_putstr(&buf,target)
+		&& buffer_putstr(&buf,my->property);
+	for ( n=0 ; ok && n<ch->n_columns ; n++ )
+	{
+		BINARYCOLUMN *c = ch->column+n;
+		unsigned int type = c->prop->ptype, n_keys = 0;
+		KEYWORD *key;
+		UNIT *unit = c->prop->unit;
+		if ( my->line_units==LU_NONE && c->prop->ptype==PT_double )
+			unit = NULL;
+		for ( key=c->prop->keywords ; key!=NULL ; key=key->next )
+			n_keys++;
+		ok = buffer_put(&buf,&type,sizeof(type))
+			&& buffer_put(&buf,&c->size,sizeof(c->size))
+			&& buffer_putstr(&buf,c->prop->name)
+			&& buffer_putstr(&buf,unit?unit->name:"")
+			&& buffer_put(&buf,&n_keys,sizeof(n_keys));
+		for ( key=c->prop->keywords ; ok && key!=NULL ; key=key->next )
+		{
+			ok = buffer_putstr(&buf,key->name)
+				&& buffer_put(&buf,&key->value,sizeof(key->value));
+		}
+	}
+	ch->define = buf.data;
+	ch->defsize = buf.size;
+	return ok;
+}
+
+/** Free a channel and its buffers
+ **/
+static void binary_free_channel(BINARYCHANNEL *ch)
+{
+	free(ch->row);
+	free(ch->column);
+	free(ch->define);
+	free(ch->assembly);
+	free(ch);
+}
+
+int binary_open_recorder(struct recorder *my, char *fname)
+{
+	OBJECT *obj = OBJECTHDR(my);
+	BINARYCHANNEL *ch;
+	PROPERTY *p;
+	unsigned int n = 0;
+
+	if ( my->trigger[0]!='\0' || my->multifile[0]!='\0' || (obj->flags&OF_DELTAMODE) )
+	{
+		gl_error("recorder:%d: binary recorders do not support triggers, multi-run files or deltamode", obj->id);
+		/* TROUBLESHOOT
+			Recorders using filetype "bin" only sample on the regular clock.  Use a text
+			recorder when a trigger, multifile or deltamode recording is needed.
+		 */
+		return 0;
+	}
+
+	ch = (BINARYCHANNEL*)calloc(1,sizeof(BINARYCHANNEL));
+	if ( ch==NULL )
+	{
+		gl_error("recorder:%d: out of memory", obj->id);
+		return 0;
+	}
+	for ( p=my->target ; p!=NULL ; p=p->next )
+		ch->n_columns++;
+	ch->column = (BINARYCOLUMN*)calloc(ch->n_columns,sizeof(BINARYCOLUMN));
+	if ( ch->column==NULL )
+	{
+		gl_error("recorder:%d: out of memory", obj->id);
+		free(ch);
+		return 0;
+	}
+	for ( p=my->target ; p!=NULL ; p=p->next, n++ )
+	{
+		BINARYCOLUMN *c = ch->column+n;
+		c->prop = p;
+		switch ( p->ptype ) {
+		case PT_double:
+			/* also covers the .real and .imag parts of complex properties */
+			c->size = sizeof(double);
+			if ( p->unit!=NULL )
+			{
+				PROPERTY *original = gl_get_property(obj->parent,p->name,NULL);
+				if ( original!=NULL && original->unit!=NULL && strcmp(original->unit->name,p->unit->name)!=0 )
+				{
+					c->from = original->unit;
+					c->to = p->unit;
+				}
+			}
+			break;
+		case PT_complex:
+		case PT_int16:
+		case PT_int32:
+		case PT_int64:
+		case PT_enumeration:
+		case PT_set:
+		case PT_bool:
+		case PT_timestamp:
+		case PT_char8:
+		case PT_char32:
+		case PT_char256:
+		case PT_char1024:
+			c->size = p->width;
+			break;
+		default:
+			c->size = 0;
+			break;
+		}
+		if ( c->size==0 )
+		{
+			gl_error("recorder:%d: property '%s' cannot be recorded in a binary file", obj->id, p->name);
+			/* TROUBLESHOOT
+				Binary recorders only store numeric, enumeration, set, timestamp and
+				string properties.  Record the property with a text recorder instead.
+			 */
+			binary_free_channel(ch);
+			return 0;
+		}
+		c->offset = ch->rowsize;
+		ch->rowsize += c->size;
+	}
+	ch->row = (char*)calloc(3,ch->rowsize);
+	if ( ch->row==NULL )
+	{
+		gl_error("recorder:%d: out of memory", obj->id);
+		binary_free_channel(ch);
+		return 0;
+	}
+	ch->last = ch->row+ch->rowsize;
+	ch->hold = ch->last+ch->rowsize;
+
+	/* the channel record is built before the channel is registered, and gets its id then */
+	if ( !binary_define(ch,my,fname)
+		|| (ch->assembly=(char*)malloc(ch->defsize>ch->rowsize ? ch->defsize : ch->rowsize))==NULL )
+	{
+		gl_error("recorder:%d: out of memory", obj->id);
+		binary_free_channel(ch);
+		return 0;
+	}
+
+	pthread_mutex_lock(&binary_lock);
+	if ( !writer_running && !binary_start() )
+	{
+		pthread_mutex_unlock(&binary_lock);
+		binary_free_channel(ch);
+		return 0;
+	}
+	if ( n_channels==max_channels )
+	{
+		unsigned int alloc = max_channels ? max_channels*2 : 64;
+		BINARYCHANNEL **grow = (BINARYCHANNEL**)realloc(channels,sizeof(BINARYCHANNEL*)*alloc);
+		if ( grow==NULL )
+		{
+			pthread_mutex_unlock(&binary_lock);
+			gl_error("recorder:%d: out of memory", obj->id);
+			binary_free_channel(ch);
+			return 0;
+		}
+		channels = grow;
+		max_channels = alloc;
+	}
+	ch->id = n_channels;
+	memcpy(ch->define,&ch->id,sizeof(ch->id));
+	channels[n_channels++] = ch;
+	pthread_mutex_unlock(&binary_lock);
+
+	binary_push(ch,BM_DEFINE,0,ch->define,ch->defsize);
+
+	my->channel = ch;
+	my->type = FT_BINARY;
+	my->last.ts = TS_ZERO;
+	my->status = TS_OPEN;
+	my->samples = 0;
+	return 1;
+}
+
+static void binary_sample(BINARYCHANNEL *ch, OBJECT *obj, char *row)
+{
+	unsigned int n;
+	for ( n=0 ; n<ch->n_columns ; n++ )
+	{
+		BINARYCOLUMN *c = ch->column+n;
+		void *addr = GETADDR(obj,c->prop);
+		if ( c->from!=NULL )
+		{
+			double value = *(double*)addr;
+			gl_convert_ex(c->from,c->to,&value);
+			memcpy(row+c->offset,&value,sizeof(value));
+		}
+		else
+			memcpy(row+c->offset,addr,c->size);
+	}
+}
+
+static void binary_write(struct recorder *my, TIMESTAMP ts, char *row)
+{
+	BINARYCHANNEL *ch = my->channel;
+	if ( my->limit>0 && my->samples>=my->limit )
+	{
+		binary_close_recorder(my);
+		my->status = TS_DONE;
+		return;
+	}
+	binary_push(ch,BM_ROW,ts,row,ch->rowsize);
+	if ( row!=ch->last )
+		memcpy(ch->last,row,ch->rowsize);
+	my->samples++;
+}
+
+/** Sample a binary recorder; this follows the sampling rules of text recorders
+	@return the time of the next sample
+ **/
+TIMESTAMP binary_sync_recorder(struct recorder *my, TIMESTAMP t0)
+{
+	OBJECT *obj = OBJECTHDR(my);
+	BINARYCHANNEL *ch = my->channel;
+	if ( my->status!=TS_OPEN || ch==NULL )
+		return TS_NEVER;
+	if ( my->last.ts<1 && my->interval!=-1 )
+		my->last.ts = t0;
+
+	/* a held sample is final once the clock moves past it */
+	if ( t0>obj->clock )
+	{
+		obj->clock = t0;
+		if ( my->interval>0 && ch->held && my->last.ts<t0 )
+		{
+			ch->held = 0;
+			binary_write(my,my->last.ts,ch->hold);
+		}
+	}
+
+	if ( my->interval>0 )
+	{
+		/* like text recorders, the clock keeps one more step after the limit is reached */
+		if ( t0>=my->last.ts+my->interval || t0==my->last.ts )
+		{
+			if ( my->status==TS_OPEN )
+			{
+				binary_sample(ch,obj->parent,ch->hold);
+				ch->held = 1;
+			}
+			my->last.ts = t0;
+		}
+		return my->last.ts+my->interval;
+	}
+
+	/* interval 0 samples every timestep, interval -1 only on changes */
+	if ( my->last.ts<t0 )
+	{
+		binary_sample(ch,obj->parent,ch->row);
+		if ( my->interval==0 || my->samples==0 || memcmp(ch->row,ch->last,ch->rowsize)!=0 )
+		{
+			my->last.ts = t0;
+			binary_write(my,t0,ch->row);
+		}
+	}
+	return TS_NEVER;
+}
+
+void binary_close_recorder(struct recorder *my)
+{
+	BINARYCHANNEL *ch = my->channel;
+	if ( ch==NULL )
+		return;
+	binary_push(ch,BM_CLOSE,0,NULL,0);
+	my->channel = NULL;
+}
+
+/** Flush all channels and stop the writer thread
+ **/
+void binary_term(void)
+{
+	unsigned int n;
+	if ( !writer_running )
+		return;
+	writer_stop = 1;
+	binary_wakeup();
+	pthread_join(writer_thread,NULL);
+	writer_running = 0;
+	if ( fclose(writer_fp)!=0 && writer_errno==0 )
+		writer_errno = errno;
+	writer_fp = NULL;
+	if ( writer_errno!=0 )
+	{
+		gl_error("binary recorder file %s: %s", binary_file, strerror(writer_errno));
+		/* TROUBLESHOOT
+			Writing the binary recorder file failed, most likely because the disk is full.
+			The file is incomplete; the converter will stop at the last complete record.
+		 */
+	}
+	gl_verbose("binary recorder writer stopped: %u channels, %" FMT_INT64 "d samples, %u queue stalls", n_channels, writer_rows, ring_stalls);
+	for ( n=0 ; n<n_channels ; n++ )
+		binary_free_channel(channels[n]);
+	free(channels);
+	channels = NULL;
+	n_channels = max_channels = 0;
+	free(ring);
+	ring = NULL;
+}
+
+/***************************************************************************
+ * CONVERTER
+ */
+
+typedef struct s_convertcolumn {
+	PROPERTY prop; /**< property used to format the values */
+	unsigned int size;
+	unsigned int offset;
+} CONVERTCOLUMN;
+
+typedef struct s_convertchannel {
+	int32 format;
+	unsigned int n_columns;
+	unsigned int rowsize;
+	CONVERTCOLUMN *column;
+	FILE *fp;
+} CONVERTCHANNEL;
+
+static int convert_get(const char **pos, const char *end, void *data, unsigned int size)
+{
+	if ( *pos+size>end )
+		return 0;
+	memcpy(data,*pos,size);
+	*pos += size;
+	return 1;
+}
+
+static int convert_getstr(const char **pos, const char *end, char *str, unsigned int size)
+{
+	unsigned short len;
+	if ( !convert_get(pos,end,&len,sizeof(len)) || *pos+len>end || len>=size )
+		return 0;
+	memcpy(str,*pos,len);
+	str[len] = '\0';
+	*pos += len;
+	return 1;
+}
+
+static int convert_channel(CONVERTCHANNEL *ch, const char *data, unsigned int size, char *outname, unsigned int outsize)
+{
+	const char *pos = data, *end = data+size;
+	unsigned int id, n;
+	int32 limit;
+	int64 interval;
+	char1024 name, property;
+	char256 target;
+	time_t now = time(NULL);
+	char *ext;
+	if ( !convert_get(&pos,end,&id,sizeof(id))
+		|| !convert_get(&pos,end,&ch->n_columns,sizeof(ch->n_columns))
+		|| !convert_get(&pos,end,&ch->format,sizeof(ch->format))
+		|| !convert_get(&pos,end,&limit,sizeof(limit))
+		|| !convert_get(&pos,end,&interval,sizeof(interval))
+		|| !convert_getstr(&pos,end,name,sizeof(name))
+		|| !convert_getstr(&pos,end,target,sizeof(target))
+		|| !convert_getstr(&pos,end,property,sizeof(property)) )
+		return 0;
+	ch->column = (CONVERTCOLUMN*)calloc(ch->n_columns,sizeof(CONVERTCOLUMN));
+	if ( ch->column==NULL )
+		return 0;
+	ch->rowsize = 0;
+	for ( n=0 ; n<ch->n_columns ; n++ )
+	{
+		CONVERTCOLUMN *c = ch->column+n;
+		unsigned int type, n_keys, k;
+		char unit[64];
+		KEYWORD **last = &c->prop.keywords;
+		if ( !convert_get(&pos,end,&type,sizeof(type))
+			|| !convert_get(&pos,end,&c->size,sizeof(c->size))
+			|| !convert_getstr(&pos,end,c->prop.name,sizeof(c->prop.name))
+			|| !convert_getstr(&pos,end,unit,sizeof(unit))
+			|| !convert_get(&pos,end,&n_keys,sizeof(n_keys))
+			|| c->size>sizeof(char1024) )
+			return 0;
+		c->prop.ptype = (PROPERTYTYPE)type;
+		c->prop.width = c->size;
+		c->prop.access = PA_PUBLIC;
+		c->prop.unit = unit[0] ? gl_find_unit(unit) : NULL;
+		for ( k=0 ; k<n_keys ; k++ )
+		{
+			KEYWORD *key = (KEYWORD*)calloc(1,sizeof(KEYWORD));
+			if ( key==NULL
+				|| !convert_getstr(&pos,end,key->name,sizeof(key->name))
+				|| !convert_get(&pos,end,&key->value,sizeof(key->value)) )
+			{
+				free(key);
+				return 0;
+			}
+			*last = key;
+			last = &key->next;
+		}
+		c->offset = ch->rowsize;
+		ch->rowsize += c->size;
+	}
+
+	/* the CSV file takes the recorder's file name with the .csv extension */
+	strncpy(outname,name,outsize-5);
+	outname[outsize-5] = '\0';
+	ext = strrchr(outname,'.');
+	if ( ext!=NULL && strpbrk(ext,"/\\")==NULL )
+		*ext = '\0';
+	strcat(outname,".csv");
+	ch->fp = fopen(outname,"w");
+	if ( ch->fp==NULL )
+	{
+		gl_error("recorder file %s: %s", outname, strerror(errno));
+		return 0;
+	}
+	fprintf(ch->fp,"# file...... %s\n", outname);
+	fprintf(ch->fp,"# date...... %s", asctime(localtime(&now)));
+#ifdef WIN32
+	fprintf(ch->fp,"# user...... %s\n", getenv("USERNAME"));
+	fprintf(ch->fp,"# host...... %s\n", getenv("MACHINENAME"));
+#else
+	fprintf(ch->fp,"# user...... %s\n", getenv("USER"));
+	fprintf(ch->fp,"# host...... %s\n", getenv("HOST"));
+#endif
+	fprintf(ch->fp,"# target.... %s\n", target);
+	fprintf(ch->fp,"# trigger... %s\n", "(none)");
+	fprintf(ch->fp,"# interval.. %d\n", (int)interval);
+	fprintf(ch->fp,"# limit..... %d\n", limit);
+	fprintf(ch->fp,"# timestamp,%s\n", property);
+	return 1;
+}
+
+static int convert_block(CONVERTCHANNEL *ch, const char *data, unsigned int size)
+{
+	unsigned int n_rows, r, n;
+	const char *ts, *col;
+	if ( size<2*sizeof(unsigned int) )
+		return 0;
+	memcpy(&n_rows,data+sizeof(unsigned int),sizeof(n_rows));
+	if ( size!=2*sizeof(unsigned int)+n_rows*(sizeof(TIMESTAMP)+ch->rowsize) )
+		return 0;
+	ts = data+2*sizeof(unsigned int);
+	col = ts+n_rows*sizeof(TIMESTAMP);
+	for ( r=0 ; r<n_rows ; r++ )
+	{
+		TIMESTAMP t;
+		char buffer[64] = "0"; /* 0 = INIT */
+		memcpy(&t,ts+r*sizeof(TIMESTAMP),sizeof(t));
+		if ( ch->format!=0 )
+			sprintf(buffer,"%" FMT_INT64 "d",t);
+		else if ( t>TS_ZERO )
+		{
+			DATETIME dt;
+			gl_localtime(t,&dt);
+			gl_strtime(&dt,buffer,sizeof(buffer));
+		}
+		fputs(buffer,ch->fp);
+		for ( n=0 ; n<ch->n_columns ; n++ )
+		{
+			CONVERTCOLUMN *c = ch->column+n;
+			union { double d; int64 i; char s[sizeof(char1024)+8]; } value;
+			char text[1100];
+			memset(&value,0,sizeof(value));
+			memcpy(&value,col+n_rows*c->offset+r*c->size,c->size);
+			if ( callback->convert.property_to_string(&c->prop,&value,text,sizeof(text))<=0 )
+				strcpy(text,"");
+			fprintf(ch->fp,",%s",text);
+		}
+		fputc('\n',ch->fp);
+	}
+	return 1;
+}
+
+/** Convert a binary recorder file to one CSV file per channel
+	@return the number of channels converted, 0 on failure
+ **/
+int binary_convert(const char *filename)
+{
+	FILE *fp = fopen(filename,"rb");
+	char magic[8];
+	unsigned int header[2];
+	CONVERTCHANNEL *list = NULL;
+	unsigned int n_list = 0, n;
+	char *data = NULL;
+	unsigned int alloc = 0;
+	int ok = 1;
+	char1024 outname;
+
+	if ( fp==NULL )
+	{
+		gl_error("binary recorder file %s: %s", filename, strerror(errno));
+		return 0;
+	}
+	if ( fread(magic,1,8,fp)!=8 || memcmp(magic,BINARY_MAGIC,8)!=0
+		|| fread(header,sizeof(header),1,fp)!=1 || header[0]!=BINARY_ENDIAN )
+	{
+		gl_error("%s is not a binary recorder file written on this platform", filename);
+		/* TROUBLESHOOT
+			The converter only reads files written by recorders with filetype "bin" on a
+			system with the same byte order.  Convert the file on the system that wrote it.
+		 */
+		fclose(fp);
+		return 0;
+	}
+	while ( ok && fread(header,sizeof(header),1,fp)==1 )
+	{
+		unsigned int id;
+		if ( header[1]>alloc )
+		{
+			char *grow = (char*)realloc(data,header[1]);
+			if ( grow==NULL ) { ok = 0; break; }
+			data = grow;
+			alloc = header[1];
+		}
+		if ( header[1]<sizeof(id) || fread(data,1,header[1],fp)!=header[1] )
+		{
+			gl_warning("binary recorder file %s ends with an incomplete record", filename);
+			break;
+		}
+		memcpy(&id,data,sizeof(id));
+		if ( header[0]==BR_CHANNEL )
+		{
+			/* channels opened on different threads may be defined out of order */
+			if ( id>=n_list )
+			{
+				CONVERTCHANNEL *grow = (CONVERTCHANNEL*)realloc(list,sizeof(CONVERTCHANNEL)*(id+1));
+				if ( grow!=NULL )
+				{
+					list = grow;
+					memset(list+n_list,0,sizeof(CONVERTCHANNEL)*(id+1-n_list));
+					n_list = id+1;
+				}
+			}
+			ok = id<n_list && list[id].column==NULL
+				&& convert_channel(list+id,data,header[1],outname,sizeof(outname));
+		}
+		else if ( header[0]==BR_BLOCK )
+			ok = id<n_list && list[id].fp!=NULL && convert_block(list+id,data,header[1]);
+		else
+			ok = 0;
+		if ( !ok )
+		{
+			gl_error("binary recorder file %s is corrupt", filename);
+			/* TROUBLESHOOT
+				The binary recorder file contains a record that could not be read.
+				The CSV files converted so far are incomplete.
+			 */
+		}
+	}
+	fclose(fp);
+	free(data);
+	for ( n=0 ; n<n_list ; n++ )
+	{
+		unsigned int c;
+		if ( list[n].fp!=NULL )
+		{
+			fprintf(list[n].fp,"# end of tape\n");
+			fclose(list[n].fp);
+		}
+		for ( c=0 ; list[n].column!=NULL && c<list[n].n_columns ; c++ )
+		{
+			KEYWORD *key = list[n].column[c].prop.keywords;
+			while ( key!=NULL )
+			{
+				KEYWORD *next = key->next;
+				free(key);
+				key = next;
+			}
+		}
+		free(list[n].column);
+	}
+	free(list);
+	if ( ok )
+		gl_verbose("converted %u binary recorder channels from %s", n_list, filename);
+	return ok ? (n_list>0 ? (int)n_list : 1) : 0;
+}
+
+/**@}*/
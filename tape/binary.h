@@ -0,0 +1,25 @@
+/** $Id$
+	Copyright (C) 2008 Battelle Memorial Institute
+	@file binary.h
+	@addtogroup binary Binary recorder output
+	@ingroup recorder
+ @{
+ **/
+
+#ifndef _BINARY_H
+#define _BINARY_H
+
+#include "tape.h"
+
+extern char1024 binary_file; /**< name of the shared binary recorder file */
+extern int32 binary_queue_size; /**< number of slots in the binary writer queue */
+
+int binary_open_recorder(struct recorder *my, char *fname);
+TIMESTAMP binary_sync_recorder(struct recorder *my, TIMESTAMP t0);
+void binary_close_recorder(struct recorder *my);
+void binary_term(void);
+int binary_convert(const char *filename);
+
+#endif
+
+/**@}*/
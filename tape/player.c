@@ -29,6 +29,12 @@
 	have either absolute timestamps or relative times (indicated by a leading + sign).  Relative times are useful
 	if the \p loop parameter is used.  When a loop is performed, only lines with relative timestamps are read and all
 	absolute times are ignored.
+
+	The whole tape is read and parsed when the player is opened.  When the target property
+	has no notifiers, the values are converted to the property type at that time and are
+	copied directly to the target when played, so no text is parsed during the simulation.
+	Other targets receive the values as text through gl_set_value() as before.
+	Players of the same source and target property share one loaded tape.
  @{
  **/
 
@@ -36,6 +42,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <ctype.h>
+#include <pthread.h>
 #include "gridlabd.h"
 #include "object.h"
 #include "aggregate.h"
@@ -62,14 +69,16 @@ EXPORT int create_player(OBJECT **obj, OBJECT *parent)
 		strcpy(my->mode, "file");
 		strcpy(my->property,"(undefined)");
 		my->next.ts = TS_ZERO;
-		strcpy(my->next.value,"");
+		my->next.sample = NULL;
 		my->loopnum = 0;
 		my->loop = 0;
 		my->status = TS_INIT;
 		my->target = gl_get_property(*obj,my->property,NULL);
 		my->delta_track.ns = 0;
 		my->delta_track.ts = TS_NEVER;
-		my->delta_track.value[0] = '\0';
+		my->delta_track.sample = NULL;
+		my->tape = NULL;
+		my->pos = 0;
 		return 1;
 	}
 	return 0;
@@ -149,19 +158,23 @@ static void trim(char *str, char *to){
 	}
 }
 
-TIMESTAMP player_read(OBJECT *obj)
+/* the last hour converted by gl_mktime, reused while consecutive tape lines fall in the same hour */
+typedef struct s_playerhour {
+	int Y, m, d, H;
+	char tz[6];
+	TIMESTAMP base;
+} PLAYERHOUR;
+
+/** Parse the time of a tape line
+	@return 1 if the time was parsed, 0 if not
+ **/
+static int player_parse_time(OBJECT *obj, char *line, char *timebuf, PLAYERSAMPLE *sample, PLAYERHOUR *hour)
 {
-	char buffer[256];
-	char timebuf[64], valbuf[256], tbuf[64];
 	char tz[6];
 	int Y=0,m=0,d=0,H=0,M=0;
 	double S=0;
-	struct player *my = OBJECTDATA(obj,struct player);
 	char unit[2];
 	TIMESTAMP t1;
-	char *result=NULL;
-	char256 value;
-	int voff=0;
 
 	/* TODO move this to tape.c and make the variable available to all classes in tape */
 	static enum {UNKNOWN,ISO,US,EURO} dateformat = UNKNOWN;
@@ -175,163 +188,359 @@ TIMESTAMP player_read(OBJECT *obj)
 		else dateformat = ISO;
 	}
 
-Retry:
-	result = my->ops->read(my, buffer, sizeof(buffer));
-
-	memset(timebuf, 0, 64);
-	memset(valbuf, 0, 256);
-	memset(tbuf, 0, 64);
-	memset(value, 0, 256);
 	memset(tz, 0, 6);
-	if (result==NULL)
-	{
-		if (my->loopnum>0)
+	if (sscanf(timebuf,"%d-%d-%d %d:%d:%lf %4s",&Y,&m,&d,&H,&M,&S, tz)>=4){
+		//struct tm dt = {S,M,H,d,m-1,Y-1900,0,0,0};
+		DATETIME dt;
+		switch ( dateformat ) {
+		case ISO:
+			dt.year = Y;
+			dt.month = m;
+			dt.day = d;
+			break;
+		case US:
+			dt.year = d;
+			dt.month = Y;
+			dt.day = m;
+			break;
+		case EURO:
+			dt.year = d;
+			dt.month = m;
+			dt.day = Y;
+			break;
+		}
+		dt.hour = H;
+		dt.minute = M;
+		dt.second = (unsigned short)S;
+		dt.nanosecond = (unsigned int)(1e9*(S-dt.second));
+		strcpy(dt.tz, tz);
+		sample->kind = PS_DATETIME;
+		sample->ns = dt.nanosecond;
+		if ( hour->base==TS_INVALID || hour->Y!=Y || hour->m!=m || hour->d!=d || hour->H!=H || strcmp(hour->tz,tz)!=0
+			|| M<0 || M>59 || dt.second>59 )
 		{
-			rewind_player(my);
-			my->loopnum--;
-			goto Retry;
+			sample->ts = (TIMESTAMP)gl_mktime(&dt);
+			if ( sample->ts!=TS_INVALID && M>=0 && M<=59 && dt.second<=59 )
+			{
+				hour->Y = Y; hour->m = m; hour->d = d; hour->H = H;
+				strcpy(hour->tz,tz);
+				hour->base = sample->ts - M*60 - dt.second;
+			}
+			else
+				hour->base = TS_INVALID;
 		}
-		else {
-			close_player(my);
-			my->status=TS_DONE;
-			my->next.ts = TS_NEVER;
-			my->next.ns = 0;
-			goto Done;
+		else
+			sample->ts = hour->base + M*60 + dt.second;
+	}
+	else if (sscanf(timebuf,"%" FMT_INT64 "d%1s", &t1, unit)==2)
+	{
+		int64 scale=1;
+		switch(unit[0]) {
+		case 's': scale=TS_SECOND; break;
+		case 'm': scale=60*TS_SECOND; break;
+		case 'h': scale=3600*TS_SECOND; break;
+		case 'd': scale=86400*TS_SECOND; break;
+		default: break;
 		}
+		sample->kind = (line[0]=='+' ? PS_SHIFT : PS_TIME); /* timeshifts have leading + */
+		sample->ts = t1*scale;
+		sample->ns = 0;
+	}
+	else if (sscanf(timebuf,"%lf", &S)==1)
+	{
+		sample->kind = PS_SECONDS;
+		sample->ts = (TIMESTAMP)S;
+		sample->ns = (int64)(1e9*(S-sample->ts));
+	}
+	else
+	{
+		gl_warning("player was unable to parse timestamp \'%s\'", line);
+		return 0;
+	}
+	return 1;
+}
+
+/* tapes already loaded, shared by players of the same source and target property */
+static PLAYERTAPE *tape_list = NULL;
+static pthread_mutex_t tape_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Load the whole tape and convert the values to the target property type
+	@return the tape loaded, NULL on failure
+ **/
+static PLAYERTAPE *player_load_tape(OBJECT *obj)
+{
+	struct player *my = OBJECTDATA(obj,struct player);
+	OBJECT *target = obj->parent ? obj->parent : obj; /* target myself if no parent */
+	PLAYERTAPE *tape = (PLAYERTAPE*)calloc(1,sizeof(PLAYERTAPE));
+	unsigned int max_samples = 0, size = 0, alloc = 0, n;
+	char buffer[256];
+	char *result;
+	PLAYERHOUR hour;
+
+	hour.base = TS_INVALID;
+	if ( tape==NULL )
+	{
+		gl_error("player:%d: out of memory", obj->id);
+		return NULL;
 	}
-	if (result[0]=='#' || result[0]=='\n') /* ignore comments and blank lines */
-		goto Retry;
 
-	if(sscanf(result, "%32[^,],%256[^\n\r;]", tbuf, valbuf) == 2){
+	/* parse every line once; values are kept as text until the target type is known */
+	while ( (result=my->ops->read(my, buffer, sizeof(buffer)))!=NULL )
+	{
+		char timebuf[64], valbuf[256], tbuf[64];
+		char256 value;
+		PLAYERSAMPLE sample = {0};
+		unsigned int len;
+
+		if (result[0]=='#' || result[0]=='\n') /* ignore comments and blank lines */
+			continue;
+		memset(timebuf, 0, 64);
+		memset(valbuf, 0, 256);
+		memset(tbuf, 0, 64);
+		memset(value, 0, 256);
+		if ( sscanf(result, "%32[^,],%256[^\n\r;]", tbuf, valbuf)!=2 )
+		{
+			gl_warning("player was unable to split input string \'%s\'", result);
+			continue;
+		}
 		trim(tbuf, timebuf);
 		trim(valbuf, value);
-		if (sscanf(timebuf,"%d-%d-%d %d:%d:%lf %4s",&Y,&m,&d,&H,&M,&S, tz)==7){
-			//struct tm dt = {S,M,H,d,m-1,Y-1900,0,0,0};
-			DATETIME dt;
-			switch ( dateformat ) {
-			case ISO:
-				dt.year = Y;
-				dt.month = m;
-				dt.day = d;
-				break;
-			case US:
-				dt.year = d;
-				dt.month = Y;
-				dt.day = m;
-				break;
-			case EURO:
-				dt.year = d;
-				dt.month = m;
-				dt.day = Y;
-				break;
+		if ( !player_parse_time(obj,result,timebuf,&sample,&hour) )
+			continue;
+
+		len = (unsigned int)strlen(value)+1;
+		if ( tape->n_samples==max_samples || size+len>alloc )
+		{
+			PLAYERSAMPLE *grow_sample = tape->sample;
+			char *grow_data = tape->data;
+			if ( tape->n_samples==max_samples )
+			{
+				max_samples = max_samples ? max_samples*2 : 1024;
+				grow_sample = (PLAYERSAMPLE*)realloc(tape->sample,sizeof(PLAYERSAMPLE)*max_samples);
 			}
-			dt.hour = H;
-			dt.minute = M;
-			dt.second = (unsigned short)S;
-			dt.nanosecond = (unsigned int)(1e9*(S-dt.second));
-			strcpy(dt.tz, tz);
-			t1 = (TIMESTAMP)gl_mktime(&dt);
-			if ((obj->flags & OF_DELTAMODE)==OF_DELTAMODE)	/* Only request deltamode if we're explicitly enabled */
-				enable_deltamode(dt.nanosecond==0?TS_NEVER:t1);
-			if (t1!=TS_INVALID && my->loop==my->loopnum){
-				my->next.ts = t1;
-				my->next.ns = dt.nanosecond;
-				while(value[voff] == ' '){
-					++voff;
-				}
-				strcpy(my->next.value, value+voff);
+			if ( grow_sample!=NULL ) tape->sample = grow_sample;
+			while ( size+len>alloc )
+				alloc = alloc ? alloc*2 : 16384;
+			grow_data = (char*)realloc(tape->data,alloc);
+			if ( grow_data!=NULL ) tape->data = grow_data;
+			if ( grow_sample==NULL || grow_data==NULL )
+			{
+				gl_error("player:%d: out of memory loading tape '%s'", obj->id, my->file);
+				free(tape->data);
+				free(tape->sample);
+				free(tape);
+				return NULL;
 			}
 		}
-		else if (sscanf(timebuf,"%d-%d-%d %d:%d:%lf",&Y,&m,&d,&H,&M,&S)>=4)
+		sample.offset = size;
+		memcpy(tape->data+size,value,len);
+		size += len;
+		tape->sample[tape->n_samples++] = sample;
+	}
+
+	/* values are stored in the target type when they can be copied without notifying the target */
+	if ( my->target!=NULL && my->target->access==PA_PUBLIC && my->target->notify==NULL && target->oclass->notify==NULL )
+	{
+		unsigned int width = 0;
+		char *data;
+		switch ( my->target->ptype ) {
+		case PT_double:
+		case PT_complex:
+		case PT_int16:
+		case PT_int32:
+		case PT_int64:
+		case PT_enumeration:
+		case PT_set:
+		case PT_bool:
+		case PT_timestamp:
+		case PT_char8:
+		case PT_char32:
+		case PT_char256:
+		case PT_char1024:
+			width = my->target->width;
+			break;
+		default:
+			break;
+		}
+		data = width>0 ? (char*)calloc(tape->n_samples+1,width) : NULL;
+		for ( n=0 ; data!=NULL && n<tape->n_samples ; n++ )
 		{
-			//struct tm dt = {S,M,H,d,m-1,Y-1900,0,0,0};
-			DATETIME dt;
-			switch ( dateformat ) {
-			case ISO:
-				dt.year = Y;
-				dt.month = m;
-				dt.day = d;
-				break;
-			case US:
-				dt.year = d;
-				dt.month = Y;
-				dt.day = m;
-				break;
-			case EURO:
-				dt.year = d;
-				dt.month = m;
-				dt.day = Y;
-				break;
-			}
-			dt.hour = H;
-			dt.minute = M;
-			dt.second = (unsigned short)S;
-			dt.tz[0] = 0;
-			dt.nanosecond = (unsigned int)(1e9*(S-dt.second));
-			t1 = (TIMESTAMP)gl_mktime(&dt);
-			if ((obj->flags & OF_DELTAMODE)==OF_DELTAMODE)	/* Only request deltamode if we're explicitly enabled */
-				enable_deltamode(dt.nanosecond==0?TS_NEVER:t1);
-			if (t1!=TS_INVALID && my->loop==my->loopnum){
-				my->next.ts = t1;
-				my->next.ns = dt.nanosecond;
-				while(value[voff] == ' '){
-					++voff;
-				}
-				strcpy(my->next.value, value+voff);
-			}
+			/* bad values are reported now and are not played */
+			if ( callback->convert.string_to_property(my->target,data+n*width,tape->data+tape->sample[n].offset)<=0 )
+				tape->sample[n].invalid = 1;
+		}
+		if ( data!=NULL )
+		{
+			for ( n=0 ; n<tape->n_samples ; n++ )
+				tape->sample[n].offset = n*width;
+			free(tape->data);
+			tape->data = data;
+			tape->width = width;
 		}
-		else if (sscanf(timebuf,"%" FMT_INT64 "d%1s", &t1, unit)==2)
+	}
+
+	/* the first pass can be searched when it only moves forward in whole seconds with valid values */
+	if ( tape->width>0 && tape->n_samples>0 )
+	{
+		TIMESTAMP ts = TS_ZERO;
+		tape->first = (TIMESTAMP*)malloc(sizeof(TIMESTAMP)*tape->n_samples);
+		for ( n=0 ; tape->first!=NULL && n<tape->n_samples ; n++ )
 		{
+			PLAYERSAMPLE *sample = tape->sample+n;
+			TIMESTAMP next = ( sample->kind==PS_SHIFT ? ts+sample->ts : sample->ts );
+			if ( sample->ns!=0 || sample->ts==TS_INVALID || sample->invalid || next<ts )
 			{
-				int64 scale=1;
-				switch(unit[0]) {
-				case 's': scale=TS_SECOND; break;
-				case 'm': scale=60*TS_SECOND; break;
-				case 'h': scale=3600*TS_SECOND; break;
-				case 'd': scale=86400*TS_SECOND; break;
-				default: break;
-				}
-				t1 *= scale;
-				if (result[0]=='+'){ /* timeshifts have leading + */
-					my->next.ts += t1;
-					while(value[voff] == ' '){
-						++voff;
-					}
-					strcpy(my->next.value, value+voff);
-				} else if (my->loop==my->loopnum){ /* absolute times are ignored on all but first loops */
-					my->next.ts = t1;
-					while(value[voff] == ' '){
-						++voff;
-					}
-					strcpy(my->next.value, value+voff);
-				}
+				free(tape->first);
+				tape->first = NULL;
 			}
+			else
+				tape->first[n] = ts = next;
 		}
-		else if (sscanf(timebuf,"%lf", &S)==1)
+	}
+	gl_verbose("player:%d: loaded %u samples from '%s' (%s values)", obj->id, tape->n_samples, my->file, tape->width>0?"typed":"text");
+	return tape;
+}
+
+/** Attach the player to its tape, loading it unless another player
+	already loaded the same source for the same target property
+	@return 1 on success, 0 on failure
+ **/
+static int player_load(OBJECT *obj)
+{
+	struct player *my = OBJECTDATA(obj,struct player);
+	PLAYERTAPE *tape;
+
+	if ( my->target==NULL && obj->parent!=NULL )
+		my->target = gl_get_property(obj->parent,my->property,NULL);
+
+	pthread_mutex_lock(&tape_lock);
+	for ( tape=tape_list ; tape!=NULL ; tape=tape->next )
+	{
+		if ( tape->target==my->target && strcmp(tape->file,my->file)==0 && strcmp(tape->filetype,my->filetype)==0 )
+			break;
+	}
+	if ( tape==NULL && (tape=player_load_tape(obj))!=NULL )
+	{
+		strcpy(tape->file,my->file);
+		strcpy(tape->filetype,my->filetype);
+		tape->target = my->target;
+		tape->next = tape_list;
+		tape_list = tape;
+	}
+	pthread_mutex_unlock(&tape_lock);
+	if ( tape==NULL )
+		return 0;
+
+	close_player(my);
+	my->status = TS_OPEN;
+	my->tape = tape;
+	my->pos = 0;
+	return 1;
+}
+
+/** Post a sample value to the target property
+ **/
+void player_post(OBJECT *obj, struct player *my, PLAYERSAMPLE *sample)
+{
+	OBJECT *target = obj->parent ? obj->parent : obj; /* target myself if no parent */
+	char *value;
+	if ( sample==NULL || my->target==NULL || my->tape==NULL )
+		return;
+	value = my->tape->data+sample->offset;
+	if ( my->tape->width>0 )
+	{
+		/* same as gl_set_value() for targets without notifiers */
+		if ( my->target->flags&PF_RECALC ) target->flags |= OF_RECALC;
+		if ( !sample->invalid )
+			memcpy(GETADDR(target,my->target),value,my->tape->width);
+		gl_wake(target);
+	}
+	else
+		gl_set_value(target,GETADDR(target,my->target),value,my->target); /* pointer => int64 */
+}
+
+TIMESTAMP player_read(OBJECT *obj)
+{
+	struct player *my = OBJECTDATA(obj,struct player);
+	PLAYERTAPE *tape = my->tape;
+	PLAYERSAMPLE *sample;
+
+	if ( tape==NULL || my->pos>=tape->n_samples )
+	{
+		if ( tape!=NULL && my->loopnum>0 && tape->n_samples>0 )
 		{
-			if (my->loop==my->loopnum) {
-				my->next.ts = (unsigned short)S;
-				my->next.ns = (unsigned int)(1e9*(S-my->next.ts));
-				if ((obj->flags & OF_DELTAMODE)==OF_DELTAMODE)	/* Only request deltamode if we're explicitly enabled */
-					enable_deltamode(my->next.ns==0?TS_NEVER:t1);
-				while(value[voff] == ' '){
-					++voff;
-				}
-				strcpy(my->next.value, value+voff);
-			}
+			my->pos = 0;
+			my->loopnum--;
 		}
 		else
 		{
-			gl_warning("player was unable to parse timestamp \'%s\'", result);
+			my->status=TS_DONE;
+			my->next.ts = TS_NEVER;
+			my->next.ns = 0;
+			goto Done;
 		}
-	} else {
-		gl_warning("player was unable to split input string \'%s\'", result);
+	}
+	sample = tape->sample + my->pos++;
+	switch ( sample->kind ) {
+	case PS_DATETIME:
+		if ((obj->flags & OF_DELTAMODE)==OF_DELTAMODE)	/* Only request deltamode if we're explicitly enabled */
+			enable_deltamode(sample->ns==0?TS_NEVER:sample->ts);
+		if (sample->ts!=TS_INVALID && my->loop==my->loopnum){
+			my->next.ts = sample->ts;
+			my->next.ns = sample->ns;
+			my->next.sample = sample;
+		}
+		break;
+	case PS_SHIFT:
+		my->next.ts += sample->ts;
+		my->next.sample = sample;
+		break;
+	case PS_TIME:
+		if (my->loop==my->loopnum){ /* absolute times are ignored on all but first loops */
+			my->next.ts = sample->ts;
+			my->next.sample = sample;
+		}
+		break;
+	case PS_SECONDS:
+		if (my->loop==my->loopnum) {
+			my->next.ts = sample->ts;
+			my->next.ns = sample->ns;
+			if ((obj->flags & OF_DELTAMODE)==OF_DELTAMODE)	/* Only request deltamode if we're explicitly enabled */
+				enable_deltamode(my->next.ns==0?TS_NEVER:sample->ts);
+			my->next.sample = sample;
+		}
+		break;
 	}
 
 Done:
 	return my->next.ns==0 ? my->next.ts : (my->next.ts+1);
 }
 
+/** Skip to the last sample at or before t0 on the first pass of a typed tape.
+	The samples skipped would only have been overwritten by the next one.
+	@return the time of the next sample
+ **/
+static TIMESTAMP player_seek(OBJECT *obj, TIMESTAMP t0, TIMESTAMP t1)
+{
+	struct player *my = OBJECTDATA(obj,struct player);
+	PLAYERTAPE *tape = my->tape;
+	unsigned int lo = my->pos, hi = tape->n_samples;
+	if ( tape->first==NULL || my->loop!=my->loopnum || (obj->flags&OF_DELTAMODE)==OF_DELTAMODE
+		|| lo>=hi || tape->first[lo]>t0 )
+		return t1;
+	/* find the last sample with first[n]<=t0 */
+	while ( hi-lo>1 )
+	{
+		unsigned int mid = (lo+hi)/2;
+		if ( tape->first[mid]<=t0 ) lo = mid; else hi = mid;
+	}
+	my->pos = lo+1;
+	my->next.ts = tape->first[lo];
+	my->next.ns = 0;
+	my->next.sample = tape->sample+lo;
+	return my->next.ts;
+}
+
 EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 {
 	struct player *my = OBJECTDATA(obj,struct player);
@@ -348,11 +557,21 @@ EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 		{
 			gl_error("sync_player: Unable to open player file '%s' for object '%s'", my->file, obj->name?obj->name:"(anon)");
 		}
+		else if (player_load(obj) == 0)
+		{
+			my->status = TS_ERROR;
+			t1 = TS_NEVER;
+		}
 		else
 		{
 			t1 = player_read(obj);
 		}
 	}
+
+	/* samples before t0 would be overwritten by the last one anyway */
+	if (my->status==TS_OPEN && t1<t0 && my->next.ns==0)
+		t1 = player_seek(obj,t0,t1);
+
 	while (my->status==TS_OPEN && t1<=t0
 		&& my->next.ns==0 ) /* only use this method when not operating in subsecond mode */
 	{	/* post this value */
@@ -363,15 +582,12 @@ EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 			my->status = TS_ERROR;
 		}
 		if (my->target!=NULL)
-		{
-			OBJECT *target = obj->parent ? obj->parent : obj; /* target myself if no parent */
-			gl_set_value(target,GETADDR(target,my->target),my->next.value,my->target); /* pointer => int64 */
-		}
+			player_post(obj,my,my->next.sample);
 		
 		/* Copy the current value into our "tracking" variable */
 		my->delta_track.ns = my->next.ns;
 		my->delta_track.ts = my->next.ts;
-		memcpy(my->delta_track.value,my->next.value,sizeof(char256));
+		my->delta_track.sample = my->next.sample;
 
 		t1 = player_read(obj);
 	}
@@ -379,8 +595,7 @@ EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 	/* Apply an intermediate value, if necessary - mainly for "DELTA players in non-delta situations" */
 	if ((my->target!=NULL) && (my->delta_track.ts<t0) && (my->delta_track.ns!=0))
 	{
-		OBJECT *target = obj->parent ? obj->parent : obj; /* target myself if no parent */
-		gl_set_value(target,GETADDR(target,my->target),my->delta_track.value,my->target); /* pointer => int64 */
+		player_post(obj,my,my->delta_track.sample);
 	}
 
 	/* Delta-mode catch - if we're not explicitly in delta mode and a nano-second values pops up, try to advance past it */
@@ -403,15 +618,12 @@ EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 			/* Post the value as we go, so the "final" is correct */
 			/* Apply the "current value", if it is relevant (player_next_value contains the previous, so this will override it) */
 			if ((my->target!=NULL) && (my->next.ts<t0))
-			{
-				OBJECT *target = obj->parent ? obj->parent : obj; /* target myself if no parent */
-				gl_set_value(target,GETADDR(target,my->target),my->next.value,my->target); /* pointer => int64 */
-			}
+				player_post(obj,my,my->next.sample);
 
 			/* Copy the value into the tracking variable */
 			my->delta_track.ns = my->next.ns;
 			my->delta_track.ts = my->next.ts;
-			memcpy(my->delta_track.value,my->next.value,sizeof(char256));
+			my->delta_track.sample = my->next.sample;
 
 			/* Perform the update */
 			temp_t = player_read(obj);
@@ -430,15 +642,12 @@ EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 				/* Post the value as we go, so the "final" is correct */
 				/* Apply the "current value", if it is relevant (player_next_value contains the previous, so this will override it) */
 				if ((my->target!=NULL) && (my->next.ts<t0))
-				{
-					OBJECT *target = obj->parent ? obj->parent : obj; /* target myself if no parent */
-					gl_set_value(target,GETADDR(target,my->target),my->next.value,my->target); /* pointer => int64 */
-				}
+					player_post(obj,my,my->next.sample);
 
 				/* Copy the value into the tracking variable */
 				my->delta_track.ns = my->next.ns;
 				my->delta_track.ts = my->next.ts;
-				memcpy(my->delta_track.value,my->next.value,sizeof(char256));
+				my->delta_track.sample = my->next.sample;
 
 				/* Perform the update */
 				temp_t = player_read(obj);
@@ -462,7 +671,7 @@ EXPORT TIMESTAMP sync_player(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 			/* Copy the value into the tracking variable */
 			my->delta_track.ns = my->next.ns;
 			my->delta_track.ts = my->next.ts;
-			memcpy(my->delta_track.value,my->next.value,sizeof(char256));
+			my->delta_track.sample = my->next.sample;
 
 			/* Perform the update */
 			temp_t = player_read(obj);
@@ -27,6 +27,7 @@
 #include "tape.h"
 #include "file.h"
 #include "odbc.h"
+#include "binary.h"
 
 #ifndef WIN32
 #define strtok_s strtok_r
@@ -99,6 +100,7 @@ EXPORT int create_recorder(OBJECT **obj, OBJECT *parent)
 		my->header_units = HU_DEFAULT;
 		my->line_units = LU_DEFAULT;
 		my->flush = -1; /* -1 (default): flush when buffer full, 0 flush each line, >0 flush seconds */
+		my->channel = NULL;
 		return 1;
 	}
 	return 0;
@@ -127,6 +129,10 @@ static int recorder_open(OBJECT *obj)
 		/* use object name-id as default file name */
 		sprintf(fname,"%s-%d.%s",obj->parent->oclass->name,obj->parent->id, my->filetype);
 
+	/* binary recorders share one file written by a background thread */
+	if ( strcmp(my->filetype,"bin")==0 )
+		return binary_open_recorder(my,fname);
+
 	/* open multiple-run input file & temp output file */
 	if(my->type == FT_FILE && my->multifile[0] != 0){
 		if(my->interval < 1){
@@ -365,6 +371,10 @@ static int write_recorder(struct recorder *my, char *ts, char *value)
 
 static void close_recorder(struct recorder *my)
 {
+	if (my->type==FT_BINARY){
+		binary_close_recorder(my);
+		return;
+	}
 	if (my->ops){
 		my->ops->close(my);
 	}
@@ -646,6 +656,17 @@ EXPORT TIMESTAMP sync_recorder(OBJECT *obj, TIMESTAMP t0, PASSCONFIG pass)
 		goto Error;
 	}
 
+	/* binary recorders copy raw values and leave formatting to the converter */
+	if (strcmp(my->filetype,"bin")==0)
+	{
+		if (my->status==TS_INIT && !recorder_open(obj))
+		{
+			my->status = TS_DONE;
+			return TS_NEVER;
+		}
+		return binary_sync_recorder(my,t0);
+	}
+
 	// update clock
 	if ((my->status==TS_OPEN) && (t0 > obj->clock)) 
 	{	
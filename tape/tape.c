@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <ctype.h>
+#include <pthread.h>
 #include "gridlabd.h"
 #include "object.h"
 #include "aggregate.h"
@@ -29,6 +30,7 @@
 #include "tape.h"
 #include "file.h"
 #include "odbc.h"
+#include "binary.h"
 
 #define MAP_DOUBLE(X,LO,HI) {#X,VT_DOUBLE,&X,LO,HI}
 #define MAP_INTEGER(X,LO,HI) {#X,VT_INTEGER,&X,LO,HI}
@@ -94,7 +96,7 @@ typedef void (*CLOSEFUNC)(void *);
 typedef void (*VOIDCALL)(void);
 typedef void (*FLUSHFUNC)(void*);
 
-TAPEFUNCS *get_ftable(char *mode){
+static TAPEFUNCS *load_ftable(char *mode){
 	/* check what we've already loaded */
 	char256 modname;
 	TAPEFUNCS *fptr = funcs;
@@ -114,6 +116,8 @@ TAPEFUNCS *get_ftable(char *mode){
 		gl_error("get_ftable(char *mode='%s'): out of memory", mode);
 		return NULL; /* out of memory */
 	}
+	strncpy(fptr->mode, mode, sizeof(fptr->mode)-1);
+	fptr->mode[sizeof(fptr->mode)-1] = '\0';
 	snprintf(modname, sizeof(modname), "tape_%s" DLEXT, mode);
 	
 	if(gl_findfile(modname, NULL, 0|4, tpath,sizeof(tpath)) == NULL){
@@ -182,6 +186,17 @@ TAPEFUNCS *get_ftable(char *mode){
 	return funcs;
 }
 
+/* tapes may be opened by several threads during their first sync */
+static pthread_mutex_t ftable_lock = PTHREAD_MUTEX_INITIALIZER;
+
+TAPEFUNCS *get_ftable(char *mode){
+	TAPEFUNCS *fptr;
+	pthread_mutex_lock(&ftable_lock);
+	fptr = load_ftable(mode);
+	pthread_mutex_unlock(&ftable_lock);
+	return fptr;
+}
+
 EXPORT CLASS *init(CALLBACKS *fntable, void *module, int argc, char *argv[])
 {
 	struct recorder my;
@@ -203,6 +218,8 @@ EXPORT CLASS *init(CALLBACKS *fntable, void *module, int argc, char *argv[])
 	gl_global_create("tape::flush_interval",PT_int32,&flush_interval,NULL);
 	gl_global_create("tape::csv_data_only",PT_int32,&csv_data_only,NULL);
 	gl_global_create("tape::csv_keep_clean",PT_int32,&csv_keep_clean,NULL);
+	gl_global_create("tape::binary_file",PT_char1024,&binary_file,NULL);
+	gl_global_create("tape::binary_queue_size",PT_int32,&binary_queue_size,NULL);
 
 	/* control delta mode */
 	gl_global_create("tape::delta_mode_needed", PT_timestamp, &delta_mode_needed,NULL);
@@ -367,6 +384,18 @@ EXPORT int check(void)
 	return errcount;
 }
 
+EXPORT void term(void)
+{
+	/* flush and close the shared binary recorder file */
+	binary_term();
+}
+
+/* converts a binary recorder file to CSV files, e.g., import tape "recorder.bin"; */
+EXPORT int import_file(const char *filename)
+{
+	return binary_convert(filename);
+}
+
 /* DELTA MODE SUPPORT */
 /*
 	Delta mode is supported by maintaining a list of recorders that are enabled
@@ -505,22 +534,20 @@ EXPORT SIMULATIONMODE interupdate(MODULE *module, TIMESTAMP t0, unsigned int64 d
 		int y=0,m=0,d=0,H=0,M=0,S=0,ms=0, n=0;
 		char *fmt = "%d/%d/%d %d:%d:%d.%d,%*s";
 		double t = (double)my->next.ts + (double)my->next.ns/1e9;
-		char256 curr_value;
 
 		/* See if we're in service */
 		if ((obj->in_svc_double <= gl_globaldeltaclock) && (obj->out_svc_double >= gl_globaldeltaclock))
 		{
-			strcpy(curr_value,my->next.value);
-
 			/* post the current value */
 			if ( t<=clock_val )
 			{
 				extern TIMESTAMP player_read(OBJECT *obj);
+				extern void player_post(OBJECT *obj, struct player *my, PLAYERSAMPLE *sample);
 
 				/* Behave similar to "supersecond" players */
 				while ( t<=clock_val )
 				{
-					gl_set_value(obj->parent,GETADDR(obj->parent,my->target),my->next.value,my->target); /* pointer => int64 */
+					player_post(obj,my,my->next.sample);
 
 					/* read the next value */
 					player_read(obj);
@@ -15,7 +15,7 @@
 static char timestamp_format[32]="%Y-%m-%d %H:%M:%S";
 typedef enum {VT_INTEGER, VT_DOUBLE, VT_STRING} VARIABLETYPE;
 typedef enum {TS_INIT, TS_OPEN, TS_DONE, TS_ERROR} TAPESTATUS;
-typedef enum {FT_FILE, FT_ODBC, FT_MEMORY} FILETYPE;
+typedef enum {FT_FILE, FT_ODBC, FT_MEMORY, FT_BINARY} FILETYPE;
 typedef enum {SCREEN, EPS, GIF, JPG, PDF, PNG, SVG} PLOTFILE;
 typedef enum e_complex_part {NONE = 0, REAL, IMAG, MAG, ANG, ANG_RAD} CPLPT;
 
@@ -62,6 +62,30 @@ typedef struct s_recobjmap {
   @addtogroup player
 	@{ 
  **/
+typedef enum {
+	PS_DATETIME, /**< absolute date and time */
+	PS_TIME, /**< absolute time with a unit */
+	PS_SHIFT, /**< relative time (leading +) */
+	PS_SECONDS, /**< absolute time in seconds */
+} PLAYERSAMPLEKIND;
+typedef struct s_playersample {
+	TIMESTAMP ts; /**< time (or time shift) of the sample, TS_INVALID if it cannot be used */
+	int64 ns; /**< nanoseconds of the sample time */
+	unsigned int offset; /**< offset of the value in the tape data */
+	PLAYERSAMPLEKIND kind;
+	int16 invalid; /**< the value could not be converted to the target type */
+} PLAYERSAMPLE; /**< a player sample parsed when the tape is opened */
+typedef struct s_playertape {
+	unsigned int n_samples;
+	PLAYERSAMPLE *sample;
+	unsigned int width; /**< bytes per value when stored in the target type, 0 when stored as text */
+	char *data; /**< sample values */
+	TIMESTAMP *first; /**< sample times on the first pass, NULL if they cannot be searched */
+	char1024 file; /**< the source the tape was loaded from */
+	char8 filetype; /**< the type of the source */
+	PROPERTY *target; /**< the property the values were converted for */
+	struct s_playertape *next; /**< next tape loaded */
+} PLAYERTAPE; /**< a player tape loaded in memory */
 struct player {
 	/* public */
 	char1024 file; /**< the name of the player source */
@@ -82,16 +106,18 @@ struct player {
 	struct {
 		TIMESTAMP ts;
 		int64 ns;
-		char256 value;
+		PLAYERSAMPLE *sample;
 	} next;
 	struct {
 		TIMESTAMP ts;
 		TIMESTAMP ns;
-		char256 value;
+		PLAYERSAMPLE *sample;
 	} delta_track;	/* Added for deltamode fixes */
 	PROPERTY *target;
 	TAPEOPS *ops;
 	char lasterr[1024];
+	PLAYERTAPE *tape; /**< samples loaded when the player is opened */
+	unsigned int pos; /**< next sample to read from the tape */
 }; /**< a player item */
 /** @}
 	@addtogroup shaper
@@ -179,6 +205,7 @@ struct recorder {
 	} last;
 	int32 samples;
 	PROPERTY *target;
+	struct s_binarychannel *channel; /* binary output channel (filetype "bin") */
 };
 /** @}
 	@addtogroup collector
@@ -17,6 +17,7 @@ third_party_superLU_MT_libsuperlu_la_SOURCES =
 # from third_party/CBLAS
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dasum.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/daxpy.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dcabs1.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dcopy.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/ddot.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dgemv.c
@@ -27,15 +28,28 @@ third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dscal.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dsymv.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dsyr2.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dtrsv.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dzasum.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/dznrm2.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/f2c.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/idamax.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/izamax.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/slu_Cnames.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/superlu_f2c.h
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zaxpy.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zcopy.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zdotc.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zgemv.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zgerc.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zhemv.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zher2.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/zscal.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/CBLAS/ztrsv.c
 # from third_party/superLU_MT
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/await.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/colamd.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/colamd.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dclock.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dcomplex.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dgscon.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dgsequ.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dgsrfs.c
@@ -50,8 +64,10 @@ third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dpivotgro
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dreadhb.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dsp_blas2.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dsp_blas3.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/dzsum1.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/get_perm_c.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/heap_relax_snode.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/izmax1.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/lsame.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/mmd.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pdgssv.c
@@ -86,7 +102,31 @@ third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pxgstrf_s
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pxgstrf_super_bnd_dfs.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pxgstrf_synch.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pxgstrf_synch.h
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgssv.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgssvx.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_bmod1D.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_bmod1D_mv2.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_bmod2D.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_bmod2D_mv2.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_column_bmod.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_column_dfs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_copy_to_ucol.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_factor_snode.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_init.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_panel_bmod.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_panel_dfs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_pivotL.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_snode_bmod.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_snode_dfs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_thread.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_thread_finalize.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzgstrf_thread_init.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzmemory.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzsp_defs.h
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/pzutil.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/qrnzcnt.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/slu_dcomplex.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/slu_mt_Cnames.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/slu_mt_machines.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/slu_mt_util.h
@@ -97,4 +137,17 @@ third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/superlu_t
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/supermatrix.h
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/util.c
 third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/xerbla.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zgscon.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zgsequ.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zgsrfs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zgstrs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zlacon.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zlangs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zlaqgs.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zmatgen.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zmyblas2.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zpivotgrowth.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zreadhb.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zsp_blas2.c
+third_party_superLU_MT_libsuperlu_la_SOURCES += third_party/superLU_MT/zsp_blas3.c
 
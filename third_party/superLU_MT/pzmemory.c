@@ -302,7 +302,7 @@ pzgstrf_MemInit(int n, int annz, superlumt_options_t *superlumt_options,
 	}
 	
 	if ( !lusup )  {
-	    float t = pdgstrf_memory_use(nzlmax, nzumax, nzlumax) + n;
+	    float t = pzgstrf_memory_use(nzlmax, nzumax, nzlumax) + n;
 	    printf("Not enough memory to perform factorization .. "
 		   "need %.1f GBytes\n", t*1e-9);
 	    fflush(stdout);
@@ -265,6 +265,8 @@ extern void pxgstrf_scheduler (const int, const int, const int *,
 			       int *, int *, pxgstrf_shared_t *);
 extern int  zParallelInit (int, pxgstrf_relax_t *, superlumt_options_t *,
 			  pxgstrf_shared_t *);
+extern int  ParallelInit (int, pxgstrf_relax_t *, superlumt_options_t *,
+			  pxgstrf_shared_t *);
 extern int  ParallelFinalize ();
 extern int  queue_init (queue_t *, int);
 extern int  queue_destroy (queue_t *);
@@ -312,6 +314,8 @@ extern void StatFree  (Gstat_t*);
 extern void get_perm_c(int, SuperMatrix *, int *);
 extern void zsp_colorder (SuperMatrix *, int *, superlumt_options_t *,
 			 SuperMatrix *);
+extern void sp_colorder (SuperMatrix *, int *, superlumt_options_t *,
+			 SuperMatrix *);
 extern int  sp_coletree (int *, int *, int *, int, int, int *);
 extern int  zPresetMap (const int, SuperMatrix *, pxgstrf_relax_t *, 
 		       superlumt_options_t *, GlobalLU_t *);
@@ -333,6 +337,10 @@ extern void pzgstrf_finalize(superlumt_options_t *, SuperMatrix *);
 extern void pxgstrf_finalize(superlumt_options_t *, SuperMatrix *);
 extern void pzgstrf_relax_snode (const int, superlumt_options_t *,
 				 pxgstrf_relax_t *);
+extern void pxgstrf_relax_snode (const int, superlumt_options_t *,
+				 pxgstrf_relax_t *);
+extern void heap_relax_snode (const int, superlumt_options_t *,
+			      pxgstrf_relax_t *);
 extern int
 pzgstrf_factor_snode (const int, const int, SuperMatrix *, const double,
 		      yes_no_t *, int *, int *, int*, int*, int*, int*,